@@ -0,0 +1,21 @@
+#include "BridgeAPI.h"
+
+#define ENGINEDLL_EXPORTS
+
+using namespace lark;
+
+extern "C"
+{
+    ENGINE_API bool OpenControlBridge(const bridge::config *config)
+    {
+        return config && bridge::open(*config);
+    }
+
+    ENGINE_API void CloseControlBridge() { bridge::close(); }
+
+    ENGINE_API void GetControlBridgeStatus(bridge::status *status)
+    {
+        if (status)
+            *status = bridge::get_status();
+    }
+}
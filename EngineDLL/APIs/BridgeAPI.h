@@ -0,0 +1,18 @@
+#pragma once
+#include "EngineCoreAPI.h"
+#include "Bridge.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Publishes drone states and sensor frames to a named shared region and applies the
+    // commands external controllers write back, see Bridge.h for the layout
+    ENGINE_API bool OpenControlBridge(const lark::bridge::config *config);
+    ENGINE_API void CloseControlBridge();
+    ENGINE_API void GetControlBridgeStatus(lark::bridge::status *status);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,37 @@
+#include "ChangeTrackingAPI.h"
+
+#define ENGINEDLL_EXPORTS
+
+using namespace lark;
+
+extern "C"
+{
+    ENGINE_API u64 GetCurrentChangeFrame() { return changes::current_frame(); }
+
+    ENGINE_API u32 GetChangedEntities(changes::component_type type, u64 since_frame,
+                                      id::id_type *out_ids, u32 capacity)
+    {
+        if (type >= changes::component_type::count)
+            return 0;
+
+        return changes::get_changed_since(type, since_frame, out_ids, capacity);
+    }
+
+    ENGINE_API u64 GetEntityLastChange(id::id_type entity_id, changes::component_type type)
+    {
+        if (!engine::is_entity_valid(entity_id) || type >= changes::component_type::count)
+            return 0;
+
+        return changes::last_changed(type, game_entity::entity_id{entity_id});
+    }
+
+    ENGINE_API u32 GetRemovedEntities(u64 since_frame, id::id_type *out_ids, u32 capacity)
+    {
+        return changes::get_removed_since(since_frame, out_ids, capacity);
+    }
+
+    ENGINE_API void DiscardRemovedEntities(u64 before_frame)
+    {
+        changes::discard_removed_before(before_frame);
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "EngineCoreAPI.h"
+#include "ChangeTracking.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    ENGINE_API u64 GetCurrentChangeFrame();
+    ENGINE_API u32 GetChangedEntities(lark::changes::component_type type, u64 since_frame,
+                                      lark::id::id_type *out_ids, u32 capacity);
+    ENGINE_API u64 GetEntityLastChange(lark::id::id_type entity_id,
+                                       lark::changes::component_type type);
+    ENGINE_API u32 GetRemovedEntities(u64 since_frame, lark::id::id_type *out_ids, u32 capacity);
+    ENGINE_API void DiscardRemovedEntities(u64 before_frame);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,9 +1,13 @@
 #include "EngineUtilities.h"
+#include "Bridge.h"
+#include "ChangeTracking.h"
 #include "Core/GameLoop.h"
+#include "Core/JobSystem.h"
 #include "Geometry.h"
 #include "Geometry/MeshPrimitives.h"
 #include "Physics.h"
 #include "Script.h"
+#include "ScriptRuntime.h"
 #include "Drone.h"
 #include "Transform.h"
 #include <glm/glm.hpp>
@@ -362,6 +366,9 @@ std::shared_ptr<drone::Wind> chooseWind(const wind& wind_config)
 
 void cleanup_engine_systems()
 {
+    // Wakes clients still waiting for frames before the drones go away
+    bridge::close();
+
     std::vector<id::id_type> to_remove;
     for (id::id_type i = 0; i < active_entities.size(); ++i)
     {
@@ -378,5 +385,14 @@ void cleanup_engine_systems()
 
     active_entities.clear();
     script::shutdown();
+    script::runtime::shutdown();
+    changes::shutdown();
+    jobs::shutdown();
+}
+
+void ensure_job_system()
+{
+    // Host reference shared by the geometry calls, game loops hold their own
+    jobs::initialize();
 }
 } // namespace engine
\ No newline at end of file
@@ -24,6 +24,7 @@ game_entity::entity entity_from_id(id::id_type id);
 bool is_entity_valid(id::id_type id);
 void remove_entity(id::id_type id);
 void cleanup_engine_systems();
+void ensure_job_system();
 
 extern std::unique_ptr<GameLoop> g_game_loop;
 extern util::vector<bool> active_entities;
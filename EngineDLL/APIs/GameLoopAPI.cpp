@@ -45,4 +45,24 @@ extern "C"
     {
         return engine::g_game_loop ? engine::g_game_loop->get_fps() : 0;
     }
+
+    ENGINE_API u32 GameLoop_GetSystemTimings(SystemTiming *out_timings, u32 capacity)
+    {
+        if (!engine::g_game_loop)
+            return 0;
+
+        const auto &timings = engine::g_game_loop->get_system_timings();
+        const u32 count{(u32)timings.size()};
+        if (out_timings)
+        {
+            for (u32 i{0}; i < std::min(count, capacity); ++i)
+                out_timings[i] = timings[i];
+        }
+        return count;
+    }
+
+    ENGINE_API u64 GameLoop_GetAllocationsLastTick()
+    {
+        return engine::g_game_loop ? engine::g_game_loop->get_allocations_last_tick() : 0;
+    }
 }
\ No newline at end of file
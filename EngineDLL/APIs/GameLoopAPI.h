@@ -12,6 +12,12 @@ extern "C"
     ENGINE_API f32 GameLoop_GetDeltaTime();
     ENGINE_API u32 GameLoop_GetFPS();
 
+    // Copies up to capacity timings and returns the number of systems
+    ENGINE_API u32 GameLoop_GetSystemTimings(lark::SystemTiming *out_timings, u32 capacity);
+
+    // Heap allocations of the last tick, 0 unless built with LARK_TRACK_ALLOCATIONS
+    ENGINE_API u64 GameLoop_GetAllocationsLastTick();
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,6 +29,7 @@ extern "C"
 
         // Let the engine create the mesh
         printf("[CreatePrimitiveMesh] Calling engine CreatePrimitiveMesh\n");
+        engine::ensure_job_system();
         lark::api::create_primitive_mesh(&engine_data, &engine_info);
 
         // Just pass through the engine's buffer
@@ -49,6 +50,7 @@ extern "C"
     {
         auto engine_data = lark::tools::scene_data{};
         engine_data.settings = data->import_settings;
+        engine::ensure_job_system();
         lark::api::load_geometry(path, &engine_data);
 
         if (engine_data.buffer && engine_data.buffer_size > 0)
@@ -64,6 +66,7 @@ extern "C"
     ENGINE_API bool ModifyEntityVertexPositions(lark::id::id_type entity_id,
                                                 std::vector<glm::vec3> &new_positions)
     {
+        engine::ensure_job_system();
         if (lark::api::update_dynamic_mesh(entity_id, new_positions))
         {
             return true;
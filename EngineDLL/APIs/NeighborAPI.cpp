@@ -0,0 +1,33 @@
+#include "NeighborAPI.h"
+
+#define ENGINEDLL_EXPORTS
+
+using namespace lark;
+
+extern "C"
+{
+    ENGINE_API void ConfigureNeighbors(const neighbors::config *config)
+    {
+        if (config)
+            neighbors::configure(*config);
+    }
+
+    ENGINE_API u32 QueryDroneRadius(const u32 *drones, u32 count, f32 radius, u32 *indices,
+                                    f32 *distances, u32 *counts, u32 capacity)
+    {
+        if (!drones || !indices || !counts)
+            return 0;
+
+        return neighbors::drone_radius(drones, count, radius,
+                                       {indices, distances, counts, capacity});
+    }
+
+    ENGINE_API void QueryDroneNearest(const u32 *drones, u32 count, u32 k, u32 *indices,
+                                      f32 *distances, u32 *counts, u32 capacity)
+    {
+        if (!drones || !indices || !counts || k > capacity)
+            return;
+
+        neighbors::drone_nearest(drones, count, k, {indices, distances, counts, capacity});
+    }
+}
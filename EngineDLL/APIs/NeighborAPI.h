@@ -0,0 +1,22 @@
+#pragma once
+#include "EngineCoreAPI.h"
+#include "Neighbors.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    ENGINE_API void ConfigureNeighbors(const lark::neighbors::config *config);
+
+    // Neighbors of drones (dense indices) as of the last tick, capacity entries per drone.
+    // distances may be null. counts receives the entries written per drone. QueryDroneRadius
+    // returns how many drones had more neighbors in range than capacity.
+    ENGINE_API u32 QueryDroneRadius(const u32 *drones, u32 count, f32 radius, u32 *indices,
+                                    f32 *distances, u32 *counts, u32 capacity);
+    ENGINE_API void QueryDroneNearest(const u32 *drones, u32 count, u32 k, u32 *indices,
+                                      f32 *distances, u32 *counts, u32 capacity);
+
+#ifdef __cplusplus
+}
+#endif
@@ -80,4 +80,49 @@ extern "C"
         return true;
     }
 
-}
\ No newline at end of file
+    u32 GetContactEvents(lark::physics::contact_event *events, u32 capacity)
+    {
+        auto* world = physics::WorldRegistry::instance().get_active_world();
+        if (!world)
+            return 0;
+
+        const auto& contacts = world->contacts();
+        const u32 count{contacts.event_count()};
+        if (events)
+            std::copy_n(contacts.events(), std::min(count, capacity), events);
+        return count;
+    }
+
+    u32 GetEntityContactEvents(lark::id::id_type entity_id, lark::physics::contact_event *events,
+                               u32 capacity)
+    {
+        auto* world = physics::WorldRegistry::instance().get_active_world();
+        if (!world)
+            return 0;
+
+        return world->contacts().events_of(entity_id, events, events ? capacity : 0);
+    }
+
+    void ConfigureDynamicsLod(const drone::lod_config *config)
+    {
+        if (config)
+            drone::configure_lod(*config);
+    }
+
+    void GetDynamicsLodStats(drone::lod_stats *stats)
+    {
+        if (stats)
+            *stats = drone::get_lod_stats();
+    }
+
+    u32 GetDroneLodLevels(drone::lod_level *levels, u32 capacity)
+    {
+        const u32 count{drone::count()};
+        if (levels)
+        {
+            for (u32 i{0}; i < std::min(count, capacity); ++i)
+                levels[i] = drone::lod_at(i);
+        }
+        return count;
+    }
+}
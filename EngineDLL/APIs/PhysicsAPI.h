@@ -1,6 +1,7 @@
 #pragma once
 #include "EngineCoreAPI.h"
 #include "EngineUtilities.h"
+#include "PhysicExtension/Event/Contacts.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -11,6 +12,18 @@ extern "C"
 
     ENGINE_API bool SetWorldSettings(wind windtyp);
     ENGINE_API bool SetWind(wind_type type, glm::vec3 windVec, glm::vec3 windAmp, glm::vec3 windFreq);
+
+    // Contact events of the last physics step. Both return the total number of
+    // events, copy at most capacity of them and can be called with a null buffer
+    ENGINE_API u32 GetContactEvents(lark::physics::contact_event *events, u32 capacity);
+    ENGINE_API u32 GetEntityContactEvents(lark::id::id_type entity_id,
+                                          lark::physics::contact_event *events, u32 capacity);
+
+    // Dynamics level of detail. Levels are written in dense drone order, the
+    // return value is the number of drones
+    ENGINE_API void ConfigureDynamicsLod(const lark::drone::lod_config *config);
+    ENGINE_API void GetDynamicsLodStats(lark::drone::lod_stats *stats);
+    ENGINE_API u32 GetDroneLodLevels(lark::drone::lod_level *levels, u32 capacity);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,30 @@
+#include "SensorAPI.h"
+
+#define ENGINEDLL_EXPORTS
+
+using namespace lark;
+
+extern "C"
+{
+    ENGINE_API void ConfigureSensors(const sensors::config *config)
+    {
+        if (config)
+            sensors::configure(*config);
+    }
+
+    ENGINE_API u32 ReadImuSamples(u64 *cursor, sensors::imu_sample *out, u32 capacity)
+    {
+        if (!cursor || !out)
+            return 0;
+
+        return sensors::read_imu(*cursor, out, capacity);
+    }
+
+    ENGINE_API u32 ReadMocapSamples(u64 *cursor, sensors::mocap_sample *out, u32 capacity)
+    {
+        if (!cursor || !out)
+            return 0;
+
+        return sensors::read_mocap(*cursor, out, capacity);
+    }
+}
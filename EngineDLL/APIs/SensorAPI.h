@@ -0,0 +1,18 @@
+#pragma once
+#include "EngineCoreAPI.h"
+#include "Sensors.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    ENGINE_API void ConfigureSensors(const lark::sensors::config *config);
+
+    // Copy the samples written since *cursor and advance it, return the number copied
+    ENGINE_API u32 ReadImuSamples(u64 *cursor, lark::sensors::imu_sample *out, u32 capacity);
+    ENGINE_API u32 ReadMocapSamples(u64 *cursor, lark::sensors::mocap_sample *out, u32 capacity);
+
+#ifdef __cplusplus
+}
+#endif
@@ -79,4 +79,15 @@ extern "C"
 
         return transform_comp.get_transform_matrix();
     }
+
+    ENGINE_API bool GetEntityTransformMatrices(const lark::id::id_type *entity_ids, u32 count,
+                                               glm::mat4 *out_matrices)
+    {
+        if (!entity_ids || !out_matrices)
+            return false;
+
+        // Entities that are not alive come back as identity, keeping the output index-aligned
+        transform::get_transform_matrices(entity_ids, count, out_matrices);
+        return true;
+    }
 }
\ No newline at end of file
@@ -13,6 +13,8 @@ extern "C"
                                        transform_component *out_transform);
     ENGINE_API bool ResetEntityTransform(lark::id::id_type entity_id);
     ENGINE_API glm::mat4 GetEntityTransformMatrix(lark::id::id_type entity_id);
+    ENGINE_API bool GetEntityTransformMatrices(const lark::id::id_type *entity_ids, u32 count,
+                                               glm::mat4 *out_matrices);
 
 #ifdef __cplusplus
 }
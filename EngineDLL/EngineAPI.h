@@ -7,4 +7,8 @@
 #include "APIs/TransformAPI.h"
 #include "APIs/PhysicsAPI.h"
 #include "APIs/EngineUtilities.h"
+#include "APIs/ChangeTrackingAPI.h"
+#include "APIs/BridgeAPI.h"
+#include "APIs/NeighborAPI.h"
+#include "APIs/SensorAPI.h"
 
@@ -0,0 +1,439 @@
+#include "Bridge.h"
+#include "Drone.h"
+#include "Core/Context.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+namespace lark::bridge
+{
+namespace
+{
+constexpr u64 align_up(u64 value) { return (value + 63) & ~(u64)63; }
+
+/**
+ * @struct frame_layout
+ * @brief Byte offsets inside a frame slot, the same on both sides of the bridge
+ */
+struct frame_layout
+{
+    frame_layout(u32 capacity, u32 max_samples)
+    {
+        drones = align_up(sizeof(frame_header));
+        imu = drones + align_up((u64)capacity * sizeof(drone_frame));
+        mocap = imu + align_up((u64)max_samples * sizeof(sensors::imu_sample));
+        size = mocap + align_up((u64)max_samples * sizeof(sensors::mocap_sample));
+    }
+
+    u64 drones;
+    u64 imu;
+    u64 mocap;
+    u64 size;
+};
+
+u8 *base_of(region_header &h) { return reinterpret_cast<u8 *>(&h); }
+
+frame_header &slot_of(region_header &h, u32 frame)
+{
+    assert(frame > 0);
+    return *reinterpret_cast<frame_header *>(base_of(h) + h.frames_offset +
+                                             h.frame_size * ((frame - 1) % h.frames));
+}
+
+template <typename T> T *frame_array(frame_header &f, u64 offset)
+{
+    return reinterpret_cast<T *>(reinterpret_cast<u8 *>(&f) + offset);
+}
+
+command_slot *commands_of(region_header &h)
+{
+    return reinterpret_cast<command_slot *>(base_of(h) + h.commands_offset);
+}
+
+drone::ControlInput input_of(const control_command &c)
+{
+    drone::ControlInput input{};
+    input.cmd_motor_speeds = Eigen::Map<const drone::Vector4f>{c.motor_speeds};
+    input.cmd_motor_thrusts = Eigen::Map<const drone::Vector4f>{c.motor_thrusts};
+    input.cmd_thrust = c.thrust;
+    input.cmd_moment = Eigen::Map<const drone::Vector3f>{c.moment};
+    input.cmd_q = Eigen::Map<const drone::Vector4f>{c.attitude};
+    input.cmd_w = Eigen::Map<const drone::Vector3f>{c.body_rates};
+    input.cmd_v = Eigen::Map<const drone::Vector3f>{c.velocity};
+    input.cmd_acc = Eigen::Map<const drone::Vector3f>{c.acceleration};
+    return input;
+}
+
+struct bridge_store
+{
+    config cfg{};
+    char name[ipc::shared_region::max_name_length + 1]{};
+    ipc::shared_region region;
+    u64 imu_cursor{0};
+    u64 mocap_cursor{0};
+    u64 tick{0};
+    f64 time{0.0};
+    status counters{};
+    util::vector<applied_command> applied;  ///< Of the last apply_commands
+    util::vector<applied_command> injected; ///< Applied next while suspended
+    bool suspended{false};
+};
+
+context_local<bridge_store> store;
+
+region_header &header_of(bridge_store &s) { return *static_cast<region_header *>(s.region.data()); }
+
+/**
+ * @brief True if a region of this layout exists under name and its engine has exited
+ *
+ * Regions of other layouts or still being set up are left to their owner.
+ */
+bool is_abandoned(const char *name)
+{
+    ipc::shared_region existing;
+    if (!existing.open(name) || existing.size() < sizeof(region_header))
+        return false;
+
+    const region_header &h{*static_cast<const region_header *>(existing.data())};
+    if (h.magic != magic || h.version != version)
+        return false;
+    return !ipc::process_exists(h.engine.load(std::memory_order_acquire));
+}
+
+using clock = std::chrono::steady_clock;
+
+} // namespace
+
+bool open(const config &c)
+{
+    bridge_store &s{*store};
+    close();
+    if (!c.name || strlen(c.name) > ipc::shared_region::max_name_length || !c.capacity ||
+        c.frames < 2)
+        return false;
+
+    const frame_layout frame{c.capacity, c.max_samples};
+    const u64 frames_offset{align_up(sizeof(region_header))};
+    const u64 commands_offset{frames_offset + frame.size * c.frames};
+    const u64 size{commands_offset + (u64)c.capacity * sizeof(command_slot)};
+    if (!s.region.create(c.name, (size_t)size))
+    {
+        // Left behind by an engine that crashed, its old contents would confuse clients
+        if (!is_abandoned(c.name) || !ipc::shared_region::remove(c.name) ||
+            !s.region.create(c.name, (size_t)size))
+            return false;
+    }
+
+    s.cfg = c;
+    strncpy(s.name, c.name, sizeof(s.name) - 1);
+    s.cfg.name = s.name;
+
+    auto &h{*new (s.region.data()) region_header{}};
+    h.version = version;
+    h.capacity = c.capacity;
+    h.max_samples = c.max_samples;
+    h.frames = c.frames;
+    h.mode = c.mode;
+    h.frame_size = frame.size;
+    h.frames_offset = frames_offset;
+    h.commands_offset = commands_offset;
+    h.engine.store(ipc::current_process(), std::memory_order_relaxed);
+    for (u32 i{0}; i < c.frames; ++i)
+        new (&slot_of(h, i + 1)) frame_header{};
+    for (u32 i{0}; i < c.capacity; ++i)
+        new (commands_of(h) + i) command_slot{};
+
+    // Clients check the magic before anything else
+    std::atomic_thread_fence(std::memory_order_release);
+    h.magic = magic;
+
+    // Only samples taken from now on are bridged
+    s.imu_cursor = sensors::imu_written();
+    s.mocap_cursor = sensors::mocap_written();
+    s.tick = 0;
+    s.time = 0.0;
+    s.counters = {};
+    return true;
+}
+
+void close()
+{
+    bridge_store &s{*store};
+    if (!s.region.is_open())
+        return;
+
+    // Published advances once more without a frame, so waiting clients notice
+    region_header &h{header_of(s)};
+    h.closed.store(1, std::memory_order_release);
+    h.published.fetch_add(1, std::memory_order_acq_rel);
+    ipc::futex_wake(h.published);
+    s.region.close();
+}
+
+bool is_open() { return store->region.is_open(); }
+
+const config &get_config() { return store->cfg; }
+
+/**
+ * @brief Replays the injected commands in place of the client
+ */
+void apply_injected(bridge_store &s)
+{
+    for (const applied_command &cmd : s.injected)
+    {
+        if (cmd.index >= drone::count() || cmd.entity != (id::id_type)drone::entity_at(cmd.index))
+            continue;
+        drone::set_control(cmd.index, input_of(cmd.command));
+        s.applied.push_back(cmd);
+    }
+    s.injected.clear();
+}
+
+void apply_commands()
+{
+    bridge_store &s{*store};
+    s.applied.clear();
+    if (s.suspended)
+    {
+        apply_injected(s);
+        return;
+    }
+    if (!s.region.is_open())
+        return;
+
+    region_header &h{header_of(s)};
+    const u32 expected{h.published.load(std::memory_order_acquire)};
+    if (!expected || !h.attached.load(std::memory_order_acquire))
+        return;
+
+    if (s.cfg.mode == sync_mode::lockstep)
+    {
+        const auto start{clock::now()};
+        u32 answered{h.acknowledged.load(std::memory_order_acquire)};
+        while (answered != expected)
+        {
+            if (!ipc::wait_for_change(h.acknowledged, answered, s.cfg.timeout_us))
+            {
+                ++s.counters.timeouts;
+                // A client that crashed would otherwise cost every later tick the timeout
+                u32 client{h.client.load(std::memory_order_acquire)};
+                if (client && !ipc::process_exists(client) &&
+                    h.client.compare_exchange_strong(client, 0, std::memory_order_acq_rel))
+                {
+                    h.attached.store(0, std::memory_order_release);
+                    ++s.counters.lost_clients;
+                }
+                break;
+            }
+            answered = h.acknowledged.load(std::memory_order_acquire);
+        }
+        s.counters.wait_time += std::chrono::duration<f64>(clock::now() - start).count();
+    }
+
+    const u32 max_age{s.cfg.mode == sync_mode::lockstep ? 0u : s.cfg.max_command_age};
+    const u32 count{std::min(drone::count(), s.cfg.capacity)};
+    command_slot *slots{commands_of(h)};
+    for (u32 i{0}; i < count; ++i)
+    {
+        // Sequence lock, a command the client is writing right now waits for the next tick
+        command_slot &slot{slots[i]};
+        const u32 sequence{slot.sequence.load(std::memory_order_acquire)};
+        if (!sequence || (sequence & 1))
+            continue;
+        const id::id_type entity{slot.entity};
+        const u32 frame{slot.frame};
+        const control_command command{slot.command};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+            continue;
+
+        if (entity != (id::id_type)drone::entity_at(i) || expected - frame > max_age)
+        {
+            ++s.counters.stale;
+            continue;
+        }
+        drone::set_control(i, input_of(command));
+        s.applied.push_back({i, entity, command});
+        ++s.counters.commands;
+    }
+}
+
+void publish(f32 dt)
+{
+    bridge_store &s{*store};
+    if (!s.region.is_open() || s.suspended)
+        return;
+
+    region_header &h{header_of(s)};
+    const u32 frame{h.published.load(std::memory_order_relaxed) + 1};
+    frame_header &f{slot_of(h, frame)};
+    f.sequence.store(2 * frame - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const frame_layout layout{h.capacity, h.max_samples};
+    drone_frame *drones{frame_array<drone_frame>(f, layout.drones)};
+    const u32 count{std::min(drone::count(), h.capacity)};
+    for (u32 i{0}; i < count; ++i)
+    {
+        const drone::DroneState &state{drone::state_at(i)};
+        drone_frame &out{drones[i]};
+        out.entity = drone::entity_at(i);
+        Eigen::Map<drone::Vector3f>{out.position} = state.position;
+        Eigen::Map<drone::Vector3f>{out.velocity} = state.velocity;
+        Eigen::Map<drone::Vector4f>{out.attitude} = state.attitude;
+        Eigen::Map<drone::Vector3f>{out.body_rates} = state.body_rates;
+        Eigen::Map<drone::Vector4f>{out.rotor_speeds} = state.rotor_speeds;
+    }
+
+    // Samples go straight from the sensor rings into the frame
+    f.drones = count;
+    f.imu = sensors::read_imu(s.imu_cursor, frame_array<sensors::imu_sample>(f, layout.imu),
+                              h.max_samples);
+    f.mocap = sensors::read_mocap(
+        s.mocap_cursor, frame_array<sensors::mocap_sample>(f, layout.mocap), h.max_samples);
+    f.tick = s.tick;
+    f.time = s.time + dt;
+    f.dt = dt;
+
+    f.sequence.store(2 * frame, std::memory_order_release);
+    h.published.store(frame, std::memory_order_release);
+    ipc::futex_wake(h.published);
+
+    ++s.tick;
+    s.time += dt;
+    ++s.counters.frames;
+}
+
+const util::vector<applied_command> &applied_commands() { return store->applied; }
+
+void suspend(bool suspended)
+{
+    bridge_store &s{*store};
+    s.suspended = suspended;
+    s.injected.clear();
+}
+
+bool is_suspended() { return store->suspended; }
+
+void inject_commands(const applied_command *commands, u32 count)
+{
+    bridge_store &s{*store};
+    assert(s.suspended && (commands || !count));
+    for (u32 i{0}; i < count; ++i)
+        s.injected.push_back(commands[i]);
+}
+
+status get_status()
+{
+    bridge_store &s{*store};
+    status result{s.counters};
+    result.attached = s.region.is_open() &&
+                      header_of(s).attached.load(std::memory_order_acquire) != 0;
+    return result;
+}
+
+frame_header &client::slot(u32 frame) const { return slot_of(header(), frame); }
+
+bool client::attach(const char *name)
+{
+    detach();
+    if (!_region.open(name))
+        return false;
+
+    region_header &h{header()};
+    if (_region.size() < sizeof(region_header) || h.magic != magic || h.version != version)
+    {
+        _region.close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // Frames published so far are never handed out, answering them keeps lockstep going
+    _frame = h.published.load(std::memory_order_acquire);
+    h.acknowledged.store(_frame, std::memory_order_release);
+    h.client.store(ipc::current_process(), std::memory_order_release);
+    h.attached.store(1, std::memory_order_release);
+    ipc::futex_wake(h.acknowledged);
+    return true;
+}
+
+void client::detach()
+{
+    if (!_region.is_open())
+        return;
+
+    // Answers whatever is pending, so an engine in lockstep does not wait for the timeout
+    region_header &h{header()};
+    h.attached.store(0, std::memory_order_release);
+    h.client.store(0, std::memory_order_release);
+    h.acknowledged.store(h.published.load(std::memory_order_acquire), std::memory_order_release);
+    ipc::futex_wake(h.acknowledged);
+    _region.close();
+}
+
+bool client::next_frame(frame_view &out, u32 timeout_us)
+{
+    if (!_region.is_open())
+        return false;
+
+    region_header &h{header()};
+    for (;;)
+    {
+        const u32 frame{h.published.load(std::memory_order_acquire)};
+        if (h.closed.load(std::memory_order_acquire))
+            return false;
+        if (frame == _frame)
+        {
+            if (!ipc::wait_for_change(h.published, frame, timeout_us))
+                return false;
+            continue;
+        }
+
+        // A newer frame replaced this one while free-running, read that instead
+        frame_header &f{slot(frame)};
+        if (f.sequence.load(std::memory_order_acquire) != 2 * frame)
+            continue;
+
+        const frame_layout layout{h.capacity, h.max_samples};
+        out.frame = frame;
+        out.tick = f.tick;
+        out.time = f.time;
+        out.dt = f.dt;
+        out.drones = frame_array<drone_frame>(f, layout.drones);
+        out.drone_count = f.drones;
+        out.imu = frame_array<sensors::imu_sample>(f, layout.imu);
+        out.imu_count = f.imu;
+        out.mocap = frame_array<sensors::mocap_sample>(f, layout.mocap);
+        out.mocap_count = f.mocap;
+        _frame = frame;
+        return true;
+    }
+}
+
+bool client::is_intact(const frame_view &view) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot(view.frame).sequence.load(std::memory_order_relaxed) == 2 * view.frame;
+}
+
+void client::set_command(u32 index, id::id_type entity, const control_command &command)
+{
+    assert(index < header().capacity);
+    command_slot &slot{commands_of(header())[index]};
+    const u32 sequence{slot.sequence.load(std::memory_order_relaxed)};
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.entity = entity;
+    slot.frame = _frame;
+    slot.command = command;
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void client::submit()
+{
+    header().acknowledged.store(_frame, std::memory_order_release);
+    ipc::futex_wake(header().acknowledged);
+}
+
+} // namespace lark::bridge
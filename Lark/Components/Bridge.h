@@ -0,0 +1,281 @@
+/**
+ * @file Bridge.h
+ * @brief Shared-memory bridge to flight software running in other processes
+ *
+ * The engine publishes a frame per tick into a named shared region: the state
+ * of every drone and the sensor samples written during the tick. External
+ * controllers read it in place and answer with one command per drone, which
+ * replaces the control input the engine computed. Everything crossing the
+ * boundary is a fixed-layout struct, nothing is serialized.
+ *
+ * Frames are kept in a ring and guarded by sequence numbers, so a client can
+ * read the newest frame while the next one is written. Both sides wait on
+ * futex words of the region, spinning briefly first, so a round trip costs a
+ * few microseconds when the processes have cores to run on.
+ *
+ * In lockstep mode the engine waits before applying commands until the client
+ * answered the last frame, so every tick is controlled by commands computed
+ * from the frame before it. A client that died without detaching is detached
+ * by the engine after the first wait that timed out. In free-running mode it never waits and applies
+ * the newest commands that are at most max_command_age frames old.
+ */
+
+#pragma once
+#include "ComponentCommon.h"
+#include "Core/SharedMemory.h"
+#include "Sensors.h"
+
+namespace lark::bridge
+{
+
+constexpr u32 magic{0x4c524b42}; ///< "LRKB"
+constexpr u32 version{3};
+
+enum class sync_mode : u32
+{
+    lockstep,
+    free_running
+};
+
+/**
+ * @struct config
+ * @brief Region name, capacities and synchronization of the bridge
+ */
+struct config
+{
+    const char *name{"/lark_bridge"}; ///< POSIX shared memory name, starts with a slash
+    u32 capacity{1024};               ///< Drones per frame, drones past it are not bridged
+    u32 max_samples{4096};            ///< IMU and mocap samples per frame each
+    u32 frames{4};                    ///< Depth of the frame ring
+    sync_mode mode{sync_mode::lockstep};
+    u32 timeout_us{1'000'000};        ///< Longest lockstep wait, 0 waits without a limit
+    u32 max_command_age{2};           ///< Free-running, frames a command stays valid
+};
+
+/**
+ * @struct drone_frame
+ * @brief State of one drone after the tick
+ */
+struct drone_frame
+{
+    id::id_type entity{id::invalid_id};
+    f32 position[3]{};
+    f32 velocity[3]{};
+    f32 attitude[4]{}; ///< Quaternion [x,y,z,w]
+    f32 body_rates[3]{};
+    f32 rotor_speeds[4]{};
+};
+
+/**
+ * @struct control_command
+ * @brief ControlInput as plain arrays, fields unused by the drone's abstraction are ignored
+ */
+struct control_command
+{
+    f32 motor_speeds[4]{};  ///< rad/s
+    f32 motor_thrusts[4]{}; ///< N
+    f32 thrust{0.f};        ///< N, collective
+    f32 moment[3]{};        ///< N m
+    f32 attitude[4]{0.f, 0.f, 0.f, 1.f};
+    f32 body_rates[3]{};    ///< rad/s
+    f32 velocity[3]{};      ///< m/s, world frame
+    f32 acceleration[3]{};  ///< m/s^2, world frame
+};
+
+/**
+ * @struct region_header
+ * @brief Start of the shared region, offsets are in bytes from it
+ */
+struct region_header
+{
+    u32 magic;
+    u32 version;
+    u32 capacity;
+    u32 max_samples;
+    u32 frames;
+    sync_mode mode;
+    u64 frame_size;
+    u64 frames_offset;
+    u64 commands_offset;
+
+    std::atomic<u32> published;    ///< Frames written so far, frame n lives in slot (n - 1) % frames
+    std::atomic<u32> acknowledged; ///< Last frame the client answered
+    std::atomic<u32> attached;     ///< Nonzero while a client is attached
+    std::atomic<u32> closed;       ///< Set when the engine closes the bridge
+    std::atomic<u32> engine;       ///< Process id of the engine
+    std::atomic<u32> client;       ///< Process id of the attached client, 0 if none
+};
+
+/**
+ * @struct frame_header
+ * @brief Start of a frame slot, followed by capacity drones, then max_samples IMU
+ * and max_samples mocap samples
+ */
+struct frame_header
+{
+    std::atomic<u32> sequence; ///< Odd while written, 2n once frame n is complete
+    u32 drones;
+    u32 imu;
+    u32 mocap;
+    u64 tick;
+    f64 time; ///< s of simulated time
+    f32 dt;
+};
+
+/**
+ * @struct command_slot
+ * @brief Command for the drone at one dense index, written by the client
+ */
+struct command_slot
+{
+    std::atomic<u32> sequence; ///< Odd while written
+    id::id_type entity;        ///< Must match the drone at the index when applied
+    u32 frame;                 ///< Frame the command answers
+    control_command command;
+};
+
+/**
+ * @struct status
+ * @brief Counters of the engine side since open
+ */
+struct status
+{
+    u64 frames{0};
+    u64 commands{0}; ///< Commands applied
+    u64 stale{0};    ///< Commands skipped because they were old or for another drone
+    u64 timeouts{0}; ///< Lockstep waits that gave up
+    u64 lost_clients{0}; ///< Clients found dead after a timeout and detached
+    f64 wait_time{0.0}; ///< s spent waiting for the client
+    bool attached{false};
+};
+
+/**
+ * @struct applied_command
+ * @brief Command the bridge applied to the drone at a dense index, as recorded for replay
+ */
+struct applied_command
+{
+    u32 index{0};
+    id::id_type entity{id::invalid_id};
+    control_command command;
+};
+
+/**
+ * @brief Creates the shared region, replacing a bridge that was open
+ *
+ * Fails if the name belongs to an engine that is still running. A region
+ * left behind by an engine that crashed is replaced.
+ */
+bool open(const config &c);
+void close();
+bool is_open();
+const config &get_config();
+
+/**
+ * @brief Waits for the client if needed and applies its commands, called after
+ * drone::update_controls
+ */
+void apply_commands();
+
+/**
+ * @brief Writes the frame of the tick that just finished, called after sensors::update
+ */
+void publish(f32 dt);
+
+/**
+ * @brief Commands applied by the last apply_commands, in dense index order
+ */
+const util::vector<applied_command> &applied_commands();
+
+/**
+ * @brief Stops talking to the client without closing the region, e.g. while a replay runs
+ *
+ * A suspended bridge neither waits for nor reads the client and publishes no
+ * frames. apply_commands applies the injected commands instead.
+ */
+void suspend(bool suspended);
+bool is_suspended();
+
+/**
+ * @brief Commands the next apply_commands of a suspended bridge applies, used by replay
+ *
+ * Commands whose entity no longer sits at their index are skipped.
+ */
+void inject_commands(const applied_command *commands, u32 count);
+
+status get_status();
+
+/**
+ * @struct frame_view
+ * @brief A frame in place in the shared region
+ */
+struct frame_view
+{
+    u32 frame{0};
+    u64 tick{0};
+    f64 time{0.0};
+    f32 dt{0.f};
+    const drone_frame *drones{nullptr};
+    u32 drone_count{0};
+    const sensors::imu_sample *imu{nullptr};
+    u32 imu_count{0};
+    const sensors::mocap_sample *mocap{nullptr};
+    u32 mocap_count{0};
+};
+
+/**
+ * @class client
+ * @brief External side of the bridge, used by controller processes
+ */
+class client
+{
+  public:
+    client() = default;
+    ~client() { detach(); }
+    client(const client &) = delete;
+    client &operator=(const client &) = delete;
+
+    /**
+     * @brief Maps the region of a running engine
+     * @return false if it does not exist or has a different layout version
+     *
+     * Frames published before the call are answered right away, so an engine
+     * in lockstep waits for the client from the next frame on.
+     */
+    bool attach(const char *name);
+    void detach();
+    bool is_attached() const { return _region.is_open(); }
+
+    /**
+     * @brief Waits for a frame newer than the last one returned
+     * @return false on timeout or once the engine closed the bridge
+     *
+     * The view stays valid until the ring wraps around, which lockstep mode
+     * only allows after submit().
+     */
+    bool next_frame(frame_view &out, u32 timeout_us = 0);
+
+    /**
+     * @brief False if the engine overwrote the frame while it was read, free-running only
+     */
+    bool is_intact(const frame_view &view) const;
+
+    /**
+     * @brief Writes the command for the drone at a dense index of the last frame
+     */
+    void set_command(u32 index, id::id_type entity, const control_command &command);
+
+    /**
+     * @brief Answers the last frame, releasing the engine in lockstep mode
+     */
+    void submit();
+
+  private:
+    region_header &header() const { return *static_cast<region_header *>(_region.data()); }
+    frame_header &slot(u32 frame) const;
+
+    ipc::shared_region _region;
+    u32 _frame{0};
+};
+
+} // namespace lark::bridge
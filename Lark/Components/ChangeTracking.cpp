@@ -0,0 +1,151 @@
+#include "ChangeTracking.h"
+#include "Entity.h"
+#include "Core/Context.h"
+#include <algorithm>
+#include <atomic>
+
+namespace lark::changes
+{
+namespace
+{
+constexpr u32 type_count{(u32)component_type::count};
+
+struct removal
+{
+    frame_type frame;
+    id::id_type id;
+};
+
+struct change_store
+{
+    frame_type frame{1};
+    util::vector<frame_type> stamps[type_count];
+    util::vector<id::id_type> entities;
+    util::vector<removal> removals; ///< Ascending by frame
+    std::atomic<frame_type> last_stamped{0};
+};
+
+bool removed_before(const removal &r, frame_type frame) { return r.frame < frame; }
+
+context_local<change_store> store;
+} // namespace
+
+frame_type current_frame() { return store->frame; }
+
+void advance_frame() { ++store->frame; }
+
+frame_type last_stamped_frame() { return store->last_stamped.load(std::memory_order_relaxed); }
+
+void on_entity_created(game_entity::entity_id id)
+{
+    const id::id_type index{id::index(id)};
+    if (index >= store->entities.size())
+    {
+        store->entities.resize(index + 1, id::invalid_id);
+        for (auto &type_stamps : store->stamps)
+        {
+            type_stamps.resize(index + 1, 0);
+        }
+    }
+
+    // A recycled slot starts without the changes of its previous owner
+    store->entities[index] = id;
+    for (auto &type_stamps : store->stamps)
+    {
+        type_stamps[index] = 0;
+    }
+}
+
+void on_entity_removed(game_entity::entity_id id)
+{
+    const id::id_type index{id::index(id)};
+    assert(index < store->entities.size() && store->entities[index] == id);
+    store->entities[index] = id::invalid_id;
+    for (auto &type_stamps : store->stamps)
+    {
+        type_stamps[index] = 0;
+    }
+    store->removals.push_back({store->frame, (id::id_type)id});
+}
+
+void mark_changed(component_type type, id::id_type entity_index)
+{
+    assert(type < component_type::count);
+    change_store &s{*store};
+    auto &type_stamps = s.stamps[(u32)type];
+    assert(entity_index < type_stamps.size());
+    type_stamps[entity_index] = s.frame;
+
+    // Parallel writers stamp the same frame, only the first of a frame stores it
+    if (s.last_stamped.load(std::memory_order_relaxed) != s.frame)
+        s.last_stamped.store(s.frame, std::memory_order_relaxed);
+}
+
+frame_type last_changed(component_type type, game_entity::entity_id id)
+{
+    assert(type < component_type::count);
+    const id::id_type index{id::index(id)};
+    const auto &type_stamps = store->stamps[(u32)type];
+    return (index < type_stamps.size() && store->entities[index] == id) ? type_stamps[index] : 0;
+}
+
+u32 get_changed_since(component_type type, frame_type since_frame, id::id_type *out_ids,
+                      u32 capacity)
+{
+    assert(type < component_type::count);
+    const change_store &s{*store};
+    const auto &type_stamps = s.stamps[(u32)type];
+    const u32 count{(u32)type_stamps.size()};
+
+    u32 found{0};
+    for (u32 i{0}; i < count; ++i)
+    {
+        const frame_type stamp{type_stamps[i]};
+        if (stamp && stamp >= since_frame)
+        {
+            if (out_ids && found < capacity)
+            {
+                out_ids[found] = s.entities[i];
+            }
+            ++found;
+        }
+    }
+    return found;
+}
+
+u32 get_removed_since(frame_type since_frame, id::id_type *out_ids, u32 capacity)
+{
+    const auto &removals = store->removals;
+    const auto first =
+        std::lower_bound(removals.begin(), removals.end(), since_frame, removed_before);
+    const u32 found{(u32)(removals.end() - first)};
+    if (out_ids)
+    {
+        const u32 written{std::min(found, capacity)};
+        for (u32 i{0}; i < written; ++i)
+        {
+            out_ids[i] = first[i].id;
+        }
+    }
+    return found;
+}
+
+void discard_removed_before(frame_type frame)
+{
+    auto &removals = store->removals;
+    const auto first = std::lower_bound(removals.begin(), removals.end(), frame, removed_before);
+    removals.erase(removals.begin(), first);
+}
+
+void shutdown()
+{
+    for (auto &type_stamps : store->stamps)
+    {
+        type_stamps.clear();
+    }
+    store->entities.clear();
+    store->removals.clear();
+    store->last_stamped.store(0, std::memory_order_relaxed);
+    store->frame = 1;
+}
+} // namespace lark::changes
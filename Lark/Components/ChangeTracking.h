@@ -0,0 +1,124 @@
+/**
+ * @file ChangeTracking.h
+ * @brief Per-component change stamps for incremental synchronization
+ *
+ * Every component writer stamps the owning entity with the current frame.
+ * Consumers (renderers, serializers, bridges) remember the frame they last
+ * synchronized at and ask for everything stamped since then instead of
+ * re-pulling the full state. Removed entities are logged with the frame they
+ * were removed in, so mirrors learn about them the same way.
+ */
+
+#pragma once
+#include "ComponentCommon.h"
+
+namespace lark::changes
+{
+
+/**
+ * @enum component_type
+ * @brief Component stores that record changes
+ */
+enum class component_type : u32
+{
+    transform,
+    script,
+    geometry,
+    physics,
+    drone,
+    material,
+
+    count
+};
+
+using frame_type = u64;
+
+/**
+ * @brief Gets the frame that changes are currently stamped with
+ * @return Current change frame, starts at 1 and advances once per tick
+ */
+frame_type current_frame();
+
+/**
+ * @brief Closes the current frame, called by the game loop at the end of a tick
+ */
+void advance_frame();
+
+/**
+ * @brief Gets the newest frame any component was stamped in
+ * @return 0 if nothing changed since the last shutdown
+ *
+ * Equal to current_frame() once something was written since the last tick
+ * ended, e.g. by the host between ticks.
+ */
+frame_type last_stamped_frame();
+
+/**
+ * @brief Makes room for an entity slot, must be called before the slot is stamped
+ * @param id Newly created entity
+ *
+ * Slots are only resized here so that stamping from parallel systems never reallocates.
+ */
+void on_entity_created(game_entity::entity_id id);
+
+/**
+ * @brief Forgets the stamps of an entity and logs its removal in the current frame
+ * @param id Entity that is being removed
+ *
+ * It is no longer reported by get_changed_since, but by get_removed_since.
+ */
+void on_entity_removed(game_entity::entity_id id);
+
+/**
+ * @brief Stamps a component of an entity as changed in the current frame
+ * @param type Component that was written
+ * @param entity_index Index of the owning entity
+ *
+ * Safe to call concurrently for different entities.
+ */
+void mark_changed(component_type type, id::id_type entity_index);
+
+/**
+ * @brief Gets the frame in which a component of an entity last changed
+ * @param type Component to check
+ * @param id Entity to check
+ * @return Frame of the last change, 0 if it never changed
+ */
+frame_type last_changed(component_type type, game_entity::entity_id id);
+
+/**
+ * @brief Collects all entities whose component changed at or after a frame
+ * @param type Component to query
+ * @param since_frame First frame to include, usually the current_frame() seen at the last sync
+ * @param out_ids Destination for entity ids, may be null to only count
+ * @param capacity Number of ids that fit into out_ids
+ * @return Total number of changed entities, can exceed capacity
+ *
+ * The query is inclusive so an entity changed in the frame of the last sync is reported again
+ * rather than missed. Removed entities are not reported, see get_removed_since.
+ */
+u32 get_changed_since(component_type type, frame_type since_frame, id::id_type *out_ids,
+                      u32 capacity);
+
+/**
+ * @brief Collects all entities removed at or after a frame, in the order they were removed
+ * @param since_frame First frame to include, inclusive like get_changed_since
+ * @param out_ids Destination for entity ids, may be null to only count
+ * @param capacity Number of ids that fit into out_ids
+ * @return Total number of removed entities, can exceed capacity
+ *
+ * Ids keep their generation, so a mirror can tell a removed entity from a
+ * later one that reuses its slot.
+ */
+u32 get_removed_since(frame_type since_frame, id::id_type *out_ids, u32 capacity);
+
+/**
+ * @brief Drops the removals logged before a frame, once every consumer synchronized past it
+ */
+void discard_removed_before(frame_type frame);
+
+/**
+ * @brief Clears all change stamps and restarts the frame counter
+ */
+void shutdown();
+} // namespace lark::changes
@@ -2,3 +2,29 @@
 #include "../Common/CommonHeaders.h"
 #include "../Common/Id.h"
 #include "../LarkAPI/GameEntity.h"
+
+namespace lark
+{
+/**
+ * @struct storage_view
+ * @brief Raw access to one field of a component store, e.g. for NumPy views
+ *
+ * The view stays valid as long as the store reports the same layout
+ * generation. Creating or removing components may move the storage.
+ */
+struct storage_view
+{
+    enum scalar_type : u8
+    {
+        float32,
+        uint32
+    };
+
+    void *data{nullptr};
+    u32 count{0};               ///< Number of rows
+    u32 width{0};               ///< Scalars per row
+    u32 stride{0};              ///< Bytes from one row to the next
+    scalar_type type{float32};
+    u64 generation{0};          ///< Layout generation of the store when the view was taken
+};
+} // namespace lark
@@ -0,0 +1,170 @@
+#include "Downwash.h"
+#include "Drone.h"
+#include "Neighbors.h"
+#include "Core/Context.h"
+#include "Core/FrameArena.h"
+#include "Core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+
+namespace lark::downwash
+{
+namespace
+{
+using drone::Vector3f;
+using memory::frame_vector;
+
+constexpr f32 pi{3.14159265f};
+
+/**
+ * @struct wake
+ * @brief Wake of one drone, in the world frame
+ */
+struct wake
+{
+    Vector3f origin;
+    Vector3f direction; ///< Unit vector along the flow, against the thrust
+    f32 velocity{0.f};  ///< Contracted wake speed right below the rotors
+    f32 radius{0.f};    ///< Radius of a disk with the area of all rotors
+};
+
+struct downwash_store
+{
+    config settings{};
+    util::vector<ghost> ghosts;
+    drone::QuadParams ghost_params{};
+    bool applied{false}; ///< Drones carry induced wind that a disabled model has to clear
+};
+
+context_local<downwash_store> store;
+
+wake wake_of(const drone::DroneState &state, const drone::QuadParams &params, f32 air_density)
+{
+    const auto &geometry = params.geometric_properties;
+    const f32 thrust{params.rotor_properties.k_eta * state.rotor_speeds.squaredNorm()};
+    const f32 area{(f32)geometry.num_rotors * pi * geometry.rotor_radius * geometry.rotor_radius};
+
+    wake w{};
+    w.origin = state.position;
+    w.direction = -drone::quaternionToRotationMatrix(state.attitude).col(2);
+    w.radius = std::sqrt(area / pi);
+    // Hover induced velocity T = 2 rho A v^2, doubled once the wake has contracted
+    w.velocity = thrust > 0.f ? 2.f * std::sqrt(thrust / (2.f * air_density * area)) : 0.f;
+    return w;
+}
+
+Vector3f wake_velocity(const wake &w, const Vector3f &point, const config &c)
+{
+    const Vector3f offset{point - w.origin};
+    const f32 along{offset.dot(w.direction)};
+    if (along <= 0.f || along > c.range || w.velocity <= 0.f)
+        return Vector3f::Zero();
+
+    const f32 radius{w.radius + along * c.spread};
+    const f32 radial_squared{(offset - along * w.direction).squaredNorm()};
+    if (radial_squared > 9.f * radius * radius)
+        return Vector3f::Zero();
+
+    // The momentum flux is conserved while the wake widens
+    const f32 centerline{w.velocity * w.radius / radius};
+    return w.direction * (centerline * std::exp(-radial_squared / (radius * radius)));
+}
+
+void clear_induced(downwash_store &s, u32 count)
+{
+    if (!s.applied)
+        return;
+    const frame_vector<Vector3f> induced(count, Vector3f::Zero());
+    drone::set_induced_wind(induced.data(), 0, count);
+    s.applied = false;
+}
+} // namespace
+
+void configure(const config &c) { store->settings = c; }
+
+const config &get_config() { return store->settings; }
+
+void set_ghosts(const ghost *ghosts, u32 count, const drone::QuadParams &params)
+{
+    downwash_store &s{*store};
+    s.ghosts.resize(count);
+    std::copy_n(ghosts, count, s.ghosts.data());
+    s.ghost_params = params;
+}
+
+void update()
+{
+    downwash_store &s{*store};
+    const config &c{s.settings};
+    const u32 count{drone::count()};
+    if (!c.enabled || c.max_sources == 0 || count + s.ghosts.size() < 2)
+    {
+        clear_induced(s, count);
+        return;
+    }
+
+    // Positions changed since the grid was last built, by the dynamics or by commands.
+    // Built even with the neighbor queries disabled, the sources come from it.
+    neighbors::build();
+    if (neighbors::ghost_count() != s.ghosts.size())
+    {
+        // Wakes would be matched to the wrong ghosts, drop them rather than keep stale ones
+        clear_induced(s, count);
+        return;
+    }
+
+    const u32 points{count + (u32)s.ghosts.size()};
+    const u32 k{std::min(c.max_sources, points - 1)};
+
+    // Live for this call only, the tick arena is reset once the tick finished
+    frame_vector<wake> wakes(points);
+    frame_vector<f32> queries((size_t)count * 3);
+    frame_vector<u32> self(count);
+    frame_vector<u32> sources((size_t)count * k);
+    frame_vector<u32> source_counts(count);
+    frame_vector<Vector3f> induced(count);
+
+    // Wakes of every drone, and query points half the range above each drone
+    jobs::parallel_for(count, 0, [&](u32 begin, u32 end) {
+        for (u32 i{begin}; i < end; ++i)
+        {
+            const drone::DroneState &state{drone::state_at(i)};
+            wakes[i] = wake_of(state, drone::params_at(i), c.air_density);
+            queries[(size_t)i * 3 + 0] = state.position.x();
+            queries[(size_t)i * 3 + 1] = state.position.y();
+            queries[(size_t)i * 3 + 2] = state.position.z() + 0.5f * c.range;
+            self[i] = i;
+        }
+    });
+
+    for (u32 g{0}; g < s.ghosts.size(); ++g)
+    {
+        const ghost &source{s.ghosts[g]};
+        drone::DroneState state{};
+        state.position = {source.position[0], source.position[1], source.position[2]};
+        state.attitude = {source.attitude[0], source.attitude[1], source.attitude[2],
+                          source.attitude[3]};
+        state.rotor_speeds = {source.rotor_speeds[0], source.rotor_speeds[1],
+                              source.rotor_speeds[2], source.rotor_speeds[3]};
+        wakes[count + g] = wake_of(state, s.ghost_params, c.air_density);
+    }
+
+    neighbors::grid().nearest({queries.data(), self.data(), count}, k,
+                              {sources.data(), nullptr, source_counts.data(), k});
+
+    jobs::parallel_for(count, 0, [&](u32 begin, u32 end) {
+        for (u32 i{begin}; i < end; ++i)
+        {
+            const Vector3f &position{wakes[i].origin};
+            Vector3f sum{Vector3f::Zero()};
+            for (u32 n{0}; n < source_counts[i]; ++n)
+                sum += wake_velocity(wakes[sources[(size_t)i * k + n]], position, c);
+            induced[i] = sum;
+        }
+    });
+
+    drone::set_induced_wind(induced.data(), 0, count);
+    s.applied = true;
+}
+
+} // namespace lark::downwash
@@ -0,0 +1,78 @@
+/**
+ * @file Downwash.h
+ * @brief Rotor wake interaction between nearby drones
+ *
+ * Every drone sheds a wake along its thrust axis. Its speed follows momentum
+ * theory: the hover induced velocity of the drone's thrust over its total
+ * disk area, contracted to twice that value below the rotors and decaying as
+ * the wake widens with a constant spread angle. The radial profile is
+ * Gaussian. Drones inside another drone's wake get the wake velocity added to
+ * DroneState::wind before the dynamics step, so ComputeBodyWrench sees it as
+ * airspeed. The induced part is replaced every tick rather than accumulated.
+ *
+ * Sources are found with the neighbor grid: the nearest drones to a point
+ * half the range above each drone, at most max_sources of them, which keeps
+ * the stage O(N k) instead of O(N^2). The grid is rebuilt for this even if
+ * neighbor queries are disabled. Ghosts of the grid shed wakes as well, so
+ * drones feel the wakes of drones simulated elsewhere, but are not affected
+ * themselves.
+ *
+ * The nearest drones are not filtered by altitude. In a dense layer, drones
+ * at the same height can be closer to the query point than a drone higher
+ * up whose wake does reach, and take its place among the max_sources; raise
+ * max_sources for tightly packed formations.
+ */
+
+#pragma once
+#include "ComponentCommon.h"
+#include "PhysicExtension/Utils/DroneStructure.h"
+
+namespace lark::downwash
+{
+
+/**
+ * @struct config
+ * @brief Wake model settings of a world
+ */
+struct config
+{
+    bool enabled{false};
+    u32 max_sources{8};      ///< Wakes considered per drone
+    f32 range{5.f};          ///< m, wake length taken into account
+    f32 spread{0.15f};       ///< Growth of the wake radius per metre of wake length
+    f32 air_density{1.225f}; ///< kg/m^3
+};
+
+/**
+ * @struct ghost
+ * @brief Wake source of a drone simulated elsewhere, e.g. in a neighboring shard
+ */
+struct ghost
+{
+    f32 position[3]{};
+    f32 attitude[4]{0.f, 0.f, 0.f, 1.f}; ///< Quaternion [x,y,z,w]
+    f32 rotor_speeds[4]{};
+};
+
+void configure(const config &c);
+const config &get_config();
+
+/**
+ * @brief Replaces the ghost wakes, all of them shed by the vehicle of params
+ *
+ * ghosts[g] is the wake of ghost g of the neighbor grid, see
+ * neighbors::set_ghosts, which has to be given the same positions.
+ */
+void set_ghosts(const ghost *ghosts, u32 count, const drone::QuadParams &params);
+
+/**
+ * @brief Sets the wind induced by the wakes of nearby drones for every drone
+ *
+ * Runs after the ambient wind was sampled and before the dynamics. Rebuilds
+ * the neighbor grid from the current positions first, so sources are found
+ * where the drones are now rather than where the last build saw them.
+ * Once disabled, the next call clears the induced wind.
+ */
+void update();
+
+} // namespace lark::downwash
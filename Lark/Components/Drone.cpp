@@ -1,155 +1,574 @@
 #include "Drone.h"
+#include "ChangeTracking.h"
+#include "Entity.h"
+#include "Estimator.h"
+#include "Transform.h"
+#include "Core/Context.h"
+#include <algorithm>
 #include <utility>
 
 namespace lark::drone {
     namespace {
         struct drone_data
         {
+            // Fixed-size Eigen members, a shared_ptr and pointers to the shared vehicle type,
+            // safe to memcpy on growth
+            using trivially_relocatable = std::true_type;
+
             bool is_valid{false};
+            game_entity::entity_id entity{id::invalid_id};
             Multirotor vehicle;
             Control control;
             std::shared_ptr<Trajectory> trajectory;
+            TrajectoryPoint setpoint;
             DroneState state;
             ControlInput last_control;
+            Vector3f induced_wind{Vector3f::Zero()}; ///< Part of state.wind caused by other drones
+
+            // Level of detail
+            lod_level lod{lod_level::full};
+            u32 calm_steps{0};
+            u32 pending_ticks{0};              ///< Ticks a reduced drone has not been stepped for
+            f32 pending_dt{0.f};
+            f32 stepped_dt{0.f};               ///< dt of the last step_dynamics call, 0 if skipped
+            Vector3f held_wind{Vector3f::Zero()};
+            Vector3f held_setpoint{Vector3f::Zero()};
+            u32 steps_taken{0};
+            u32 steps_skipped{0};
+        };
+
+        struct drone_store
+        {
+            util::vector<drone_data> drone_components;
+            util::vector<id::id_type> id_mapping;
+            util::vector<id::generation_type> generations;
+            util::deque<drone_id> free_ids;
+            u64 storage_generation{0};
+            lod_config lod{};
         };
 
-        util::vector<drone_data> drone_components;
-        util::vector<id::id_type> id_mapping;
-        util::vector<id::generation_type> generations;
-        std::deque<drone_id> free_ids;
+        context_local<drone_store> store;
 
         bool exists(drone_id id)
         {
+            drone_store &s{*store};
             assert(id::is_valid(id));
             const id::id_type index{id::index(id)};
-            assert(index < generations.size());
-            return (id::is_valid(id_mapping[index]) && generations[index] == id::generation(id) &&
-                    drone_components[id_mapping[index]].is_valid);
+            assert(index < s.generations.size());
+            return (id::is_valid(s.id_mapping[index]) && s.generations[index] == id::generation(id) &&
+                    s.drone_components[s.id_mapping[index]].is_valid);
+        }
+
+        drone_data &data_of(drone_id id)
+        {
+            drone_store &s{*store};
+            return s.drone_components[s.id_mapping[id::index(id)]];
+        }
+
+        void mark_changed(const drone_data &data)
+        {
+            changes::mark_changed(changes::component_type::drone, id::index(data.entity));
+        }
+
+        void update_trajectory(drone_data &data, f32 dt)
+        {
+            if (data.trajectory)
+                data.setpoint = data.trajectory->update(dt);
+        }
+
+        void update_control(drone_data &data)
+        {
+            data.last_control = data.control.computeMotorCommands(data.state, data.setpoint);
+        }
+
+        void step_vehicle(drone_data &data, f32 dt)
+        {
+            data.state = data.vehicle.step(data.state, data.last_control, dt);
+            data.stepped_dt = dt;
+            mark_changed(data);
+        }
+
+        bool within(const Vector3f &v, f32 tolerance) { return v.norm() <= tolerance; }
+
+        void reset_lod(drone_data &data)
+        {
+            data.lod = lod_level::full;
+            data.calm_steps = 0;
+            data.pending_ticks = 0;
+            data.pending_dt = 0.f;
+        }
+
+        bool is_calm(const drone_data &data, const lod_config &c)
+        {
+            const DroneState &state{data.state};
+            return within(state.velocity, c.velocity_tolerance) &&
+                   within(state.body_rates, c.rate_tolerance) &&
+                   within(state.position - data.setpoint.position, c.position_tolerance) &&
+                   within(data.setpoint.velocity, c.velocity_tolerance);
+        }
+
+        bool is_disturbed(const drone_data &data, const lod_config &c)
+        {
+            return !within(data.setpoint.position - data.held_setpoint, c.position_tolerance) ||
+                   !within(data.setpoint.velocity, c.velocity_tolerance) ||
+                   !within(data.state.wind - data.held_wind, c.wind_tolerance);
+        }
+
+        u32 reduced_stride(const drone_data &data, const lod_config &c, f32 dt)
+        {
+            if (c.roi_radius <= 0.f || dt <= 0.f)
+                return 1;
+            const Vector3f center{c.roi_center[0], c.roi_center[1], c.roi_center[2]};
+            if ((data.state.position - center).norm() <= c.roi_radius)
+                return 1;
+            // The epsilon keeps exact multiples such as 0.02 / 0.005 from rounding down
+            return std::max(1u, (u32)(c.max_reduced_dt / dt + 1e-4f));
+        }
+
+        /**
+         * @brief Steps a drone at the rate its level of detail allows
+         *
+         * The motor lag and attitude loop limit how far dt can grow, so
+         * reduced drones are capped by max_reduced_dt and settled ones are held
+         * instead of being stepped with a large dt.
+         */
+        void step_with_lod(drone_data &data, f32 dt, const lod_config &c)
+        {
+            data.stepped_dt = 0.f;
+            if (data.lod == lod_level::held)
+            {
+                if (!is_disturbed(data, c))
+                {
+                    ++data.steps_skipped;
+                    return;
+                }
+                reset_lod(data);
+            }
+
+            const u32 stride{reduced_stride(data, c, dt)};
+            data.lod = stride > 1 ? lod_level::reduced : lod_level::full;
+            data.pending_dt += dt;
+            if (++data.pending_ticks < stride)
+            {
+                ++data.steps_skipped;
+                return;
+            }
+
+            step_vehicle(data, data.pending_dt);
+            ++data.steps_taken;
+            data.pending_ticks = 0;
+            data.pending_dt = 0.f;
+
+            data.calm_steps = is_calm(data, c) ? data.calm_steps + 1 : 0;
+            if (data.calm_steps >= c.settle_ticks)
+            {
+                data.lod = lod_level::held;
+                data.held_wind = data.state.wind;
+                data.held_setpoint = data.setpoint.position;
+            }
+        }
+
+        template <typename Field> storage_view field_view(Field DroneState::*field)
+        {
+            drone_store &s{*store};
+            static_assert(std::is_same_v<typename Field::Scalar, f32>);
+            void *data{s.drone_components.empty() ? nullptr
+                                                : (s.drone_components[0].state.*field).data()};
+            return {data,
+                    (u32)s.drone_components.size(),
+                    (u32)Field::SizeAtCompileTime,
+                    (u32)sizeof(drone_data),
+                    storage_view::float32,
+                    s.storage_generation};
         }
 
     }
 
     component create(init_info info, game_entity::entity entity) {
         assert(entity.is_valid());
+        drone_store &s{*store};
 
         drone_id id{};
 
-        if (free_ids.size() > id::min_deleted_elements)
+        if (s.free_ids.size() > id::min_deleted_elements)
         {
-            id = free_ids.front();
+            id = s.free_ids.front();
             assert(!exists(id));
-            free_ids.pop_front();
+            s.free_ids.pop_front();
             id = drone_id{id::new_generation(id)};
-            ++generations[id::index(id)];
+            ++s.generations[id::index(id)];
         }
         else
         {
-            id = drone_id{(id::id_type)id_mapping.size()};
-            id_mapping.emplace_back();
-            generations.push_back(0);
+            id = drone_id{(id::id_type)s.id_mapping.size()};
+            s.id_mapping.emplace_back();
+            s.generations.push_back(0);
         }
 
         assert(id::is_valid(id));
-        const id::id_type index{(id::id_type)drone_components.size()};
+        const id::id_type index{(id::id_type)s.drone_components.size()};
+        const vehicle_type dynamics{vehicle_types::acquire(info.params)};
 
-        drone_components.emplace_back(drone_data{
+        s.drone_components.emplace_back(drone_data{
             true,
-            Multirotor(info.params, info.initial_state, info.abstraction),
-            Control{info.params},
+            entity.get_id(),
+            Multirotor(dynamics, info.initial_state, info.abstraction),
+            Control{dynamics},
             std::move(info.trajectory),
+            TrajectoryPoint{},
             info.initial_state,
             info.last_control
         });
 
-        id_mapping[id::index(id)] = index;
+        s.id_mapping[id::index(id)] = index;
+        ++s.storage_generation;
         return component{id};
 
     }
 
     void remove(component c)
     {
+        drone_store &s{*store};
         if (!c.is_valid() || !exists(c.get_id()))
             return;
 
         const drone_id id{c.get_id()};
-        const id::id_type index{id_mapping[id::index(id)]};
-        const id::id_type last_index{(id::id_type)drone_components.size() - 1};
+        const id::id_type index{s.id_mapping[id::index(id)]};
+        const id::id_type last_index{(id::id_type)s.drone_components.size() - 1};
 
         if (index != last_index)
         {
-            drone_components[index] = std::move(drone_components[last_index]);
+            s.drone_components[index] = std::move(s.drone_components[last_index]);
             const auto moved_id =
-                std::find_if(id_mapping.begin(), id_mapping.end(),
+                std::find_if(s.id_mapping.begin(), s.id_mapping.end(),
                              [last_index](id::id_type mapping) { return mapping == last_index; });
-            if (moved_id != id_mapping.end())
+            if (moved_id != s.id_mapping.end())
             {
                 *moved_id = index;
             }
         }
 
-        drone_components.pop_back();
-        id_mapping[id::index(id)] = id::invalid_id;
+        s.drone_components.pop_back();
+        s.id_mapping[id::index(id)] = id::invalid_id;
+        ++s.storage_generation;
 
-        if (generations[id::index(id)] < id::max_generation)
+        if (s.generations[id::index(id)] < id::max_generation)
         {
-            free_ids.push_back(id);
+            s.free_ids.push_back(id);
         }
     }
 
     void component::update(float dt, const Eigen::Vector3f& wind)
     {
         assert(is_valid() && exists(_id));
-        auto &data = drone_components[id_mapping[id::index(_id)]];
+        auto &data = data_of(_id);
 
         // Update wind
         data.state.wind = wind;
 
-        // Update trajectory
-        TrajectoryPoint point = data.trajectory->update(dt);
-
-        // Compute control
-        data.last_control = data.control.computeMotorCommands(data.state, point);
-
-        // Vehicle dynamics step
-        data.state = data.vehicle.step(data.state, data.last_control, dt);
+        update_trajectory(data, dt);
+        update_control(data);
+        step_vehicle(data, dt);
     }
 
     std::pair<Eigen::Vector3f, Eigen::Vector3f> component::get_forces_and_torques() const
     {
         assert(is_valid() && exists(_id));
-        auto &data = drone_components[id_mapping[id::index(_id)]];
+        auto &data = data_of(_id);
         return data.vehicle.GetPairs();
     }
 
     DroneState component::get_state() const
     {
         assert(is_valid() && exists(_id));
-        return drone_components[id_mapping[id::index(_id)]].state;
+        return data_of(_id).state;
     }
 
     void component::set_state(const DroneState& state)
     {
         assert(is_valid() && exists(_id));
-        drone_components[id_mapping[id::index(_id)]].state = state;
+        auto &data = data_of(_id);
+        data.state = state;
+        data.induced_wind.setZero();
+        reset_lod(data);
+        mark_changed(data);
     }
 
     void component::sync_from_physics(const math::v3& position, const math::v4& orientation,
                                   const math::v3& velocity, const math::v3& angular_velocity)
     {
         assert(is_valid() && exists(_id));
-        auto &data = drone_components[id_mapping[id::index(_id)]];
+        auto &data = data_of(_id);
 
         data.state.position = Eigen::Vector3f(position.x, position.y, position.z);
         data.state.attitude = Eigen::Vector4f(orientation.x, orientation.y, orientation.z, orientation.w);
         data.state.velocity = Eigen::Vector3f(velocity.x, velocity.y, velocity.z);
         data.state.body_rates = Eigen::Vector3f(angular_velocity.x, angular_velocity.y, angular_velocity.z);
+        reset_lod(data);
+        mark_changed(data);
+    }
+
+    u32 count() { return (u32)store->drone_components.size(); }
+
+    game_entity::entity_id entity_at(u32 index) { return store->drone_components[index].entity; }
+
+    const DroneState &state_at(u32 index) { return store->drone_components[index].state; }
+
+    const QuadParams &params_at(u32 index)
+    {
+        return store->drone_components[index].vehicle.GetDynamics().GetQuadParams();
+    }
+
+    void sample_wind(Wind &wind, f32 dt, u32 begin, u32 end)
+    {
+        auto &components = store->drone_components;
+        assert(begin <= end && end <= components.size());
+        for (u32 i{begin}; i < end; ++i)
+        {
+            auto &data = components[i];
+            data.state.wind = wind.update(dt, data.state.position);
+            data.induced_wind.setZero();
+        }
+    }
+
+    void set_induced_wind(const Vector3f *induced, u32 begin, u32 end)
+    {
+        auto &components = store->drone_components;
+        assert(begin <= end && end <= components.size());
+        for (u32 i{begin}; i < end; ++i)
+        {
+            auto &data = components[i];
+            data.state.wind += induced[i] - data.induced_wind;
+            data.induced_wind = induced[i];
+        }
+    }
+
+    void update_trajectories(f32 dt, u32 begin, u32 end)
+    {
+        auto &components = store->drone_components;
+        assert(begin <= end && end <= components.size());
+        for (u32 i{begin}; i < end; ++i)
+            update_trajectory(components[i], dt);
+    }
+
+    void update_controls(u32 begin, u32 end)
+    {
+        auto &components = store->drone_components;
+        assert(begin <= end && end <= components.size());
+        if (!estimator::feeds_control())
+        {
+            for (u32 i{begin}; i < end; ++i)
+                update_control(components[i]);
+            return;
+        }
+
+        // Controllers only see what the filter knows, drones it does not track yet see the truth
+        for (u32 i{begin}; i < end; ++i)
+        {
+            drone_data &data{components[i]};
+            DroneState observed{data.state};
+            estimator::estimate(i, observed);
+            data.last_control = data.control.computeMotorCommands(observed, data.setpoint);
+        }
+    }
+
+    void set_control(u32 index, const ControlInput &input)
+    {
+        auto &components = store->drone_components;
+        assert(index < components.size());
+        drone_data &data{components[index]};
+        data.last_control = input;
+        // The external controller may be steering a settled drone away
+        reset_lod(data);
+        mark_changed(data);
+    }
+
+    void step_dynamics(f32 dt, u32 begin, u32 end)
+    {
+        drone_store &s{*store};
+        auto &components = s.drone_components;
+        assert(begin <= end && end <= components.size());
+        if (!s.lod.enabled)
+        {
+            for (u32 i{begin}; i < end; ++i)
+                step_vehicle(components[i], dt);
+            return;
+        }
+
+        for (u32 i{begin}; i < end; ++i)
+            step_with_lod(components[i], dt, s.lod);
+    }
+
+    void configure_lod(const lod_config &c)
+    {
+        drone_store &s{*store};
+        s.lod = c;
+        for (auto &data : s.drone_components)
+        {
+            reset_lod(data);
+            data.steps_taken = 0;
+            data.steps_skipped = 0;
+        }
+    }
+
+    const lod_config &get_lod_config() { return store->lod; }
+
+    lod_level lod_at(u32 index)
+    {
+        const auto &components = store->drone_components;
+        assert(index < components.size());
+        return components[index].lod;
+    }
+
+    f32 stepped_dt_at(u32 index)
+    {
+        const auto &components = store->drone_components;
+        assert(index < components.size());
+        return components[index].stepped_dt;
+    }
+
+    lod_stats get_lod_stats()
+    {
+        lod_stats stats{};
+        for (const auto &data : store->drone_components)
+        {
+            switch (data.lod)
+            {
+            case lod_level::full: ++stats.full; break;
+            case lod_level::reduced: ++stats.reduced; break;
+            case lod_level::held: ++stats.held; break;
+            }
+            stats.steps_taken += data.steps_taken;
+            stats.steps_skipped += data.steps_skipped;
+        }
+        return stats;
+    }
+
+    void sync_transforms(u32 begin, u32 end)
+    {
+        const auto &components = store->drone_components;
+        assert(begin <= end && end <= components.size());
+        for (u32 i{begin}; i < end; ++i)
+        {
+            const auto &data = components[i];
+            auto transform = game_entity::entity{data.entity}.transform();
+            if (!transform.is_valid())
+                continue;
+
+            // DroneState stores the attitude as [x,y,z,w]
+            const DroneState &state{data.state};
+            transform.set_position(
+                math::v3(state.position.x(), state.position.y(), state.position.z()));
+            transform.set_rotation(math::v4(state.attitude.x(), state.attitude.y(),
+                                            state.attitude.z(), state.attitude.w()));
+        }
+    }
+
+    storage_view state_view(state_field field)
+    {
+        switch (field)
+        {
+        case state_field::position:
+            return field_view(&DroneState::position);
+        case state_field::velocity:
+            return field_view(&DroneState::velocity);
+        case state_field::attitude:
+            return field_view(&DroneState::attitude);
+        case state_field::body_rates:
+            return field_view(&DroneState::body_rates);
+        case state_field::rotor_speeds:
+            return field_view(&DroneState::rotor_speeds);
+        }
+        assert(false);
+        return {};
+    }
+
+    storage_view entities_view()
+    {
+        drone_store &s{*store};
+        static_assert(sizeof(game_entity::entity_id) == sizeof(u32));
+        void *data{s.drone_components.empty() ? nullptr : &s.drone_components[0].entity};
+        return {data,
+                (u32)s.drone_components.size(),
+                1,
+                (u32)sizeof(drone_data),
+                storage_view::uint32,
+                s.storage_generation};
+    }
+
+    u64 layout_generation() { return store->storage_generation; }
+
+    void mark_all_changed()
+    {
+        // Writes through a view may have disturbed settled drones
+        for (auto &data : store->drone_components)
+        {
+            reset_lod(data);
+            mark_changed(data);
+        }
+    }
+
+    void save_states(util::vector<saved_state> &out)
+    {
+        drone_store &s{*store};
+        out.resize(s.drone_components.size());
+        for (u32 i{0}; i < s.drone_components.size(); ++i)
+        {
+            auto &data = s.drone_components[i];
+            out[i] = {(id::id_type)data.entity,
+                      data.state,
+                      data.setpoint,
+                      data.last_control,
+                      random::save_state(data.vehicle.GetNoiseGenerator()),
+                      data.induced_wind,
+                      data.lod,
+                      data.calm_steps,
+                      data.pending_ticks,
+                      data.pending_dt,
+                      data.stepped_dt,
+                      data.held_wind,
+                      data.held_setpoint};
+        }
+    }
+
+    bool load_states(const saved_state *states, u32 count)
+    {
+        drone_store &s{*store};
+        if (count != s.drone_components.size())
+            return false;
+        for (u32 i{0}; i < count; ++i)
+        {
+            if (states[i].entity != (id::id_type)s.drone_components[i].entity)
+                return false;
+        }
+
+        for (u32 i{0}; i < count; ++i)
+        {
+            auto &data = s.drone_components[i];
+            data.state = states[i].state;
+            data.setpoint = states[i].setpoint;
+            data.last_control = states[i].last_control;
+            data.induced_wind = states[i].induced_wind;
+            data.lod = states[i].lod;
+            data.calm_steps = states[i].calm_steps;
+            data.pending_ticks = states[i].pending_ticks;
+            data.pending_dt = states[i].pending_dt;
+            data.stepped_dt = states[i].stepped_dt;
+            data.held_wind = states[i].held_wind;
+            data.held_setpoint = states[i].held_setpoint;
+            random::load_state(data.vehicle.GetNoiseGenerator(), states[i].noise_state);
+            mark_changed(data);
+        }
+        return true;
     }
 
     void shutdown()
     {
-        drone_components.clear();
-        id_mapping.clear();
-        generations.clear();
-        free_ids.clear();
+        drone_store &s{*store};
+        ++s.storage_generation;
+        s.drone_components.clear();
+        s.id_mapping.clear();
+        s.generations.clear();
+        s.free_ids.clear();
     }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "ComponentCommon.h"
 #include "PhysicExtension/Controller/Controller.h"
 #include "PhysicExtension/Utils/DroneDynamics.h"
+#include "PhysicExtension/Utils/Wind.h"
 #include "PhysicExtension/Vehicles/Multirotor.h"
 
 /**
@@ -38,5 +39,218 @@ namespace lark::drone
      */
     void remove(component t);
 
+    /**
+     * @brief Number of live drone components
+     *
+     * The batch functions below address drones by their dense index in
+     * [0, count()). Ranges that do not overlap can be processed concurrently.
+     */
+    u32 count();
+
+    /**
+     * @brief Owner, state and airframe of the drone at a dense index, for batch readers
+     */
+    game_entity::entity_id entity_at(u32 index);
+    const DroneState &state_at(u32 index);
+    const QuadParams &params_at(u32 index);
+
+    /**
+     * @brief Samples the wind model at the position of each drone in [begin, end)
+     *
+     * Wind models keep internal state, so a single thread must own the model.
+     */
+    void sample_wind(Wind &wind, f32 dt, u32 begin, u32 end);
+
+    /**
+     * @brief Replaces the part of the wind caused by other drones for drones in [begin, end)
+     *
+     * The wind of drone i becomes its ambient wind plus induced[i]. Sampling
+     * the ambient wind clears the induced part.
+     */
+    void set_induced_wind(const Vector3f *induced, u32 begin, u32 end);
+
+    /**
+     * @brief Evaluates the trajectory setpoint of drones in [begin, end)
+     */
+    void update_trajectories(f32 dt, u32 begin, u32 end);
+
+    /**
+     * @brief Computes the control input of drones in [begin, end) from state and setpoint
+     */
+    void update_controls(u32 begin, u32 end);
+
+    /**
+     * @brief Replaces the control input of the drone at a dense index until the next update_controls
+     *
+     * For controllers running outside the engine, called after update_controls.
+     */
+    void set_control(u32 index, const ControlInput &input);
+
+    /**
+     * @brief Integrates the dynamics of drones in [begin, end) with the last control input
+     *
+     * With the LOD policy enabled, drones below full detail skip some or all steps.
+     */
+    void step_dynamics(f32 dt, u32 begin, u32 end);
+
+    /**
+     * @brief Dynamics level of detail of a drone
+     */
+    enum class lod_level : u8
+    {
+        full,    ///< Stepped every tick
+        reduced, ///< Outside the region of interest, stepped every few ticks with their summed dt
+        held     ///< Settled in hover, the state is held until its inputs change
+    };
+
+    /**
+     * @struct lod_config
+     * @brief Dynamics LOD policy of a world
+     *
+     * A drone is held after its velocity, body rates and distance to the
+     * setpoint stayed within the tolerances for settle_ticks steps while the
+     * setpoint was at rest. It returns to full rate as soon as the setpoint
+     * moves, its wind changes or its state is set from outside. Drones farther
+     * than roi_radius from roi_center are stepped with up to max_reduced_dt.
+     */
+    struct lod_config
+    {
+        bool enabled{false};
+        f32 velocity_tolerance{0.01f};  ///< m/s, also applies to the setpoint velocity
+        f32 rate_tolerance{0.01f};      ///< rad/s
+        f32 position_tolerance{0.01f};  ///< m, from the setpoint and for setpoint moves
+        f32 wind_tolerance{0.05f};      ///< m/s change of the wind while held
+        u32 settle_ticks{30};           ///< Calm steps before a drone is held
+        f32 roi_center[3]{};            ///< m, world frame
+        f32 roi_radius{0.f};            ///< m, 0 keeps every drone at full rate
+        f32 max_reduced_dt{0.02f};      ///< s, longest step of a reduced drone
+    };
+
+    /**
+     * @struct lod_stats
+     * @brief Drones per level and the vehicle steps taken and skipped since configure_lod
+     */
+    struct lod_stats
+    {
+        u32 full{0};
+        u32 reduced{0};
+        u32 held{0};
+        u64 steps_taken{0};
+        u64 steps_skipped{0};
+
+        /** @brief Share of the dynamics work saved, 0 without LOD */
+        f64 saved_fraction() const
+        {
+            const u64 total{steps_taken + steps_skipped};
+            return total ? (f64)steps_skipped / (f64)total : 0.0;
+        }
+    };
+
+    /**
+     * @brief Replaces the LOD policy and returns every drone to full rate
+     */
+    void configure_lod(const lod_config &c);
+    const lod_config &get_lod_config();
+
+    /**
+     * @brief Level of the drone at a dense index
+     */
+    lod_level lod_at(u32 index);
+
+    /**
+     * @brief Time the last step_dynamics call integrated a drone over
+     * @return dt at full rate, the summed dt of a reduced drone that caught up,
+     * 0 if the drone skipped the step
+     */
+    f32 stepped_dt_at(u32 index);
+
+    /**
+     * @brief Counts the drones per level and sums their step counters
+     */
+    lod_stats get_lod_stats();
+
+    /**
+     * @brief Copies position and attitude of drones in [begin, end) to their transforms
+     */
+    void sync_transforms(u32 begin, u32 end);
+
+    /**
+     * @brief DroneState fields that can be viewed in place
+     */
+    enum class state_field : u8
+    {
+        position,
+        velocity,
+        attitude, ///< Quaternion [x,y,z,w]
+        body_rates,
+        rotor_speeds
+    };
+
+    /**
+     * @brief Strided view of one state field of every drone, rows in dense index order
+     *
+     * Drones are stored as whole structs, so the stride is the size of the
+     * per-drone record rather than of the field.
+     */
+    storage_view state_view(state_field field);
+
+    /**
+     * @brief Owning entity id of every drone, rows in dense index order
+     */
+    storage_view entities_view();
+
+    /**
+     * @brief Changes whenever drones are created or removed, removal moves the last drone
+     */
+    u64 layout_generation();
+
+    /**
+     * @brief Flags every drone as changed this frame, for writes made through a view
+     *
+     * Also returns every drone to full dynamics rate.
+     */
+    void mark_all_changed();
+
+    /**
+     * @struct saved_state
+     * @brief Simulated state of one drone
+     *
+     * Parameters, controllers and trajectories are not included, they belong
+     * to the scene a saved state is restored into. The level of detail is, so a
+     * restored drone is held or stepped on the same ticks as when it was saved.
+     */
+    struct saved_state
+    {
+        // Fixed-size Eigen members only
+        using trivially_relocatable = std::true_type;
+
+        id::id_type entity{id::invalid_id};
+        DroneState state;
+        TrajectoryPoint setpoint;
+        ControlInput last_control;
+        u32 noise_state{0}; ///< Motor noise generator
+        Vector3f induced_wind{Vector3f::Zero()}; ///< Downwash part of state.wind
+
+        lod_level lod{lod_level::full};
+        u32 calm_steps{0};
+        u32 pending_ticks{0};
+        f32 pending_dt{0.f};
+        f32 stepped_dt{0.f};
+        Vector3f held_wind{Vector3f::Zero()};
+        Vector3f held_setpoint{Vector3f::Zero()};
+    };
+
+    /**
+     * @brief Copies the state of every drone, in dense index order
+     */
+    void save_states(util::vector<saved_state> &out);
+
+    /**
+     * @brief Restores states taken by save_states in place
+     * @return false if the live drones or their order differ from the saved ones,
+     * nothing is changed then
+     */
+    bool load_states(const saved_state *states, u32 count);
+
     void shutdown();
 } // namespace lark::physics
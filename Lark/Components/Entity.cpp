@@ -1,86 +1,97 @@
 #include "Entity.h"
+#include "ChangeTracking.h"
 #include "Geometry.h"
 #include "Physics.h"
 #include "Script.h"
 #include "Transform.h"
 #include "Drone.h"
 #include "Material.h"
+#include "Core/Context.h"
 
 namespace lark::game_entity
 {
 // private alternative to static
 namespace
 {
-util::vector<transform::component> transforms;
-util::vector<script::component> scripts;
-util::vector<geometry::component> geometries;
-util::vector<physics::component> physics_container;
-util::vector<drone::component> drones;
-util::vector<material::component> materials;
+struct entity_store
+{
+    util::vector<transform::component> transforms;
+    util::vector<script::component> scripts;
+    util::vector<geometry::component> geometries;
+    util::vector<physics::component> physics_container;
+    util::vector<drone::component> drones;
+    util::vector<material::component> materials;
 
+    std::vector<id::generation_type> generations;
+    util::deque<entity_id> free_ids;
 
-std::vector<id::generation_type> generations;
-util::deque<entity_id> free_ids;
+    util::vector<entity_id> active_entities;
+};
 
-util::vector<entity_id> active_entities;
+context_local<entity_store> store;
 } // namespace
 
 entity create(entity_info info)
 {
+    entity_store &s{*store};
     assert(info.transform); // transform is required
 
     entity_id id;
-    if (free_ids.size() > id::min_deleted_elements)
+    if (s.free_ids.size() > id::min_deleted_elements)
     {
-        id = free_ids.front();
+        id = s.free_ids.front();
         assert(!is_alive(id));
-        free_ids.pop_front();
+        s.free_ids.pop_front();
         id = entity_id{id::new_generation(id)};
-        ++generations[id::index(id)];
+        ++s.generations[id::index(id)];
     }
     else
     {
-        id = entity_id{(id::id_type)generations.size()};
-        generations.push_back(0);
+        id = entity_id{(id::id_type)s.generations.size()};
+        s.generations.push_back(0);
 
         // Resize Components
         // emplace isntead of resize for memory allocations
-        transforms.emplace_back();
-        scripts.emplace_back();
-        geometries.emplace_back();
-        physics_container.emplace_back();
-        drones.emplace_back();
-        materials.emplace_back();
+        s.transforms.emplace_back();
+        s.scripts.emplace_back();
+        s.geometries.emplace_back();
+        s.physics_container.emplace_back();
+        s.drones.emplace_back();
+        s.materials.emplace_back();
     }
 
     const entity new_entity{id};
     const id::id_type index{id::index(id)};
+    changes::on_entity_created(id);
 
     // Create Transform Component
-    assert(!transforms[index].is_valid());
-    transforms[index] = transform::create(*info.transform, new_entity);
-    if (!transforms[index].is_valid())
+    assert(!s.transforms[index].is_valid());
+    s.transforms[index] = transform::create(*info.transform, new_entity);
+    if (!s.transforms[index].is_valid())
         return {};
 
     // Create Script Component
     if (info.script && info.script->script_creator)
     {
-        assert(!scripts[index].is_valid());
-        scripts[index] = script::create(*info.script, new_entity);
-        assert(scripts[index].is_valid());
+        assert(!s.scripts[index].is_valid());
+        s.scripts[index] = script::create(*info.script, new_entity);
+        assert(s.scripts[index].is_valid());
+        changes::mark_changed(changes::component_type::script, index);
     }
 
     // Create Geometry Component
     if (info.geometry && info.geometry->scene)
     {
-        assert(!geometries[index].is_valid());
-        geometries[index] = geometry::create(*info.geometry, new_entity);
+        assert(!s.geometries[index].is_valid());
+        s.geometries[index] = geometry::create(*info.geometry, new_entity);
+        changes::mark_changed(changes::component_type::geometry, index);
 
         // Create Material Component requirement geometry at least
         if (info.material)
         {
-            assert(!materials[index].is_valid());
-            materials[index] = material::create(*info.material, new_entity);
+            assert(!s.materials[index].is_valid());
+            s.materials[index] = material::create(*info.material, new_entity);
+            changes::mark_changed(changes::component_type::material, index);
         }
     }
 
@@ -88,88 +99,93 @@ entity create(entity_info info)
     // check if geometry is existing then drone component is available
     if (info.physics && info.physics->scene)
     {
-        assert(!physics_container[index].is_valid());
-        physics_container[index] = physics::create(*info.physics, new_entity);
+        assert(!s.physics_container[index].is_valid());
+        s.physics_container[index] = physics::create(*info.physics, new_entity);
+        changes::mark_changed(changes::component_type::physics, index);
     }
 
     if (info.drone && info.drone->params.inertia_properties.mass > 0)
     {
-        assert(!drones[index].is_valid());
-        drones[index] = drone::create(*info.drone, new_entity);
+        assert(!s.drones[index].is_valid());
+        s.drones[index] = drone::create(*info.drone, new_entity);
+        changes::mark_changed(changes::component_type::drone, index);
     }
 
-    active_entities.push_back(new_entity.get_id());
+    s.active_entities.push_back(new_entity.get_id());
 
     return new_entity;
 }
 
 void remove(entity_id id)
 {
+    entity_store &s{*store};
     const id::id_type index{id::index(id)};
     assert(is_alive(id));
 
     // First invalidate any script component
-    if (scripts[index].is_valid())
+    if (s.scripts[index].is_valid())
     {
-        auto script_copy = scripts[index]; // Make a copy before invalidating
-        scripts[index] = {};               // Invalidate first
+        auto script_copy = s.scripts[index]; // Make a copy before invalidating
+        s.scripts[index] = {};               // Invalidate first
         script::remove(script_copy);       // Then remove using the copy
     }
 
-    if (geometries[index].is_valid())
+    if (s.geometries[index].is_valid())
     {
-        auto geometry_copy = geometries[index];
-        geometries[index] = {};
+        auto geometry_copy = s.geometries[index];
+        s.geometries[index] = {};
         geometry::remove(geometry_copy);
 
         // also remove material if this happens
 
-        if (materials[index].is_valid())
+        if (s.materials[index].is_valid())
         {
-            auto material_copy = materials[index];
-            materials[index] = {};
+            auto material_copy = s.materials[index];
+            s.materials[index] = {};
             material::remove(material_copy);
         }
     }
 
-    if (materials[index].is_valid())
+    if (s.materials[index].is_valid())
     {
-        auto material_copy = materials[index];
-        materials[index] = {};
+        auto material_copy = s.materials[index];
+        s.materials[index] = {};
         material::remove(material_copy);
     }
 
-    if (physics_container[index].is_valid())
+    if (s.physics_container[index].is_valid())
     {
-        auto physics_copy = physics_container[index];
-        physics_container[index] = {};
+        auto physics_copy = s.physics_container[index];
+        s.physics_container[index] = {};
         physics::remove(physics_copy);
     }
 
-    if (drones[index].is_valid())
+    if (s.drones[index].is_valid())
     {
-        auto drone_copy = drones[index];
-        drones[index] = {};
+        auto drone_copy = s.drones[index];
+        s.drones[index] = {};
         drone::remove(drone_copy);
     }
 
-    transform::remove(transforms[index]);
-    transforms[index] = {};
+    transform::remove(s.transforms[index]);
+    s.transforms[index] = {};
+    changes::on_entity_removed(id);
 
-    if (generations[index] < id::max_generation)
+    if (s.generations[index] < id::max_generation)
     {
-        free_ids.push_back(id);
+        s.free_ids.push_back(id);
     }
 
-    auto it = std::find(active_entities.begin(), active_entities.end(), id);
-    if (it != active_entities.end())
+    auto it = std::find(s.active_entities.begin(), s.active_entities.end(), id);
+    if (it != s.active_entities.end())
     {
-        util::erase_unordered(active_entities, it - active_entities.begin());
+        util::erase_unordered(s.active_entities, it - s.active_entities.begin());
     }
 }
 
 bool updateEntity(entity_id id, entity_info info)
 {
+    entity_store &s{*store};
     const id::id_type index{id::index(id)};
     assert(is_alive(id));
 
@@ -194,127 +210,133 @@ bool updateEntity(entity_id id, entity_info info)
     if (info.script && info.script->script_creator)
     {
         // check if there is already and existing script for that id then delete it
-        if (scripts[index].is_valid())
+        if (s.scripts[index].is_valid())
         {
             // delete part
-            auto script_copy = scripts[index];
-            scripts[index] = {};
+            auto script_copy = s.scripts[index];
+            s.scripts[index] = {};
             script::remove(script_copy);
         }
 
         // creating new part
-        assert(!scripts[index].is_valid());
-        scripts[index] = script::create(*info.script, updated_entity);
-        assert(scripts[index].is_valid());
+        assert(!s.scripts[index].is_valid());
+        s.scripts[index] = script::create(*info.script, updated_entity);
+        assert(s.scripts[index].is_valid());
+        changes::mark_changed(changes::component_type::script, index);
     }
 
     if (info.geometry && info.geometry->scene)
     {
 
-        if (geometries[index].is_valid())
+        if (s.geometries[index].is_valid())
         {
-            auto geometry_copy = geometries[index];
-            geometries[index] = {};
+            auto geometry_copy = s.geometries[index];
+            s.geometries[index] = {};
             geometry::remove(geometry_copy);
         }
 
-        assert(!geometries[index].is_valid());
-        geometries[index] = geometry::create(*info.geometry, updated_entity);
-        assert(geometries[index].is_valid());
+        assert(!s.geometries[index].is_valid());
+        s.geometries[index] = geometry::create(*info.geometry, updated_entity);
+        assert(s.geometries[index].is_valid());
+        changes::mark_changed(changes::component_type::geometry, index);
     }
 
     if (info.material)
     {
 
-        if (materials[index].is_valid())
+        if (s.materials[index].is_valid())
         {
-            auto material_copy = materials[index];
-            materials[index] = {};
+            auto material_copy = s.materials[index];
+            s.materials[index] = {};
             material::remove(material_copy);
         }
 
-        assert(!materials[index].is_valid());
-        materials[index] = material::create(*info.material, updated_entity);
-        assert(materials[index].is_valid());
+        assert(!s.materials[index].is_valid());
+        s.materials[index] = material::create(*info.material, updated_entity);
+        assert(s.materials[index].is_valid());
+        changes::mark_changed(changes::component_type::material, index);
     }
 
     if (info.physics && info.physics->scene)
     {
 
-        if (physics_container[index].is_valid())
+        if (s.physics_container[index].is_valid())
         {
-            auto physics_copy= physics_container[index];
-            physics_container[index] = {};
+            auto physics_copy= s.physics_container[index];
+            s.physics_container[index] = {};
             physics::remove(physics_copy);
         }
 
-        assert(!physics_container[index].is_valid());
-        physics_container[index] = physics::create(*info.physics, updated_entity);
-        assert(physics_container[index].is_valid());
+        assert(!s.physics_container[index].is_valid());
+        s.physics_container[index] = physics::create(*info.physics, updated_entity);
+        assert(s.physics_container[index].is_valid());
+        changes::mark_changed(changes::component_type::physics, index);
     }
 
     if (info.drone && info.drone->params.inertia_properties.mass > 0)
     {
 
-        if (drones[index].is_valid())
+        if (s.drones[index].is_valid())
         {
-            auto drones_copy = drones[index];
-            drones[index] = {};
+            auto drones_copy = s.drones[index];
+            s.drones[index] = {};
             drone::remove(drones_copy);
         }
 
-        assert(!drones[index].is_valid());
-        drones[index] = drone::create(*info.drone, updated_entity);
-        assert(drones[index].is_valid());
+        assert(!s.drones[index].is_valid());
+        s.drones[index] = drone::create(*info.drone, updated_entity);
+        assert(s.drones[index].is_valid());
+        changes::mark_changed(changes::component_type::drone, index);
     }
 
     return true;
 }
 
-const util::vector<entity_id> &get_active_entities() { return active_entities; }
+const util::vector<entity_id> &get_active_entities() { return store->active_entities; }
 
 bool is_alive(entity_id id)
 {
+    entity_store &s{*store};
     assert(id::is_valid(id));
     const id::id_type index{id::index(id)};
-    assert(index < generations.size());
-    return (generations[index] == id::generation(id) && transforms[index].is_valid());
+    assert(index < s.generations.size());
+    return (s.generations[index] == id::generation(id) && s.transforms[index].is_valid());
 }
 
 transform::component entity::transform() const
 {
     assert(is_alive(_id));
     const id::id_type index{id::index(_id)};
-    return transforms[index];
+    return store->transforms[index];
 }
 
 script::component entity::script() const
 {
     assert(is_alive(_id));
-    return scripts[id::index(_id)];
+    return store->scripts[id::index(_id)];
 }
 
 geometry::component entity::geometry() const
 {
     assert(is_alive(_id));
-    return geometries[id::index(_id)];
+    return store->geometries[id::index(_id)];
 }
 
 physics::component entity::physics() const
 {
     assert(is_alive(_id));
-    return physics_container[id::index(_id)];
+    return store->physics_container[id::index(_id)];
 }
 
 drone::component entity::drone() const
 {
     assert(is_alive(_id));
-    return drones[id::index(_id)];
+    return store->drones[id::index(_id)];
 }
 
 material::component entity::material() const
 {
     assert(is_alive(_id));
-    return materials[id::index(_id)];
+    return store->materials[id::index(_id)];
 }
 } // namespace lark::game_entity
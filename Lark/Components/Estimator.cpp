@@ -0,0 +1,723 @@
+#include "Estimator.h"
+#include "Drone.h"
+#include "Sensors.h"
+#include "Core/Context.h"
+#include "Core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+
+namespace lark::estimator
+{
+namespace
+{
+constexpr u32 lanes{8}; ///< Drones per block, one AVX register of f32
+constexpr f32 gravity{9.81f};
+
+/**
+ * @enum column
+ * @brief Nominal state columns, the covariance follows them row-major
+ */
+enum column : u32
+{
+    px, py, pz,
+    vx, vy, vz,
+    qx, qy, qz, qw,
+    bax, bay, baz,
+    bgx, bgy, bgz,
+    wx, wy, wz, ///< Last bias-corrected gyro reading
+    nominal_count
+};
+
+static_assert(nominal_count == nominal_size);
+
+constexpr u32 covariance_size{state_size * state_size};
+constexpr u32 column_count{nominal_count + covariance_size};
+
+// First entry of each block of the error state
+constexpr u32 position_block{0};
+constexpr u32 velocity_block{3};
+constexpr u32 attitude_block{6};
+constexpr u32 accel_bias_block{9};
+constexpr u32 gyro_bias_block{12};
+
+using lane = f32[lanes];
+
+/**
+ * @struct filter_block
+ * @brief Filters of lanes adjacent drones, loaded from the columns for processing
+ */
+struct filter_block
+{
+    lane x[nominal_count];
+    lane P[state_size][state_size];
+};
+
+struct estimator_store
+{
+    config settings{};
+    util::vector<f32> columns;          ///< column_count columns of capacity rows
+    util::vector<id::id_type> entities; ///< Drone tracked by each row
+    util::vector<u32> rows;             ///< Row of each entity index, u32_invalid_id if untracked
+    u32 capacity{0};                    ///< Rows per column, a multiple of lanes
+    u32 count{0};                       ///< Tracked drones
+    u64 seen_layout{~u64{0}};
+
+    u64 imu_cursor{0};
+    u64 mocap_cursor{0};
+    util::vector<f64> imu_times; ///< Sensor time of the last IMU sample of each row, < 0 before
+
+    // Newest sample of each row, fresh is 1 for rows that got one in this update
+    util::vector<sensors::imu_sample> imu;
+    util::vector<sensors::mocap_sample> mocap;
+    util::vector<f32> imu_fresh;
+    util::vector<f32> mocap_fresh;
+    util::vector<sensors::imu_sample> imu_staging;
+    util::vector<sensors::mocap_sample> mocap_staging;
+};
+
+context_local<estimator_store> store;
+
+void init_row(f32 *columns, u32 capacity, u32 row, const drone::DroneState &state,
+              const config &c)
+{
+    const auto set = [columns, capacity, row](u32 column, f32 value) {
+        columns[(size_t)column * capacity + row] = value;
+    };
+
+    for (u32 i{0}; i < 3; ++i)
+    {
+        set(px + i, state.position[i]);
+        set(vx + i, state.velocity[i]);
+        set(bax + i, 0.f);
+        set(bgx + i, 0.f);
+        set(wx + i, state.body_rates[i]);
+    }
+    for (u32 i{0}; i < 4; ++i)
+        set(qx + i, state.attitude[i]);
+
+    const f32 sigmas[5]{c.initial_position_sigma, c.initial_velocity_sigma,
+                        c.initial_attitude_sigma, c.initial_accel_bias_sigma,
+                        c.initial_gyro_bias_sigma};
+    for (u32 i{0}; i < state_size; ++i)
+    {
+        for (u32 j{0}; j < state_size; ++j)
+            set(nominal_count + i * state_size + j,
+                i == j ? sigmas[i / 3] * sigmas[i / 3] : 0.f);
+    }
+}
+
+/**
+ * @brief Matches rows to the live drones after creations and removals
+ *
+ * Surviving drones keep their filter, new ones start from the true state.
+ */
+void sync_layout(estimator_store &s)
+{
+    const u64 layout{drone::layout_generation()};
+    if (layout == s.seen_layout)
+        return;
+    s.seen_layout = layout;
+
+    const util::vector<u32> old_rows{std::move(s.rows)};
+    const u32 count{drone::count()};
+    const u32 capacity{(count + lanes - 1) / lanes * lanes};
+    util::vector<f32> columns((size_t)column_count * capacity, 0.f);
+    util::vector<id::id_type> entities(count);
+    util::vector<f64> imu_times(capacity, -1.0);
+    util::vector<u32> rows;
+
+    for (u32 row{0}; row < count; ++row)
+    {
+        const id::id_type entity{drone::entity_at(row)};
+        const id::id_type index{id::index(entity)};
+        const u32 old{index < old_rows.size() ? old_rows[index] : u32_invalid_id};
+        entities[row] = entity;
+        if (index >= rows.size())
+            rows.resize(index + 1, u32_invalid_id);
+        rows[index] = row;
+
+        if (old != u32_invalid_id && s.entities[old] == entity)
+        {
+            for (u32 c{0}; c < column_count; ++c)
+                columns[(size_t)c * capacity + row] = s.columns[(size_t)c * s.capacity + old];
+            imu_times[row] = s.imu_times[old];
+        }
+        else
+        {
+            init_row(columns.data(), capacity, row, drone::state_at(row), s.settings);
+        }
+    }
+
+    // Padding rows hold a valid attitude so normalizing them stays finite
+    for (u32 row{count}; row < capacity; ++row)
+        columns[(size_t)qw * capacity + row] = 1.f;
+
+    s.columns = std::move(columns);
+    s.entities = std::move(entities);
+    s.rows = std::move(rows);
+    s.imu_times = std::move(imu_times);
+    s.capacity = capacity;
+    s.count = count;
+    s.imu.resize(capacity);
+    s.mocap.resize(capacity);
+    s.imu_fresh.resize(capacity);
+    s.mocap_fresh.resize(capacity);
+}
+
+void load(const estimator_store &s, u32 first, filter_block &f)
+{
+    const f32 *columns{s.columns.data()};
+    for (u32 c{0}; c < nominal_count; ++c)
+        std::copy_n(columns + (size_t)c * s.capacity + first, lanes, f.x[c]);
+    for (u32 i{0}; i < state_size; ++i)
+        for (u32 j{0}; j < state_size; ++j)
+        {
+            const size_t column{nominal_count + i * state_size + j};
+            std::copy_n(columns + column * s.capacity + first, lanes, f.P[i][j]);
+        }
+}
+
+void store_block(estimator_store &s, u32 first, const filter_block &f)
+{
+    f32 *columns{s.columns.data()};
+    for (u32 c{0}; c < nominal_count; ++c)
+        std::copy_n(f.x[c], lanes, columns + (size_t)c * s.capacity + first);
+    for (u32 i{0}; i < state_size; ++i)
+        for (u32 j{0}; j < state_size; ++j)
+        {
+            const size_t column{nominal_count + i * state_size + j};
+            std::copy_n(f.P[i][j], lanes, columns + column * s.capacity + first);
+        }
+}
+
+/**
+ * @brief q = q * [d, 1], normalized
+ */
+void rotate_by(filter_block &f, const lane d[3])
+{
+    for (u32 l{0}; l < lanes; ++l)
+    {
+        const f32 x{f.x[qx][l]}, y{f.x[qy][l]}, z{f.x[qz][l]}, w{f.x[qw][l]};
+        const f32 nx{w * d[0][l] + x + y * d[2][l] - z * d[1][l]};
+        const f32 ny{w * d[1][l] - x * d[2][l] + y + z * d[0][l]};
+        const f32 nz{w * d[2][l] + x * d[1][l] - y * d[0][l] + z};
+        const f32 nw{w - x * d[0][l] - y * d[1][l] - z * d[2][l]};
+        const f32 inverse_norm{1.f / std::sqrt(nx * nx + ny * ny + nz * nz + nw * nw)};
+        f.x[qx][l] = nx * inverse_norm;
+        f.x[qy][l] = ny * inverse_norm;
+        f.x[qz][l] = nz * inverse_norm;
+        f.x[qw][l] = nw * inverse_norm;
+    }
+}
+
+/**
+ * @brief Body to world rotation of every lane
+ */
+void rotation(const filter_block &f, lane R[3][3])
+{
+    for (u32 l{0}; l < lanes; ++l)
+    {
+        const f32 x{f.x[qx][l]}, y{f.x[qy][l]}, z{f.x[qz][l]}, w{f.x[qw][l]};
+        R[0][0][l] = 1.f - 2.f * (y * y + z * z);
+        R[0][1][l] = 2.f * (x * y - z * w);
+        R[0][2][l] = 2.f * (x * z + y * w);
+        R[1][0][l] = 2.f * (x * y + z * w);
+        R[1][1][l] = 1.f - 2.f * (x * x + z * z);
+        R[1][2][l] = 2.f * (y * z - x * w);
+        R[2][0][l] = 2.f * (x * z - y * w);
+        R[2][1][l] = 2.f * (y * z + x * w);
+        R[2][2][l] = 1.f - 2.f * (x * x + y * y);
+    }
+}
+
+/**
+ * @brief Propagates nominal state and covariance by one IMU sample
+ * @param dt Time since the previous sample of each lane, 0 leaves a lane untouched
+ *
+ * The transition matrix is identity apart from five 3x3 blocks, so F P F^T
+ * is formed block-wise instead of as dense 15x15 products.
+ */
+void predict(filter_block &f, const lane accel[3], const lane gyro[3], const lane dt,
+             const sensors::imu_config &imu)
+{
+    lane fb[3], wb[3], R[3][3];
+    for (u32 i{0}; i < 3; ++i)
+    {
+        for (u32 l{0}; l < lanes; ++l)
+        {
+            fb[i][l] = accel[i][l] - f.x[bax + i][l];
+            wb[i][l] = gyro[i][l] - f.x[bgx + i][l];
+            if (dt[l] > 0.f)
+                f.x[wx + i][l] = wb[i][l];
+        }
+    }
+    rotation(f, R);
+
+    // Nominal state
+    for (u32 i{0}; i < 3; ++i)
+    {
+        for (u32 l{0}; l < lanes; ++l)
+        {
+            const f32 a{R[i][0][l] * fb[0][l] + R[i][1][l] * fb[1][l] + R[i][2][l] * fb[2][l] -
+                        (i == 2 ? gravity : 0.f)};
+            f.x[px + i][l] += (f.x[vx + i][l] + 0.5f * a * dt[l]) * dt[l];
+            f.x[vx + i][l] += a * dt[l];
+        }
+    }
+
+    lane half_angle[3];
+    for (u32 i{0}; i < 3; ++i)
+        for (u32 l{0}; l < lanes; ++l)
+            half_angle[i][l] = 0.5f * wb[i][l] * dt[l];
+    rotate_by(f, half_angle);
+
+    // Jacobian blocks: A = -R [fb]x dt, B = -R dt, C = I - [wb]x dt
+    lane A[3][3], B[3][3], C[3][3];
+    for (u32 l{0}; l < lanes; ++l)
+    {
+        const f32 skew_f[3][3]{{0.f, -fb[2][l], fb[1][l]},
+                               {fb[2][l], 0.f, -fb[0][l]},
+                               {-fb[1][l], fb[0][l], 0.f}};
+        const f32 skew_w[3][3]{{0.f, -wb[2][l], wb[1][l]},
+                               {wb[2][l], 0.f, -wb[0][l]},
+                               {-wb[1][l], wb[0][l], 0.f}};
+        for (u32 r{0}; r < 3; ++r)
+        {
+            for (u32 c{0}; c < 3; ++c)
+            {
+                A[r][c][l] = -(R[r][0][l] * skew_f[0][c] + R[r][1][l] * skew_f[1][c] +
+                               R[r][2][l] * skew_f[2][c]) *
+                             dt[l];
+                B[r][c][l] = -R[r][c][l] * dt[l];
+                C[r][c][l] = (r == c ? 1.f : 0.f) - skew_w[r][c] * dt[l];
+            }
+        }
+    }
+
+    // M = F P, only the position, velocity and attitude rows change
+    lane M[state_size][state_size];
+    for (u32 c{0}; c < state_size; ++c)
+    {
+        for (u32 r{0}; r < 3; ++r)
+        {
+            for (u32 l{0}; l < lanes; ++l)
+            {
+                f32 v{f.P[velocity_block + r][c][l]};
+                f32 t{-dt[l] * f.P[gyro_bias_block + r][c][l]};
+                for (u32 k{0}; k < 3; ++k)
+                {
+                    v += A[r][k][l] * f.P[attitude_block + k][c][l] +
+                         B[r][k][l] * f.P[accel_bias_block + k][c][l];
+                    t += C[r][k][l] * f.P[attitude_block + k][c][l];
+                }
+                M[position_block + r][c][l] =
+                    f.P[position_block + r][c][l] + dt[l] * f.P[velocity_block + r][c][l];
+                M[velocity_block + r][c][l] = v;
+                M[attitude_block + r][c][l] = t;
+            }
+        }
+        for (u32 r{accel_bias_block}; r < state_size; ++r)
+            std::copy_n(f.P[r][c], lanes, M[r][c]);
+    }
+
+    // P = M F^T, the same blocks applied to the columns
+    for (u32 r{0}; r < state_size; ++r)
+    {
+        for (u32 c{0}; c < 3; ++c)
+        {
+            for (u32 l{0}; l < lanes; ++l)
+            {
+                f32 v{M[r][velocity_block + c][l]};
+                f32 t{-dt[l] * M[r][gyro_bias_block + c][l]};
+                for (u32 k{0}; k < 3; ++k)
+                {
+                    v += M[r][attitude_block + k][l] * A[c][k][l] +
+                         M[r][accel_bias_block + k][l] * B[c][k][l];
+                    t += M[r][attitude_block + k][l] * C[c][k][l];
+                }
+                f.P[r][position_block + c][l] =
+                    M[r][position_block + c][l] + dt[l] * M[r][velocity_block + c][l];
+                f.P[r][velocity_block + c][l] = v;
+                f.P[r][attitude_block + c][l] = t;
+            }
+        }
+        for (u32 c{accel_bias_block}; c < state_size; ++c)
+            std::copy_n(M[r][c], lanes, f.P[r][c]);
+    }
+
+    // Process noise of the IMU, densities integrated over the sample period
+    const f32 noise[4]{imu.accel_noise_density * imu.accel_noise_density,
+                       imu.gyro_noise_density * imu.gyro_noise_density,
+                       imu.accel_random_walk * imu.accel_random_walk,
+                       imu.gyro_random_walk * imu.gyro_random_walk};
+    for (u32 i{velocity_block}; i < state_size; ++i)
+        for (u32 l{0}; l < lanes; ++l)
+            f.P[i][i][l] += noise[i / 3 - 1] * dt[l];
+}
+
+/**
+ * @brief Adds the error estimate to the nominal state
+ */
+void inject(filter_block &f, const lane dx[state_size])
+{
+    for (u32 i{0}; i < 3; ++i)
+    {
+        for (u32 l{0}; l < lanes; ++l)
+        {
+            f.x[px + i][l] += dx[position_block + i][l];
+            f.x[vx + i][l] += dx[velocity_block + i][l];
+            f.x[bax + i][l] += dx[accel_bias_block + i][l];
+            f.x[bgx + i][l] += dx[gyro_bias_block + i][l];
+        }
+    }
+
+    lane half_angle[3];
+    for (u32 i{0}; i < 3; ++i)
+        for (u32 l{0}; l < lanes; ++l)
+            half_angle[i][l] = 0.5f * dx[attitude_block + i][l];
+    rotate_by(f, half_angle);
+}
+
+/**
+ * @brief Kalman update with a direct measurement of one 3-entry block
+ * @param residual Measurement minus prediction of that block
+ * @param measured 1 for lanes that have a measurement, 0 leaves a lane untouched
+ */
+void correct(filter_block &f, u32 block, const lane residual[3], f32 variance,
+             const lane measured)
+{
+    // S = P_bb + variance I, inverted through its adjugate
+    lane S_inverse[3][3];
+    for (u32 l{0}; l < lanes; ++l)
+    {
+        f32 S[3][3];
+        for (u32 r{0}; r < 3; ++r)
+            for (u32 c{0}; c < 3; ++c)
+                S[r][c] = f.P[block + r][block + c][l] + (r == c ? variance : 0.f);
+
+        const f32 c00{S[1][1] * S[2][2] - S[1][2] * S[2][1]};
+        const f32 c01{S[1][2] * S[2][0] - S[1][0] * S[2][2]};
+        const f32 c02{S[1][0] * S[2][1] - S[1][1] * S[2][0]};
+        const f32 inverse_det{1.f / (S[0][0] * c00 + S[0][1] * c01 + S[0][2] * c02)};
+
+        S_inverse[0][0][l] = c00 * inverse_det;
+        S_inverse[1][0][l] = c01 * inverse_det;
+        S_inverse[2][0][l] = c02 * inverse_det;
+        S_inverse[0][1][l] = (S[0][2] * S[2][1] - S[0][1] * S[2][2]) * inverse_det;
+        S_inverse[1][1][l] = (S[0][0] * S[2][2] - S[0][2] * S[2][0]) * inverse_det;
+        S_inverse[2][1][l] = (S[0][1] * S[2][0] - S[0][0] * S[2][1]) * inverse_det;
+        S_inverse[0][2][l] = (S[0][1] * S[1][2] - S[0][2] * S[1][1]) * inverse_det;
+        S_inverse[1][2][l] = (S[0][2] * S[1][0] - S[0][0] * S[1][2]) * inverse_det;
+        S_inverse[2][2][l] = (S[0][0] * S[1][1] - S[0][1] * S[1][0]) * inverse_det;
+    }
+
+    // K = P_:b S^-1, dx = K residual
+    lane K[state_size][3], dx[state_size];
+    for (u32 i{0}; i < state_size; ++i)
+    {
+        for (u32 l{0}; l < lanes; ++l)
+        {
+            dx[i][l] = 0.f;
+            for (u32 j{0}; j < 3; ++j)
+            {
+                K[i][j][l] = (f.P[i][block][l] * S_inverse[0][j][l] +
+                              f.P[i][block + 1][l] * S_inverse[1][j][l] +
+                              f.P[i][block + 2][l] * S_inverse[2][j][l]) *
+                             measured[l];
+                dx[i][l] += K[i][j][l] * residual[j][l];
+            }
+        }
+    }
+
+    // P -= K P_b:, the measured rows are read before they change
+    lane rows[3][state_size];
+    for (u32 k{0}; k < 3; ++k)
+        for (u32 c{0}; c < state_size; ++c)
+            std::copy_n(f.P[block + k][c], lanes, rows[k][c]);
+
+    for (u32 i{0}; i < state_size; ++i)
+        for (u32 c{0}; c < state_size; ++c)
+            for (u32 l{0}; l < lanes; ++l)
+                f.P[i][c][l] -= K[i][0][l] * rows[0][c][l] + K[i][1][l] * rows[1][c][l] +
+                                K[i][2][l] * rows[2][c][l];
+
+    inject(f, dx);
+}
+
+void symmetrize(filter_block &f)
+{
+    for (u32 i{0}; i < state_size; ++i)
+    {
+        for (u32 j{i + 1}; j < state_size; ++j)
+        {
+            for (u32 l{0}; l < lanes; ++l)
+            {
+                const f32 mean{0.5f * (f.P[i][j][l] + f.P[j][i][l])};
+                f.P[i][j][l] = mean;
+                f.P[j][i][l] = mean;
+            }
+        }
+    }
+}
+
+void fuse_mocap(filter_block &f, const sensors::mocap_sample *samples, const lane measured,
+                u32 valid, const sensors::mocap_config &mocap)
+{
+    lane position[3]{}, velocity[3]{}, attitude[3]{};
+    for (u32 l{0}; l < valid; ++l)
+    {
+        if (!measured[l])
+            continue;
+        const sensors::mocap_sample &m{samples[l]};
+        for (u32 i{0}; i < 3; ++i)
+        {
+            position[i][l] = m.position[i] - f.x[px + i][l];
+            velocity[i][l] = m.velocity[i] - f.x[vx + i][l];
+        }
+    }
+
+    // The floor keeps S invertible with noiseless sensors
+    const auto variance = [](f32 sigma) { return std::max(sigma * sigma, 1e-10f); };
+    correct(f, position_block, position, variance(mocap.position_noise), measured);
+    correct(f, velocity_block, velocity, variance(mocap.velocity_noise), measured);
+
+    // Attitude residual 2 vec(q^-1 * q_measured), after the corrections above
+    for (u32 l{0}; l < valid; ++l)
+    {
+        if (!measured[l])
+            continue;
+        const f32 *z{samples[l].attitude};
+        const f32 x{f.x[qx][l]}, y{f.x[qy][l]}, zq{f.x[qz][l]}, w{f.x[qw][l]};
+        const f32 dw{w * z[3] + x * z[0] + y * z[1] + zq * z[2]};
+        const f32 sign{dw < 0.f ? -2.f : 2.f};
+        attitude[0][l] = sign * (w * z[0] - z[3] * x - (y * z[2] - zq * z[1]));
+        attitude[1][l] = sign * (w * z[1] - z[3] * y - (zq * z[0] - x * z[2]));
+        attitude[2][l] = sign * (w * z[2] - z[3] * zq - (x * z[1] - y * z[0]));
+    }
+    correct(f, attitude_block, attitude, variance(mocap.attitude_noise), measured);
+}
+
+/**
+ * @brief Collects the newest sample of every row written since the cursor
+ * @param out Sample of each row, only rows flagged in fresh are updated
+ * @param fresh Set to 1 for rows that received a sample, 0 for the others
+ * @return Number of rows that received a sample
+ *
+ * Samples are matched to rows by entity, so sensors that skip drones or a
+ * row order that differs from the sample order cannot misassign them.
+ * Samples of drones the estimator does not track are ignored.
+ */
+template <typename Sample>
+u32 take_latest(const estimator_store &s, u64 &cursor, u64 written,
+                u32 (*read)(u64 &, Sample *, u32), util::vector<Sample> &staging,
+                util::vector<Sample> &out, util::vector<f32> &fresh)
+{
+    std::fill(fresh.begin(), fresh.end(), 0.f);
+    staging.resize(std::max(s.count, 64u));
+
+    u32 rows{0};
+    while (cursor < written)
+    {
+        const u32 count{read(cursor, staging.data(), (u32)std::min<u64>(written - cursor,
+                                                                         staging.size()))};
+        if (count == 0)
+            break;
+
+        for (u32 i{0}; i < count; ++i)
+        {
+            const id::id_type entity{staging[i].entity};
+            const id::id_type index{id::index(entity)};
+            const u32 row{index < s.rows.size() ? s.rows[index] : u32_invalid_id};
+            if (row == u32_invalid_id || s.entities[row] != entity)
+                continue;
+
+            rows += fresh[row] == 0.f;
+            fresh[row] = 1.f;
+            out[row] = staging[i];
+        }
+    }
+    cursor = written;
+    return rows;
+}
+} // namespace
+
+void configure(const config &c)
+{
+    estimator_store &s{*store};
+    s.settings = c;
+    s.columns.clear();
+    s.entities.clear();
+    s.capacity = 0;
+    s.count = 0;
+    s.seen_layout = ~u64{0};
+    s.imu_cursor = sensors::imu_written();
+    s.mocap_cursor = sensors::mocap_written();
+    s.rows.clear();
+    s.imu_times.clear();
+}
+
+const config &get_config() { return store->settings; }
+
+void update()
+{
+    estimator_store &s{*store};
+    if (!s.settings.enabled)
+        return;
+
+    sync_layout(s);
+    if (s.count == 0)
+        return;
+
+    const sensors::config &sensor_config{sensors::get_config()};
+    const bool has_imu{take_latest(s, s.imu_cursor, sensors::imu_written(), &sensors::read_imu,
+                                   s.imu_staging, s.imu, s.imu_fresh) > 0};
+    const bool has_mocap{take_latest(s, s.mocap_cursor, sensors::mocap_written(),
+                                     &sensors::read_mocap, s.mocap_staging, s.mocap,
+                                     s.mocap_fresh) > 0};
+    if (!has_imu && !has_mocap)
+        return;
+
+    const u32 block_count{s.capacity / lanes};
+    jobs::parallel_for(block_count, 0, [&](u32 begin, u32 end) {
+        filter_block f;
+        for (u32 b{begin}; b < end; ++b)
+        {
+            const u32 first{b * lanes};
+            const u32 valid{std::min(lanes, s.count - first)};
+            load(s, first, f);
+
+            if (has_imu)
+            {
+                lane accel[3]{}, gyro[3]{}, dt{};
+                for (u32 l{0}; l < valid; ++l)
+                {
+                    const u32 row{first + l};
+                    if (!s.imu_fresh[row])
+                        continue;
+
+                    // Per drone and in f64, an f32 clock loses the period after a few hours
+                    const sensors::imu_sample &sample{s.imu[row]};
+                    dt[l] = s.imu_times[row] < 0.0 ? 1.f / sensor_config.imu.rate
+                                                   : (f32)(sample.time - s.imu_times[row]);
+                    s.imu_times[row] = sample.time;
+                    for (u32 i{0}; i < 3; ++i)
+                    {
+                        accel[i][l] = sample.accel[i];
+                        gyro[i][l] = sample.gyro[i];
+                    }
+                }
+                predict(f, accel, gyro, dt, sensor_config.imu);
+            }
+
+            if (has_mocap)
+                fuse_mocap(f, s.mocap.data() + first, s.mocap_fresh.data() + first, valid,
+                           sensor_config.mocap);
+
+            symmetrize(f);
+            store_block(s, first, f);
+        }
+    });
+}
+
+bool feeds_control()
+{
+    const config &c{store->settings};
+    return c.enabled && c.feed_control;
+}
+
+bool estimate(u32 index, drone::DroneState &state)
+{
+    const estimator_store &s{*store};
+    if (!s.settings.enabled || index >= s.count || s.seen_layout != drone::layout_generation())
+        return false;
+
+    const auto at = [&s, index](u32 column) {
+        return s.columns[(size_t)column * s.capacity + index];
+    };
+    state.position = drone::Vector3f{at(px), at(py), at(pz)};
+    state.velocity = drone::Vector3f{at(vx), at(vy), at(vz)};
+    state.attitude = drone::Vector4f{at(qx), at(qy), at(qz), at(qw)};
+    state.body_rates = drone::Vector3f{at(wx), at(wy), at(wz)};
+    return true;
+}
+
+bool biases(u32 index, f32 accel[3], f32 gyro[3])
+{
+    const estimator_store &s{*store};
+    if (index >= s.count)
+        return false;
+
+    for (u32 i{0}; i < 3; ++i)
+    {
+        accel[i] = s.columns[(size_t)(bax + i) * s.capacity + index];
+        gyro[i] = s.columns[(size_t)(bgx + i) * s.capacity + index];
+    }
+    return true;
+}
+
+bool covariance(u32 index, f32 *out)
+{
+    const estimator_store &s{*store};
+    if (index >= s.count)
+        return false;
+
+    for (u32 i{0}; i < covariance_size; ++i)
+        out[i] = s.columns[(size_t)(nominal_count + i) * s.capacity + index];
+    return true;
+}
+
+void save_state(saved_cursors &cursors, util::vector<saved_filter> &filters)
+{
+    const estimator_store &s{*store};
+    cursors.imu = s.imu_cursor;
+    cursors.mocap = s.mocap_cursor;
+
+    filters.resize(s.count);
+    for (u32 row{0}; row < s.count; ++row)
+    {
+        saved_filter &out{filters[row]};
+        out.entity = s.entities[row];
+        for (u32 c{0}; c < nominal_count; ++c)
+            out.nominal[c] = s.columns[(size_t)c * s.capacity + row];
+        for (u32 i{0}; i < covariance_size; ++i)
+            out.covariance[i] = s.columns[(size_t)(nominal_count + i) * s.capacity + row];
+        out.imu_time = s.imu_times[row];
+    }
+}
+
+void load_state(const saved_cursors &cursors, const saved_filter *filters, u32 count)
+{
+    assert(filters || !count);
+    estimator_store &s{*store};
+    s.imu_cursor = cursors.imu;
+    s.mocap_cursor = cursors.mocap;
+
+    const u32 capacity{(count + lanes - 1) / lanes * lanes};
+    s.columns = util::vector<f32>((size_t)column_count * capacity, 0.f);
+    s.entities.resize(count);
+    s.imu_times = util::vector<f64>(capacity, -1.0);
+    s.rows.clear();
+    for (u32 row{0}; row < count; ++row)
+    {
+        const saved_filter &in{filters[row]};
+        const id::id_type index{id::index(in.entity)};
+        s.entities[row] = in.entity;
+        if (index >= s.rows.size())
+            s.rows.resize(index + 1, u32_invalid_id);
+        s.rows[index] = row;
+
+        for (u32 c{0}; c < nominal_count; ++c)
+            s.columns[(size_t)c * capacity + row] = in.nominal[c];
+        for (u32 i{0}; i < covariance_size; ++i)
+            s.columns[(size_t)(nominal_count + i) * capacity + row] = in.covariance[i];
+        s.imu_times[row] = in.imu_time;
+    }
+    s.capacity = capacity;
+    s.count = count;
+
+    // Maps the saved rows onto the live drones right away so estimate() answers before update
+    s.seen_layout = ~u64{0};
+    sync_layout(s);
+}
+
+} // namespace lark::estimator
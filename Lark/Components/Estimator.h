@@ -0,0 +1,111 @@
+/**
+ * @file Estimator.h
+ * @brief Error-state EKF estimating the state of every drone from its sensors
+ *
+ * The filter propagates position, velocity, attitude and the accelerometer
+ * and gyro biases with each IMU sample and corrects them with each motion
+ * capture sample, using the noise settings of the sensors module. Its error
+ * state has 15 entries: position, velocity, attitude (body frame), accel bias
+ * and gyro bias.
+ *
+ * Filter states and covariances are stored as one column per scalar with a
+ * row per drone, and predict and update run on blocks of adjacent drones so
+ * every arithmetic step is a loop over the block that the compiler turns into
+ * SIMD. Blocks are distributed across the job pool.
+ */
+
+#pragma once
+#include "ComponentCommon.h"
+#include "PhysicExtension/Utils/DroneState.h"
+
+namespace lark::estimator
+{
+
+constexpr u32 state_size{15};
+constexpr u32 nominal_size{19}; ///< Position, velocity, attitude, biases and body rates
+
+/**
+ * @struct saved_cursors
+ * @brief Sensor samples the filters have consumed, as ring sequence numbers
+ */
+struct saved_cursors
+{
+    u64 imu{0};
+    u64 mocap{0};
+};
+
+/**
+ * @struct saved_filter
+ * @brief Filter of one drone: nominal state, error-state covariance and IMU clock
+ */
+struct saved_filter
+{
+    id::id_type entity{id::invalid_id};
+    f32 nominal[nominal_size]{};
+    f32 covariance[state_size * state_size]{}; ///< Row-major
+    f64 imu_time{-1.0};
+};
+
+/**
+ * @struct config
+ * @brief Filter switches and the initial uncertainty of newly tracked drones
+ */
+struct config
+{
+    bool enabled{false};
+    bool feed_control{false}; ///< Controllers consume the estimate instead of the true state
+
+    f32 initial_position_sigma{0.05f};   ///< m
+    f32 initial_velocity_sigma{0.05f};   ///< m/s
+    f32 initial_attitude_sigma{0.02f};   ///< rad
+    f32 initial_accel_bias_sigma{0.05f}; ///< m/s^2
+    f32 initial_gyro_bias_sigma{0.005f}; ///< rad/s
+};
+
+/**
+ * @brief Replaces the settings and restarts every filter from the true state
+ */
+void configure(const config &c);
+const config &get_config();
+
+/**
+ * @brief Processes the sensor samples of the current tick, called after sensors::update
+ */
+void update();
+
+/**
+ * @brief True while the filters are enabled and controllers should consume them
+ */
+bool feeds_control();
+
+/**
+ * @brief Overwrites position, velocity, attitude and body rates with the estimate
+ * @param index Dense drone index
+ * @return false if the drone is not tracked yet, state is left untouched then
+ */
+bool estimate(u32 index, drone::DroneState &state);
+
+/**
+ * @brief Current bias estimates of a drone, accel then gyro
+ */
+bool biases(u32 index, f32 accel[3], f32 gyro[3]);
+
+/**
+ * @brief Copies the error-state covariance of a drone, row-major state_size x state_size
+ */
+bool covariance(u32 index, f32 *out);
+
+/**
+ * @brief Copies the filter of every tracked drone and the sample cursors
+ */
+void save_state(saved_cursors &cursors, util::vector<saved_filter> &filters);
+
+/**
+ * @brief Restores a state taken by save_state, the config stays as it is
+ *
+ * Filters are matched to the live drones by entity. Drones without a saved
+ * filter start from the true state as if they had just been created.
+ */
+void load_state(const saved_cursors &cursors, const saved_filter *filters, u32 count);
+
+} // namespace lark::estimator
@@ -1,4 +1,6 @@
 #include "Geometry.h"
+#include "ChangeTracking.h"
+#include "Core/Context.h"
 #include "../Common/CommonHeaders.h"
 
 namespace lark::geometry
@@ -11,89 +13,110 @@ struct geometry_data
     bool is_valid{false};
     bool is_dynamic{false};
     std::shared_ptr<tools::scene> scene{nullptr};
+    game_entity::entity_id entity{id::invalid_id};
 };
 
-util::vector<geometry_data> geometries;
-util::vector<id::id_type> id_mapping;
-util::vector<id::generation_type> generations;
-std::deque<geometry_id> free_ids;
+struct geometry_store
+{
+    util::vector<geometry_data> geometries;
+    util::vector<id::id_type> id_mapping;
+    util::vector<id::generation_type> generations;
+    util::deque<geometry_id> free_ids;
+};
+
+context_local<geometry_store> store;
+
+geometry_data &data_of(geometry_id id)
+{
+    geometry_store &s{*store};
+    return s.geometries[s.id_mapping[id::index(id)]];
+}
 
 bool exists(const geometry_id id)
 {
+    geometry_store &s{*store};
     assert(id::is_valid(id));
     const id::id_type index{id::index(id)};
-    assert(index < generations.size() &&
-           !(id::is_valid(id_mapping[index]) && id_mapping[index] >= geometries.size()));
-    return (id::is_valid(id_mapping[index]) && generations[index] == id::generation(id) &&
-            geometries[id_mapping[index]].is_valid);
+    assert(index < s.generations.size() &&
+           !(id::is_valid(s.id_mapping[index]) && s.id_mapping[index] >= s.geometries.size()));
+    return (id::is_valid(s.id_mapping[index]) && s.generations[index] == id::generation(id) &&
+            s.geometries[s.id_mapping[index]].is_valid);
+}
+
+void mark_changed(const geometry_data &data)
+{
+    changes::mark_changed(changes::component_type::geometry, id::index(data.entity));
 }
 } // namespace
 
 component create(init_info info, game_entity::entity entity)
 {
+    geometry_store &s{*store};
     assert(entity.is_valid());
     assert(info.scene);
 
     geometry_id id{};
 
-    if (free_ids.size() > id::min_deleted_elements)
+    if (s.free_ids.size() > id::min_deleted_elements)
     {
-        id = free_ids.front();
+        id = s.free_ids.front();
         assert(!exists(id));
-        free_ids.pop_front();
+        s.free_ids.pop_front();
         id = geometry_id{id::new_generation(id)};
-        ++generations[id::index(id)];
+        ++s.generations[id::index(id)];
     }
     else
     {
-        id = geometry_id{(id::id_type)id_mapping.size()};
-        id_mapping.emplace_back();
-        generations.push_back(0);
+        id = geometry_id{(id::id_type)s.id_mapping.size()};
+        s.id_mapping.emplace_back();
+        s.generations.push_back(0);
     }
 
     assert(id::is_valid(id));
-    const id::id_type index{(id::id_type)geometries.size()};
-    geometries.emplace_back(geometry_data{
+    const id::id_type index{(id::id_type)s.geometries.size()};
+    s.geometries.emplace_back(geometry_data{
         true,
         info.is_dynamic,
         info.scene,
+        entity.get_id(),
     });
 
-    id_mapping[id::index(id)] = index;
+    s.id_mapping[id::index(id)] = index;
     return component{id};
 }
 
 void remove(component c)
 {
+    geometry_store &s{*store};
     if (!c.is_valid())
         return;
     if (!exists(c.get_id()))
         return;
 
     const geometry_id id{c.get_id()};
-    const id::id_type index{id_mapping[id::index(id)]};
-    const id::id_type last_index{(id::id_type)geometries.size() - 1};
+    const id::id_type index{s.id_mapping[id::index(id)]};
+    const id::id_type last_index{(id::id_type)s.geometries.size() - 1};
 
     // Move last element to the removed position
     if (index != last_index)
     {
-        geometries[index] = std::move(geometries[last_index]);
+        s.geometries[index] = std::move(s.geometries[last_index]);
         // Update the id_mapping for the moved element
         const auto moved_id =
-            std::find_if(id_mapping.begin(), id_mapping.end(),
+            std::find_if(s.id_mapping.begin(), s.id_mapping.end(),
                          [last_index](id::id_type mapping) { return mapping == last_index; });
-        if (moved_id != id_mapping.end())
+        if (moved_id != s.id_mapping.end())
         {
             *moved_id = index;
         }
     }
 
-    geometries.pop_back();
-    id_mapping[id::index(id)] = id::invalid_id;
+    s.geometries.pop_back();
+    s.id_mapping[id::index(id)] = id::invalid_id;
 
-    if (generations[id::index(id)] < id::max_generation)
+    if (s.generations[id::index(id)] < id::max_generation)
     {
-        free_ids.push_back(id);
+        s.free_ids.push_back(id);
     }
 }
 
@@ -101,26 +124,28 @@ void remove(component c)
 std::shared_ptr<tools::scene> component::get_scene() const
 {
     assert(is_valid() && exists(_id));
-    return geometries[id_mapping[id::index(_id)]].scene;
+    return data_of(_id).scene;
 }
 
 bool component::set_dynamic(bool dynamic)
 {
     assert(is_valid() && exists(_id));
-    geometries[id_mapping[id::index(_id)]].is_dynamic = dynamic;
+    auto &geom = data_of(_id);
+    geom.is_dynamic = dynamic;
+    mark_changed(geom);
     return true;
 }
 
 bool component::is_dynamic() const
 {
     assert(is_valid() && exists(_id));
-    return geometries[id_mapping[id::index(_id)]].is_dynamic;
+    return data_of(_id).is_dynamic;
 }
 
 bool component::update_vertices(const std::vector<math::v3> &new_positions)
 {
     assert(is_valid() && exists(_id));
-    const auto &geom = geometries[id_mapping[id::index(_id)]];
+    const auto &geom = data_of(_id);
     assert(geom.is_dynamic && "Geometry must be dynamic to update vertices");
 
     geometry_import_settings settings{};
@@ -128,14 +153,21 @@ bool component::update_vertices(const std::vector<math::v3> &new_positions)
     settings.calculate_tangents = true;
     settings.smoothing_angle = 178.f;
 
-    return tools::update_scene_mesh_positions(*geom.scene, 0, 0, new_positions, settings);
+    const bool updated{
+        tools::update_scene_mesh_positions(*geom.scene, 0, 0, new_positions, settings)};
+    if (updated)
+    {
+        mark_changed(geom);
+    }
+    return updated;
 }
 
 void shutdown()
 {
-    geometries.clear();
-    id_mapping.clear();
-    generations.clear();
-    free_ids.clear();
+    geometry_store &s{*store};
+    s.geometries.clear();
+    s.id_mapping.clear();
+    s.generations.clear();
+    s.free_ids.clear();
 }
 } // namespace lark::geometry
@@ -1,4 +1,5 @@
 #include "Material.h"
+#include "Core/Context.h"
 
 namespace lark::material
 {
@@ -9,46 +10,53 @@ namespace lark::material
             bool is_valid{false};
         };
 
-        util::vector<material_data> material_components;
-        util::vector<id::id_type> id_mapping;
-        util::vector<id::generation_type> generations;
-        std::deque<material_id> free_ids;
+        struct material_store
+        {
+            util::vector<material_data> material_components;
+            util::vector<id::id_type> id_mapping;
+            util::vector<id::generation_type> generations;
+            util::deque<material_id> free_ids;
+        };
+
+        context_local<material_store> store;
 
         bool exists(material_id id)
         {
+            material_store &s{*store};
             assert(id::is_valid(id));
             const id::id_type index{id::index(id)};
-            assert(index < generations.size());
-            return (id::is_valid(id_mapping[index]) && generations[index] == id::generation(id) &&
-                    material_components[id_mapping[index]].is_valid);
+            assert(index < s.generations.size());
+            return (id::is_valid(s.id_mapping[index]) && s.generations[index] == id::generation(id) &&
+                    s.material_components[s.id_mapping[index]].is_valid);
         }
     } // anon namespace
 
     component create(init_info info, game_entity::entity entity)
     {
+        material_store &s{*store};
         assert(entity.is_valid());
 
         material_id id{};
 
-        if (free_ids.size() > id::min_deleted_elements)
+        if (s.free_ids.size() > id::min_deleted_elements)
         {
-            id = free_ids.front();
+            id = s.free_ids.front();
             assert(!exists(id));
-            free_ids.pop_front();
+            s.free_ids.pop_front();
             id = material_id{id::new_generation(id)};
-            ++generations[id::index(id)];
+            ++s.generations[id::index(id)];
         }
         else
         {
-            id = material_id{(id::id_type)id_mapping.size()};
-            id_mapping.emplace_back();
-            generations.push_back(0);
+            id = material_id{(id::id_type)s.id_mapping.size()};
+            s.id_mapping.emplace_back();
+            s.generations.push_back(0);
         }
         assert(id::is_valid(id));
-        const id::id_type index{(id::id_type)material_components.size()};
+        const id::id_type index{(id::id_type)s.material_components.size()};
 
-        material_components.emplace_back(material_data{true});
-        id_mapping[id::index(id)] = index;
+        s.material_components.emplace_back(material_data{true});
+        s.id_mapping[id::index(id)] = index;
         return component{id};
     };
 
@@ -60,37 +68,38 @@ namespace lark::material
             return;
 
         const material_id id{c.get_id()};
-        const id::id_type index{id_mapping[id::index(id)]};
-        const id::id_type last_index{(id::id_type)material_components.size() - 1};
+        const id::id_type index{s.id_mapping[id::index(id)]};
+        const id::id_type last_index{(id::id_type)s.material_components.size() - 1};
 
         // Move last element to the removed position
         if (index != last_index)
         {
-            material_components[index] = std::move(material_components[last_index]);
+            s.material_components[index] = std::move(s.material_components[last_index]);
             // Update the id_mapping for the moved element
             const auto moved_id =
-                std::find_if(id_mapping.begin(), id_mapping.end(),
+                std::find_if(s.id_mapping.begin(), s.id_mapping.end(),
                              [last_index](id::id_type mapping) { return mapping == last_index; });
-            if (moved_id != id_mapping.end())
+            if (moved_id != s.id_mapping.end())
             {
                 *moved_id = index;
             }
         }
 
-        material_components.pop_back();
-        id_mapping[id::index(id)] = id::invalid_id;
+        s.material_components.pop_back();
+        s.id_mapping[id::index(id)] = id::invalid_id;
 
-        if (generations[id::index(id)] < id::max_generation)
+        if (s.generations[id::index(id)] < id::max_generation)
         {
-            free_ids.push_back(id);
+            s.free_ids.push_back(id);
         }
     }
 
     void shutdown()
     {
-        material_components.clear();
-        id_mapping.clear();
-        generations.clear();
-        free_ids.clear();
+        material_store &s{*store};
+        s.material_components.clear();
+        s.id_mapping.clear();
+        s.generations.clear();
+        s.free_ids.clear();
     }
 }
\ No newline at end of file
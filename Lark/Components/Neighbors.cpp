@@ -0,0 +1,491 @@
+#include "Neighbors.h"
+#include "Drone.h"
+#include "Core/Context.h"
+#include "Core/FrameArena.h"
+#include "Core/JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace lark::neighbors
+{
+namespace
+{
+// Cells are packed as three 21 bit coordinates, offset so negative cells fit
+constexpr u32 coordinate_bits{21};
+constexpr s64 coordinate_offset{s64{1} << (coordinate_bits - 1)};
+constexpr s64 coordinate_limit{coordinate_offset - 1};
+constexpr u32 radix_bits{11};
+
+u64 pack(s64 x, s64 y, s64 z)
+{
+    return (u64)(x + coordinate_offset) | (u64)(y + coordinate_offset) << coordinate_bits |
+           (u64)(z + coordinate_offset) << (2 * coordinate_bits);
+}
+
+bool in_range(s64 c) { return c >= -coordinate_offset && c <= coordinate_limit; }
+
+/**
+ * @brief Cell coordinate of p, clamped to the packable range
+ *
+ * Clamped before the conversion, which is undefined for values out of range.
+ * NaN maps to the last cell so broken points do not crowd the origin.
+ */
+s64 coordinate(f32 p, f32 inverse_cell_size)
+{
+    const f32 cell{std::floor(p * inverse_cell_size)};
+    if (std::isnan(cell))
+        return coordinate_limit;
+    return (s64)std::clamp(cell, (f32)-coordinate_offset, (f32)coordinate_limit);
+}
+
+/**
+ * @brief Cells needed to span length, saturating at the packable range
+ */
+s64 cell_span(f32 length, f32 inverse_cell_size)
+{
+    const f32 cells{std::ceil(length * inverse_cell_size)};
+    return std::isnan(cells) ? coordinate_offset
+                             : (s64)std::clamp(cells, 0.f, (f32)coordinate_offset);
+}
+
+f32 distance_squared(const f32 a[3], const f32 b[3])
+{
+    const f32 dx{a[0] - b[0]}, dy{a[1] - b[1]}, dz{a[2] - b[2]};
+    return dx * dx + dy * dy + dz * dz;
+}
+
+struct candidate
+{
+    f32 distance_squared;
+    u32 index;
+
+    bool operator<(const candidate &other) const
+    {
+        return distance_squared < other.distance_squared ||
+               (distance_squared == other.distance_squared && index < other.index);
+    }
+};
+
+/**
+ * @brief Keeps the k smallest candidates as a max-heap
+ */
+void offer(util::vector<candidate> &heap, u32 k, candidate c)
+{
+    if (heap.size() < k)
+    {
+        heap.push_back(c);
+        std::push_heap(heap.begin(), heap.end());
+    }
+    else if (c < heap.front())
+    {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = c;
+        std::push_heap(heap.begin(), heap.end());
+    }
+}
+} // namespace
+
+u32 spatial_hash::bucket_of(u64 cell) const
+{
+    return (u32)((cell * 0x9E3779B97F4A7C15ull) >> 32) & _bucket_mask;
+}
+
+u64 spatial_hash::cell_of(const f32 p[3]) const
+{
+    return pack(coordinate(p[0], _inverse_cell_size), coordinate(p[1], _inverse_cell_size),
+                coordinate(p[2], _inverse_cell_size));
+}
+
+void spatial_hash::build(const f32 *positions, u32 stride, u32 count, f32 cell_size)
+{
+    assert(cell_size > 0.f);
+    assert(count == 0 || positions);
+    _count = count;
+    _cell_size = cell_size;
+    _inverse_cell_size = 1.f / cell_size;
+
+    u32 bucket_bits{4};
+    while ((1u << bucket_bits) < 2 * count)
+        ++bucket_bits;
+    const u32 buckets{1u << bucket_bits};
+    _bucket_mask = buckets - 1;
+
+    _pairs.resize(count);
+    _scratch.resize(count);
+    _entries.resize(count);
+    _starts.resize(buckets + 1);
+
+    const auto point = [positions, stride](u32 i) {
+        return reinterpret_cast<const f32 *>(reinterpret_cast<const u8 *>(positions) +
+                                             (size_t)stride * i);
+    };
+
+    // Every chunk is one job and owns one histogram per radix pass
+    const u32 chunk_count{std::clamp(count / 4096, 1u, 256u)};
+    const u32 chunk_size{(count + chunk_count - 1) / chunk_count};
+    const auto chunk_range = [chunk_size, count](u32 c) {
+        return std::pair{std::min(c * chunk_size, count), std::min((c + 1) * chunk_size, count)};
+    };
+
+    // Cell and bucket of every point, paired with its index
+    for (u32 a{0}; a < 3; ++a)
+    {
+        _bounds_min[a] = count ? point(0)[a] : 0.f;
+        _bounds_max[a] = _bounds_min[a];
+    }
+    util::vector<f32> bounds((size_t)chunk_count * 6);
+    jobs::parallel_for(chunk_count, 1, [&](u32 first_chunk, u32 last_chunk) {
+        for (u32 c{first_chunk}; c < last_chunk; ++c)
+        {
+            f32 *low{bounds.data() + (size_t)c * 6};
+            f32 *high{low + 3};
+            std::copy_n(_bounds_min, 3, low);
+            std::copy_n(_bounds_max, 3, high);
+
+            const auto [begin, end] = chunk_range(c);
+            for (u32 i{begin}; i < end; ++i)
+            {
+                const f32 *p{point(i)};
+                _pairs[i] = (u64)bucket_of(cell_of(p)) << 32 | i;
+                for (u32 a{0}; a < 3; ++a)
+                {
+                    low[a] = std::min(low[a], p[a]);
+                    high[a] = std::max(high[a], p[a]);
+                }
+            }
+        }
+    });
+    for (u32 c{0}; c < chunk_count; ++c)
+    {
+        for (u32 a{0}; a < 3; ++a)
+        {
+            _bounds_min[a] = std::min(_bounds_min[a], bounds[(size_t)c * 6 + a]);
+            _bounds_max[a] = std::max(_bounds_max[a], bounds[(size_t)c * 6 + 3 + a]);
+        }
+    }
+
+    // Stable LSD radix sort by bucket, points of a bucket keep their index order
+    constexpr u32 digits{1u << radix_bits};
+    _histograms.resize((size_t)chunk_count * digits);
+    for (u32 shift{0}; shift < bucket_bits; shift += radix_bits)
+    {
+        const auto digit = [shift](u64 pair) { return (u32)(pair >> (32 + shift)) & (digits - 1); };
+
+        jobs::parallel_for(chunk_count, 1, [&](u32 first_chunk, u32 last_chunk) {
+            for (u32 c{first_chunk}; c < last_chunk; ++c)
+            {
+                u32 *histogram{_histograms.data() + (size_t)c * digits};
+                std::fill_n(histogram, digits, 0u);
+                const auto [begin, end] = chunk_range(c);
+                for (u32 i{begin}; i < end; ++i)
+                    ++histogram[digit(_pairs[i])];
+            }
+        });
+
+        // Digit-major, chunk-minor offsets keep equal digits in input order
+        u32 offset{0};
+        for (u32 d{0}; d < digits; ++d)
+        {
+            for (u32 c{0}; c < chunk_count; ++c)
+            {
+                u32 &slot{_histograms[(size_t)c * digits + d]};
+                const u32 size{slot};
+                slot = offset;
+                offset += size;
+            }
+        }
+
+        jobs::parallel_for(chunk_count, 1, [&](u32 first_chunk, u32 last_chunk) {
+            for (u32 c{first_chunk}; c < last_chunk; ++c)
+            {
+                u32 *histogram{_histograms.data() + (size_t)c * digits};
+                const auto [begin, end] = chunk_range(c);
+                for (u32 i{begin}; i < end; ++i)
+                    _scratch[histogram[digit(_pairs[i])]++] = _pairs[i];
+            }
+        });
+        std::swap(_pairs, _scratch);
+    }
+
+    // Bucket starts from the sorted keys, every bucket is written by exactly one point
+    jobs::parallel_for(count, 0, [&](u32 begin, u32 end) {
+        for (u32 i{begin}; i < end; ++i)
+        {
+            const u32 index{(u32)_pairs[i]};
+            const u32 bucket{(u32)(_pairs[i] >> 32)};
+            const u32 first_bucket{i == 0 ? 0 : (u32)(_pairs[i - 1] >> 32) + 1};
+            for (u32 b{first_bucket}; b <= bucket; ++b)
+                _starts[b] = i;
+
+            const f32 *p{point(index)};
+            _entries[i] = {{p[0], p[1], p[2]}, index, cell_of(p)};
+        }
+    });
+    const u32 tail{count ? (u32)(_pairs[count - 1] >> 32) + 1 : 0};
+    std::fill(_starts.begin() + tail, _starts.end(), count);
+}
+
+u32 spatial_hash::radius(const query_batch &queries, f32 radius,
+                         const query_results &results) const
+{
+    assert(results.indices && results.counts);
+    const f32 radius_squared{radius * radius};
+    const s64 reach{cell_span(radius, _inverse_cell_size)};
+    // Beyond this many cells a scan of all points is cheaper than visiting them
+    const f64 side{(f64)(2 * reach + 1)};
+    const bool scan_all{side * side * side > (f64)_count};
+    std::atomic<u32> truncated{0};
+
+    jobs::parallel_for(queries.count, 0, [&](u32 begin, u32 end) {
+        u32 full_rows{0};
+        for (u32 q{begin}; q < end; ++q)
+        {
+            const f32 *center{queries.points + (size_t)q * 3};
+            const u32 exclude{queries.exclude ? queries.exclude[q] : u32_invalid_id};
+            u32 *indices{results.indices + (size_t)q * results.capacity};
+            f32 *distances{results.distances ? results.distances + (size_t)q * results.capacity
+                                             : nullptr};
+            u32 found{0}, total{0};
+
+            // Points past the capacity are only counted, NaN distances are never in range
+            const auto consider = [&](const entry &e) {
+                if (e.index == exclude)
+                    return;
+                const f32 d{distance_squared(e.position, center)};
+                if (!(d <= radius_squared))
+                    return;
+                if (found < results.capacity)
+                {
+                    indices[found] = e.index;
+                    if (distances)
+                        distances[found] = std::sqrt(d);
+                    ++found;
+                }
+                ++total;
+            };
+
+            if (scan_all)
+            {
+                for (const entry &e : _entries)
+                    consider(e);
+            }
+            else
+            {
+                const s64 cx{coordinate(center[0], _inverse_cell_size)};
+                const s64 cy{coordinate(center[1], _inverse_cell_size)};
+                const s64 cz{coordinate(center[2], _inverse_cell_size)};
+                for (s64 z{cz - reach}; z <= cz + reach; ++z)
+                {
+                    for (s64 y{cy - reach}; y <= cy + reach; ++y)
+                    {
+                        for (s64 x{cx - reach}; x <= cx + reach; ++x)
+                        {
+                            if (!in_range(x) || !in_range(y) || !in_range(z))
+                                continue;
+                            const u64 cell{pack(x, y, z)};
+                            const u32 b{bucket_of(cell)};
+                            for (u32 i{_starts[b]}; i < _starts[b + 1]; ++i)
+                            {
+                                if (_entries[i].cell == cell)
+                                    consider(_entries[i]);
+                            }
+                        }
+                    }
+                }
+            }
+            results.counts[q] = found;
+            if (results.totals)
+                results.totals[q] = total;
+            full_rows += total > found;
+        }
+        truncated.fetch_add(full_rows, std::memory_order_relaxed);
+    });
+    return truncated.load(std::memory_order_relaxed);
+}
+
+void spatial_hash::nearest(const query_batch &queries, u32 k, const query_results &results) const
+{
+    assert(results.indices && results.counts);
+    assert(k <= results.capacity);
+
+    jobs::parallel_for(queries.count, 0, [&](u32 begin, u32 end) {
+        util::vector<candidate> heap;
+        heap.reserve(k);
+        for (u32 q{begin}; q < end; ++q)
+        {
+            const f32 *center{queries.points + (size_t)q * 3};
+            const u32 exclude{queries.exclude ? queries.exclude[q] : u32_invalid_id};
+            heap.clear();
+
+            // NaN distances would break the heap order
+            const auto consider = [&](const entry &e) {
+                const f32 d{distance_squared(e.position, center)};
+                if (e.index != exclude && !std::isnan(d))
+                    offer(heap, k, {d, e.index});
+            };
+            const auto visit = [&](s64 x, s64 y, s64 z) {
+                if (!in_range(x) || !in_range(y) || !in_range(z))
+                    return;
+                const u64 cell{pack(x, y, z)};
+                const u32 b{bucket_of(cell)};
+                for (u32 i{_starts[b]}; i < _starts[b + 1]; ++i)
+                {
+                    if (_entries[i].cell == cell)
+                        consider(_entries[i]);
+                }
+            };
+
+            // Rings needed to cover every point from the query cell
+            f32 farthest{0.f};
+            for (u32 a{0}; a < 3; ++a)
+                farthest = std::max({farthest, std::abs(center[a] - _bounds_min[a]),
+                                     std::abs(center[a] - _bounds_max[a])});
+            const s64 last_ring{cell_span(farthest, _inverse_cell_size) + 1};
+
+            const s64 cx{coordinate(center[0], _inverse_cell_size)};
+            const s64 cy{coordinate(center[1], _inverse_cell_size)};
+            const s64 cz{coordinate(center[2], _inverse_cell_size)};
+            for (s64 r{0}; k > 0 && r <= last_ring; ++r)
+            {
+                // A large shell costs more than looking at every point once
+                if ((f64)(24 * r * r + 2) > (f64)_count)
+                {
+                    heap.clear();
+                    for (const entry &e : _entries)
+                        consider(e);
+                    break;
+                }
+
+                // Cells at Chebyshev distance r from the query cell
+                for (s64 z{-r}; z <= r; ++z)
+                {
+                    for (s64 y{-r}; y <= r; ++y)
+                    {
+                        if (std::abs(z) == r || std::abs(y) == r)
+                        {
+                            for (s64 x{-r}; x <= r; ++x)
+                                visit(cx + x, cy + y, cz + z);
+                        }
+                        else
+                        {
+                            visit(cx - r, cy + y, cz + z);
+                            visit(cx + r, cy + y, cz + z);
+                        }
+                    }
+                }
+
+                // Unvisited points are at least r cells away from the query
+                const f32 covered{(f32)r * _cell_size};
+                if (heap.size() == k && heap.front().distance_squared <= covered * covered)
+                    break;
+            }
+
+            std::sort_heap(heap.begin(), heap.end());
+            u32 *indices{results.indices + (size_t)q * results.capacity};
+            for (u32 i{0}; i < heap.size(); ++i)
+            {
+                indices[i] = heap[i].index;
+                if (results.distances)
+                    results.distances[(size_t)q * results.capacity + i] =
+                        std::sqrt(heap[i].distance_squared);
+            }
+            results.counts[q] = (u32)heap.size();
+        }
+    });
+}
+
+namespace
+{
+struct neighbor_store
+{
+    config settings{};
+    spatial_hash grid;
+    util::vector<f32> ghosts; ///< xyz rows
+    util::vector<f32> points; ///< Drones followed by ghosts, only built with ghosts
+    u64 built_layout{~u64{0}};
+};
+
+context_local<neighbor_store> store;
+
+query_batch drone_queries(memory::frame_vector<f32> &points, const u32 *drones, u32 count)
+{
+    points.resize((size_t)count * 3);
+    for (u32 i{0}; i < count; ++i)
+    {
+        const drone::DroneState &state{drone::state_at(drones[i])};
+        for (u32 a{0}; a < 3; ++a)
+            points[(size_t)i * 3 + a] = state.position[a];
+    }
+    return {points.data(), drones, count};
+}
+} // namespace
+
+void configure(const config &c)
+{
+    neighbor_store &s{*store};
+    s.settings = c;
+    s.grid = {};
+    s.built_layout = ~u64{0};
+}
+
+const config &get_config() { return store->settings; }
+
+void update()
+{
+    if (store->settings.enabled)
+        build();
+}
+
+void build()
+{
+    neighbor_store &s{*store};
+    const storage_view positions{drone::state_view(drone::state_field::position)};
+    if (s.ghosts.empty())
+    {
+        s.grid.build(static_cast<const f32 *>(positions.data), positions.stride, positions.count,
+                     s.settings.cell_size);
+    }
+    else
+    {
+        const size_t drones{(size_t)positions.count * 3};
+        s.points.resize(drones + s.ghosts.size());
+        const u8 *row{static_cast<const u8 *>(positions.data)};
+        for (u32 i{0}; i < positions.count; ++i, row += positions.stride)
+            std::copy_n(reinterpret_cast<const f32 *>(row), 3, s.points.data() + (size_t)i * 3);
+        std::copy(s.ghosts.begin(), s.ghosts.end(), s.points.data() + drones);
+        s.grid.build(s.points.data(), 3 * sizeof(f32), (u32)(s.points.size() / 3),
+                     s.settings.cell_size);
+    }
+    s.built_layout = drone::layout_generation();
+}
+
+void set_ghosts(const f32 *positions, u32 count)
+{
+    neighbor_store &s{*store};
+    s.ghosts.resize((size_t)count * 3);
+    std::copy_n(positions, (size_t)count * 3, s.ghosts.data());
+}
+
+u32 ghost_count() { return (u32)(store->ghosts.size() / 3); }
+
+const spatial_hash &grid() { return store->grid; }
+
+bool is_current() { return store->built_layout == drone::layout_generation(); }
+
+// Query points live on the scope arena, callers may query outside the tick
+u32 drone_radius(const u32 *drones, u32 count, f32 radius, const query_results &results)
+{
+    memory::frame_scope scope;
+    memory::frame_vector<f32> points;
+    return store->grid.radius(drone_queries(points, drones, count), radius, results);
+}
+
+void drone_nearest(const u32 *drones, u32 count, u32 k, const query_results &results)
+{
+    memory::frame_scope scope;
+    memory::frame_vector<f32> points;
+    store->grid.nearest(drone_queries(points, drones, count), k, results);
+}
+
+} // namespace lark::neighbors
@@ -0,0 +1,168 @@
+/**
+ * @file Neighbors.h
+ * @brief Uniform-grid spatial hash answering radius and k-nearest queries over drones
+ *
+ * Space is divided into cubic cells that are hashed into a bucket table about
+ * twice the size of the point count. A build computes every point's cell and
+ * sorts the points by bucket into one contiguous array with a stable radix
+ * sort: per-chunk digit counts, a prefix sum and a scatter per pass, chunks
+ * spread over the job pool. Points of a bucket stay in index order, so query
+ * results do not depend on the thread timing.
+ *
+ * The game loop rebuilds the drone grid after the dynamics when enabled, and
+ * the downwash stage rebuilds it before them whenever downwash is enabled.
+ * Queries are batched and can run concurrently with each other.
+ *
+ * Ghosts are points of drones simulated elsewhere, e.g. the boundary drones
+ * of a neighboring shard. They are binned after the drones, so drone i is
+ * point i and ghost g is point count() + g of the grid.
+ */
+
+#pragma once
+#include "ComponentCommon.h"
+
+namespace lark::neighbors
+{
+
+/**
+ * @struct query_batch
+ * @brief Query points, one row of xyz per query
+ */
+struct query_batch
+{
+    const f32 *points{nullptr};
+    const u32 *exclude{nullptr}; ///< Optional point skipped per query, e.g. the asking drone
+    u32 count{0};
+};
+
+/**
+ * @struct query_results
+ * @brief Caller-owned result rows of capacity entries per query
+ */
+struct query_results
+{
+    u32 *indices{nullptr};   ///< Point indices, row i starts at i * capacity
+    f32 *distances{nullptr}; ///< Optional, same layout as indices
+    u32 *counts{nullptr};    ///< Entries written per query
+    u32 capacity{0};
+    u32 *totals{nullptr};    ///< Optional, points in range per query, may exceed counts
+};
+
+/**
+ * @class spatial_hash
+ * @brief Points binned by cell, rebuilt from scratch on every build
+ */
+class spatial_hash
+{
+  public:
+    /**
+     * @brief Bins count points read with a byte stride, replacing the previous contents
+     * @param cell_size Edge of a cell in metres, about the usual query radius works best
+     */
+    void build(const f32 *positions, u32 stride, u32 count, f32 cell_size);
+
+    /**
+     * @brief All points within radius of each query
+     *
+     * Rows hold at most capacity points in an order that only depends on the
+     * points; counts reports how many were written and totals how many were in range.
+     * @return Number of queries that found more points than capacity
+     */
+    u32 radius(const query_batch &queries, f32 radius, const query_results &results) const;
+
+    /**
+     * @brief The k nearest points of each query, closest first
+     *
+     * Ties are broken by the lower index. capacity must be at least k.
+     */
+    void nearest(const query_batch &queries, u32 k, const query_results &results) const;
+
+    u32 count() const { return _count; }
+    f32 cell_size() const { return _cell_size; }
+
+  private:
+    struct entry
+    {
+        f32 position[3];
+        u32 index;
+        u64 cell; ///< Packed cell coordinates, tells apart cells sharing a bucket
+    };
+
+    u32 bucket_of(u64 cell) const;
+    u64 cell_of(const f32 p[3]) const;
+
+    util::vector<entry> _entries;   ///< Sorted by bucket, index order inside a bucket
+    util::vector<u32> _starts;      ///< Bucket b covers [_starts[b], _starts[b + 1])
+    util::vector<u64> _pairs;       ///< Scratch, bucket << 32 | index
+    util::vector<u64> _scratch;     ///< Scratch, other buffer of the radix sort
+    util::vector<u32> _histograms;  ///< Scratch, digit counts per chunk
+    f32 _bounds_min[3]{};
+    f32 _bounds_max[3]{};
+    f32 _cell_size{1.f};
+    f32 _inverse_cell_size{1.f};
+    u32 _count{0};
+    u32 _bucket_mask{0};
+};
+
+/**
+ * @struct config
+ * @brief Drone grid settings of a world
+ */
+struct config
+{
+    bool enabled{true};
+    f32 cell_size{2.f}; ///< m
+};
+
+void configure(const config &c);
+const config &get_config();
+
+/**
+ * @brief Rebuilds the drone grid from the current drone and ghost positions, if enabled
+ *
+ * Point indices of the grid are dense drone indices, followed by the ghosts.
+ */
+void update();
+
+/**
+ * @brief Rebuilds the drone grid even if disabled, for stages that depend on it
+ */
+void build();
+
+/**
+ * @brief Replaces the ghost points, one row of xyz per ghost, from the next update on
+ */
+void set_ghosts(const f32 *positions, u32 count);
+
+/**
+ * @brief Ghost points of the next update
+ */
+u32 ghost_count();
+
+/**
+ * @brief The drone grid as of the last update
+ */
+const spatial_hash &grid();
+
+/**
+ * @brief True if the grid was built since drones were last created or removed
+ *
+ * Only then do its point indices match the dense drone indices.
+ */
+bool is_current();
+
+/**
+ * @brief Radius query around drones, each query skips the drone itself
+ * @param drones Dense drone indices
+ *
+ * Results from drone::count() on are ghosts.
+ * @return Number of queries that found more drones than capacity
+ */
+u32 drone_radius(const u32 *drones, u32 count, f32 radius, const query_results &results);
+
+/**
+ * @brief k-nearest query around drones, each query skips the drone itself
+ */
+void drone_nearest(const u32 *drones, u32 count, u32 k, const query_results &results);
+
+} // namespace lark::neighbors
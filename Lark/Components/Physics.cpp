@@ -1,4 +1,6 @@
 #include "Physics.h"
+#include "ChangeTracking.h"
+#include "Core/Context.h"
 #include <utility>
 #include "PhysicExtension/Event/PhysicEvent.h"
 
@@ -13,18 +15,31 @@ namespace
         float mass{1.0f};
     };
 
-    util::vector<physics_data> physics_components;
-    util::vector<id::id_type> id_mapping;
-    util::vector<id::generation_type> generations;
-    std::deque<physics_id> free_ids;
+    struct physics_store
+    {
+        util::vector<physics_data> physics_components;
+        util::vector<id::id_type> id_mapping;
+        util::vector<id::generation_type> generations;
+        util::deque<physics_id> free_ids;
+        util::vector<btRigidBody *> retired; ///< Removed, freed once the bus let go of them
+    };
+
+    context_local<physics_store> store;
+
+    physics_data &data_of(physics_id id)
+    {
+        physics_store &s{*store};
+        return s.physics_components[s.id_mapping[id::index(id)]];
+    }
 
     bool exists(physics_id id)
     {
+        physics_store &s{*store};
         assert(id::is_valid(id));
         const id::id_type index{id::index(id)};
-        assert(index < generations.size());
-        return (id::is_valid(id_mapping[index]) && generations[index] == id::generation(id) &&
-                physics_components[id_mapping[index]].is_valid);
+        assert(index < s.generations.size());
+        return (id::is_valid(s.id_mapping[index]) && s.generations[index] == id::generation(id) &&
+                s.physics_components[s.id_mapping[index]].is_valid);
     }
 
     btConvexHullShape* extract_shape(const lod_group& group)
@@ -41,30 +56,45 @@ namespace
 
         return shape;
     }
+
+    void destroy_body(btRigidBody *body)
+    {
+        delete body->getMotionState();
+        delete body->getCollisionShape();
+        delete body;
+    }
+
+    // Bodies carry their entity id in the user pointer (set in create)
+    void mark_changed(const physics_data &data)
+    {
+        const auto entity_id = (id::id_type)reinterpret_cast<uintptr_t>(data.body->getUserPointer());
+        changes::mark_changed(changes::component_type::physics, id::index(entity_id));
+    }
 } // namespace
 
 component create(init_info info, game_entity::entity entity)
 {
+    physics_store &s{*store};
     assert(entity.is_valid());
 
     physics_id id{};
 
-    if (free_ids.size() > id::min_deleted_elements)
+    if (s.free_ids.size() > id::min_deleted_elements)
     {
-        id = free_ids.front();
+        id = s.free_ids.front();
         assert(!exists(id));
-        free_ids.pop_front();
+        s.free_ids.pop_front();
         id = physics_id{id::new_generation(id)};
-        ++generations[id::index(id)];
+        ++s.generations[id::index(id)];
     }
     else
     {
-        id = physics_id{(id::id_type)id_mapping.size()};
-        id_mapping.emplace_back();
-        generations.push_back(0);
+        id = physics_id{(id::id_type)s.id_mapping.size()};
+        s.id_mapping.emplace_back();
+        s.generations.push_back(0);
     }
     assert(id::is_valid(id));
-    const id::id_type index{(id::id_type)physics_components.size()};
+    const id::id_type index{(id::id_type)s.physics_components.size()};
 
     // Bullet
     btTransform transform;
@@ -104,80 +134,66 @@ component create(init_info info, game_entity::entity entity)
                                       btCollisionObject::CF_KINEMATIC_OBJECT);
     }
 
-    physics_components.emplace_back(physics_data{
+    s.physics_components.emplace_back(physics_data{
         true,
         rigid_body,
         info.mass
     });
 
-    // Event Physics Object was created
-    PhysicObjectCreated event;
-    event.body = rigid_body;
-    PhysicEventBus::Get().Publish(event);
+    // Added to the world with the rest of the tick's bodies in dispatch_events
+    PhysicEventBus::Get().Publish(PhysicObjectCreated{rigid_body});
 
-    id_mapping[id::index(id)] = index;
+    s.id_mapping[id::index(id)] = index;
     return component{id};
 }
 
 void remove(component c)
 {
+    physics_store &s{*store};
     if (!c.is_valid() || !exists(c.get_id()))
         return;
 
     const physics_id id{c.get_id()};
-    const id::id_type index{id_mapping[id::index(id)]};
+    const id::id_type index{s.id_mapping[id::index(id)]};
 
     // Bullet Cleanup
-    auto& data = physics_components[index];
+    auto& data = s.physics_components[index];
     if (data.body)
     {
-        PhysicObjectRemoved event;
-        event.body = data.body;
-        PhysicEventBus::Get().Publish(event);
-
-        // Delete motion state
-        if (data.body->getMotionState())
-        {
-            delete data.body->getMotionState();
-        }
-
-        // Delete collision shape
-        if (data.body->getCollisionShape())
-        {
-            delete data.body->getCollisionShape();
-        }
-
-        delete data.body;
+        // The world may still hold the body, or a creation event may still point
+        // at it, until the bus is dispatched
+        PhysicEventBus::Get().Publish(PhysicObjectRemoved{data.body});
+        s.retired.push_back(data.body);
         data.body = nullptr;
     }
 
-    const id::id_type last_index{(id::id_type)physics_components.size() - 1};
+    const id::id_type last_index{(id::id_type)s.physics_components.size() - 1};
 
     if (index != last_index)
     {
-        physics_components[index] = std::move(physics_components[last_index]);
+        s.physics_components[index] = std::move(s.physics_components[last_index]);
         const auto moved_id =
-            std::find_if(id_mapping.begin(), id_mapping.end(),
+            std::find_if(s.id_mapping.begin(), s.id_mapping.end(),
                          [last_index](id::id_type mapping) { return mapping == last_index; });
-        if (moved_id != id_mapping.end())
+        if (moved_id != s.id_mapping.end())
         {
             *moved_id = index;
         }
     }
 
-    physics_components.pop_back();
-    id_mapping[id::index(id)] = id::invalid_id;
+    s.physics_components.pop_back();
+    s.id_mapping[id::index(id)] = id::invalid_id;
 
-    if (generations[id::index(id)] < id::max_generation)
+    if (s.generations[id::index(id)] < id::max_generation)
     {
-        free_ids.push_back(id);
+        s.free_ids.push_back(id);
     }
 }
 
 void component::apply_force(const math::v3& force, const math::v3& position)
 {
     assert(is_valid() && exists(_id));
-    auto& data = physics_components[id_mapping[id::index(_id)]];
+    auto& data = data_of(_id);
     if (data.body)
     {
         btVector3 btForce(force.x, force.y, force.z);
@@ -190,16 +206,18 @@ void component::apply_force(const math::v3& force, const math::v3& position)
             btVector3 btPos(position.x, position.y, position.z);
             data.body->applyForce(btForce, btPos);
         }
+        mark_changed(data);
     }
 }
 
 void component::apply_torque(const math::v3& torque)
 {
     assert(is_valid() && exists(_id));
-    auto& data = physics_components[id_mapping[id::index(_id)]];
+    auto& data = data_of(_id);
     if (data.body)
     {
         data.body->applyTorque(btVector3(torque.x, torque.y, torque.z));
+        mark_changed(data);
     }
 }
 
@@ -207,7 +225,7 @@ void component::get_state(math::v3& position, math::v4& orientation,
                       math::v3& velocity, math::v3& angular_velocity) const
 {
     assert(is_valid() && exists(_id));
-    auto& data = physics_components[id_mapping[id::index(_id)]];
+    auto& data = data_of(_id);
     if (data.body)
     {
         const btTransform& transform = data.body->getWorldTransform();
@@ -226,26 +244,42 @@ void component::get_state(math::v3& position, math::v4& orientation,
 btRigidBody* component::get_rigid_body() const
 {
     assert(is_valid() && exists(_id));
-    return physics_components[id_mapping[id::index(_id)]].body;
+    return data_of(_id).body;
+}
+
+void dispatch_events()
+{
+    PhysicEventBus::Get().Dispatch();
+
+    physics_store &s{*store};
+    for (btRigidBody *body : s.retired)
+        destroy_body(body);
+    s.retired.clear();
+}
+
+void publish_bodies()
+{
+    for (const auto &data : store->physics_components)
+    {
+        if (data.body)
+            PhysicEventBus::Get().Publish(PhysicObjectCreated{data.body});
+    }
 }
 
 void shutdown()
 {
-    for (auto& data : physics_components)
+    dispatch_events();
+
+    physics_store &s{*store};
+    for (auto& data : s.physics_components)
     {
         if (data.body)
-        {
-            if (data.body->getMotionState())
-                delete data.body->getMotionState();
-            if (data.body->getCollisionShape())
-                delete data.body->getCollisionShape();
-            delete data.body;
-        }
+            destroy_body(data.body);
     }
 
-    physics_components.clear();
-    id_mapping.clear();
-    generations.clear();
-    free_ids.clear();
+    s.physics_components.clear();
+    s.id_mapping.clear();
+    s.generations.clear();
+    s.free_ids.clear();
 }
 } // namespace lark::physics
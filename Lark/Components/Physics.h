@@ -36,5 +36,21 @@ component create(init_info info, game_entity::entity entity);
  */
 void remove(component t);
 
+/**
+ * @brief Delivers the physics events queued since the last call and frees removed bodies
+ *
+ * Created bodies join the active world here in one batch, removed ones leave it.
+ * Called once per tick before the Bullet step.
+ */
+void dispatch_events();
+
+/**
+ * @brief Queues a creation event for every live body
+ *
+ * Called when a world becomes active, so it adopts the bodies created before
+ * it through the next dispatch like any new body.
+ */
+void publish_bodies();
+
 void shutdown();
 } // namespace lark::physics
@@ -1,15 +1,81 @@
 #include "Script.h"
 #include "Entity.h"
+#include "ScriptBindings.h"
+#include "Core/Context.h"
+#include <pybind11/embed.h>
+#include <chrono>
+
+// Registered before the interpreter starts with the first script; scripts `import lark`
+PYBIND11_EMBEDDED_MODULE(lark, m)
+{
+    m.doc() = "Lark engine access for entity scripts";
+
+    // What Script classes are constructed with
+    pybind11::class_<lark::game_entity::entity>(m, "Entity")
+        .def_property_readonly("id",
+                               [](const lark::game_entity::entity &e) { return (u32)e.get_id(); })
+        .def("is_valid", &lark::game_entity::entity::is_valid);
+
+    lark::script::bind_component_views(m);
+}
 
 namespace lark::script
 {
 namespace
 {
-util::vector<detail::script_ptr> entity_scripts;
-util::vector<id::id_type> id_mapping;
+namespace py = pybind11;
+using clock = std::chrono::steady_clock;
+
+constexpr f32 timing_smoothing{0.1f};
+
+/**
+ * @struct script_group
+ * @brief Instances sharing one Python class, dispatched together
+ */
+struct script_group
+{
+    py::handle type;                        ///< Borrowed, the instances keep the class alive
+    py::object batch_update;                ///< Class-level update_batch, null if absent
+    py::list instances;                     ///< Passed to update_batch
+    util::vector<u32> entity_ids;           ///< Same order as instances
+    util::vector<entity_script *> scripts;
+    u32 cursor{0};                          ///< First instance of the next tick when over budget
+    f32 budget_ms{0.f};
+};
+
+struct script_store
+{
+    ~script_store()
+    {
+        // Groups hold Python references; without an interpreter they are leaked instead
+        if (Py_IsInitialized())
+        {
+            py::gil_scoped_acquire gil;
+            groups.clear();
+        }
+        else
+        {
+            for (auto &group : groups)
+            {
+                group.batch_update.release();
+                group.instances.release();
+            }
+        }
+    }
+
+    util::vector<detail::script_ptr> entity_scripts;
+    util::vector<id::id_type> id_mapping;
 
-util::vector<id::generation_type> generations;
-util::deque<script_id> free_ids;
+    util::vector<id::generation_type> generations;
+    util::deque<script_id> free_ids;
+
+    util::vector<script_group> groups;
+    util::vector<script_timing> group_timings;
+    std::unordered_map<std::string, f32> budgets;
+    bool groups_dirty{true};
+};
+
+context_local<script_store> store;
 
 using script_registry = std::unordered_map<size_t, detail::script_creator>;
 
@@ -22,17 +88,164 @@ script_registry &registry()
 
 bool exists(script_id id)
 {
+    script_store &s{*store};
     assert(id::is_valid(id));
     const id::id_type index{id::index(id)};
-    assert(index < generations.size() &&
-           !(id::is_valid(id_mapping[index]) && id_mapping[index] >= entity_scripts.size()));
-    assert(generations[index] == id::generation(id));
-    return (id::is_valid(id_mapping[index]) && generations[index] == id::generation(id)) &&
-           entity_scripts[id_mapping[index]] && entity_scripts[id_mapping[index]]->is_valid();
+    assert(index < s.generations.size() &&
+           !(id::is_valid(s.id_mapping[index]) && s.id_mapping[index] >= s.entity_scripts.size()));
+    assert(s.generations[index] == id::generation(id));
+    return (id::is_valid(s.id_mapping[index]) && s.generations[index] == id::generation(id)) &&
+           s.entity_scripts[s.id_mapping[index]] && s.entity_scripts[s.id_mapping[index]]->is_valid();
+}
+
+std::string type_name(py::handle type)
+{
+    return py::str(type.attr("__module__")).cast<std::string>() + "." +
+           py::str(type.attr("__qualname__")).cast<std::string>();
+}
+
+void rebuild_groups()
+{
+    script_store &s{*store};
+    s.groups.clear();
+    // Spawning or removing an instance must not reset the history of its class
+    util::vector<script_timing> previous{std::move(s.group_timings)};
+    s.group_timings.clear();
+
+    for (const auto &script : s.entity_scripts)
+    {
+        const py::object &instance{script->instance()};
+        if (!instance)
+            continue;
+
+        const py::handle type{py::type::handle_of(instance)};
+        auto group = std::find_if(s.groups.begin(), s.groups.end(),
+                                  [type](const script_group &g) { return g.type.is(type); });
+        if (group == s.groups.end())
+        {
+            script_group new_group{};
+            new_group.type = type;
+            if (py::hasattr(type, "update_batch"))
+                new_group.batch_update = type.attr("update_batch");
+
+            script_timing timing{};
+            std::string name{type_name(type)};
+            auto kept = std::find_if(previous.begin(), previous.end(),
+                                     [&name](const script_timing &t) { return t.name == name; });
+            if (kept != previous.end())
+                timing = std::move(*kept);
+            timing.name = std::move(name);
+            timing.batched = (bool)new_group.batch_update;
+            const auto budget = s.budgets.find(timing.name);
+            new_group.budget_ms = budget == s.budgets.end() ? 0.f : budget->second;
+
+            s.groups.emplace_back(std::move(new_group));
+            s.group_timings.emplace_back(std::move(timing));
+            group = s.groups.end() - 1;
+        }
+
+        if (!group->batch_update && !script->update_method())
+            continue;
+
+        group->instances.append(instance);
+        group->entity_ids.push_back((u32)script->get_id());
+        group->scripts.push_back(script.get());
+    }
+
+    for (u32 i{0}; i < s.groups.size(); ++i)
+        s.group_timings[i].entities = (u32)s.groups[i].scripts.size();
+
+    s.groups_dirty = false;
+}
+
+/**
+ * @brief Calls the bound update of the group's instances, resuming where the budget cut off
+ * @return Number of instances updated
+ */
+u32 update_instances(script_group &group, f32 dt, clock::time_point start)
+{
+    const u32 count{(u32)group.scripts.size()};
+    if (group.cursor >= count)
+        group.cursor = 0;
+
+    u32 updated{0};
+    while (updated < count)
+    {
+        group.scripts[group.cursor]->update(dt);
+        group.cursor = (group.cursor + 1) % count;
+        ++updated;
+
+        if (group.budget_ms > 0.f &&
+            std::chrono::duration<f32, std::milli>(clock::now() - start).count() > group.budget_ms)
+            break;
+    }
+    return updated;
 }
 
 } // namespace
 
+void tick(f32 dt)
+{
+    script_store &s{*store};
+    if (s.entity_scripts.empty() || !Py_IsInitialized())
+        return;
+
+    py::gil_scoped_acquire gil;
+
+    if (s.groups_dirty)
+        rebuild_groups();
+
+    for (u32 i{0}; i < s.groups.size(); ++i)
+    {
+        script_group &group{s.groups[i]};
+        script_timing &timing{s.group_timings[i]};
+        if (group.scripts.empty())
+            continue;
+
+        const auto start = clock::now();
+        if (group.batch_update)
+        {
+            try
+            {
+                const py::memoryview ids{py::memoryview::from_buffer(
+                    group.entity_ids.data(), {(py::ssize_t)group.entity_ids.size()},
+                    {(py::ssize_t)sizeof(u32)}, true)};
+                group.batch_update(dt, ids, group.instances);
+            }
+            catch (py::error_already_set &e)
+            {
+                e.discard_as_unraisable(timing.name.c_str());
+            }
+            timing.updated = (u32)group.scripts.size();
+        }
+        else
+        {
+            timing.updated = update_instances(group, dt, start);
+        }
+
+        const f32 elapsed_ms{std::chrono::duration<f32, std::milli>(clock::now() - start).count()};
+        timing.last_ms = elapsed_ms;
+        timing.average_ms = timing.average_ms == 0.f
+                                ? elapsed_ms
+                                : timing.average_ms + (elapsed_ms - timing.average_ms) * timing_smoothing;
+        if (group.budget_ms > 0.f && elapsed_ms > group.budget_ms)
+            ++timing.overruns;
+    }
+}
+
+void set_time_budget(const char *name, f32 milliseconds)
+{
+    script_store &s{*store};
+    assert(name && milliseconds >= 0.f);
+    if (milliseconds > 0.f)
+        s.budgets[name] = milliseconds;
+    else
+        s.budgets.erase(name);
+    s.groups_dirty = true;
+}
+
+const util::vector<script_timing> &timings() { return store->group_timings; }
+
 namespace detail
 {
 u8 register_script(size_t tag, script_creator func)
@@ -85,47 +298,59 @@ bool script_exists(size_t tag) { return lark::script::registry().find(tag) != re
 
 void shutdown()
 {
+    script_store &s{*store};
     // Clear all script data
-    entity_scripts.clear();
-    id_mapping.clear();
-    generations.clear();
-    free_ids.clear();
+    if (Py_IsInitialized())
+    {
+        py::gil_scoped_acquire gil;
+        s.groups.clear();
+    }
+    s.group_timings.clear();
+    s.budgets.clear();
+    s.groups_dirty = true;
+    s.entity_scripts.clear();
+    s.id_mapping.clear();
+    s.generations.clear();
+    s.free_ids.clear();
     registry().clear();
     detail::script_name().clear();
 }
 
 component create(init_info info, game_entity::entity entity)
 {
+    script_store &s{*store};
     assert(entity.is_valid());
     assert(info.script_creator);
     script_id id{};
 
-    if (free_ids.size() > id::min_deleted_elements)
+    if (s.free_ids.size() > id::min_deleted_elements)
     {
-        id = free_ids.front();
+        id = s.free_ids.front();
         assert(!exists(id));
-        free_ids.pop_front();
+        s.free_ids.pop_front();
         id = script_id{id::new_generation(id)};
-        ++generations[id::index(id)];
+        ++s.generations[id::index(id)];
     }
     else
     {
-        id = script_id{(id::id_type)id_mapping.size()};
-        id_mapping.emplace_back();
-        generations.push_back(0);
+        id = script_id{(id::id_type)s.id_mapping.size()};
+        s.id_mapping.emplace_back();
+        s.generations.push_back(0);
     }
 
     assert(id::is_valid(id));
-    const id::id_type index{(id::id_type)entity_scripts.size()};
-    entity_scripts.emplace_back(info.script_creator(entity));
-    assert(entity_scripts.back()->get_id() == entity.get_id());
-    id_mapping[id::index(id)] = index;
+    const id::id_type index{(id::id_type)s.entity_scripts.size()};
+    s.entity_scripts.emplace_back(info.script_creator(entity));
+    assert(s.entity_scripts.back()->get_id() == entity.get_id());
+    s.id_mapping[id::index(id)] = index;
+    s.groups_dirty = true;
 
     return component{id};
 }
 
 void remove(component c)
 {
+    script_store &s{*store};
     // Change the validation to be more defensive
     if (!c.is_valid())
         return;
@@ -133,16 +358,17 @@ void remove(component c)
         return;
 
     const script_id id{c.get_id()};
-    const id::id_type index{id_mapping[id::index(id)]};
-    const script_id last_id{entity_scripts.back()->script().get_id()};
-    util::erase_unordered(entity_scripts, index);
-    id_mapping[id::index(last_id)] = index;
-    id_mapping[id::index(id)] = id::invalid_id;
+    const id::id_type index{s.id_mapping[id::index(id)]};
+    const script_id last_id{s.entity_scripts.back()->script().get_id()};
+    util::erase_unordered(s.entity_scripts, index);
+    s.id_mapping[id::index(last_id)] = index;
+    s.id_mapping[id::index(id)] = id::invalid_id;
 
-    if (generations[index] < id::max_generation)
+    if (s.generations[index] < id::max_generation)
     {
-        free_ids.push_back(id);
+        s.free_ids.push_back(id);
     }
+    s.groups_dirty = true;
 }
 
 } // namespace lark::script
@@ -13,6 +13,24 @@
 namespace lark::script
 {
 
+/**
+ * @struct script_timing
+ * @brief Cost of one script type during the last tick
+ *
+ * Averages and overruns accumulate for as long as the class has instances;
+ * spawning or removing instances keeps them.
+ */
+struct script_timing
+{
+    std::string name;    ///< Python class as module.qualname
+    u32 entities{0};     ///< Instances of the class
+    u32 updated{0};      ///< Instances updated in the last tick
+    bool batched{false}; ///< Whether the class provides update_batch
+    f32 last_ms{0.f};
+    f32 average_ms{0.f};
+    u32 overruns{0};     ///< Ticks in which the class exceeded its budget
+};
+
 /**
  * @struct init_info
  * @brief Initialization information for creating a script component
@@ -46,6 +64,39 @@ component create(init_info info, game_entity::entity entity);
  */
 void remove(component t);
 
+/**
+ * @brief Runs the update of every script, one dispatch per Python class
+ * @param dt Variable timestep duration
+ *
+ * Instances are grouped by their Python class. A class that defines
+ * `update_batch(dt, entity_ids, instances)` as a classmethod or staticmethod
+ * is called once per tick with a read-only u32 memoryview of the entity ids
+ * (valid during the call only) and the list of its instances; the lark
+ * module views give it the matching component arrays. Other classes get
+ * their bound update method called per instance.
+ *
+ * Takes the GIL, so it may run on any thread as long as the caller does not
+ * hold it while waiting for that thread.
+ */
+void tick(f32 dt);
+
+/**
+ * @brief Limits the time one script type may take per tick
+ * @param name Python class as module.qualname
+ * @param milliseconds Budget, 0 removes it
+ *
+ * Per-instance updates stop once the budget is spent and continue with the
+ * remaining instances on the next tick. A batched update cannot be split and
+ * is only counted as an overrun.
+ */
+void set_time_budget(const char *name, f32 milliseconds);
+
+/**
+ * @brief Gets the cost of each script type
+ * @return One entry per Python class with live instances
+ */
+const util::vector<script_timing> &timings();
+
 /**
  * @brief Shuts down the entire script component system
  *
@@ -0,0 +1,249 @@
+#include "ScriptBindings.h"
+#include "ScriptExecution.h"
+#include "Sensors.h"
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+// Samples reach scripts as structured arrays, fields keep their C++ names
+PYBIND11_NUMPY_DTYPE(lark::sensors::imu_sample, entity, time, accel, gyro, accel_true);
+PYBIND11_NUMPY_DTYPE(lark::sensors::mocap_sample, entity, time, position, velocity, attitude,
+                     body_rates);
+
+namespace lark::script
+{
+namespace
+{
+namespace py = pybind11;
+
+/**
+ * @brief The tick's snapshot of a column as a read-only (count, width) array, worker mode only
+ *
+ * The array aliases the snapshot and keeps it alive, so a script can hold on
+ * to it; it shows the state of the tick it was taken in.
+ */
+py::array snapshot_array(view_column column, std::shared_ptr<const void> owner)
+{
+    const storage_view view{column_view(column)};
+    const py::dtype type{view.type == storage_view::float32 ? py::dtype::of<f32>()
+                                                            : py::dtype::of<u32>()};
+    const py::capsule base{new std::shared_ptr<const void>{std::move(owner)}, [](void *p) {
+                               delete static_cast<std::shared_ptr<const void> *>(p);
+                           }};
+    py::array values{type,
+                     {(py::ssize_t)view.count, (py::ssize_t)view.width},
+                     {(py::ssize_t)view.stride, (py::ssize_t)sizeof(u32)},
+                     view.data,
+                     base};
+    values.attr("setflags")(py::arg("write") = false);
+    return values;
+}
+
+/**
+ * @class component_view
+ * @brief Zero-copy access to one live column through the buffer protocol
+ *
+ * Every access, whether indexing, the buffer protocol or __array__, checks
+ * the layout generation the view was taken at and raises once components
+ * were created or removed, since the storage may have moved. Arrays built
+ * from the view alias the store directly and are not checked. Writable views
+ * flag the components as changed on every item assignment and when a with
+ * block around them ends, which covers writes through such arrays.
+ */
+class component_view
+{
+  public:
+    component_view(view_column column, bool writable)
+        : _column{column}, _captured{column_generation(column)}, _writable{writable}
+    {
+        if (writable && get_execution_mode() == execution_mode::worker_thread)
+            throw std::runtime_error{"scripts on the worker thread read a snapshot, use the "
+                                     "lark.set_* commands instead of writable views"};
+    }
+
+    bool valid() const { return _captured == column_generation(_column); }
+    void refresh() { _captured = column_generation(_column); }
+    bool writable() const { return _writable; }
+
+    py::buffer_info buffer() const
+    {
+        const storage_view view{checked_view()};
+        const bool is_float{view.type == storage_view::float32};
+        return py::buffer_info{view.data,
+                               (py::ssize_t)sizeof(u32),
+                               is_float ? py::format_descriptor<f32>::format()
+                                        : py::format_descriptor<u32>::format(),
+                               2,
+                               {(py::ssize_t)view.count, (py::ssize_t)view.width},
+                               {(py::ssize_t)view.stride, (py::ssize_t)sizeof(u32)},
+                               !_writable};
+    }
+
+    /**
+     * @brief The column as an array aliasing the store, the view stays its base
+     */
+    static py::array array(const py::object &self)
+    {
+        const component_view &v{self.cast<const component_view &>()};
+        const storage_view view{v.checked_view()};
+        const py::dtype type{view.type == storage_view::float32 ? py::dtype::of<f32>()
+                                                                : py::dtype::of<u32>()};
+        py::array values{type,
+                         {(py::ssize_t)view.count, (py::ssize_t)view.width},
+                         {(py::ssize_t)view.stride, (py::ssize_t)sizeof(u32)},
+                         view.data,
+                         self};
+        if (!v._writable)
+            values.attr("setflags")(py::arg("write") = false);
+        return values;
+    }
+
+    static py::object get_item(const py::object &self, const py::object &key)
+    {
+        return array(self)[key];
+    }
+
+    static void set_item(const py::object &self, const py::object &key, const py::object &value)
+    {
+        component_view &v{self.cast<component_view &>()};
+        if (!v._writable)
+            throw std::runtime_error{"component view is read-only, pass writable=True"};
+        array(self)[key] = value;
+        v.mark_changed();
+    }
+
+    py::ssize_t length() const { return (py::ssize_t)checked_view().count; }
+
+    py::tuple shape() const
+    {
+        const storage_view view{checked_view()};
+        return py::make_tuple(view.count, view.width);
+    }
+
+    static py::object enter(const py::object &self)
+    {
+        self.cast<const component_view &>().checked_view();
+        return self;
+    }
+
+    void exit(const py::object &exception_type, const py::object &, const py::object &)
+    {
+        if (!_writable || !exception_type.is_none())
+            return;
+        checked_view();
+        mark_changed();
+    }
+
+  private:
+    storage_view checked_view() const
+    {
+        if (!valid())
+            throw std::runtime_error{"component view is stale, components were created or "
+                                     "removed since it was taken; call refresh()"};
+        return column_view(_column);
+    }
+
+    void mark_changed() const
+    {
+        if (column_view(_column).count)
+            mark_column_changed(_column);
+    }
+
+    view_column _column;
+    u64 _captured;
+    bool _writable;
+};
+
+void def_view(py::module_ &m, const char *name, view_column column)
+{
+    m.def(
+        name,
+        [column](bool writable) -> py::object {
+            if (!writable)
+            {
+                if (std::shared_ptr<const void> owner{column_owner(column)})
+                    return snapshot_array(column, std::move(owner));
+            }
+            return py::cast(component_view{column, writable});
+        },
+        py::arg("writable") = false,
+        "Returns a view of the live column, or of the tick's snapshot on the worker thread; "
+        "writable=True allows item assignment");
+}
+
+template <size_t N> void def_command(py::module_ &m, const char *name, command_type type)
+{
+    m.def(
+        name,
+        [type](u32 entity, std::array<f32, N> values) {
+            command cmd{type, entity};
+            std::copy(values.begin(), values.end(), cmd.values);
+            queue_command(cmd);
+        },
+        py::arg("entity"), py::arg("values"));
+}
+
+template <typename Sample>
+void def_sensor(py::module_ &m, const char *name, u64 (*written)(),
+                u32 (*read)(u64 &, Sample *, u32))
+{
+    m.def(
+        name,
+        [written, read](u64 cursor) {
+            const u64 total{written()};
+            const u32 available{(u32)std::min<u64>(total - std::min(cursor, total),
+                                                   sensors::get_config().history)};
+            py::array_t<Sample> samples{(py::ssize_t)available};
+            const u32 count{read(cursor, samples.mutable_data(), available)};
+            assert(count == available);
+            (void)count;
+            return py::make_tuple(samples, cursor);
+        },
+        py::arg("cursor") = 0u,
+        "Returns (samples, next_cursor) with every sample written since cursor");
+}
+} // namespace
+
+void bind_component_views(py::module_ &m)
+{
+    py::class_<component_view>(m, "ComponentView", py::buffer_protocol())
+        .def_buffer(&component_view::buffer)
+        .def("__array__", [](const py::object &self, const py::args &,
+                             const py::kwargs &) { return component_view::array(self); })
+        .def("__getitem__", &component_view::get_item)
+        .def("__setitem__", &component_view::set_item)
+        .def("__len__", &component_view::length)
+        .def_property_readonly("shape", &component_view::shape)
+        .def("__enter__", &component_view::enter)
+        .def("__exit__", &component_view::exit)
+        .def_property_readonly("valid", &component_view::valid)
+        .def_property_readonly("writable", &component_view::writable)
+        .def("refresh", &component_view::refresh,
+             "Accepts the current layout, later accesses see the moved storage");
+
+    def_view(m, "transform_positions", view_column::transform_positions);
+    def_view(m, "transform_rotations", view_column::transform_rotations);
+    def_view(m, "transform_scales", view_column::transform_scales);
+    def_view(m, "drone_positions", view_column::drone_positions);
+    def_view(m, "drone_velocities", view_column::drone_velocities);
+    def_view(m, "drone_attitudes", view_column::drone_attitudes);
+    def_view(m, "drone_body_rates", view_column::drone_body_rates);
+    def_view(m, "drone_rotor_speeds", view_column::drone_rotor_speeds);
+    m.def("drone_entities", [] {
+        if (std::shared_ptr<const void> owner{column_owner(view_column::drone_entities)})
+            return py::object{snapshot_array(view_column::drone_entities, std::move(owner))};
+        return py::cast(component_view{view_column::drone_entities, false});
+    });
+
+    // Applied at the start of the next tick in both execution modes
+    def_command<3>(m, "set_position", command_type::set_position);
+    def_command<4>(m, "set_rotation", command_type::set_rotation);
+    def_command<3>(m, "set_drone_position", command_type::set_drone_position);
+    def_command<3>(m, "set_drone_velocity", command_type::set_drone_velocity);
+
+    def_sensor(m, "read_imu", &sensors::imu_written, &sensors::read_imu);
+    def_sensor(m, "read_mocap", &sensors::mocap_written, &sensors::read_mocap);
+}
+} // namespace lark::script
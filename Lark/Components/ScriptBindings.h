@@ -0,0 +1,23 @@
+/**
+ * @file ScriptBindings.h
+ * @brief Engine functions exposed to Python scripts through the embedded "lark" module
+ */
+
+#pragma once
+#include <pybind11/pybind11.h>
+
+namespace lark::script
+{
+/**
+ * @brief Adds NumPy access to the transform and drone arrays and the command functions
+ *
+ * In inline mode each function returns a ComponentView: a (count, width)
+ * buffer over the live store, without copies. Accessing a view after
+ * components were created or removed raises until refresh() is called. With
+ * writable=True items can be assigned, and a with block around the view
+ * flags the components as changed at its end. In worker mode they return a
+ * read-only array of the tick's snapshot, and writable views raise. The
+ * set_* commands queue changes for the next tick, see ScriptExecution.h.
+ */
+void bind_component_views(pybind11::module_ &m);
+} // namespace lark::script
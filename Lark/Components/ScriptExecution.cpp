@@ -0,0 +1,326 @@
+#include "ScriptExecution.h"
+#include "Drone.h"
+#include "Entity.h"
+#include "Script.h"
+#include "Transform.h"
+#include "Core/Context.h"
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace lark::script
+{
+namespace
+{
+constexpr u32 column_count{(u32)view_column::count};
+
+/**
+ * @struct snapshot_column
+ * @brief Dense copy of one column, every scalar stored as a 32-bit word
+ *
+ * Arrays handed to scripts share the buffer. A tick whose previous buffer is
+ * still shared captures into a new one, so those arrays never see it move.
+ */
+struct snapshot_column
+{
+    std::shared_ptr<util::vector<u32>> words;
+    storage_view view;
+};
+
+/**
+ * @class script_worker
+ * @brief Thread that runs one script tick per begin_frame, in the context that created it
+ */
+class script_worker
+{
+  public:
+    script_worker() : _owner{context::current()}, _thread{[this] { run(); }} {}
+
+    ~script_worker()
+    {
+        {
+            std::lock_guard lock{_mutex};
+            _stop = true;
+        }
+        _wake.notify_one();
+        _thread.join();
+    }
+
+    void start(f32 dt)
+    {
+        {
+            std::lock_guard lock{_mutex};
+            assert(!_busy);
+            _dt = dt;
+            _busy = true;
+        }
+        _wake.notify_one();
+    }
+
+    void wait()
+    {
+        std::unique_lock lock{_mutex};
+        _done.wait(lock, [this] { return !_busy; });
+    }
+
+  private:
+    void run()
+    {
+        context_scope scope{_owner};
+        std::unique_lock lock{_mutex};
+        while (true)
+        {
+            _wake.wait(lock, [this] { return _busy || _stop; });
+            if (_stop)
+                return;
+
+            const f32 dt{_dt};
+            lock.unlock();
+            tick(dt);
+            lock.lock();
+
+            _busy = false;
+            _done.notify_all();
+        }
+    }
+
+    context &_owner;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    f32 _dt{0.f};
+    bool _busy{false};
+    bool _stop{false};
+    std::thread _thread; ///< Declared last, it starts running in the constructor
+};
+
+struct execution_store
+{
+    execution_mode mode{execution_mode::inline_tick};
+    std::unique_ptr<script_worker> worker;
+
+    snapshot_column snapshot[column_count];
+    u64 snapshot_generation{0};
+
+    std::mutex command_mutex;
+    util::vector<command> pending_commands;
+    util::vector<command> applied_list; ///< Swapped with the pending list at the sync point
+    u64 column_writes{0};
+};
+
+context_local<execution_store> store;
+
+storage_view live_view(view_column column)
+{
+    switch (column)
+    {
+    case view_column::transform_positions:
+        return transform::positions_view();
+    case view_column::transform_rotations:
+        return transform::rotations_view();
+    case view_column::transform_scales:
+        return transform::scales_view();
+    case view_column::drone_positions:
+        return drone::state_view(drone::state_field::position);
+    case view_column::drone_velocities:
+        return drone::state_view(drone::state_field::velocity);
+    case view_column::drone_attitudes:
+        return drone::state_view(drone::state_field::attitude);
+    case view_column::drone_body_rates:
+        return drone::state_view(drone::state_field::body_rates);
+    case view_column::drone_rotor_speeds:
+        return drone::state_view(drone::state_field::rotor_speeds);
+    case view_column::drone_entities:
+        return drone::entities_view();
+    case view_column::count:
+        break;
+    }
+    assert(false);
+    return {};
+}
+
+bool is_drone_column(view_column column) { return column >= view_column::drone_positions; }
+
+void capture_snapshot()
+{
+    execution_store &s{*store};
+    ++s.snapshot_generation;
+    for (u32 c{0}; c < column_count; ++c)
+    {
+        const storage_view source{live_view((view_column)c)};
+        snapshot_column &column{s.snapshot[c]};
+
+        // The worker is idle, so nothing can start sharing the buffer after this check
+        if (!column.words || column.words.use_count() > 1)
+            column.words = std::make_shared<util::vector<u32>>();
+
+        const u32 row_bytes{source.width * (u32)sizeof(u32)};
+        column.words->resize((size_t)source.count * source.width);
+        const auto *from = static_cast<const u8 *>(source.data);
+        auto *to = reinterpret_cast<u8 *>(column.words->data());
+
+        if (source.stride == row_bytes)
+        {
+            if (source.count)
+                std::memcpy(to, from, (size_t)source.count * row_bytes);
+        }
+        else
+        {
+            for (u32 row{0}; row < source.count; ++row)
+                std::memcpy(to + (size_t)row * row_bytes, from + (size_t)row * source.stride,
+                            row_bytes);
+        }
+
+        column.view = source;
+        column.view.data = column.words->data();
+        column.view.stride = row_bytes;
+        column.view.generation = s.snapshot_generation;
+    }
+}
+
+math::v3 to_v3(const f32 *values) { return {values[0], values[1], values[2]}; }
+
+void apply(const command &cmd)
+{
+    const game_entity::entity_id id{cmd.entity};
+    if (!id::is_valid(id) || !game_entity::is_alive(id))
+        return;
+
+    const game_entity::entity entity{id};
+    switch (cmd.type)
+    {
+    case command_type::set_position:
+        if (auto t = entity.transform(); t.is_valid())
+            t.set_position(to_v3(cmd.values));
+        break;
+    case command_type::set_rotation:
+        if (auto t = entity.transform(); t.is_valid())
+            t.set_rotation({cmd.values[0], cmd.values[1], cmd.values[2], cmd.values[3]});
+        break;
+    case command_type::set_drone_position:
+    case command_type::set_drone_velocity:
+        if (auto d = entity.drone(); d.is_valid())
+        {
+            drone::DroneState state{d.get_state()};
+            auto &target = cmd.type == command_type::set_drone_position ? state.position
+                                                                        : state.velocity;
+            target = {cmd.values[0], cmd.values[1], cmd.values[2]};
+            d.set_state(state);
+        }
+        break;
+    }
+}
+
+void apply_commands()
+{
+    execution_store &s{*store};
+    s.applied_list.clear();
+    {
+        std::lock_guard lock{s.command_mutex};
+        std::swap(s.pending_commands, s.applied_list);
+    }
+
+    for (const command &cmd : s.applied_list)
+        apply(cmd);
+}
+} // namespace
+
+void set_execution_mode(execution_mode new_mode)
+{
+    execution_store &s{*store};
+    if (new_mode == s.mode)
+        return;
+
+    s.mode = new_mode;
+    s.worker = s.mode == execution_mode::worker_thread ? std::make_unique<script_worker>() : nullptr;
+}
+
+execution_mode get_execution_mode() { return store->mode; }
+
+storage_view column_view(view_column column)
+{
+    assert(column < view_column::count);
+    const execution_store &s{*store};
+    return s.mode == execution_mode::worker_thread ? s.snapshot[(u32)column].view
+                                                 : live_view(column);
+}
+
+std::shared_ptr<const void> column_owner(view_column column)
+{
+    assert(column < view_column::count);
+    const execution_store &s{*store};
+    if (s.mode != execution_mode::worker_thread)
+        return {};
+    return s.snapshot[(u32)column].words;
+}
+
+u64 column_generation(view_column column)
+{
+    assert(column < view_column::count);
+    const execution_store &s{*store};
+    if (s.mode == execution_mode::worker_thread)
+        return s.snapshot_generation;
+    return is_drone_column(column) ? drone::layout_generation() : transform::layout_generation();
+}
+
+void mark_column_changed(view_column column)
+{
+    assert(store->mode != execution_mode::worker_thread);
+    ++store->column_writes;
+    if (is_drone_column(column))
+        drone::mark_all_changed();
+    else
+        transform::mark_all_changed();
+}
+
+u64 column_write_count() { return store->column_writes; }
+
+void queue_command(const command &cmd)
+{
+    execution_store &s{*store};
+    std::lock_guard lock{s.command_mutex};
+    s.pending_commands.push_back(cmd);
+}
+
+void discard_commands()
+{
+    execution_store &s{*store};
+    std::lock_guard lock{s.command_mutex};
+    s.pending_commands.clear();
+}
+
+void begin_frame(f32 dt)
+{
+    apply_commands();
+
+    execution_store &s{*store};
+    if (s.mode == execution_mode::worker_thread)
+    {
+        capture_snapshot();
+        s.worker->start(dt);
+    }
+}
+
+const util::vector<command> &applied_commands() { return store->applied_list; }
+
+void end_frame()
+{
+    if (script_worker *worker{store->worker.get()})
+        worker->wait();
+}
+
+void shutdown_execution()
+{
+    execution_store &s{*store};
+    s.worker.reset();
+    s.mode = execution_mode::inline_tick;
+
+    std::lock_guard lock{s.command_mutex};
+    s.pending_commands.clear();
+    s.applied_list.clear();
+    for (auto &column : s.snapshot)
+        column = {};
+}
+
+} // namespace lark::script
@@ -0,0 +1,138 @@
+/**
+ * @file ScriptExecution.h
+ * @brief Where and when entity scripts run relative to the simulation systems
+ *
+ * In inline mode the scripts system of the scheduler runs the scripts with
+ * the rest of the tick. In worker mode a dedicated thread runs them while the
+ * C++ systems advance the same tick: scripts read a snapshot of the component
+ * state taken at the start of the tick and cannot write engine memory
+ * directly. Both modes hand changes back as commands, which are applied at
+ * the start of the next tick, so scripts act with one frame of latency.
+ */
+
+#pragma once
+#include "ComponentCommon.h"
+
+namespace lark::script
+{
+
+enum class execution_mode : u8
+{
+    inline_tick,   ///< Scripts run as a scheduler system
+    worker_thread, ///< Scripts run on their own thread against a snapshot
+    disabled       ///< Scripts do not run, e.g. while a recording replays their commands
+};
+
+/**
+ * @enum view_column
+ * @brief Component arrays exposed to scripts
+ */
+enum class view_column : u8
+{
+    transform_positions,
+    transform_rotations,
+    transform_scales,
+    drone_positions,
+    drone_velocities,
+    drone_attitudes,
+    drone_body_rates,
+    drone_rotor_speeds,
+    drone_entities,
+
+    count
+};
+
+/**
+ * @enum command_type
+ * @brief Changes a script can request
+ */
+enum class command_type : u8
+{
+    set_position,       ///< Transform position, values[0..2]
+    set_rotation,       ///< Transform rotation quaternion xyzw, values[0..3]
+    set_drone_position, ///< Drone state position, values[0..2]
+    set_drone_velocity  ///< Drone state velocity, values[0..2]
+};
+
+struct command
+{
+    command_type type;
+    id::id_type entity{id::invalid_id};
+    f32 values[4]{};
+};
+
+/**
+ * @brief Switches the execution mode, only between ticks
+ */
+void set_execution_mode(execution_mode mode);
+execution_mode get_execution_mode();
+
+/**
+ * @brief Current view of a column: the live store in inline mode, the snapshot in worker mode
+ */
+storage_view column_view(view_column column);
+
+/**
+ * @brief Keeps the memory of a column_view alive, only set in worker mode
+ *
+ * While a reference is held the snapshot buffer is neither reused nor freed,
+ * later ticks capture into a new one. Live stores in inline mode have no
+ * owner, their views move when components are created or removed.
+ */
+std::shared_ptr<const void> column_owner(view_column column);
+
+/**
+ * @brief Generation a view of the column has to match to still be valid
+ *
+ * The snapshot is refilled every tick, so worker mode views last one tick.
+ */
+u64 column_generation(view_column column);
+
+/**
+ * @brief Flags the components behind a column as changed, for writes made through a view
+ */
+void mark_column_changed(view_column column);
+
+/**
+ * @brief Number of mark_column_changed calls so far, lets a recorder notice writes through views
+ */
+u64 column_write_count();
+
+/**
+ * @brief Queues a command for the next sync point, callable from any thread
+ */
+void queue_command(const command &cmd);
+
+/**
+ * @brief Drops the commands queued since the last sync point, e.g. before restoring a snapshot
+ */
+void discard_commands();
+
+/**
+ * @brief Sync point at the start of a tick
+ *
+ * Applies the commands queued during the previous tick. In worker mode it
+ * then captures the snapshot and wakes the script thread, which must not
+ * touch the live stores until end_frame returned.
+ */
+void begin_frame(f32 dt);
+
+/**
+ * @brief Commands applied by the last begin_frame, in the order they were queued
+ */
+const util::vector<command> &applied_commands();
+
+/**
+ * @brief Waits for the script thread to finish the tick, no-op in inline mode
+ *
+ * Called before the tick ends so that entities can be created and removed
+ * between ticks without racing the scripts.
+ */
+void end_frame();
+
+/**
+ * @brief Stops the script thread and drops pending commands
+ */
+void shutdown_execution();
+
+} // namespace lark::script
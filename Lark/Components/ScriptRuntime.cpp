@@ -0,0 +1,261 @@
+#include "ScriptRuntime.h"
+#include <pybind11/embed.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace lark::script::runtime
+{
+namespace
+{
+namespace py = pybind11;
+
+/**
+ * @struct module_entry
+ * @brief Cached import of one script module
+ */
+struct module_entry
+{
+    py::object module;
+    py::object script_class; ///< Null if the module defines no Script
+    bool stale{false};       ///< Reload on next use
+};
+
+std::unordered_map<std::string, module_entry> modules;
+std::mutex startup_mutex;
+std::condition_variable state_changed;
+std::thread interpreter_thread;
+std::atomic<bool> ready{false};
+bool initialized{false};
+bool stop_requested{false};
+bool host_reference{false};
+u32 references{0};
+
+/**
+ * @brief Imports or reloads a module, requires the GIL
+ */
+module_entry &load(const std::string &module_name)
+{
+    auto entry = modules.find(module_name);
+    if (entry != modules.end() && !entry->second.stale)
+        return entry->second;
+
+    module_entry loaded{};
+    try
+    {
+        // A module that failed to import has nothing to reload and is imported again
+        if (entry != modules.end() && entry->second.module)
+            loaded.module = py::module_::import("importlib").attr("reload")(entry->second.module);
+        else
+            loaded.module = py::module_::import(module_name.c_str());
+
+        if (py::hasattr(loaded.module, "Script"))
+            loaded.script_class = loaded.module.attr("Script");
+    }
+    catch (py::error_already_set &e)
+    {
+        e.discard_as_unraisable(module_name.c_str());
+    }
+
+    return modules[module_name] = std::move(loaded);
+}
+
+/**
+ * @brief Adds missing search paths and imports the preloaded modules, requires the GIL
+ */
+void apply(const runtime_config &config)
+{
+    try
+    {
+        auto sys_path = py::module_::import("sys").attr("path");
+        // Inserted back to front, so the first path ends up first
+        for (size_t i{config.search_paths.size()}; i > 0; --i)
+        {
+            const std::string &path{config.search_paths[i - 1]};
+            if (!sys_path.attr("__contains__")(path).cast<bool>())
+                sys_path.attr("insert")(0, path);
+        }
+    }
+    catch (py::error_already_set &e)
+    {
+        e.discard_as_unraisable("lark script runtime startup");
+    }
+
+    for (const auto &name : config.preload)
+        load(name);
+}
+
+/**
+ * @brief Body of the thread that owns the interpreter from initialization to finalization
+ *
+ * Python expects the thread that initialized it to finalize it, so shutdown
+ * hands finalization back to this thread instead of doing it itself.
+ */
+void run_interpreter(const runtime_config &config)
+{
+    py::initialize_interpreter();
+    {
+        try
+        {
+            // Registers the Entity type before the first spawn instead of during it
+            py::module_::import("lark");
+        }
+        catch (py::error_already_set &e)
+        {
+            e.discard_as_unraisable("lark script runtime startup");
+        }
+        apply(config);
+    }
+
+    // From here on every caller takes the GIL, whichever thread it runs on
+    PyThreadState *const owner{PyEval_SaveThread()};
+    {
+        std::unique_lock lock{startup_mutex};
+        ready.store(true, std::memory_order_release);
+        state_changed.notify_all();
+        state_changed.wait(lock, [] { return stop_requested; });
+    }
+
+    PyEval_RestoreThread(owner);
+    modules.clear();
+    py::finalize_interpreter();
+}
+
+/**
+ * @brief Starts the interpreter, or applies the config to the running one
+ *
+ * Called with the lifetime lock held by a caller that took a reference, which
+ * keeps the interpreter alive while the lock is dropped for the GIL.
+ */
+void start(const runtime_config &config, std::unique_lock<std::mutex> &lock)
+{
+    if (!initialized)
+    {
+        initialized = true;
+        stop_requested = false;
+        interpreter_thread = std::thread{[config] { run_interpreter(config); }};
+        if (!config.background)
+            state_changed.wait(lock, [] { return ready.load(std::memory_order_acquire); });
+        return;
+    }
+
+    if (config.search_paths.empty() && config.preload.empty())
+        return;
+
+    // A later user's paths and modules are added to the running interpreter
+    state_changed.wait(lock, [] { return ready.load(std::memory_order_acquire); });
+    lock.unlock();
+    {
+        py::gil_scoped_acquire gil;
+        apply(config);
+    }
+    lock.lock();
+}
+
+/**
+ * @brief Finalizes the interpreter once neither the host nor a user holds it
+ */
+void stop_if_unused(std::unique_lock<std::mutex> &lock)
+{
+    if (!initialized || host_reference || references)
+        return;
+
+    // A background startup finishes before the interpreter can be torn down
+    state_changed.wait(lock, [] { return ready.load(std::memory_order_acquire); });
+    stop_requested = true;
+    state_changed.notify_all();
+
+    // The interpreter thread takes the lock on its way out
+    lock.unlock();
+    interpreter_thread.join();
+    lock.lock();
+
+    ready.store(false, std::memory_order_release);
+    initialized = false;
+    state_changed.notify_all();
+}
+
+/**
+ * @brief Waits for a stop in progress, so a new reference starts a fresh interpreter
+ */
+void wait_for_stop(std::unique_lock<std::mutex> &lock)
+{
+    state_changed.wait(lock, [] { return !initialized || !stop_requested; });
+}
+} // namespace
+
+bool initialize(const runtime_config &config)
+{
+    std::unique_lock lock{startup_mutex};
+    wait_for_stop(lock);
+    const bool started{!initialized};
+    host_reference = true;
+    start(config, lock);
+    return started;
+}
+
+void acquire(const runtime_config &config)
+{
+    std::unique_lock lock{startup_mutex};
+    wait_for_stop(lock);
+    ++references;
+    start(config, lock);
+}
+
+void release()
+{
+    std::unique_lock lock{startup_mutex};
+    assert(references);
+    if (references)
+        --references;
+    stop_if_unused(lock);
+}
+
+void wait_until_ready()
+{
+    if (ready.load(std::memory_order_acquire))
+        return;
+
+    std::unique_lock lock{startup_mutex};
+    wait_for_stop(lock);
+    if (!initialized)
+    {
+        // Nobody started the runtime, the host owns it from now on
+        host_reference = true;
+        start({}, lock);
+    }
+    state_changed.wait(lock, [] { return ready.load(std::memory_order_acquire); });
+}
+
+bool is_ready() { return ready.load(std::memory_order_acquire); }
+
+py::object script_class(const std::string &module_name)
+{
+    assert(is_ready() && PyGILState_Check());
+    return load(module_name).script_class;
+}
+
+void invalidate(const std::string &module_name)
+{
+    assert(PyGILState_Check());
+    auto entry = modules.find(module_name);
+    if (entry != modules.end())
+        entry->second.stale = true;
+}
+
+void invalidate_all()
+{
+    assert(PyGILState_Check());
+    for (auto &entry : modules)
+        entry.second.stale = true;
+}
+
+void shutdown()
+{
+    std::unique_lock lock{startup_mutex};
+    host_reference = false;
+    stop_if_unused(lock);
+}
+
+} // namespace lark::script::runtime
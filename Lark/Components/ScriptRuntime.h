@@ -0,0 +1,101 @@
+/**
+ * @file ScriptRuntime.h
+ * @brief Owner of the embedded Python interpreter and the script module cache
+ *
+ * The interpreter is started once at engine start instead of by the first
+ * script that gets created, so spawning entities never pays for interpreter
+ * startup. Script modules are imported once per name and their Script class
+ * is cached; invalidate() drops a module so the next spawn reloads it.
+ *
+ * The interpreter is initialized and finalized on a thread of its own, which
+ * sleeps in between, so shutdown works from any thread. Like the job system it
+ * is held by the host through initialize()/shutdown() and by game loops through
+ * acquire()/release(), and runs until the last of them let go.
+ */
+
+#pragma once
+#include "../Common/CommonHeaders.h"
+#include <pybind11/pybind11.h>
+
+namespace lark::script::runtime
+{
+
+/**
+ * @struct runtime_config
+ * @brief Startup options of the interpreter
+ */
+struct runtime_config
+{
+    util::vector<std::string> search_paths; ///< Prepended to sys.path, e.g. the scripts folder
+    util::vector<std::string> preload;      ///< Script modules imported during startup
+    bool background{false};                 ///< initialize returns before startup finished
+};
+
+/**
+ * @brief Takes the host reference, starting the interpreter if nobody runs it yet
+ * @return false if the runtime was already running
+ *
+ * The GIL is released once startup finished, so every thread that calls into
+ * Python has to take it, including the one that called initialize. If the
+ * runtime already runs, the search paths it lacks are added and the preloaded
+ * modules imported, so no caller's config is dropped.
+ */
+bool initialize(const runtime_config &config = {});
+
+/**
+ * @brief Takes a reference on the runtime, starting it if nobody runs it yet
+ *
+ * For users that share the interpreter, e.g. one game loop per context. The
+ * config is applied as in initialize().
+ */
+void acquire(const runtime_config &config = {});
+
+/**
+ * @brief Drops a reference taken by acquire(), see shutdown() for what finalization needs
+ */
+void release();
+
+/**
+ * @brief Blocks until a background startup finished, starts the runtime if nobody did
+ *
+ * A runtime started here is held by the host until shutdown().
+ */
+void wait_until_ready();
+
+/**
+ * @brief Whether the interpreter finished starting up
+ */
+bool is_ready();
+
+/**
+ * @brief Gets the Script class of a module, importing the module on first use
+ * @param module_name Python module name
+ * @return The class, or a null object if the module has none or failed to import
+ *
+ * Import errors are reported through sys.unraisablehook. A failed import is
+ * retried only after the module was invalidated. Must be called with the GIL held.
+ */
+pybind11::object script_class(const std::string &module_name);
+
+/**
+ * @brief Drops a cached module, the next script_class call reloads it from disk
+ *
+ * Existing instances keep running the old code until they are recreated.
+ */
+void invalidate(const std::string &module_name);
+
+/**
+ * @brief Drops every cached module
+ */
+void invalidate_all();
+
+/**
+ * @brief Drops the host reference, finalizing the interpreter if no acquire() holds it
+ *
+ * Finalization clears the cache and runs on the thread that initialized the
+ * interpreter. All Python objects held by the engine have to be released
+ * before, and the calling thread must not hold the GIL.
+ */
+void shutdown();
+
+} // namespace lark::script::runtime
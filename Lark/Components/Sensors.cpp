@@ -0,0 +1,423 @@
+#include "Sensors.h"
+#include "Drone.h"
+#include "Core/Context.h"
+#include "Core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+namespace lark::sensors
+{
+namespace
+{
+using drone::Vector3f;
+
+constexpr f32 gravity{9.81f};
+
+/**
+ * @class sample_ring
+ * @brief Fixed number of samples addressed by a running sequence number
+ *
+ * Written by the sensor update, read from any thread between or during ticks.
+ */
+template <typename T> class sample_ring
+{
+  public:
+    void reset(u32 capacity)
+    {
+        std::lock_guard lock{_mutex};
+        _slots.resize(capacity);
+        _written = 0;
+    }
+
+    void push(const T *samples, u32 count)
+    {
+        std::lock_guard lock{_mutex};
+        const u32 size{(u32)_slots.size()};
+        if (count > size)
+        {
+            // Only the newest samples survive
+            _written += count - size;
+            samples += count - size;
+            count = size;
+        }
+
+        const u32 start{size ? (u32)(_written % size) : 0};
+        const u32 first{std::min(count, size - start)};
+        std::memcpy(_slots.data() + start, samples, first * sizeof(T));
+        std::memcpy(_slots.data(), samples + first, (count - first) * sizeof(T));
+        _written += count;
+    }
+
+    u32 read(u64 &cursor, T *out, u32 capacity) const
+    {
+        std::lock_guard lock{_mutex};
+        const u32 size{(u32)_slots.size()};
+        const u64 oldest{_written > size ? _written - size : 0};
+        cursor = std::clamp(cursor, oldest, _written);
+
+        const u32 count{(u32)std::min<u64>(_written - cursor, capacity)};
+        if (count == 0)
+            return 0;
+
+        const u32 start{(u32)(cursor % size)};
+        const u32 first{std::min(count, size - start)};
+        std::memcpy(out, _slots.data() + start, first * sizeof(T));
+        std::memcpy(out + first, _slots.data(), (count - first) * sizeof(T));
+        cursor += count;
+        return count;
+    }
+
+    u64 written() const
+    {
+        std::lock_guard lock{_mutex};
+        return _written;
+    }
+
+    /**
+     * @brief Continues the sequence at a restored position, the slots keep their samples
+     */
+    void set_written(u64 written)
+    {
+        std::lock_guard lock{_mutex};
+        _written = written;
+    }
+
+  private:
+    util::vector<T> _slots;
+    u64 _written{0};
+    mutable std::mutex _mutex;
+};
+
+/**
+ * @struct drone_sensors
+ * @brief Sensor state of one drone, kept by entity index
+ */
+struct drone_sensors
+{
+    id::id_type entity{id::invalid_id};
+    Vector3f velocity;   ///< At the end of the previous tick, for differentiation
+    Vector3f body_rates;
+    Vector3f accel_bias;
+    Vector3f gyro_bias;
+    random::engine noise;
+    f64 imu_time{-1.0}; ///< Of the last IMU sample, negative before the first
+};
+
+struct sensor_store
+{
+    sensor_store()
+    {
+        imu.reset(settings.history);
+        mocap.reset(settings.history);
+    }
+
+    config settings{};
+    f64 time{0.0};
+    f64 imu_clock{0.0};
+    f64 mocap_clock{0.0};
+    u64 seen_layout{~u64{0}};
+
+    util::vector<drone_sensors> drones;
+    util::vector<imu_sample> imu_staging;
+    util::vector<mocap_sample> mocap_staging;
+    sample_ring<imu_sample> imu;
+    sample_ring<mocap_sample> mocap;
+};
+
+context_local<sensor_store> store;
+
+/**
+ * @brief Advances a sensor clock, true when a sample is due
+ *
+ * Rates above the tick rate sample once per tick.
+ */
+bool advance_clock(f64 &clock, f32 dt, f32 rate)
+{
+    if (rate <= 0.f)
+        return false;
+
+    const f64 period{1.0 / rate};
+    clock += dt;
+    // dt arrives as f32, 0.01f is slightly below 0.01
+    if (clock < period * (1.0 - 1e-5))
+        return false;
+
+    // A clock just short of the period carries nothing over instead of a whole period
+    clock = std::max(0.0, clock - period);
+    if (clock >= period)
+        clock = std::fmod(clock, period);
+    return true;
+}
+
+/**
+ * @brief Starts tracking drones that were created since the last layout change
+ *
+ * Serial, so noise seeds are drawn in dense index order.
+ */
+void track_new_drones(sensor_store &s)
+{
+    const u64 layout{drone::layout_generation()};
+    if (layout == s.seen_layout)
+        return;
+    s.seen_layout = layout;
+
+    const u32 count{drone::count()};
+    for (u32 i{0}; i < count; ++i)
+    {
+        const game_entity::entity_id entity{drone::entity_at(i)};
+        const id::id_type index{id::index(entity)};
+        if (index >= s.drones.size())
+            s.drones.resize(index + 1);
+
+        drone_sensors &sensors{s.drones[index]};
+        if (sensors.entity == (id::id_type)entity)
+            continue;
+
+        const drone::DroneState &state{drone::state_at(i)};
+        sensors.entity = entity;
+        sensors.velocity = state.velocity;
+        sensors.body_rates = state.body_rates;
+        sensors.accel_bias.setZero();
+        sensors.gyro_bias.setZero();
+        sensors.imu_time = -1.0;
+        sensors.noise.seed(random::next_seed());
+    }
+}
+
+Vector3f gaussian(random::engine &noise, f32 sigma)
+{
+    std::normal_distribution<f32> n{0.f, 1.f};
+    return Vector3f{n(noise), n(noise), n(noise)} * sigma;
+}
+
+void copy3(f32 *to, const Vector3f &v)
+{
+    to[0] = v.x();
+    to[1] = v.y();
+    to[2] = v.z();
+}
+
+Vector3f vector3(const f32 *from) { return Vector3f{from[0], from[1], from[2]}; }
+
+void sample_imu(const imu_config &c, f32 dt, f64 time, const drone::DroneState &state,
+                const Vector3f &lever_arm, drone_sensors &sensors, imu_sample &out)
+{
+    const Vector3f acceleration{(state.velocity - sensors.velocity) / dt};
+    const Vector3f angular_acceleration{(state.body_rates - sensors.body_rates) / dt};
+    const Vector3f &w{state.body_rates};
+    const drone::Matrix3f rotation{drone::quaternionToRotationMatrix(state.attitude)};
+
+    // Specific force at the IMU: body frame acceleration minus gravity plus the lever arm terms
+    const Vector3f accel_true{rotation.transpose() * (acceleration + Vector3f{0.f, 0.f, gravity}) +
+                              angular_acceleration.cross(lever_arm) + w.cross(w.cross(lever_arm))};
+
+    // Discrete noise of a density: sigma / sqrt(interval), bias steps: walk * sqrt(interval).
+    // Rates above the tick rate sample once per tick, so the interval is the drone's actual one.
+    const f32 interval{sensors.imu_time < 0.0 ? std::max(dt, 1.f / c.rate)
+                                              : (f32)(time - sensors.imu_time)};
+    const f32 sqrt_interval{std::sqrt(interval)};
+    sensors.imu_time = time;
+    sensors.accel_bias += gaussian(sensors.noise, c.accel_random_walk * sqrt_interval);
+    sensors.gyro_bias += gaussian(sensors.noise, c.gyro_random_walk * sqrt_interval);
+
+    out.entity = sensors.entity;
+    out.time = time;
+    copy3(out.accel, accel_true + sensors.accel_bias +
+                         gaussian(sensors.noise, c.accel_noise_density / sqrt_interval));
+    copy3(out.gyro,
+          w + sensors.gyro_bias + gaussian(sensors.noise, c.gyro_noise_density / sqrt_interval));
+    copy3(out.accel_true, accel_true);
+}
+
+void sample_mocap(const mocap_config &c, f64 time, const drone::DroneState &state,
+                  drone_sensors &sensors, mocap_sample &out)
+{
+    out.entity = sensors.entity;
+    out.time = time;
+    copy3(out.position, state.position + gaussian(sensors.noise, c.position_noise));
+    copy3(out.velocity, state.velocity + gaussian(sensors.noise, c.velocity_noise));
+    copy3(out.body_rates, state.body_rates + gaussian(sensors.noise, c.body_rate_noise));
+
+    // Small rotation in the body frame, q * [1, d/2]
+    const Vector3f half{gaussian(sensors.noise, c.attitude_noise) * 0.5f};
+    const drone::Quaternionf q{state.attitude.w(), state.attitude.x(), state.attitude.y(),
+                               state.attitude.z()};
+    const drone::Quaternionf measured{
+        (q * drone::Quaternionf{1.f, half.x(), half.y(), half.z()}).normalized()};
+    out.attitude[0] = measured.x();
+    out.attitude[1] = measured.y();
+    out.attitude[2] = measured.z();
+    out.attitude[3] = measured.w();
+}
+/**
+ * @brief Moves the samples of drones that were sampled to the front, keeping their order
+ * @return Number of samples
+ */
+template <typename Sample> u32 sampled(util::vector<Sample> &staging)
+{
+    u32 count{0};
+    for (const Sample &sample : staging)
+    {
+        if (id::is_valid(sample.entity))
+            staging[count++] = sample;
+    }
+    return count;
+}
+} // namespace
+
+void configure(const config &c)
+{
+    sensor_store &s{*store};
+    s.settings = c;
+    s.time = 0.0;
+    s.imu_clock = 0.0;
+    s.mocap_clock = 0.0;
+    s.seen_layout = ~u64{0};
+    s.drones.clear();
+    s.imu.reset(c.history);
+    s.mocap.reset(c.history);
+}
+
+const config &get_config() { return store->settings; }
+
+void update(f32 dt)
+{
+    sensor_store &s{*store};
+    if (dt <= 0.f)
+        return;
+
+    s.time += dt;
+    const bool imu_enabled{s.settings.imu.rate > 0.f};
+    const bool imu_due{advance_clock(s.imu_clock, dt, s.settings.imu.rate)};
+    const bool mocap_due{advance_clock(s.mocap_clock, dt, s.settings.mocap.rate)};
+    if (!imu_enabled && !mocap_due)
+        return;
+
+    track_new_drones(s);
+
+    const u32 count{drone::count()};
+    if (imu_due)
+        s.imu_staging.resize(count);
+    if (mocap_due)
+        s.mocap_staging.resize(count);
+
+    const f64 time{s.time};
+    const bool lod{drone::get_lod_config().enabled};
+    jobs::parallel_for(count, 0, [&, dt, time, lod](u32 begin, u32 end) {
+        for (u32 i{begin}; i < end; ++i)
+        {
+            const drone::DroneState &state{drone::state_at(i)};
+            drone_sensors &sensors{s.drones[id::index(drone::entity_at(i))]};
+
+            // A reduced drone that skipped the step lags behind the clock, it is not sampled
+            // and differentiates over its whole step once it caught up. Held drones are current.
+            f32 span{dt};
+            if (lod)
+            {
+                const f32 stepped{drone::stepped_dt_at(i)};
+                if (stepped > 0.f)
+                {
+                    span = stepped;
+                }
+                else if (drone::lod_at(i) != drone::lod_level::held)
+                {
+                    if (imu_due)
+                        s.imu_staging[i].entity = id::invalid_id;
+                    if (mocap_due)
+                        s.mocap_staging[i].entity = id::invalid_id;
+                    continue;
+                }
+            }
+
+            if (imu_due)
+            {
+                const Vector3f &lever_arm{drone::params_at(i).geometric_properties.imu_position};
+                sample_imu(s.settings.imu, span, time, state, lever_arm, sensors,
+                           s.imu_staging[i]);
+            }
+            if (mocap_due)
+                sample_mocap(s.settings.mocap, time, state, sensors, s.mocap_staging[i]);
+
+            // The IMU differentiates over every tick, also those it does not sample in
+            if (imu_enabled)
+            {
+                sensors.velocity = state.velocity;
+                sensors.body_rates = state.body_rates;
+            }
+        }
+    });
+
+    if (imu_due)
+        s.imu.push(s.imu_staging.data(), lod ? sampled(s.imu_staging) : count);
+    if (mocap_due)
+        s.mocap.push(s.mocap_staging.data(), lod ? sampled(s.mocap_staging) : count);
+}
+
+u32 read_imu(u64 &cursor, imu_sample *out, u32 capacity)
+{
+    return store->imu.read(cursor, out, capacity);
+}
+
+u32 read_mocap(u64 &cursor, mocap_sample *out, u32 capacity)
+{
+    return store->mocap.read(cursor, out, capacity);
+}
+
+u64 imu_written() { return store->imu.written(); }
+u64 mocap_written() { return store->mocap.written(); }
+
+void save_state(saved_clocks &clocks, util::vector<saved_drone> &drones)
+{
+    const sensor_store &s{*store};
+    clocks.time = s.time;
+    clocks.imu_clock = s.imu_clock;
+    clocks.mocap_clock = s.mocap_clock;
+    clocks.imu_written = s.imu.written();
+    clocks.mocap_written = s.mocap.written();
+
+    drones.resize(s.drones.size());
+    for (u32 i{0}; i < s.drones.size(); ++i)
+    {
+        const drone_sensors &sensors{s.drones[i]};
+        saved_drone &out{drones[i]};
+        out.entity = sensors.entity;
+        copy3(out.velocity, sensors.velocity);
+        copy3(out.body_rates, sensors.body_rates);
+        copy3(out.accel_bias, sensors.accel_bias);
+        copy3(out.gyro_bias, sensors.gyro_bias);
+        out.noise_state = random::save_state(sensors.noise);
+        out.imu_time = sensors.imu_time;
+    }
+}
+
+void load_state(const saved_clocks &clocks, const saved_drone *drones, u32 count)
+{
+    assert(drones || !count);
+    sensor_store &s{*store};
+    s.time = clocks.time;
+    s.imu_clock = clocks.imu_clock;
+    s.mocap_clock = clocks.mocap_clock;
+    s.imu.set_written(clocks.imu_written);
+    s.mocap.set_written(clocks.mocap_written);
+
+    s.drones.resize(count);
+    for (u32 i{0}; i < count; ++i)
+    {
+        const saved_drone &in{drones[i]};
+        drone_sensors &sensors{s.drones[i]};
+        sensors.entity = in.entity;
+        sensors.velocity = vector3(in.velocity);
+        sensors.body_rates = vector3(in.body_rates);
+        sensors.accel_bias = vector3(in.accel_bias);
+        sensors.gyro_bias = vector3(in.gyro_bias);
+        random::load_state(sensors.noise, in.noise_state);
+        sensors.imu_time = in.imu_time;
+    }
+
+    // Drones the saved state did not track yet are picked up again on the next update
+    s.seen_layout = ~u64{0};
+}
+
+} // namespace lark::sensors
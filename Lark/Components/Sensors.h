@@ -0,0 +1,164 @@
+/**
+ * @file Sensors.h
+ * @brief Simulated IMU and motion capture measurements for every drone
+ *
+ * The game loop calls update once per tick after the dynamics. Each sensor
+ * keeps its own clock and samples all drones at its configured rate, which
+ * is independent of the tick rate but at most one sample per tick. Samples
+ * are appended to a fixed-size ring per sensor; readers keep a cursor and
+ * copy everything written since in bulk.
+ *
+ * The IMU measures the specific force and body rates at imu_position of the
+ * airframe, including the lever arm terms, with white noise and a bias that
+ * follows a random walk. Both are discretized over the time since the drone's
+ * previous sample, which is the tick when the rate exceeds the tick rate.
+ * Accelerations are differentiated from the state over the last tick. Motion
+ * capture reports the pose and twist with white noise.
+ *
+ * With dynamics LOD, a reduced drone that skipped the tick's step is not
+ * sampled, and its next sample differentiates over the whole step it caught
+ * up with. Held drones are sampled as usual.
+ */
+
+#pragma once
+#include "ComponentCommon.h"
+
+namespace lark::sensors
+{
+
+/**
+ * @struct imu_config
+ * @brief Rate and noise model of the IMU, densities follow the datasheet convention
+ */
+struct imu_config
+{
+    f32 rate{200.f};                 ///< Hz, 0 disables the sensor
+    f32 accel_noise_density{0.004f}; ///< m/s^2/sqrt(Hz)
+    f32 accel_random_walk{0.01f};    ///< m/s^3/sqrt(Hz), drives the bias
+    f32 gyro_noise_density{0.01f};   ///< rad/s/sqrt(Hz)
+    f32 gyro_random_walk{0.001f};    ///< rad/s^2/sqrt(Hz), drives the bias
+};
+
+/**
+ * @struct mocap_config
+ * @brief Rate and white noise of the motion capture system
+ */
+struct mocap_config
+{
+    f32 rate{100.f};              ///< Hz, 0 disables the sensor
+    f32 position_noise{0.0005f};  ///< m, standard deviation
+    f32 velocity_noise{0.005f};   ///< m/s
+    f32 attitude_noise{0.001f};   ///< rad, applied as a small rotation
+    f32 body_rate_noise{0.005f};  ///< rad/s
+};
+
+/**
+ * @struct config
+ * @brief Sensor setup of a world, history is the ring size in samples per sensor
+ */
+struct config
+{
+    imu_config imu{};
+    mocap_config mocap{};
+    u32 history{1u << 16};
+};
+
+/**
+ * @struct imu_sample
+ * @brief One IMU reading, all vectors in the body frame
+ */
+struct imu_sample
+{
+    id::id_type entity{id::invalid_id};
+    f64 time{0.0};       ///< Sensor clock, seconds of simulated time since the first update
+    f32 accel[3]{};      ///< Measured specific force, m/s^2
+    f32 gyro[3]{};       ///< Measured body rates, rad/s
+    f32 accel_true[3]{}; ///< Specific force without noise and bias
+};
+
+/**
+ * @struct mocap_sample
+ * @brief One motion capture reading in the world frame
+ */
+struct mocap_sample
+{
+    id::id_type entity{id::invalid_id};
+    f64 time{0.0};
+    f32 position[3]{};
+    f32 velocity[3]{};
+    f32 attitude[4]{}; ///< Quaternion [x,y,z,w]
+    f32 body_rates[3]{};
+};
+
+/**
+ * @struct saved_clocks
+ * @brief Clocks of the sensors and the number of samples written to each ring
+ */
+struct saved_clocks
+{
+    f64 time{0.0};
+    f64 imu_clock{0.0};
+    f64 mocap_clock{0.0};
+    u64 imu_written{0};
+    u64 mocap_written{0};
+};
+
+/**
+ * @struct saved_drone
+ * @brief Sensor state of one drone slot: differentiation inputs, biases and noise generator
+ */
+struct saved_drone
+{
+    id::id_type entity{id::invalid_id}; ///< invalid_id for slots no drone was tracked in
+    f32 velocity[3]{};
+    f32 body_rates[3]{};
+    f32 accel_bias[3]{};
+    f32 gyro_bias[3]{};
+    u32 noise_state{0};
+    f64 imu_time{-1.0};
+};
+
+/**
+ * @brief Replaces the sensor setup, clears the rings and the bias states
+ */
+void configure(const config &c);
+const config &get_config();
+
+/**
+ * @brief Advances the sensor clocks and samples every drone that is due
+ * @param dt Duration of the tick that just finished integrating
+ */
+void update(f32 dt);
+
+/**
+ * @brief Copies samples written since cursor, oldest first
+ * @param cursor Sequence number of the next wanted sample, advanced past the copied ones.
+ * Samples that were already overwritten are skipped.
+ * @return Number of samples copied, at most capacity
+ */
+u32 read_imu(u64 &cursor, imu_sample *out, u32 capacity);
+u32 read_mocap(u64 &cursor, mocap_sample *out, u32 capacity);
+
+/**
+ * @brief Total number of samples written, the cursor of the next sample
+ */
+u64 imu_written();
+u64 mocap_written();
+
+/**
+ * @brief Copies the clocks and the state of every tracked drone, by entity index
+ *
+ * Samples in the rings are not included, only how many were written.
+ */
+void save_state(saved_clocks &clocks, util::vector<saved_drone> &drones);
+
+/**
+ * @brief Restores a state taken by save_state, the config stays as it is
+ *
+ * The next samples continue at the saved ring positions, so readers whose
+ * cursors were saved alongside read on without a gap. Older samples in the
+ * rings are those of the run the state was restored into.
+ */
+void load_state(const saved_clocks &clocks, const saved_drone *drones, u32 count);
+
+} // namespace lark::sensors
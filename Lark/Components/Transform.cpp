@@ -1,14 +1,27 @@
 #include "Transform.h"
+#include "ChangeTracking.h"
 #include "Entity.h"
+#include "Core/Context.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define LARK_TRANSFORM_SSE 1
+#endif
 
 namespace lark::transform
 {
 
 namespace
 {
-util::vector<math::v3> positions;
-util::vector<math::v4> rotations; // Using vec4 for quaternions
-util::vector<math::v3> scales;
+struct transform_store
+{
+    util::vector<math::v3> positions;
+    util::vector<math::v4> rotations; // Using vec4 for quaternions
+    util::vector<math::v3> scales;
+    u64 storage_generation{0};
+};
+
+context_local<transform_store> store;
 
 math::v4 euler_to_quaternion(const math::v3 &euler_angles)
 {
@@ -28,12 +41,113 @@ math::v3 quaternion_to_euler(const math::v4 &quaternion)
     glm::quat q(quaternion.w, quaternion.x, quaternion.y, quaternion.z);
     return glm::degrees(glm::eulerAngles(q));
 }
+
+// Transform slots share the entity index, so the component index is the change slot
+void mark_changed(id::id_type index)
+{
+    changes::mark_changed(changes::component_type::transform, index);
+}
+
+bool is_live(id::id_type entity_id)
+{
+    return id::is_valid(entity_id) && id::index(entity_id) < store->positions.size() &&
+           game_entity::is_alive(game_entity::entity_id{entity_id});
+}
+
+// Same result as get_transform_matrix (T * R * S) without the intermediate glm matrices
+void compose_matrix(const transform_store &data, id::id_type index, math::m4x4 &m)
+{
+    const math::v4 &q{data.rotations[index]};
+    const math::v3 &s{data.scales[index]};
+
+    const f32 xx{q.x * q.x}, yy{q.y * q.y}, zz{q.z * q.z};
+    const f32 xy{q.x * q.y}, xz{q.x * q.z}, yz{q.y * q.z};
+    const f32 wx{q.w * q.x}, wy{q.w * q.y}, wz{q.w * q.z};
+
+    m[0] = math::v4((1.f - 2.f * (yy + zz)) * s.x, 2.f * (xy + wz) * s.x, 2.f * (xz - wy) * s.x,
+                    0.f);
+    m[1] = math::v4(2.f * (xy - wz) * s.y, (1.f - 2.f * (xx + zz)) * s.y, 2.f * (yz + wx) * s.y,
+                    0.f);
+    m[2] = math::v4(2.f * (xz + wy) * s.z, 2.f * (yz - wx) * s.z, (1.f - 2.f * (xx + yy)) * s.z,
+                    0.f);
+    m[3] = math::v4(data.positions[index], 1.f);
+}
+
+void compose_or_identity(const transform_store &data, id::id_type entity_id, math::m4x4 &m)
+{
+    if (is_live(entity_id))
+    {
+        compose_matrix(data, id::index(entity_id), m);
+    }
+    else
+    {
+        m = math::m4x4(1.0f);
+    }
+}
+
+#if LARK_TRANSFORM_SSE
+// Transposes one matrix column for four transforms (lanes) back to AoS and stores it
+inline void store_column(math::m4x4 *out, u32 column, __m128 x, __m128 y, __m128 z, __m128 w)
+{
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(&out[0][column][0], x);
+    _mm_storeu_ps(&out[1][column][0], y);
+    _mm_storeu_ps(&out[2][column][0], z);
+    _mm_storeu_ps(&out[3][column][0], w);
+}
+
+// Composes four matrices at once: quaternions are transposed into x/y/z/w lanes so every
+// rotation term is computed for all four transforms with a single instruction.
+void compose_matrices_x4(const transform_store &data, const id::id_type (&indices)[4],
+                         math::m4x4 *out)
+{
+    __m128 qx{_mm_loadu_ps(&data.rotations[indices[0]].x)};
+    __m128 qy{_mm_loadu_ps(&data.rotations[indices[1]].x)};
+    __m128 qz{_mm_loadu_ps(&data.rotations[indices[2]].x)};
+    __m128 qw{_mm_loadu_ps(&data.rotations[indices[3]].x)};
+    _MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+
+    const math::v3 &s0{data.scales[indices[0]]}, &s1{data.scales[indices[1]]};
+    const math::v3 &s2{data.scales[indices[2]]}, &s3{data.scales[indices[3]]};
+    const __m128 sx{_mm_setr_ps(s0.x, s1.x, s2.x, s3.x)};
+    const __m128 sy{_mm_setr_ps(s0.y, s1.y, s2.y, s3.y)};
+    const __m128 sz{_mm_setr_ps(s0.z, s1.z, s2.z, s3.z)};
+
+    const __m128 one{_mm_set1_ps(1.f)};
+    const __m128 two{_mm_set1_ps(2.f)};
+    const __m128 zero{_mm_setzero_ps()};
+
+    const __m128 xx{_mm_mul_ps(qx, qx)}, yy{_mm_mul_ps(qy, qy)}, zz{_mm_mul_ps(qz, qz)};
+    const __m128 xy{_mm_mul_ps(qx, qy)}, xz{_mm_mul_ps(qx, qz)}, yz{_mm_mul_ps(qy, qz)};
+    const __m128 wx{_mm_mul_ps(qw, qx)}, wy{_mm_mul_ps(qw, qy)}, wz{_mm_mul_ps(qw, qz)};
+
+    const auto diag = [&](__m128 a, __m128 b, __m128 s) {
+        return _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(a, b))), s);
+    };
+    const auto sum2 = [&](__m128 a, __m128 b, __m128 s) {
+        return _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(a, b)), s);
+    };
+    const auto diff2 = [&](__m128 a, __m128 b, __m128 s) {
+        return _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(a, b)), s);
+    };
+
+    store_column(out, 0, diag(yy, zz, sx), sum2(xy, wz, sx), diff2(xz, wy, sx), zero);
+    store_column(out, 1, diff2(xy, wz, sy), diag(xx, zz, sy), sum2(yz, wx, sy), zero);
+    store_column(out, 2, sum2(xz, wy, sz), diff2(yz, wx, sz), diag(xx, yy, sz), zero);
+
+    for (u32 k{0}; k < 4; ++k)
+    {
+        out[k][3] = math::v4(data.positions[indices[k]], 1.f);
+    }
+}
+#endif
 } // namespace
 
 void component::set_rotation(const math::v4 &rotation)
 {
     assert(is_valid());
-    rotations[id::index(_id)] = glm::normalize(rotation);
+    store->rotations[id::index(_id)] = glm::normalize(rotation);
+    mark_changed(id::index(_id));
 }
 
 void component::set_rotation_euler(const math::v3 &euler_angles)
@@ -45,19 +159,22 @@ void component::set_scale(const math::v3 &new_scale)
 {
     assert(is_valid());
     // Prevent zero or negative scale
-    scales[id::index(_id)] = glm::max(new_scale, math::v3(0.001f));
+    store->scales[id::index(_id)] = glm::max(new_scale, math::v3(0.001f));
+    mark_changed(id::index(_id));
 }
 
 void component::set_position(const math::v3 &new_position)
 {
     assert(is_valid());
-    positions[id::index(_id)] = new_position;
+    store->positions[id::index(_id)] = new_position;
+    mark_changed(id::index(_id));
 }
 
 void component::translate(const math::v3 &translation)
 {
     assert(is_valid());
-    positions[id::index(_id)] += translation;
+    store->positions[id::index(_id)] += translation;
+    mark_changed(id::index(_id));
 }
 
 void component::rotate(const math::v3 &euler_angles)
@@ -69,83 +186,179 @@ void component::rotate(const math::v3 &euler_angles)
 
 void component::scale_by(const math::v3 &scale_factor)
 {
+    transform_store &s{*store};
     assert(is_valid());
-    scales[id::index(_id)] *= scale_factor;
+    s.scales[id::index(_id)] *= scale_factor;
     // Ensure scale doesn't go below minimum
-    scales[id::index(_id)] = glm::max(scales[id::index(_id)], math::v3(0.001f));
+    s.scales[id::index(_id)] = glm::max(s.scales[id::index(_id)], math::v3(0.001f));
+    mark_changed(id::index(_id));
 }
 
 math::m4x4 component::get_transform_matrix() const
 {
+    transform_store &s{*store};
     assert(is_valid());
     const id::id_type index = id::index(_id);
 
     math::m4x4 transform = glm::mat4(1.0f);
 
     // Apply translation
-    transform = glm::translate(transform, positions[index]);
+    transform = glm::translate(transform, s.positions[index]);
 
     // Apply rotation (quaternion)
-    glm::quat rotation_quat(rotations[index].w, rotations[index].x, rotations[index].y,
-                            rotations[index].z);
+    glm::quat rotation_quat(s.rotations[index].w, s.rotations[index].x, s.rotations[index].y,
+                            s.rotations[index].z);
     transform *= glm::mat4_cast(rotation_quat);
 
     // Apply scale
-    transform = glm::scale(transform, scales[index]);
+    transform = glm::scale(transform, s.scales[index]);
 
     return transform;
 }
 
 void component::reset()
 {
+    transform_store &s{*store};
     assert(is_valid());
     const id::id_type index = id::index(_id);
-    positions[index] = math::v3(0.0f);
-    rotations[index] = math::v4(0.0f, 0.0f, 0.0f, 1.0f); // Identity quaternion
-    scales[index] = math::v3(1.0f);
+    s.positions[index] = math::v3(0.0f);
+    s.rotations[index] = math::v4(0.0f, 0.0f, 0.0f, 1.0f); // Identity quaternion
+    s.scales[index] = math::v3(1.0f);
+    mark_changed(index);
 }
 
 component create(init_info info, game_entity::entity entity)
 {
+    transform_store &s{*store};
     assert(entity.is_valid());
     const id::id_type entity_index{id::index(entity.get_id())};
 
-    if (positions.size() > entity_index)
+    if (s.positions.size() > entity_index)
     {
         // Convert arrays to GLM vectors
-        rotations[entity_index] =
+        s.rotations[entity_index] =
             math::v4(info.rotation[0], info.rotation[1], info.rotation[2], info.rotation[3]);
-        positions[entity_index] = math::v3(info.position[0], info.position[1], info.position[2]);
-        scales[entity_index] = math::v3(info.scale[0], info.scale[1], info.scale[2]);
+        s.positions[entity_index] = math::v3(info.position[0], info.position[1], info.position[2]);
+        s.scales[entity_index] = math::v3(info.scale[0], info.scale[1], info.scale[2]);
     }
     else
     {
-        assert(positions.size() == entity_index);
-        rotations.emplace_back(
+        assert(s.positions.size() == entity_index);
+        s.rotations.emplace_back(
             math::v4(info.rotation[0], info.rotation[1], info.rotation[2], info.rotation[3]));
-        positions.emplace_back(math::v3(info.position[0], info.position[1], info.position[2]));
-        scales.emplace_back(math::v3(info.scale[0], info.scale[1], info.scale[2]));
+        s.positions.emplace_back(math::v3(info.position[0], info.position[1], info.position[2]));
+        s.scales.emplace_back(math::v3(info.scale[0], info.scale[1], info.scale[2]));
+        ++s.storage_generation;
     }
-    return component(transform_id{(id::id_type)positions.size() - 1});
+    mark_changed(entity_index);
+    return component(transform_id{entity_index});
 }
 
 void remove(component t) { assert(t.is_valid()); }
 
+storage_view positions_view()
+{
+    transform_store &s{*store};
+    return {s.positions.data(), (u32)s.positions.size(), 3, sizeof(math::v3), storage_view::float32,
+            s.storage_generation};
+}
+
+storage_view rotations_view()
+{
+    transform_store &s{*store};
+    return {s.rotations.data(), (u32)s.rotations.size(), 4, sizeof(math::v4), storage_view::float32,
+            s.storage_generation};
+}
+
+storage_view scales_view()
+{
+    transform_store &s{*store};
+    return {s.scales.data(), (u32)s.scales.size(), 3, sizeof(math::v3), storage_view::float32,
+            s.storage_generation};
+}
+
+u64 layout_generation() { return store->storage_generation; }
+
+void mark_all_changed()
+{
+    const id::id_type count{(id::id_type)store->positions.size()};
+    for (id::id_type index{0}; index < count; ++index)
+        mark_changed(index);
+}
+
+void save_state(util::byte_writer &out)
+{
+    transform_store &s{*store};
+    out.write((u32)s.positions.size());
+    out.write_bytes(s.positions.data(), s.positions.size() * sizeof(math::v3));
+    out.write_bytes(s.rotations.data(), s.rotations.size() * sizeof(math::v4));
+    out.write_bytes(s.scales.data(), s.scales.size() * sizeof(math::v3));
+}
+
+bool load_state(util::byte_reader &in)
+{
+    transform_store &s{*store};
+    util::byte_reader probe{in};
+    u32 count{0};
+    if (!probe.read(count) || count != s.positions.size() ||
+        !probe.skip(count * (2 * sizeof(math::v3) + sizeof(math::v4))))
+        return false;
+
+    in.read(count);
+    in.read_bytes(s.positions.data(), count * sizeof(math::v3));
+    in.read_bytes(s.rotations.data(), count * sizeof(math::v4));
+    in.read_bytes(s.scales.data(), count * sizeof(math::v3));
+    mark_all_changed();
+    return in.ok();
+}
+
+void get_transform_matrices(const id::id_type *entity_ids, u32 count, math::m4x4 *out)
+{
+    assert(entity_ids && out);
+    const transform_store &data{*store};
+    u32 i{0};
+
+#if LARK_TRANSFORM_SSE
+    for (; i + 4 <= count; i += 4)
+    {
+        const id::id_type *group{&entity_ids[i]};
+        if (is_live(group[0]) && is_live(group[1]) && is_live(group[2]) && is_live(group[3]))
+        {
+            const id::id_type indices[4]{id::index(group[0]), id::index(group[1]),
+                                         id::index(group[2]), id::index(group[3])};
+            compose_matrices_x4(data, indices, &out[i]);
+        }
+        else
+        {
+            for (u32 k{0}; k < 4; ++k)
+            {
+                compose_or_identity(data, group[k], out[i + k]);
+            }
+        }
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        compose_or_identity(data, entity_ids[i], out[i]);
+    }
+}
+
 math::v4 component::rotation() const
 {
     assert(is_valid());
-    return rotations[id::index(_id)];
+    return store->rotations[id::index(_id)];
 }
 
 math::v3 component::scale() const
 {
     assert(is_valid());
-    return scales[id::index(_id)];
+    return store->scales[id::index(_id)];
 }
 
 math::v3 component::position() const
 {
     assert(is_valid());
-    return positions[id::index(_id)];
+    return store->positions[id::index(_id)];
 }
 } // namespace lark::transform
\ No newline at end of file
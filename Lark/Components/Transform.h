@@ -5,6 +5,7 @@
 
 #pragma once
 #include "ComponentCommon.h"
+#include "../Utils/BinaryStream.h"
 
 namespace lark::transform
 {
@@ -33,4 +34,46 @@ component create(init_info info, game_entity::entity entity);
  * @param t The transform component to remove
  */
 void remove(component t);
+
+/**
+ * @brief Composes world matrices for a batch of entities in a single pass
+ * @param entity_ids Entities whose transforms should be composed
+ * @param count Number of entries in entity_ids
+ * @param out Destination buffer with room for count matrices
+ *
+ * Reads the position/rotation/scale arrays directly and builds four matrices
+ * per iteration with SSE where available. Invalid or dead entities produce an
+ * identity matrix so the output stays index-aligned with the input.
+ */
+void get_transform_matrices(const id::id_type *entity_ids, u32 count, math::m4x4 *out);
+
+/**
+ * @brief Views of the position, rotation (quaternion xyzw) and scale arrays
+ *
+ * Rows are indexed by entity index. Rows of dead entities hold stale values.
+ */
+storage_view positions_view();
+storage_view rotations_view();
+storage_view scales_view();
+
+/**
+ * @brief Changes whenever the transform arrays grow and may have been reallocated
+ */
+u64 layout_generation();
+
+/**
+ * @brief Flags every transform as changed this frame, for writes made through a view
+ */
+void mark_all_changed();
+
+/**
+ * @brief Writes the position, rotation and scale arrays
+ */
+void save_state(util::byte_writer &out);
+
+/**
+ * @brief Restores arrays written by save_state and flags every transform as changed
+ * @return false if the number of transform slots differs, nothing is changed then
+ */
+bool load_state(util::byte_reader &in);
 } // namespace lark::transform
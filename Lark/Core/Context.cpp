@@ -0,0 +1,102 @@
+#include "Context.h"
+
+namespace lark
+{
+namespace
+{
+struct slot_type
+{
+    detail::slot_create create;
+    detail::slot_destroy destroy;
+};
+
+struct slot_registry
+{
+    std::mutex mutex;
+    slot_type slots[context::max_slots]{};
+    u32 count{0};
+};
+
+slot_registry &registry()
+{
+    // Stores register during static initialization, in no particular order
+    static slot_registry instance;
+    return instance;
+}
+
+std::atomic<u64> next_context_id{0};
+thread_local context *bound_context{nullptr};
+} // namespace
+
+namespace detail
+{
+u32 register_context_slot(slot_create create, slot_destroy destroy)
+{
+    slot_registry &slots{registry()};
+    std::lock_guard lock{slots.mutex};
+    assert(slots.count < context::max_slots);
+    slots.slots[slots.count] = {create, destroy};
+    return slots.count++;
+}
+} // namespace detail
+
+context::context() : _id{next_context_id.fetch_add(1, std::memory_order_relaxed)}
+{
+    // Constructed first so it outlives a context that is destroyed at exit
+    registry();
+}
+
+context::~context()
+{
+    // Store destructors may reach into other stores of this context
+    context *previous{bind(this)};
+    slot_registry &slots{registry()};
+    for (u32 i{_created}; i-- > 0;)
+    {
+        const u32 index{_creation_order[i]};
+        slots.slots[index].destroy(_slots[index].load(std::memory_order_relaxed));
+        _slots[index].store(nullptr, std::memory_order_relaxed);
+    }
+    bind(previous == this ? nullptr : previous);
+}
+
+context &context::current() { return bound_context ? *bound_context : default_context(); }
+
+context &context::default_context()
+{
+    static context instance;
+    return instance;
+}
+
+context *context::bind(context *ctx)
+{
+    context *previous{bound_context};
+    bound_context = ctx;
+    return previous;
+}
+
+void *context::create_slot(u32 index)
+{
+    std::lock_guard lock{_mutex};
+    if (void *data{_slots[index].load(std::memory_order_acquire)})
+        return data;
+
+    slot_registry &slots{registry()};
+    slot_type type{};
+    {
+        std::lock_guard registry_lock{slots.mutex};
+        assert(index < slots.count);
+        type = slots.slots[index];
+    }
+
+    // Constructors reach other stores through the current context
+    context *previous{bind(this)};
+    void *data{type.create()};
+    bind(previous);
+
+    _creation_order[_created++] = index;
+    _slots[index].store(data, std::memory_order_release);
+    return data;
+}
+
+} // namespace lark
@@ -0,0 +1,143 @@
+/**
+ * @file Context.h
+ * @brief Instance-scoped engine state, so several simulations can share a process
+ *
+ * The mutable state of the entity system (component stores, change stamps,
+ * the physics world registry and event bus, the seed stream, the script
+ * stores and frame arenas) lives in a context instead of in globals. Every
+ * thread has a current context and the free functions of the component
+ * modules operate on it. Threads that never bind one use the default context,
+ * so code written for a single world keeps working unchanged.
+ *
+ * Contexts share no mutable state, so different threads can create, step and
+ * destroy different contexts concurrently. Jobs run in the context of the
+ * thread that submitted them. Process-wide are the job pool, the vehicle type
+ * registry, the script type registry and the Python interpreter.
+ *
+ * Usage, one environment per thread:
+ *   lark::context ctx;
+ *   lark::context_scope scope{ctx};
+ *   lark::GameLoop loop{config};  // World and entities now belong to ctx
+ */
+
+#pragma once
+#include "../Common/PrimitiveTypes.h"
+#include <atomic>
+#include <cassert>
+#include <mutex>
+
+namespace lark
+{
+
+namespace detail
+{
+using slot_create = void *(*)();
+using slot_destroy = void (*)(void *);
+
+/**
+ * @brief Reserves a slot in every context, called once per context_local
+ */
+u32 register_context_slot(slot_create create, slot_destroy destroy);
+} // namespace detail
+
+/**
+ * @class context
+ * @brief Owns one instance of every context_local store
+ *
+ * Stores are created on first use and destroyed with the context, in reverse
+ * order of creation and with the context bound to the destroying thread.
+ */
+class context
+{
+  public:
+    static constexpr u32 max_slots{32};
+
+    context();
+    ~context();
+    context(const context &) = delete;
+    context &operator=(const context &) = delete;
+
+    /**
+     * @brief Context bound to the calling thread, the default context if none is
+     */
+    static context &current();
+
+    /**
+     * @brief Context used by threads that never bound one
+     */
+    static context &default_context();
+
+    /**
+     * @brief Unique for the lifetime of the process, never reused like addresses are
+     */
+    u64 id() const { return _id; }
+
+    void *slot(u32 index)
+    {
+        assert(index < max_slots);
+        void *data{_slots[index].load(std::memory_order_acquire)};
+        return data ? data : create_slot(index);
+    }
+
+  private:
+    friend class context_scope;
+
+    /**
+     * @brief Makes ctx current on the calling thread
+     * @return Previously bound context, nullptr for the default
+     */
+    static context *bind(context *ctx);
+
+    void *create_slot(u32 index);
+
+    std::atomic<void *> _slots[max_slots]{};
+    u32 _creation_order[max_slots]{};
+    u32 _created{0};
+    std::recursive_mutex _mutex; ///< Stores may use other stores while being created
+    u64 _id;
+};
+
+/**
+ * @class context_scope
+ * @brief Binds a context to the calling thread until the end of the scope
+ */
+class context_scope
+{
+  public:
+    explicit context_scope(context &ctx) : _previous{context::bind(&ctx)} {}
+    ~context_scope() { context::bind(_previous); }
+    context_scope(const context_scope &) = delete;
+    context_scope &operator=(const context_scope &) = delete;
+
+  private:
+    context *_previous;
+};
+
+/**
+ * @class context_local
+ * @brief Declares a store that exists once per context
+ *
+ * Replaces a file-scope global: declare it at namespace scope and access the
+ * instance of the current context through -> or *. Hot loops should fetch the
+ * instance once instead of per element.
+ */
+template <typename T> class context_local
+{
+  public:
+    context_local() : _slot{detail::register_context_slot(&create, &destroy)} {}
+    context_local(const context_local &) = delete;
+    context_local &operator=(const context_local &) = delete;
+
+    T &get() const { return get(context::current()); }
+    T &get(context &ctx) const { return *static_cast<T *>(ctx.slot(_slot)); }
+    T *operator->() const { return &get(); }
+    T &operator*() const { return get(); }
+
+  private:
+    static void *create() { return new T(); }
+    static void destroy(void *data) { delete static_cast<T *>(data); }
+
+    u32 _slot;
+};
+
+} // namespace lark
@@ -0,0 +1,254 @@
+#include "FrameArena.h"
+#include "Context.h"
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+namespace lark::memory
+{
+namespace
+{
+constexpr size_t default_block_size{64 * 1024};
+
+// Bumped by every destroyed context, tells the threads to prune their arena caches
+std::atomic<u64> retired_registries{0};
+
+/**
+ * @struct arena_registry
+ * @brief Arenas of every thread that allocated on behalf of one context
+ */
+struct arena_registry
+{
+    arena_registry() = default;
+    ~arena_registry()
+    {
+        alive.reset();
+        retired_registries.fetch_add(1, std::memory_order_release);
+    }
+
+    std::mutex mutex;
+    util::vector<std::unique_ptr<frame_arena>> arenas; ///< Reset at the end of a tick
+    util::vector<std::unique_ptr<frame_arena>> scope_arenas;
+    std::shared_ptr<bool> alive{std::make_shared<bool>(true)}; ///< Expires with the registry
+};
+
+context_local<arena_registry> registries;
+
+/**
+ * @struct thread_arenas
+ * @brief Arenas of the calling thread for one context
+ */
+struct thread_arenas
+{
+    u64 context_id;
+    frame_arena *tick;
+    frame_arena *scope;
+    std::weak_ptr<bool> alive; ///< Expired once the context destroyed the arenas
+};
+
+// Scope arena of the innermost default frame_scope and the context it belongs to
+thread_local frame_arena *active_scope_arena{nullptr};
+thread_local u64 active_scope_context{0};
+
+#ifdef LARK_TRACK_ALLOCATIONS
+std::atomic<u64> heap_allocations{0};
+#endif
+
+size_t align_up(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+frame_arena::~frame_arena() { release_blocks(); }
+
+void *frame_arena::allocate(size_t size, size_t alignment)
+{
+    assert(alignment && (alignment & (alignment - 1)) == 0);
+    size = std::max<size_t>(size, 1);
+
+    // Try the current block, then blocks kept around by an earlier rewind
+    while (_current < _blocks.size())
+    {
+        block &b{_blocks[_current]};
+        const uintptr_t base{reinterpret_cast<uintptr_t>(b.data)};
+        const size_t aligned{align_up(base + _offset, alignment) - base};
+        if (aligned + size <= b.size)
+        {
+            _offset = aligned + size;
+            return b.data + aligned;
+        }
+
+        if (_current + 1 == _blocks.size())
+            break;
+
+        ++_current;
+        _offset = 0;
+    }
+
+    const size_t last_size{_blocks.empty() ? default_block_size : _blocks.back().size * 2};
+    const size_t block_size{std::max(last_size, size + alignment)};
+    u8 *data{static_cast<u8 *>(std::malloc(block_size))};
+    if (!data)
+        throw std::bad_alloc{};
+
+    _blocks.emplace_back(block{data, block_size});
+    _current = (u32)_blocks.size() - 1;
+
+    const uintptr_t base{reinterpret_cast<uintptr_t>(data)};
+    const size_t aligned{align_up(base, alignment) - base};
+    _offset = aligned + size;
+    return data + aligned;
+}
+
+void frame_arena::rewind(marker m)
+{
+    assert(m.block < _blocks.size() || (m.block == 0 && m.offset == 0));
+    _current = m.block;
+    _offset = m.offset;
+}
+
+void frame_arena::reset()
+{
+    if (_blocks.size() > 1)
+    {
+        // Coalesce so the next tick of the same workload fits into one block
+        const size_t total{capacity()};
+        release_blocks();
+        u8 *data{static_cast<u8 *>(std::malloc(total))};
+        if (data)
+            _blocks.emplace_back(block{data, total});
+    }
+
+    _current = 0;
+    _offset = 0;
+}
+
+size_t frame_arena::used() const
+{
+    size_t total{0};
+    for (u32 i{0}; i < _current && i < _blocks.size(); ++i)
+        total += _blocks[i].size;
+    return total + _offset;
+}
+
+size_t frame_arena::capacity() const
+{
+    size_t total{0};
+    for (const auto &b : _blocks)
+        total += b.size;
+    return total;
+}
+
+void frame_arena::release_blocks()
+{
+    for (auto &b : _blocks)
+        std::free(b.data);
+    _blocks.clear();
+    _current = 0;
+    _offset = 0;
+}
+
+namespace
+{
+thread_arenas &arenas_of_thread(context &owner)
+{
+    // Keyed by context id: a thread may run jobs of several contexts within one tick of each
+    thread_local util::vector<thread_arenas> cache;
+    thread_local u64 retired_seen{0};
+
+    // Entries of destroyed contexts can never match again, drop them instead of piling up
+    const u64 retired{retired_registries.load(std::memory_order_acquire)};
+    if (retired != retired_seen)
+    {
+        retired_seen = retired;
+        for (u32 i{(u32)cache.size()}; i-- > 0;)
+        {
+            if (cache[i].alive.expired())
+                cache.erase(cache.begin() + i);
+        }
+    }
+
+    for (thread_arenas &entry : cache)
+    {
+        if (entry.context_id == owner.id())
+            return entry;
+    }
+
+    arena_registry &registry{registries.get(owner)};
+    std::lock_guard lock{registry.mutex};
+    frame_arena *tick{registry.arenas.emplace_back(std::make_unique<frame_arena>()).get()};
+    frame_arena *scope{registry.scope_arenas.emplace_back(std::make_unique<frame_arena>()).get()};
+    return cache.emplace_back(thread_arenas{owner.id(), tick, scope, registry.alive});
+}
+} // namespace
+
+frame_arena &thread_frame_arena()
+{
+    context &owner{context::current()};
+    if (active_scope_arena && active_scope_context == owner.id())
+        return *active_scope_arena;
+    return *arenas_of_thread(owner).tick;
+}
+
+frame_arena &thread_scope_arena() { return *arenas_of_thread(context::current()).scope; }
+
+frame_scope::frame_scope()
+    : _arena{thread_scope_arena()}, _marker{_arena.mark()}, _previous{active_scope_arena},
+      _previous_context{active_scope_context}, _redirects{true}
+{
+    active_scope_arena = &_arena;
+    active_scope_context = context::current().id();
+}
+
+frame_scope::~frame_scope()
+{
+    _arena.rewind(_marker);
+    if (_redirects)
+    {
+        active_scope_arena = _previous;
+        active_scope_context = _previous_context;
+    }
+}
+
+void reset_frame_arenas()
+{
+    arena_registry &arenas{*registries};
+    std::lock_guard lock{arenas.mutex};
+    for (auto &arena : arenas.arenas)
+        arena->reset();
+}
+
+u64 allocation_count()
+{
+#ifdef LARK_TRACK_ALLOCATIONS
+    return heap_allocations.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+} // namespace lark::memory
+
+#ifdef LARK_TRACK_ALLOCATIONS
+// Lives next to allocation_count() so the linker keeps it whenever the counter is used
+void *operator new(std::size_t size)
+{
+    lark::memory::heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr{std::malloc(size ? size : 1)})
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void *operator new[](std::size_t size) { return ::operator new(size); }
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+#endif
@@ -0,0 +1,194 @@
+/**
+ * @file FrameArena.h
+ * @brief Per-thread linear allocator for temporaries that live at most one tick
+ *
+ * Every thread owns a frame arena per context it works for. Allocations bump
+ * a pointer and are never freed individually; the game loop, or World::update
+ * when it drives the tick, resets the arenas of its context at the end of a
+ * tick. Stages such as downwash keep their per-tick scratch on it.
+ * A frame_scope moves the thread onto a second arena the game loop never
+ * resets, and rewinds it when it goes out of scope. Code that may run outside
+ * the tick, such as geometry import, keeps its temporaries in one.
+ *
+ * When the engine is built with LARK_TRACK_ALLOCATIONS the global operator new
+ * is replaced by a counting version so heap traffic per tick can be measured.
+ */
+
+#pragma once
+#include "../Common/CommonHeaders.h"
+#include <cstddef>
+#include <vector>
+
+namespace lark::memory
+{
+
+/**
+ * @class frame_arena
+ * @brief Linear allocator backed by a list of blocks
+ *
+ * After a reset that found more than one block, the blocks are merged into a
+ * single block of the combined size, so a steady workload stops touching the
+ * heap after a few ticks.
+ */
+class frame_arena
+{
+  public:
+    struct marker
+    {
+        u32 block{0};
+        size_t offset{0};
+    };
+
+    frame_arena() = default;
+    ~frame_arena();
+    frame_arena(const frame_arena &) = delete;
+    frame_arena &operator=(const frame_arena &) = delete;
+
+    /**
+     * @brief Returns uninitialized memory that stays valid until reset or rewind
+     */
+    void *allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @brief Current position, to be passed to rewind()
+     */
+    marker mark() const { return {_current, _offset}; }
+
+    /**
+     * @brief Releases everything allocated after the marker was taken
+     */
+    void rewind(marker m);
+
+    /**
+     * @brief Releases all allocations
+     */
+    void reset();
+
+    size_t used() const;
+    size_t capacity() const;
+
+  private:
+    struct block
+    {
+        u8 *data{nullptr};
+        size_t size{0};
+    };
+
+    void release_blocks();
+
+    util::vector<block> _blocks;
+    u32 _current{0};
+    size_t _offset{0};
+};
+
+/**
+ * @brief Arena of the calling thread for the current context
+ *
+ * Inside a default frame_scope this is the scope arena, otherwise the tick arena.
+ */
+frame_arena &thread_frame_arena();
+
+/**
+ * @brief Arena of the calling thread for the current context that frame scopes draw from
+ */
+frame_arena &thread_scope_arena();
+
+/**
+ * @brief Resets the tick arenas all threads use for the current context
+ *
+ * Only valid while no thread allocates on behalf of the context outside a
+ * frame_scope, i.e. between its ticks once its jobs finished. Scope arenas are
+ * left alone, other contexts may keep running.
+ */
+void reset_frame_arenas();
+
+/**
+ * @brief Number of heap allocations since startup
+ *
+ * Always 0 unless the engine was built with LARK_TRACK_ALLOCATIONS.
+ */
+u64 allocation_count();
+
+/**
+ * @brief Whether allocation_count() reports real numbers
+ */
+constexpr bool allocation_tracking_enabled()
+{
+#ifdef LARK_TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @class frame_scope
+ * @brief Rewinds an arena to its state at construction
+ *
+ * The default scope uses the thread's scope arena and makes it the thread's
+ * frame arena until the scope ends, so frame containers created inside are
+ * safe from the game loop's reset. Jobs the scope starts run on other threads
+ * and must not allocate from the frame arena.
+ */
+class frame_scope
+{
+  public:
+    frame_scope();
+    explicit frame_scope(frame_arena &arena) : _arena{arena}, _marker{arena.mark()} {}
+    ~frame_scope();
+    frame_scope(const frame_scope &) = delete;
+    frame_scope &operator=(const frame_scope &) = delete;
+
+  private:
+    frame_arena &_arena;
+    frame_arena::marker _marker;
+    frame_arena *_previous{nullptr}; ///< Scope arena active before, default scopes only
+    u64 _previous_context{0};
+    bool _redirects{false};
+};
+
+/**
+ * @class frame_allocator
+ * @brief STL allocator drawing from a frame arena, deallocation is a no-op
+ *
+ * Containers using it must not outlive the reset (or frame_scope) of the
+ * arena they were created on.
+ */
+template <typename T> class frame_allocator
+{
+  public:
+    using value_type = T;
+
+    frame_allocator() noexcept : _arena{&thread_frame_arena()} {}
+    explicit frame_allocator(frame_arena &arena) noexcept : _arena{&arena} {}
+    template <typename U>
+    frame_allocator(const frame_allocator<U> &other) noexcept : _arena{other.arena()}
+    {
+    }
+
+    T *allocate(size_t count)
+    {
+        return static_cast<T *>(_arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, size_t) noexcept {}
+
+    frame_arena *arena() const noexcept { return _arena; }
+
+    template <typename U> bool operator==(const frame_allocator<U> &other) const noexcept
+    {
+        return _arena == other.arena();
+    }
+
+    template <typename U> bool operator!=(const frame_allocator<U> &other) const noexcept
+    {
+        return _arena != other.arena();
+    }
+
+  private:
+    frame_arena *_arena;
+};
+
+template <typename T> using frame_vector = std::vector<T, frame_allocator<T>>;
+
+} // namespace lark::memory
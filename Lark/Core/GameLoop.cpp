@@ -1,5 +1,15 @@
 #include "GameLoop.h"
+#include "Components/Bridge.h"
+#include "Components/ChangeTracking.h"
+#include "Components/Downwash.h"
+#include "Components/Drone.h"
+#include "Components/Estimator.h"
+#include "Components/Neighbors.h"
+#include "Components/Sensors.h"
+#include "Components/ScriptRuntime.h"
+#include "Replay.h"
 #include "PhysicExtension/World/WorldRegistry.h"
+#include <optional>
 
 #if defined(_WIN32)
 #include <Windows.h>
@@ -65,6 +75,13 @@ bool GameLoop::initialize()
         // Store raw pointer for easy access
         world = world_ptr.get();
 
+        // Other loops may share the pool, it stops once the last one released it
+        jobs::acquire(_config.worker_threads);
+        _holds_jobs = true;
+        register_systems();
+        start_script_runtime();
+        script::set_execution_mode(_config.script_mode);
+
         _initialized = true;
         printf("GameLoop initialized successfully");
         return true;
@@ -81,10 +98,26 @@ void GameLoop::shutdown()
     if (!_initialized)
         return;
 
+    _scheduler.clear();
+    script::shutdown_execution();
+    bridge::close();
+
     // Clean up world (will automatically unregister from registry)
     world_ptr.reset();
     world = nullptr;
 
+    if (_holds_script_runtime)
+    {
+        script::runtime::release();
+        _holds_script_runtime = false;
+    }
+
+    if (_holds_jobs)
+    {
+        jobs::release();
+        _holds_jobs = false;
+    }
+
     _initialized = false;
 }
 
@@ -93,11 +126,43 @@ void GameLoop::tick()
     if (!_initialized || !world)
         return;
 
-    _current_delta_time = calculate_delta_time();
+    step(calculate_delta_time());
+}
+
+void GameLoop::step(f32 dt)
+{
+    if (!_initialized || !world)
+        return;
+
+    const u64 allocations_at_start{memory::allocation_count()};
+
+    _current_delta_time = dt;
     _accumulated_time += _current_delta_time;
 
-    world->update(_current_delta_time);
-    update_script_components(_current_delta_time);
+    if (_recorder)
+        _recorder->begin_tick(*this);
+
+    // Applies last tick's script commands, in worker mode the scripts start running here
+    script::begin_frame(_current_delta_time);
+    {
+        // Scripts take the GIL on whichever thread runs them
+        std::optional<pybind11::gil_scoped_release> release;
+        if (Py_IsInitialized() && PyGILState_Check())
+            release.emplace();
+        _scheduler.run(_current_delta_time);
+        script::end_frame();
+    }
+    if (_recorder)
+        _recorder->end_tick(_current_delta_time, script::applied_commands(),
+                            bridge::applied_commands());
+    world->report_drone_states();
+
+    // Everything written from here on belongs to the next frame
+    changes::advance_frame();
+
+    // The job system is idle again, so nothing references per-tick temporaries anymore
+    memory::reset_frame_arenas();
+    _allocations_last_tick = memory::allocation_count() - allocations_at_start;
 
     // Update FPS counter
     _frame_count++;
@@ -138,20 +203,132 @@ f32 GameLoop::calculate_delta_time()
     return delta_time;
 }
 
-// TODO: ADD Exit Statuses etc (especially for physics)
+void GameLoop::start_script_runtime()
+{
+    // Import every registered script while the first frames run instead of at first spawn
+    script::runtime::runtime_config config{};
+    config.search_paths.emplace_back(_config.script_directory);
+    config.background = _config.background_script_startup;
+
+    size_t count{0};
+    script::detail::get_script_names(nullptr, &count);
+    util::vector<const char *> names(count);
+    script::detail::get_script_names(names.data(), &count);
+    for (const char *name : names)
+        config.preload.emplace_back(name);
 
-void GameLoop::update_script_components(f32 dt)
+    // Held like the job system, the runtime stops with its last user
+    script::runtime::acquire(config);
+    _holds_script_runtime = true;
+}
+
+void GameLoop::register_systems()
 {
-    const auto &active_entities = game_entity::get_active_entities();
-    for (const auto &entity_id : active_entities)
-    {
-        game_entity::entity entity{entity_id};
-        auto script = entity.script();
-        if (script.is_valid())
-        {
-            // Update script
-        }
-    }
+    using r = SystemResource;
+    const auto drone_count = [] { return drone::count(); };
+
+    // Wind models keep state between samples, so one thread owns the model
+    _scheduler.add_system({"wind",
+                           resources(r::drone_state),
+                           resources(r::wind_field, r::drone_wind),
+                           drone_count,
+                           [this](f32 dt, u32 begin, u32 end) { world->sample_wind(dt, begin, end); },
+                           0,
+                           false});
+
+    // Rebuilds the neighbor grid itself, positions may have changed since the neighbors system
+    _scheduler.add_system({"downwash",
+                           resources(r::drone_state),
+                           resources(r::drone_wind, r::neighbor_grid),
+                           {},
+                           [](f32, u32, u32) { downwash::update(); }});
+
+    _scheduler.add_system({"trajectory",
+                           0,
+                           resources(r::drone_setpoint),
+                           drone_count,
+                           [](f32 dt, u32 begin, u32 end) {
+                               drone::update_trajectories(dt, begin, end);
+                           }});
+
+    _scheduler.add_system({"control",
+                           resources(r::drone_state, r::drone_setpoint, r::drone_estimate),
+                           resources(r::drone_control),
+                           drone_count,
+                           [](f32, u32 begin, u32 end) { drone::update_controls(begin, end); }});
+
+    // External controllers override the engine's inputs, in lockstep this waits for their answer
+    _scheduler.add_system({"bridge_commands",
+                           resources(r::drone_state),
+                           resources(r::drone_control, r::bridge),
+                           {},
+                           [](f32, u32, u32) { bridge::apply_commands(); }});
+
+    _scheduler.add_system({"dynamics",
+                           resources(r::drone_control, r::drone_wind),
+                           resources(r::drone_state),
+                           drone_count,
+                           [](f32 dt, u32 begin, u32 end) {
+                               drone::step_dynamics(dt, begin, end);
+                           }});
+
+    _scheduler.add_system({"transform_sync",
+                           resources(r::drone_state),
+                           resources(r::transform),
+                           drone_count,
+                           [](f32, u32 begin, u32 end) { drone::sync_transforms(begin, end); }});
+
+    // Builds on the job pool itself, separation or comms logic queries it on the next tick
+    _scheduler.add_system({"neighbors",
+                           resources(r::drone_state),
+                           resources(r::neighbor_grid),
+                           {},
+                           [](f32, u32, u32) { neighbors::update(); }});
+
+    _scheduler.add_system({"sensors",
+                           resources(r::drone_state),
+                           resources(r::sensor_data),
+                           {},
+                           [](f32 dt, u32, u32) { sensors::update(dt); }});
+
+    // Spreads its drone blocks over the job pool itself, the next tick's control reads the result
+    _scheduler.add_system({"estimator",
+                           resources(r::sensor_data, r::drone_state),
+                           resources(r::drone_estimate),
+                           {},
+                           [](f32, u32, u32) { estimator::update(); }});
+
+    _scheduler.add_system({"bridge_publish",
+                           resources(r::drone_state, r::sensor_data),
+                           resources(r::bridge),
+                           {},
+                           [](f32 dt, u32, u32) { bridge::publish(dt); }});
+
+    // Drone bodies follow the integrated state before the collision pass
+    _scheduler.add_system({"bullet",
+                           resources(r::drone_state),
+                           resources(r::physics_body),
+                           {},
+                           [this](f32 dt, u32, u32) { world->step_bodies(dt); }});
+
+    // Scripts may touch anything they can reach through their entity. In worker
+    // mode they run next to the whole tick instead and the system has nothing to do.
+    _scheduler.add_system({"scripts",
+                           resources(r::drone_state, r::physics_body),
+                           resources(r::script, r::transform),
+                           [] {
+                               return script::get_execution_mode() ==
+                                              script::execution_mode::inline_tick
+                                          ? 1u
+                                          : 0u;
+                           },
+                           [this](f32 dt, u32, u32) { update_script_components(dt); },
+                           0,
+                           false});
 }
 
+// TODO: ADD Exit Statuses etc (especially for physics)
+
+void GameLoop::update_script_components(f32 dt) { script::tick(dt); }
+
 } // namespace lark
\ No newline at end of file
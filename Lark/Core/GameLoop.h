@@ -11,12 +11,19 @@
 #include "../Common/CommonHeaders.h"
 #include "../Components/Entity.h"
 #include "../Components/Script.h"
+#include "../Components/ScriptExecution.h"
 #include "../Components/Transform.h"
 #include "../PhysicExtension/World/World.h"
+#include "FrameArena.h"
+#include "SystemScheduler.h"
 #include <PhysicExtension/World/WorldSettings.h>
 
 namespace lark
 {
+namespace replay
+{
+class recorder;
+}
 
 /**
  * @class GameLoop
@@ -37,9 +44,13 @@ class GameLoop
      */
     struct Config
     {
-        u32 target_fps = 60;               ///< Target frames per second
-        f32 fixed_timestep = 1.0f / 60.0f; ///< Fixed timestep for physics updates (in seconds)
-        bool show_fps = false;             ///< Whether to display FPS counter
+        u32 target_fps = 60;                      ///< Target frames per second
+        f32 fixed_timestep = 1.0f / 60.0f;        ///< Fixed timestep for physics updates (in seconds)
+        bool show_fps = false;                    ///< Whether to display FPS counter
+        u32 worker_threads = 0;                   ///< Job system threads, 0 uses all hardware threads
+        std::string script_directory = "scripts"; ///< Added to the Python module search path
+        bool background_script_startup = true;    ///< Start Python off the calling thread
+        script::execution_mode script_mode = script::execution_mode::inline_tick;
     };
 
     /**
@@ -76,6 +87,22 @@ class GameLoop
      */
     void tick();
 
+    /**
+     * @brief Processes a single frame with a given time step instead of the wall clock
+     * @param dt Time step in seconds
+     *
+     * Used by replays and to run faster than real time.
+     */
+    void step(f32 dt);
+
+    /**
+     * @brief Records every following tick, nullptr stops recording
+     * @param recorder Open recorder, owned by the caller
+     */
+    void set_recorder(replay::recorder *recorder) { _recorder = recorder; }
+
+    physics::World *get_world() const { return world; }
+
     /**
      * @brief Gets the time elapsed since last frame
      * @return Delta time in seconds
@@ -88,6 +115,21 @@ class GameLoop
      */
     u32 get_fps() const { return _fps; }
 
+    /**
+     * @brief Gets the cost of each simulation system
+     * @return One entry per system, in registration order
+     */
+    const util::vector<SystemTiming> &get_system_timings() const
+    {
+        return _scheduler.timings();
+    }
+
+    /**
+     * @brief Gets the heap allocations made during the last tick
+     * @return Allocation count, always 0 unless built with LARK_TRACK_ALLOCATIONS
+     */
+    u64 get_allocations_last_tick() const { return _allocations_last_tick; }
+
   private:
     /**
      * @brief Calculates time between frames
@@ -95,6 +137,16 @@ class GameLoop
      */
     f32 calculate_delta_time();
 
+    /**
+     * @brief Registers the simulation systems with the scheduler
+     */
+    void register_systems();
+
+    /**
+     * @brief Holds the Python runtime for this loop and preloads the registered scripts
+     */
+    void start_script_runtime();
+
     /**
      * @brief Updates transform components with fixed timestep
      * @param dt Fixed timestep duration
@@ -128,6 +180,12 @@ class GameLoop
 
     physics::World* world{nullptr};
     std::unique_ptr<physics::World> world_ptr;
+
+    SystemScheduler _scheduler;    ///< Runs the systems of a tick
+    u64 _allocations_last_tick{0}; ///< Heap allocations of the last tick
+    bool _holds_jobs{false};       ///< Whether this loop holds a job system reference
+    bool _holds_script_runtime{false}; ///< Whether this loop holds a script runtime reference
+    replay::recorder *_recorder{nullptr}; ///< Records the ticks when set
 };
 
 } // namespace lark
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include "JobSystem.h"
+#include "Context.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace lark::jobs
+{
+namespace
+{
+struct worker_queue
+{
+    std::mutex mutex;
+    util::deque<job> jobs;
+};
+
+util::vector<std::unique_ptr<worker_queue>> queues;
+util::vector<std::thread> workers;
+std::atomic<bool> running{false};
+std::atomic<u32> queued{0};
+std::atomic<u32> next_queue{0};
+
+std::mutex sleep_mutex;
+std::condition_variable wake;
+
+// Starting and stopping the pool happens under this lock, so sharing users cannot race
+std::mutex lifetime_mutex;
+u32 references{0};          ///< acquire() calls not yet released
+bool host_reference{false}; ///< Held between initialize() and shutdown()
+std::atomic<u32> pool_generation{0};
+
+thread_local u32 worker_index{u32_invalid_id};
+thread_local u32 worker_generation{0}; ///< Pool the index belongs to
+
+/**
+ * @brief Index of the calling thread in the running pool
+ *
+ * The thread that started a pool keeps its index when another thread stops
+ * the pool, the generation tells that it belongs to an older one.
+ */
+u32 own_index()
+{
+    return worker_generation == pool_generation.load(std::memory_order_acquire)
+               ? worker_index
+               : u32_invalid_id;
+}
+
+bool pop_back(u32 index, job &out)
+{
+    worker_queue &queue{*queues[index]};
+    std::lock_guard lock{queue.mutex};
+    if (queue.jobs.empty())
+        return false;
+
+    out = queue.jobs.back();
+    queue.jobs.pop_back();
+    return true;
+}
+
+bool steal(u32 thief, job &out)
+{
+    const u32 count{(u32)queues.size()};
+    for (u32 i{1}; i <= count; ++i)
+    {
+        worker_queue &queue{*queues[(thief + i) % count]};
+        std::lock_guard lock{queue.mutex};
+        if (!queue.jobs.empty())
+        {
+            out = queue.jobs.front();
+            queue.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void execute(const job &j)
+{
+    {
+        context_scope scope{*j.owner};
+        j.entry(j.data, j.begin, j.end);
+    }
+    if (j.done)
+        j.done->release();
+}
+
+bool try_execute_one()
+{
+    if (queued.load(std::memory_order_acquire) == 0)
+        return false;
+
+    const u32 self{own_index()};
+    job j{};
+    const bool found{self != u32_invalid_id ? (pop_back(self, j) || steal(self, j))
+                                             : steal(next_queue.load(std::memory_order_relaxed), j)};
+    if (!found)
+        return false;
+
+    queued.fetch_sub(1, std::memory_order_acq_rel);
+    execute(j);
+    return true;
+}
+
+void worker_main(u32 index, u32 generation)
+{
+    worker_index = index;
+    worker_generation = generation;
+    while (true)
+    {
+        if (try_execute_one())
+            continue;
+
+        std::unique_lock lock{sleep_mutex};
+        wake.wait(lock, [] {
+            return queued.load(std::memory_order_acquire) > 0 ||
+                   !running.load(std::memory_order_acquire);
+        });
+
+        if (!running.load(std::memory_order_acquire) &&
+            queued.load(std::memory_order_acquire) == 0)
+            break;
+    }
+    worker_index = u32_invalid_id;
+}
+
+/**
+ * @brief Starts the worker threads unless the pool runs, requires lifetime_mutex
+ */
+void start(u32 count)
+{
+    if (running.load(std::memory_order_acquire))
+        return;
+
+    if (count == 0)
+        count = std::max(1u, std::thread::hardware_concurrency());
+
+    queues.clear();
+    for (u32 i{0}; i < count; ++i)
+        queues.emplace_back(std::make_unique<worker_queue>());
+
+    const u32 generation{pool_generation.fetch_add(1, std::memory_order_acq_rel) + 1};
+    worker_index = 0;
+    worker_generation = generation;
+    running.store(true, std::memory_order_release);
+
+    workers.reserve(count - 1);
+    for (u32 i{1}; i < count; ++i)
+        workers.emplace_back(worker_main, i, generation);
+}
+
+/**
+ * @brief Joins the worker threads once nobody holds a reference, requires lifetime_mutex
+ */
+void stop_if_unused()
+{
+    if (references || host_reference || !running.load(std::memory_order_acquire))
+        return;
+
+    // Whatever is still queued gets executed by the workers before they exit
+    {
+        std::lock_guard lock{sleep_mutex};
+        running.store(false, std::memory_order_release);
+    }
+    wake.notify_all();
+
+    for (auto &worker : workers)
+        worker.join();
+
+    // A pool without extra workers leaves its jobs to the stopping thread
+    while (try_execute_one())
+    {
+    }
+
+    workers.clear();
+    queues.clear();
+    worker_index = u32_invalid_id;
+}
+} // namespace
+
+namespace detail
+{
+u32 default_chunk_size(u32 count)
+{
+    // A few chunks per thread leaves room for stealing when chunks are uneven
+    const u32 chunks{thread_count() * 4};
+    return std::max(1u, (count + chunks - 1) / chunks);
+}
+} // namespace detail
+
+void initialize(u32 count)
+{
+    std::lock_guard lock{lifetime_mutex};
+    host_reference = true;
+    start(count);
+}
+
+void shutdown()
+{
+    std::lock_guard lock{lifetime_mutex};
+    host_reference = false;
+    stop_if_unused();
+}
+
+void acquire(u32 count)
+{
+    std::lock_guard lock{lifetime_mutex};
+    ++references;
+    start(count);
+}
+
+void release()
+{
+    std::lock_guard lock{lifetime_mutex};
+    assert(references);
+    if (references)
+        --references;
+    stop_if_unused();
+}
+
+bool is_running() { return running.load(std::memory_order_acquire); }
+
+u32 thread_count() { return is_running() ? (u32)queues.size() : 1; }
+
+u32 thread_index() { return own_index(); }
+
+void submit(const job &j)
+{
+    assert(j.entry);
+    if (!is_running())
+    {
+        j.entry(j.data, j.begin, j.end);
+        return;
+    }
+
+    if (j.done)
+        j.done->add();
+
+    job queued_job{j};
+    if (!queued_job.owner)
+        queued_job.owner = &context::current();
+
+    const u32 self{own_index()};
+    const u32 target{self != u32_invalid_id
+                         ? self
+                         : next_queue.fetch_add(1, std::memory_order_relaxed) % (u32)queues.size()};
+    {
+        worker_queue &queue{*queues[target]};
+        std::lock_guard lock{queue.mutex};
+        queue.jobs.push_back(queued_job);
+    }
+    queued.fetch_add(1, std::memory_order_acq_rel);
+
+    // Taking the lock orders the increment against a worker checking the predicate
+    {
+        std::lock_guard lock{sleep_mutex};
+    }
+    wake.notify_one();
+}
+
+void task_group::run(task fn)
+{
+    assert(fn);
+    _done.add();
+    _tasks.fetch_add(1, std::memory_order_relaxed);
+    submit(job{&task_group::run_task, new task_holder{std::move(fn), this}, 0, 0, nullptr});
+}
+
+void task_group::then(task fn)
+{
+    assert(fn);
+
+    // One count for the continuation itself, one guard that makes then() behave like a
+    // finishing task, so the last task cannot miss the registration
+    _done.add(2);
+    _tasks.fetch_add(1, std::memory_order_relaxed);
+
+    task_holder *previous{_continuation.exchange(new task_holder{std::move(fn), this},
+                                                 std::memory_order_acq_rel)};
+    assert(!previous);
+    (void)previous;
+
+    task_finished();
+}
+
+void task_group::run_task(void *data, u32, u32)
+{
+    std::unique_ptr<task_holder> holder{static_cast<task_holder *>(data)};
+    holder->fn();
+    holder->group->task_finished();
+}
+
+void task_group::run_continuation(void *data, u32, u32)
+{
+    std::unique_ptr<task_holder> holder{static_cast<task_holder *>(data)};
+    task_group *group{holder->group};
+    holder->fn();
+    group->_done.release();
+}
+
+void task_group::task_finished()
+{
+    if (_tasks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        if (task_holder *next{_continuation.exchange(nullptr, std::memory_order_acq_rel)})
+        {
+            // Already counted in _done by then()
+            submit(job{&task_group::run_continuation, next, 0, 0, nullptr});
+        }
+    }
+
+    // Last, so the group stays alive for everything above
+    _done.release();
+}
+
+void wait(const counter &c)
+{
+    while (!c.is_done())
+    {
+        if (!try_execute_one())
+            std::this_thread::yield();
+    }
+}
+
+} // namespace lark::jobs
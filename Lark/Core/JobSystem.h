@@ -0,0 +1,232 @@
+/**
+ * @file JobSystem.h
+ * @brief Work-stealing thread pool shared by the engine
+ *
+ * Every worker owns a deque of jobs. Workers push and pop at the back of their
+ * own deque and steal from the front of the others when they run dry. Threads
+ * waiting on a counter keep executing jobs instead of blocking, so jobs may
+ * spawn and wait on nested work without deadlocking the pool.
+ *
+ * Geometry processing, the simulation systems and any other engine code share
+ * this one pool, so nested parallel work never oversubscribes the machine.
+ * Jobs run in the context of the thread that submitted them, so contexts
+ * stepped on different threads can share the pool.
+ */
+
+#pragma once
+#include "../Common/CommonHeaders.h"
+#include <atomic>
+#include <functional>
+#include <type_traits>
+
+namespace lark
+{
+class context;
+}
+
+namespace lark::jobs
+{
+
+/**
+ * @class counter
+ * @brief Number of outstanding jobs a caller can wait on
+ */
+class counter
+{
+  public:
+    counter() = default;
+    counter(const counter &) = delete;
+    counter &operator=(const counter &) = delete;
+
+    bool is_done() const { return _pending.load(std::memory_order_acquire) == 0; }
+
+    void add(u32 count = 1) { _pending.fetch_add(count, std::memory_order_relaxed); }
+    void release() { _pending.fetch_sub(1, std::memory_order_acq_rel); }
+
+  private:
+    std::atomic<u32> _pending{0};
+};
+
+/**
+ * @struct job
+ * @brief Unit of work executed by the pool
+ *
+ * Jobs are plain values so they can be queued without allocating. The entry
+ * point receives the opaque data pointer and the [begin, end) range it covers.
+ */
+struct job
+{
+    void (*entry)(void *data, u32 begin, u32 end){nullptr};
+    void *data{nullptr};
+    u32 begin{0};
+    u32 end{0};
+    counter *done{nullptr}; ///< Decremented once the job finished (optional)
+    context *owner{nullptr}; ///< Bound while the job runs, submit() fills in the caller's
+};
+
+/**
+ * @brief Starts the worker threads on behalf of the host
+ * @param thread_count Total number of threads including the caller, 0 picks the
+ * hardware concurrency
+ *
+ * The thread that starts the pool becomes worker 0 and helps out whenever it
+ * waits. A pool that already runs keeps its thread count.
+ */
+void initialize(u32 thread_count = 0);
+
+/**
+ * @brief Ends the host's use of the pool
+ *
+ * Joins all worker threads once no acquire() reference is left either.
+ * Pending jobs are executed first.
+ */
+void shutdown();
+
+/**
+ * @brief Takes a reference on the pool, starting it if nobody runs it yet
+ * @param thread_count Used only if this call starts the pool, see initialize()
+ *
+ * For users that share the pool, e.g. one game loop per context. The pool
+ * stops when the last reference is released and the host did not initialize it.
+ */
+void acquire(u32 thread_count = 0);
+
+/**
+ * @brief Drops a reference taken by acquire()
+ */
+void release();
+
+/**
+ * @brief Whether the pool has been initialized
+ */
+bool is_running();
+
+/**
+ * @brief Number of threads executing jobs, including the owning thread
+ */
+u32 thread_count();
+
+/**
+ * @brief Index of the calling thread inside the pool, u32_invalid_id for foreign threads
+ */
+u32 thread_index();
+
+/**
+ * @brief Queues a job. Runs it inline if the pool is not running.
+ */
+void submit(const job &j);
+
+/**
+ * @brief Executes queued jobs until the counter reaches zero
+ */
+void wait(const counter &c);
+
+/**
+ * @brief Splits [0, count) into chunks and runs body(begin, end) on the pool
+ * @param count Number of items
+ * @param chunk_size Items per job, 0 picks a size giving a few chunks per thread
+ * @param body Callable taking (u32 begin, u32 end)
+ *
+ * Returns once every chunk has been processed. The calling thread executes
+ * chunks as well, and nested calls from inside a job are allowed.
+ */
+template <typename Fn> void parallel_for(u32 count, u32 chunk_size, Fn &&body);
+
+/**
+ * @class task_group
+ * @brief Set of heterogeneous tasks that can be waited on together
+ *
+ * A continuation registered with then() is queued as soon as every task
+ * spawned so far has finished; wait() returns after the continuation ran.
+ * Tasks and continuations may spawn further tasks into the same group.
+ */
+class task_group
+{
+  public:
+    using task = std::function<void()>;
+
+    task_group() = default;
+    ~task_group() { wait(); }
+    task_group(const task_group &) = delete;
+    task_group &operator=(const task_group &) = delete;
+
+    /**
+     * @brief Queues a task on the pool
+     */
+    void run(task fn);
+
+    /**
+     * @brief Queues fn once all tasks spawned so far are done
+     *
+     * Only one continuation can be pending at a time.
+     */
+    void then(task fn);
+
+    /**
+     * @brief Executes jobs until all tasks and the continuation finished
+     */
+    void wait() { jobs::wait(_done); }
+
+    bool is_done() const { return _done.is_done(); }
+
+  private:
+    struct task_holder
+    {
+        task fn;
+        task_group *group;
+    };
+
+    static void run_task(void *data, u32, u32);
+    static void run_continuation(void *data, u32, u32);
+    void task_finished();
+
+    counter _done;                             ///< Tasks plus pending continuation
+    std::atomic<u32> _tasks{0};                ///< Tasks the continuation waits for
+    std::atomic<task_holder *> _continuation{nullptr};
+};
+
+namespace detail
+{
+u32 default_chunk_size(u32 count);
+
+template <typename Fn> void invoke_range(void *data, u32 begin, u32 end)
+{
+    (*static_cast<Fn *>(data))(begin, end);
+}
+} // namespace detail
+
+template <typename Fn> void parallel_for(u32 count, u32 chunk_size, Fn &&body)
+{
+    using body_type = std::remove_reference_t<Fn>;
+
+    if (count == 0)
+        return;
+
+    if (chunk_size == 0)
+        chunk_size = detail::default_chunk_size(count);
+
+    if (!is_running() || count <= chunk_size)
+    {
+        body(0u, count);
+        return;
+    }
+
+    counter done;
+    job j{};
+    j.entry = &detail::invoke_range<body_type>;
+    j.data = const_cast<void *>(static_cast<const void *>(&body));
+    j.done = &done;
+
+    // Keep the first chunk for the calling thread
+    for (u32 begin{chunk_size}; begin < count; begin += chunk_size)
+    {
+        j.begin = begin;
+        j.end = std::min(begin + chunk_size, count);
+        submit(j);
+    }
+
+    body(0u, chunk_size);
+    wait(done);
+}
+
+} // namespace lark::jobs
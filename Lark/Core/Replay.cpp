@@ -0,0 +1,309 @@
+#include "Replay.h"
+#include "GameLoop.h"
+#include "WorldSnapshot.h"
+#include "Components/ChangeTracking.h"
+#include "Utils/Random.h"
+#include <algorithm>
+
+namespace lark::replay
+{
+namespace
+{
+constexpr u32 log_magic{0x504b524c}; // "LRKP"
+constexpr u32 log_version{6};
+
+enum class chunk : u8
+{
+    tick,
+    checkpoint
+};
+
+/**
+ * @brief Commands are written field by field, the struct has padding
+ */
+void write_command(util::byte_writer &out, const script::command &cmd)
+{
+    out.write(cmd.type);
+    out.write(cmd.entity);
+    out.write(cmd.values);
+}
+
+bool read_command(util::byte_reader &in, script::command &cmd)
+{
+    return in.read(cmd.type) && in.read(cmd.entity) && in.read(cmd.values);
+}
+
+void write_bridged(util::byte_writer &out, const bridge::applied_command &cmd)
+{
+    out.write(cmd.index);
+    out.write(cmd.entity);
+    out.write(cmd.command);
+}
+
+bool read_bridged(util::byte_reader &in, bridge::applied_command &cmd)
+{
+    return in.read(cmd.index) && in.read(cmd.entity) && in.read(cmd.command);
+}
+} // namespace
+
+void capture_checkpoint(GameLoop &loop, util::byte_writer &out)
+{
+    world_snapshot::capture(loop.get_world()).write(out);
+}
+
+bool restore_checkpoint(GameLoop &loop, util::byte_reader &in)
+{
+    world_snapshot snapshot{};
+    return snapshot.read(in) && snapshot.restore(loop.get_world());
+}
+
+bool recorder::open(const char *path, u32 checkpoint_interval)
+{
+    close();
+    _file = std::fopen(path, "wb");
+    if (!_file)
+        return false;
+
+    _checkpoint_interval = checkpoint_interval;
+    _tick = 0;
+    _column_writes = script::column_write_count();
+    _failed = false;
+    _buffer.clear();
+    _buffer.write(log_magic);
+    _buffer.write(log_version);
+    _buffer.write(random::get_seed());
+    flush();
+    return !_failed;
+}
+
+bool recorder::close()
+{
+    if (!_file)
+        return !_failed;
+
+    flush();
+    if (std::fclose(_file) != 0)
+        _failed = true;
+    _file = nullptr;
+    return !_failed;
+}
+
+void recorder::begin_tick(GameLoop &loop)
+{
+    if (!_file)
+        return;
+
+    // Stamps of the current frame were made after the last tick, views count their writes
+    const u64 column_writes{script::column_write_count()};
+    const bool external{changes::last_stamped_frame() == changes::current_frame() ||
+                        column_writes != _column_writes};
+    _column_writes = column_writes;
+
+    if (_tick == 0 || external || (_checkpoint_interval && _tick % _checkpoint_interval == 0))
+    {
+        util::byte_writer state;
+        capture_checkpoint(loop, state);
+
+        _buffer.write(chunk::checkpoint);
+        _buffer.write(_tick);
+        _buffer.write((u8)(_tick && external));
+        _buffer.write((u64)state.size());
+        _buffer.write_bytes(state.data(), state.size());
+    }
+}
+
+void recorder::end_tick(f32 dt, const util::vector<script::command> &commands,
+                        const util::vector<bridge::applied_command> &bridged)
+{
+    if (!_file)
+        return;
+
+    _buffer.write(chunk::tick);
+    _buffer.write(dt);
+    _buffer.write((u32)commands.size());
+    for (const auto &cmd : commands)
+        write_command(_buffer, cmd);
+    _buffer.write((u32)bridged.size());
+    for (const auto &cmd : bridged)
+        write_bridged(_buffer, cmd);
+    ++_tick;
+
+    // Keeps the tick cheap: the file is written in blocks, not per tick
+    if (_buffer.size() > (size_t{1} << 16))
+        flush();
+}
+
+void recorder::flush()
+{
+    // A short write (e.g. a full disk) loses ticks, the log stays marked as failed
+    if (_buffer.size() && std::fwrite(_buffer.data(), 1, _buffer.size(), _file) != _buffer.size())
+        _failed = true;
+    _buffer.clear();
+}
+
+bool replayer::open(const char *path)
+{
+    _data.clear();
+    _ticks.clear();
+    _commands.clear();
+    _bridged.clear();
+    _checkpoints.clear();
+    _next_tick = 0;
+    _restored = false;
+
+    std::FILE *file{std::fopen(path, "rb")};
+    if (!file)
+        return false;
+
+    std::fseek(file, 0, SEEK_END);
+    const long size{std::ftell(file)};
+    std::fseek(file, 0, SEEK_SET);
+    _data.resize(size > 0 ? (size_t)size : 0);
+    const size_t read{std::fread(_data.data(), 1, _data.size(), file)};
+    std::fclose(file);
+    if (read != _data.size())
+        return false;
+
+    util::byte_reader in{_data.data(), _data.size()};
+    u32 magic{0}, version{0};
+    if (!in.read(magic) || !in.read(version) || !in.read(_seed) || magic != log_magic ||
+        version != log_version)
+        return false;
+
+    while (in.ok() && !in.at_end())
+    {
+        chunk type{};
+        if (!in.read(type))
+            break;
+
+        if (type == chunk::checkpoint)
+        {
+            checkpoint_record checkpoint{};
+            u64 size{0};
+            u8 external{0};
+            in.read(checkpoint.tick);
+            in.read(external);
+            in.read(size);
+            checkpoint.external = external != 0;
+            checkpoint.offset = in.offset();
+            checkpoint.size = (size_t)size;
+            if (!in.skip(checkpoint.size))
+                break;
+            _checkpoints.push_back(checkpoint);
+        }
+        else if (type == chunk::tick)
+        {
+            tick_record tick{};
+            in.read(tick.dt);
+            in.read(tick.command_count);
+            tick.first_command = (u32)_commands.size();
+            for (u32 i{0}; i < tick.command_count; ++i)
+            {
+                script::command cmd{};
+                if (!read_command(in, cmd))
+                    break;
+                _commands.push_back(cmd);
+            }
+            in.read(tick.bridged_count);
+            tick.first_bridged = (u32)_bridged.size();
+            for (u32 i{0}; i < tick.bridged_count && in.ok(); ++i)
+            {
+                bridge::applied_command cmd{};
+                if (!read_bridged(in, cmd))
+                    break;
+                _bridged.push_back(cmd);
+            }
+            if (!in.ok())
+                break;
+            _ticks.push_back(tick);
+        }
+        else
+        {
+            // Chunks have no length prefix, nothing after an unknown one can be trusted
+            return false;
+        }
+    }
+
+    // A log cut off mid-tick (e.g. by a crash) keeps all complete ticks
+    return !_checkpoints.empty() && _checkpoints.front().tick == 0;
+}
+
+void replayer::apply_seed() const { random::set_seed(_seed); }
+
+bool replayer::start(GameLoop &loop)
+{
+    // The recording is the only input, a live client would steer the drones a second time
+    script::set_execution_mode(script::execution_mode::disabled);
+    bridge::suspend(true);
+    return seek(loop, 0);
+}
+
+bool replayer::step(GameLoop &loop)
+{
+    if (_next_tick >= _ticks.size())
+        return false;
+
+    // The host wrote state before this tick, which only the checkpoint knows
+    if (!_restored)
+    {
+        const auto next = std::upper_bound(
+            _checkpoints.begin(), _checkpoints.end(), _next_tick,
+            [](u64 tick, const checkpoint_record &checkpoint) { return tick < checkpoint.tick; });
+        if (next != _checkpoints.begin() && (next - 1)->tick == _next_tick &&
+            (next - 1)->external && !restore(loop, *(next - 1)))
+            return false;
+    }
+    _restored = false;
+
+    const tick_record &tick{_ticks[_next_tick]};
+    for (u32 i{0}; i < tick.command_count; ++i)
+        script::queue_command(_commands[tick.first_command + i]);
+    bridge::inject_commands(_bridged.data() + tick.first_bridged, tick.bridged_count);
+
+    loop.step(tick.dt);
+    ++_next_tick;
+    return true;
+}
+
+bool replayer::restore(GameLoop &loop, const checkpoint_record &checkpoint)
+{
+    util::byte_reader in{_data.data() + checkpoint.offset, checkpoint.size};
+    return restore_checkpoint(loop, in);
+}
+
+void replayer::run(GameLoop &loop)
+{
+    while (step(loop))
+    {
+    }
+}
+
+bool replayer::seek(GameLoop &loop, u64 tick)
+{
+    if (tick > _ticks.size() || _checkpoints.empty())
+        return false;
+
+    const checkpoint_record *checkpoint{&_checkpoints.front()};
+    for (const auto &candidate : _checkpoints)
+    {
+        if (candidate.tick <= tick)
+            checkpoint = &candidate;
+    }
+
+    // Commands queued for the tick we leave would otherwise land on the restored state
+    script::discard_commands();
+
+    if (!restore(loop, *checkpoint))
+        return false;
+
+    _next_tick = checkpoint->tick;
+    _restored = true;
+    while (_next_tick < tick)
+    {
+        if (!step(loop))
+            return false;
+    }
+    return true;
+}
+
+} // namespace lark::replay
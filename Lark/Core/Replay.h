@@ -0,0 +1,188 @@
+/**
+ * @file Replay.h
+ * @brief Deterministic recording and replay of simulation runs
+ *
+ * A recording holds the engine seed, a checkpoint of the simulated state at
+ * the first tick and then every checkpoint_interval ticks, and for every tick
+ * its time step, the script commands applied at its sync point and the
+ * commands the bridge applied. Replaying rebuilds the same scene, restores
+ * the first checkpoint and feeds the ticks back with scripts disabled and the
+ * bridge suspended, so the run repeats bit for bit and as fast as the systems
+ * allow.
+ *
+ * Everything else that writes state is caught by the recorder: when a
+ * component was written between two ticks (host setters, drone::set_control,
+ * the EngineDLL) or through a writable view, the next tick gets a checkpoint
+ * that the replay restores instead of recomputing the tick's start. Settings
+ * that are not component state, e.g. the wind model or the LOD policy, must
+ * not change while recording.
+ *
+ * Checkpoints are serialized world snapshots, see WorldSnapshot.h. Entities must be
+ * created by the host in the same order before recording and before
+ * replaying, since creation draws seeds from the engine stream.
+ */
+
+#pragma once
+#include "../Common/CommonHeaders.h"
+#include "../Components/Bridge.h"
+#include "../Components/ScriptExecution.h"
+#include "../Utils/BinaryStream.h"
+#include <cstdio>
+
+namespace lark
+{
+class GameLoop;
+}
+
+namespace lark::replay
+{
+
+/**
+ * @brief Writes a snapshot of the world the loop simulates
+ */
+void capture_checkpoint(GameLoop &loop, util::byte_writer &out);
+
+/**
+ * @brief Restores a checkpoint written by capture_checkpoint
+ * @return false if the scene does not match the one the checkpoint was taken from
+ */
+bool restore_checkpoint(GameLoop &loop, util::byte_reader &in);
+
+/**
+ * @class recorder
+ * @brief Appends the ticks of a GameLoop to a binary log
+ */
+class recorder
+{
+  public:
+    recorder() = default;
+    recorder(const recorder &) = delete;
+    recorder &operator=(const recorder &) = delete;
+    ~recorder() { close(); }
+
+    /**
+     * @brief Creates the log, call before the first recorded tick
+     * @param checkpoint_interval Ticks between checkpoints, 0 only writes the first one
+     */
+    bool open(const char *path, u32 checkpoint_interval = 600);
+
+    /**
+     * @brief Writes the buffered ticks and closes the log
+     * @return false if any write since open failed, the log is then incomplete
+     */
+    bool close();
+    bool is_open() const { return _file != nullptr; }
+
+    /**
+     * @brief Whether every write since open succeeded
+     */
+    bool ok() const { return !_failed; }
+
+    /**
+     * @brief Called by the game loop before the sync point of a tick
+     *
+     * Writes a checkpoint when one is due or state was written from outside
+     * the recorded inputs since the last tick.
+     */
+    void begin_tick(GameLoop &loop);
+
+    /**
+     * @brief Called by the game loop once the systems of the tick ran
+     * @param commands Script commands applied at the sync point of the tick
+     * @param bridged Commands the bridge applied during the tick
+     */
+    void end_tick(f32 dt, const util::vector<script::command> &commands,
+                  const util::vector<bridge::applied_command> &bridged);
+
+    u64 tick_count() const { return _tick; }
+
+  private:
+    void flush();
+
+    std::FILE *_file{nullptr};
+    util::byte_writer _buffer;
+    u32 _checkpoint_interval{0};
+    u64 _tick{0};
+    u64 _column_writes{0}; ///< script::column_write_count() at the last tick
+    bool _failed{false}; ///< A write failed, sticky until the next open
+};
+
+/**
+ * @class replayer
+ * @brief Plays a log back into a GameLoop
+ */
+class replayer
+{
+  public:
+    /**
+     * @brief Loads and indexes a log
+     * @return false if the file is missing or malformed
+     */
+    bool open(const char *path);
+
+    /**
+     * @brief Sets the engine seed of the recording, call before creating the scene
+     */
+    void apply_seed() const;
+
+    /**
+     * @brief Restores the first checkpoint, disables scripts and suspends the bridge
+     * @return false if the scene does not match the recording
+     *
+     * The bridge stays suspended until the host calls bridge::suspend(false).
+     */
+    bool start(GameLoop &loop);
+
+    /**
+     * @brief Replays the next tick
+     * @return false once the recording is exhausted or a checkpoint failed to restore
+     */
+    bool step(GameLoop &loop);
+
+    /**
+     * @brief Replays all remaining ticks
+     */
+    void run(GameLoop &loop);
+
+    /**
+     * @brief Jumps to the start of a tick
+     *
+     * Restores the last checkpoint at or before the tick and replays from there.
+     * Script commands queued but not yet applied are dropped.
+     */
+    bool seek(GameLoop &loop, u64 tick);
+
+    u64 tick_count() const { return (u64)_ticks.size(); }
+    u64 current_tick() const { return _next_tick; }
+
+  private:
+    struct tick_record
+    {
+        f32 dt{0.f};
+        u32 first_command{0};
+        u32 command_count{0};
+        u32 first_bridged{0};
+        u32 bridged_count{0};
+    };
+
+    struct checkpoint_record
+    {
+        u64 tick{0};
+        size_t offset{0};
+        size_t size{0};
+        bool external{false}; ///< State was written from outside, restored when reached
+    };
+
+    bool restore(GameLoop &loop, const checkpoint_record &checkpoint);
+
+    util::vector<u8> _data;
+    util::vector<tick_record> _ticks;
+    util::vector<script::command> _commands;
+    util::vector<bridge::applied_command> _bridged;
+    util::vector<checkpoint_record> _checkpoints;
+    u64 _seed{0};
+    u64 _next_tick{0};
+    bool _restored{false}; ///< The state is the checkpoint of _next_tick already
+};
+
+} // namespace lark::replay
@@ -0,0 +1,634 @@
+#include "Sharding.h"
+#include "Components/Drone.h"
+#include "Components/Entity.h"
+#include "Components/Neighbors.h"
+#include "Components/Transform.h"
+#include "Context.h"
+#include "JobSystem.h"
+#include "PhysicExtension/World/World.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <new>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/prctl.h>
+#endif
+
+namespace lark::shard
+{
+namespace
+{
+enum op : u32
+{
+    op_step,
+    op_publish,
+    op_stop,
+};
+
+// Box directions, towards the shard below and above
+constexpr u32 lower{0};
+constexpr u32 upper{1};
+
+// How long the coordinator sleeps between checks on its workers
+constexpr u32 liveness_interval_us{50'000};
+
+/**
+ * @struct control_block
+ * @brief Start of the shared mapping
+ */
+struct control_block
+{
+    ipc::process_barrier lockstep; ///< Coordinator and workers, around every command
+    ipc::process_barrier exchange; ///< Workers only, once per tick
+    u32 op{op_step};
+    u32 ticks{0};
+};
+
+/**
+ * @struct shard_block
+ * @brief Counters and box sizes a worker writes, indexed [parity][direction]
+ */
+struct shard_block
+{
+    shard_stats stats;
+    u32 migrations[2][2];
+    u32 halos[2][2];
+    u32 published;
+};
+
+constexpr size_t align_up(size_t value) { return (value + 63) & ~(size_t)63; }
+
+/**
+ * @struct layout
+ * @brief Byte offsets inside the shared mapping
+ */
+struct layout
+{
+    explicit layout(const config &c)
+    {
+        migrations = align_up(sizeof(shard_block));
+        halos = migrations + align_up(4 * (size_t)c.max_transfers * sizeof(drone_record));
+        snapshot = halos + align_up(4 * (size_t)c.max_transfers * sizeof(ghost_record));
+        shard_size = snapshot + align_up((size_t)c.max_drones * sizeof(drone_record));
+        shards = align_up(sizeof(control_block));
+        total = shards + shard_size * c.shards;
+    }
+
+    size_t shards;
+    size_t shard_size;
+    size_t migrations;
+    size_t halos;
+    size_t snapshot;
+    size_t total;
+};
+
+/**
+ * @struct shared_view
+ * @brief Typed access to the shared mapping, valid in the coordinator and every worker
+ */
+struct shared_view
+{
+    shared_view(void *data, const config &c)
+        : base{static_cast<u8 *>(data)}, offsets{c}, max_transfers{c.max_transfers}
+    {
+    }
+
+    control_block &control() const { return *reinterpret_cast<control_block *>(base); }
+
+    u8 *shard(u32 index) const { return base + offsets.shards + offsets.shard_size * index; }
+
+    shard_block &block(u32 index) const { return *reinterpret_cast<shard_block *>(shard(index)); }
+
+    drone_record *migrations(u32 index, u32 parity, u32 direction) const
+    {
+        auto *boxes = reinterpret_cast<drone_record *>(shard(index) + offsets.migrations);
+        return boxes + (size_t)(parity * 2 + direction) * max_transfers;
+    }
+
+    ghost_record *halos(u32 index, u32 parity, u32 direction) const
+    {
+        auto *boxes = reinterpret_cast<ghost_record *>(shard(index) + offsets.halos);
+        return boxes + (size_t)(parity * 2 + direction) * max_transfers;
+    }
+
+    drone_record *snapshot(u32 index) const
+    {
+        return reinterpret_cast<drone_record *>(shard(index) + offsets.snapshot);
+    }
+
+    u8 *base;
+    layout offsets;
+    u32 max_transfers;
+};
+
+using clock = std::chrono::steady_clock;
+
+/**
+ * @class worker
+ * @brief Simulates one slab, runs in its own process and context
+ */
+class worker
+{
+  public:
+    worker(const config &c, const shared_view &view, u32 shard, physics::World &world)
+        : _config{c}, _view{view}, _shard{shard}, _world{world}
+    {
+        _width = (c.max_x - c.min_x) / (f32)c.shards;
+        _lower_edge = c.min_x + _width * (f32)shard;
+        _upper_edge = _lower_edge + _width;
+#if defined(__linux__) || defined(__APPLE__)
+        _coordinator = (s32)getppid();
+#endif
+    }
+
+    void run(const drone_record *drones, u32 count)
+    {
+        for (u32 i{0}; i < count; ++i)
+        {
+            if (shard_of(drones[i].position[0]) == _shard)
+                spawn(drones[i]);
+        }
+        publish_stats();
+
+        control_block &control{_view.control()};
+        for (;;)
+        {
+            wait(control.lockstep, control.lockstep.arrive());
+            if (control.op == op_stop)
+                return;
+
+            if (control.op == op_step)
+            {
+                for (u32 i{0}; i < control.ticks; ++i)
+                    tick();
+            }
+            else if (control.op == op_publish)
+            {
+                publish();
+            }
+            publish_stats();
+            wait(control.lockstep, control.lockstep.arrive());
+        }
+    }
+
+  private:
+    /**
+     * @struct local_drone
+     * @brief What a drone carries between shards besides its state, by entity index
+     */
+    struct local_drone
+    {
+        u64 key{0};
+        f32 setpoint[3]{};
+        f32 user[4]{};
+    };
+
+    /**
+     * @brief Shard whose slab contains x, NaN belongs to the first shard
+     *
+     * Every shard has to agree on the owner of a drone, a NaN position would
+     * otherwise make the conversion undefined.
+     */
+    u32 shard_of(f32 x) const
+    {
+        const f32 slab{std::floor((x - _config.min_x) / _width)};
+        if (std::isnan(slab))
+            return 0;
+        return (u32)std::clamp(slab, 0.f, (f32)(_config.shards - 1));
+    }
+
+    /**
+     * @brief Waits for a barrier generation, ends the process once the coordinator is gone
+     *
+     * A worker that dies is noticed by the coordinator, which then kills the
+     * others, so only the coordinator has to be watched here. Linux kills
+     * orphaned workers anyway; this covers platforms without a parent-death signal.
+     */
+    void wait(ipc::process_barrier &barrier, u32 generation) const
+    {
+        while (!barrier.wait(generation, liveness_interval_us))
+        {
+#if defined(__linux__) || defined(__APPLE__)
+            if ((s32)getppid() != _coordinator)
+            {
+                fflush(nullptr);
+                _exit(1);
+            }
+#endif
+        }
+    }
+
+    void spawn(const drone_record &r)
+    {
+        transform::init_info transform_info{};
+        std::copy_n(r.position, 3, transform_info.position);
+        std::copy_n(r.attitude, 4, transform_info.rotation);
+
+        const drone::Vector3f setpoint{r.setpoint[0], r.setpoint[1], r.setpoint[2]};
+        drone::init_info drone_info{};
+        drone_info.params = _config.params;
+        drone_info.abstraction = _config.abstraction;
+        drone_info.trajectory = std::make_shared<drone::Circular>(setpoint, 0.f, 0.f);
+        drone::DroneState &state{drone_info.initial_state};
+        state.position = {r.position[0], r.position[1], r.position[2]};
+        state.velocity = {r.velocity[0], r.velocity[1], r.velocity[2]};
+        state.attitude = {r.attitude[0], r.attitude[1], r.attitude[2], r.attitude[3]};
+        state.body_rates = {r.body_rates[0], r.body_rates[1], r.body_rates[2]};
+        state.wind.setZero();
+        state.rotor_speeds = {r.rotor_speeds[0], r.rotor_speeds[1], r.rotor_speeds[2],
+                              r.rotor_speeds[3]};
+        drone_info.last_control.cmd_motor_speeds = state.rotor_speeds;
+        if (_config.prepare)
+            _config.prepare(r, drone_info);
+
+        game_entity::entity_info info{};
+        info.transform = &transform_info;
+        info.drone = &drone_info;
+        const id::id_type index{id::index(game_entity::create(info).get_id())};
+
+        if (index >= _local.size())
+            _local.resize(index + 1);
+        local_drone &local{_local[index]};
+        local.key = r.key;
+        std::copy_n(r.setpoint, 3, local.setpoint);
+        std::copy_n(r.user, 4, local.user);
+    }
+
+    drone_record record_of(u32 index) const
+    {
+        const drone::DroneState &state{drone::state_at(index)};
+        const local_drone &local{_local[id::index(drone::entity_at(index))]};
+
+        drone_record r{};
+        r.key = local.key;
+        for (u32 k{0}; k < 3; ++k)
+        {
+            r.position[k] = state.position[k];
+            r.velocity[k] = state.velocity[k];
+            r.body_rates[k] = state.body_rates[k];
+        }
+        for (u32 k{0}; k < 4; ++k)
+        {
+            r.attitude[k] = state.attitude[k];
+            r.rotor_speeds[k] = state.rotor_speeds[k];
+        }
+        std::copy_n(local.setpoint, 3, r.setpoint);
+        std::copy_n(local.user, 4, r.user);
+        return r;
+    }
+
+    ghost_record ghost_of(u32 index) const
+    {
+        const drone::DroneState &state{drone::state_at(index)};
+        ghost_record g{};
+        g.key = _local[id::index(drone::entity_at(index))].key;
+        for (u32 k{0}; k < 3; ++k)
+        {
+            g.position[k] = state.position[k];
+            g.velocity[k] = state.velocity[k];
+        }
+        for (u32 k{0}; k < 4; ++k)
+        {
+            g.attitude[k] = state.attitude[k];
+            g.rotor_speeds[k] = state.rotor_speeds[k];
+        }
+        return g;
+    }
+
+    void tick()
+    {
+        const auto start{clock::now()};
+        _world.update(_config.dt);
+        _step_time += std::chrono::duration<f64>(clock::now() - start).count();
+
+        const u32 parity{(u32)(_ticks & 1)};
+        export_boxes(parity);
+
+        control_block &control{_view.control()};
+        wait(control.exchange, control.exchange.arrive());
+
+        import_boxes(parity);
+        if (_config.after_exchange)
+            _config.after_exchange(_shard, _ghosts.data(), (u32)_ghosts.size());
+        ++_ticks;
+    }
+
+    /**
+     * @brief Writes leaving and boundary drones to this shard's boxes of the tick
+     *
+     * Drones only move to adjacent shards, one that skipped a slab is
+     * forwarded again by the next shard.
+     */
+    void export_boxes(u32 parity)
+    {
+        shard_block &block{_view.block(_shard)};
+        u32 migrations[2]{};
+        u32 halos[2]{};
+        const bool has_lower{_shard > 0};
+        const bool has_upper{_shard + 1 < _config.shards};
+
+        _leaving.clear();
+        const u32 count{drone::count()};
+        for (u32 i{0}; i < count; ++i)
+        {
+            const f32 x{drone::state_at(i).position.x()};
+            const u32 target{shard_of(x)};
+            if (target != _shard)
+            {
+                const u32 direction{target < _shard ? lower : upper};
+                if (migrations[direction] < _config.max_transfers)
+                {
+                    _view.migrations(_shard, parity, direction)[migrations[direction]++] =
+                        record_of(i);
+                    _leaving.push_back(drone::entity_at(i));
+                }
+                else
+                {
+                    ++_deferred;
+                }
+                continue;
+            }
+
+            // Ghosts over the box size are not mirrored this tick, the next one sends them again
+            const auto mirror = [&](u32 direction) {
+                if (halos[direction] < _config.max_transfers)
+                    _view.halos(_shard, parity, direction)[halos[direction]++] = ghost_of(i);
+                else
+                    ++_dropped_ghosts;
+            };
+            if (has_lower && x < _lower_edge + _config.halo)
+                mirror(lower);
+            if (has_upper && x >= _upper_edge - _config.halo)
+                mirror(upper);
+        }
+
+        for (u32 direction{0}; direction < 2; ++direction)
+        {
+            block.migrations[parity][direction] = migrations[direction];
+            block.halos[parity][direction] = halos[direction];
+        }
+
+        // Removal moves the last drone into the gap, so indices were collected first
+        for (const auto id : _leaving)
+            game_entity::remove(id);
+        _sent += _leaving.size();
+    }
+
+    void import_boxes(u32 parity)
+    {
+        _ghosts.clear();
+        const auto receive = [this, parity](u32 neighbor, u32 direction) {
+            const shard_block &block{_view.block(neighbor)};
+            const drone_record *arrivals{_view.migrations(neighbor, parity, direction)};
+            for (u32 i{0}; i < block.migrations[parity][direction]; ++i)
+                spawn(arrivals[i]);
+            _received += block.migrations[parity][direction];
+
+            const u32 ghosts{block.halos[parity][direction]};
+            const size_t offset{_ghosts.size()};
+            _ghosts.resize(offset + ghosts);
+            std::copy_n(_view.halos(neighbor, parity, direction), ghosts, _ghosts.data() + offset);
+        };
+
+        if (_shard > 0)
+            receive(_shard - 1, upper);
+        if (_shard + 1 < _config.shards)
+            receive(_shard + 1, lower);
+
+        // The next tick's World update bins them and adds their wakes
+        const u32 count{(u32)_ghosts.size()};
+        _ghost_positions.resize((size_t)count * 3);
+        _ghost_wakes.resize(count);
+        for (u32 i{0}; i < count; ++i)
+        {
+            const ghost_record &g{_ghosts[i]};
+            std::copy_n(g.position, 3, _ghost_positions.data() + (size_t)i * 3);
+            downwash::ghost &wake{_ghost_wakes[i]};
+            std::copy_n(g.position, 3, wake.position);
+            std::copy_n(g.attitude, 4, wake.attitude);
+            std::copy_n(g.rotor_speeds, 4, wake.rotor_speeds);
+        }
+        neighbors::set_ghosts(_ghost_positions.data(), count);
+        downwash::set_ghosts(_ghost_wakes.data(), count, _config.params);
+    }
+
+    void publish()
+    {
+        drone_record *out{_view.snapshot(_shard)};
+        const u32 count{std::min(drone::count(), _config.max_drones)};
+        for (u32 i{0}; i < count; ++i)
+            out[i] = record_of(i);
+        _view.block(_shard).published = count;
+    }
+
+    void publish_stats()
+    {
+        shard_stats &stats{_view.block(_shard).stats};
+        stats.ticks = _ticks;
+        stats.drones = drone::count();
+        stats.ghosts = (u32)_ghosts.size();
+        stats.sent = _sent;
+        stats.received = _received;
+        stats.deferred = _deferred;
+        stats.dropped_ghosts = _dropped_ghosts;
+        stats.step_time = _step_time;
+    }
+
+    const config &_config;
+    shared_view _view;
+    u32 _shard;
+    physics::World &_world;
+
+    f32 _width{0.f};
+    f32 _lower_edge{0.f};
+    f32 _upper_edge{0.f};
+
+    util::vector<local_drone> _local;
+    util::vector<game_entity::entity_id> _leaving;
+    util::vector<ghost_record> _ghosts;
+    util::vector<f32> _ghost_positions;
+    util::vector<downwash::ghost> _ghost_wakes;
+
+    u64 _ticks{0};
+    u64 _sent{0};
+    u64 _received{0};
+    u64 _deferred{0};
+    u64 _dropped_ghosts{0};
+    f64 _step_time{0.0};
+    s32 _coordinator{0}; ///< Process id of the coordinator, the parent
+};
+
+#if defined(__linux__) || defined(__APPLE__)
+[[noreturn]] void run_worker(const config &c, const shared_view &view, u32 shard,
+                             const drone_record *drones, u32 count)
+{
+#if defined(__linux__)
+    // Do not outlive a coordinator that crashed
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+
+    {
+        context ctx;
+        context_scope scope{ctx};
+        if (c.worker_threads > 1)
+            jobs::initialize(c.worker_threads);
+        downwash::configure(c.downwash);
+
+        {
+            physics::World world;
+            world.set_reports_enabled(false);
+            worker w{c, view, shard, world};
+            w.run(drones, count);
+        }
+
+        if (jobs::is_running())
+            jobs::shutdown();
+    }
+
+    // Skip the atexit handlers of the coordinator's copy, e.g. a test runner's
+    fflush(nullptr);
+    _exit(0);
+}
+#endif
+
+} // namespace
+
+bool cluster::start(const config &c, const drone_record *drones, u32 count)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    if (is_running() || jobs::is_running() || !c.shards || !(c.max_x > c.min_x) ||
+        !c.max_transfers || (count && !drones))
+        return false;
+
+    _config = c;
+    _failed = false;
+    const layout offsets{c};
+    if (!_region.create_anonymous(offsets.total))
+        return false;
+
+    const shared_view view{_region.data(), c};
+    control_block &control{*new (_region.data()) control_block{}};
+    control.lockstep.init(c.shards + 1);
+    control.exchange.init(c.shards);
+    for (u32 s{0}; s < c.shards; ++s)
+        new (view.shard(s)) shard_block{};
+
+    // Buffered output would be written once more by every child
+    fflush(nullptr);
+    for (u32 s{0}; s < c.shards; ++s)
+    {
+        const pid_t pid{fork()};
+        if (pid == 0)
+            run_worker(_config, view, s, drones, count);
+        if (pid < 0)
+        {
+            _failed = true;
+            stop();
+            return false;
+        }
+        _workers.push_back((s32)pid);
+    }
+    return true;
+#else
+    (void)c;
+    (void)drones;
+    (void)count;
+    return false;
+#endif
+}
+
+bool cluster::step(u32 ticks) { return command(op_step, ticks); }
+
+bool cluster::gather(util::vector<drone_record> &out)
+{
+    out.clear();
+    if (!command(op_publish, 0))
+        return false;
+
+    const shared_view view{_region.data(), _config};
+    for (u32 s{0}; s < shards(); ++s)
+    {
+        const u32 published{view.block(s).published};
+        const size_t offset{out.size()};
+        out.resize(offset + published);
+        std::copy_n(view.snapshot(s), published, out.data() + offset);
+    }
+    std::sort(out.begin(), out.end(),
+              [](const drone_record &a, const drone_record &b) { return a.key < b.key; });
+    return true;
+}
+
+shard_stats cluster::stats(u32 shard) const
+{
+    assert(shard < shards());
+    return shared_view{_region.data(), _config}.block(shard).stats;
+}
+
+void cluster::stop()
+{
+#if defined(__linux__) || defined(__APPLE__)
+    if (!is_running())
+        return;
+
+    if (!_failed && !command(op_stop, 0))
+        _failed = true;
+
+    for (const s32 pid : _workers)
+    {
+        if (!pid)
+            continue;
+        if (_failed)
+            kill((pid_t)pid, SIGKILL);
+        waitpid((pid_t)pid, nullptr, 0);
+    }
+#endif
+    _workers.clear();
+    _region.close();
+}
+
+bool cluster::command(u32 op, u32 ticks)
+{
+    if (!is_running() || _failed)
+        return false;
+
+    control_block &control{shared_view{_region.data(), _config}.control()};
+    control.op = op;
+    control.ticks = ticks;
+    if (!wait_for_workers(control.lockstep.arrive()))
+        return false;
+    if (op == op_stop)
+        return true;
+    return wait_for_workers(control.lockstep.arrive());
+}
+
+bool cluster::wait_for_workers(u32 generation)
+{
+    control_block &control{shared_view{_region.data(), _config}.control()};
+    while (!control.lockstep.wait(generation, liveness_interval_us))
+    {
+#if defined(__linux__) || defined(__APPLE__)
+        for (s32 &pid : _workers)
+        {
+            if (pid && waitpid((pid_t)pid, nullptr, WNOHANG) == (pid_t)pid)
+            {
+                pid = 0;
+                _failed = true;
+            }
+        }
+#endif
+        if (_failed)
+            return false;
+    }
+    return true;
+}
+
+} // namespace lark::shard
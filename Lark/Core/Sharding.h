@@ -0,0 +1,186 @@
+/**
+ * @file Sharding.h
+ * @brief Drone swarms split spatially across worker processes that step in lockstep
+ *
+ * The arena is cut into slabs of equal width along x, one per shard. Every
+ * shard is a forked worker process with its own context and World that
+ * simulates the drones inside its slab; drones outside [min_x, max_x] belong
+ * to the first or last shard. The parent process is the coordinator.
+ *
+ * A tick runs in three steps:
+ *  1. every worker steps its World,
+ *  2. drones that left the slab are written to the migration box towards the
+ *     shard they entered, and drones within halo of a slab edge are written
+ *     to the halo box towards that neighbor,
+ *  3. after all workers wrote their boxes, each one removes what it sent,
+ *     creates the drones that migrated in and keeps the neighbor's boundary
+ *     drones as ghosts. Ghosts are points of the shard's neighbor grid and
+ *     shed wakes in its downwash stage from the next tick on.
+ * Boxes live in one shared mapping and are double buffered by tick parity, so
+ * the workers only meet at one futex barrier per tick. The coordinator joins
+ * the workers at a second barrier before and after every step() call.
+ * Drones with a NaN x belong to the first shard.
+ *
+ * The coordinator checks on its workers while it waits; once one died, step()
+ * fails and stop() kills the others, which may be stuck at the exchange
+ * barrier. Workers in turn wait in timed slices and exit when the
+ * coordinator is gone.
+ *
+ * Migrated drones keep their state, key, setpoint and user data. Controllers,
+ * trajectories and motor internals are rebuilt in the new shard: by default a
+ * position hold at the setpoint, or whatever config::prepare sets up.
+ *
+ * Only Linux and macOS are supported. The job pool of the coordinator must not
+ * be running when the cluster starts, since threads do not survive fork().
+ */
+
+#pragma once
+#include "../Common/CommonHeaders.h"
+#include "Components/Downwash.h"
+#include "PhysicExtension/Utils/DroneState.h"
+#include "PhysicExtension/Utils/DroneStructure.h"
+#include "SharedMemory.h"
+#include <functional>
+
+namespace lark::drone
+{
+struct init_info;
+}
+
+namespace lark::shard
+{
+
+/**
+ * @struct drone_record
+ * @brief Fixed layout of a drone crossing a process boundary
+ */
+struct drone_record
+{
+    u64 key{0}; ///< Chosen by the caller, identifies the drone in every shard
+    f32 position[3]{};
+    f32 velocity[3]{};
+    f32 attitude[4]{0.f, 0.f, 0.f, 1.f}; ///< Quaternion [x,y,z,w]
+    f32 body_rates[3]{};
+    f32 rotor_speeds[4]{};
+    f32 setpoint[3]{}; ///< Position the default controller holds
+    f32 user[4]{};     ///< Carried along untouched
+};
+
+/**
+ * @struct ghost_record
+ * @brief Boundary drone of a neighboring shard
+ */
+struct ghost_record
+{
+    u64 key{0};
+    f32 position[3]{};
+    f32 velocity[3]{};
+    f32 attitude[4]{0.f, 0.f, 0.f, 1.f}; ///< Quaternion [x,y,z,w]
+    f32 rotor_speeds[4]{};
+};
+
+/**
+ * @struct config
+ * @brief Decomposition, capacities and the vehicle every shard simulates
+ */
+struct config
+{
+    u32 shards{2};
+    f32 min_x{-100.f}; ///< m, the slabs split [min_x, max_x]
+    f32 max_x{100.f};
+    f32 halo{5.f};     ///< m, boundary band mirrored to the neighbor each tick
+    f32 dt{0.01f};     ///< s, step of every tick
+
+    u32 max_drones{1u << 20}; ///< Per shard, also bounds gather()
+    u32 max_transfers{8192};  ///< Per box and tick, extra migrations wait, extra ghosts drop
+    u32 worker_threads{1};    ///< Job pool of each worker, 1 keeps a worker serial
+
+    drone::QuadParams params{};
+    drone::ControlAbstraction abstraction{drone::ControlAbstraction::CMD_MOTOR_SPEEDS};
+    downwash::config downwash{}; ///< Wake model of every worker, ghosts included
+
+    /**
+     * @brief Optional, adjusts a drone before a worker creates it, e.g. its trajectory
+     */
+    std::function<void(const drone_record &, drone::init_info &)> prepare;
+
+    /**
+     * @brief Optional, runs in the worker after every exchange with the ghosts it received
+     */
+    std::function<void(u32 shard, const ghost_record *ghosts, u32 count)> after_exchange;
+};
+
+/**
+ * @struct shard_stats
+ * @brief Counters a worker publishes after every tick
+ */
+struct shard_stats
+{
+    u64 ticks{0};
+    u32 drones{0};
+    u32 ghosts{0};         ///< Received in the last exchange
+    u64 sent{0};           ///< Drones that migrated out, since start
+    u64 received{0};       ///< Drones that migrated in, since start
+    u64 deferred{0};       ///< Migrations postponed because a box was full
+    u64 dropped_ghosts{0}; ///< Boundary drones not mirrored because a halo box was full
+    f64 step_time{0.0};    ///< s, World updates only, since start
+};
+
+/**
+ * @class cluster
+ * @brief Coordinator side of a sharded simulation, owns the worker processes
+ */
+class cluster
+{
+  public:
+    cluster() = default;
+    ~cluster() { stop(); }
+    cluster(const cluster &) = delete;
+    cluster &operator=(const cluster &) = delete;
+
+    /**
+     * @brief Maps the shared boxes and forks one worker per shard
+     *
+     * Workers create the drones of their slab from drones, which only has to
+     * stay valid during this call.
+     * @return false if the configuration is invalid, the job pool is running or
+     * the processes could not be created
+     */
+    bool start(const config &c, const drone_record *drones, u32 count);
+
+    /**
+     * @brief Advances every shard by ticks ticks and waits until all are done
+     * @return false once a worker died, the cluster has to be stopped then
+     */
+    bool step(u32 ticks = 1);
+
+    /**
+     * @brief Copies every drone of every shard, sorted by key
+     * @return false if a worker died
+     */
+    bool gather(util::vector<drone_record> &out);
+
+    /**
+     * @brief Counters of a shard as of the last step
+     */
+    shard_stats stats(u32 shard) const;
+
+    /**
+     * @brief Ends the workers and unmaps the boxes, kills workers that stopped responding
+     */
+    void stop();
+
+    bool is_running() const { return _workers.size() > 0; }
+    u32 shards() const { return (u32)_workers.size(); }
+
+  private:
+    bool command(u32 op, u32 ticks);
+    bool wait_for_workers(u32 generation);
+
+    config _config{};
+    ipc::shared_region _region; ///< Control block and the boxes of every shard
+    util::vector<s32> _workers; ///< Process ids by shard, 0 once reaped
+    bool _failed{false};
+};
+
+} // namespace lark::shard
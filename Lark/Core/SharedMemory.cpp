@@ -0,0 +1,255 @@
+#include "SharedMemory.h"
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace lark::ipc
+{
+namespace
+{
+// Checks before a waiter sleeps, enough to catch peers that are a few microseconds behind
+constexpr u32 spin_checks{2000};
+
+using clock = std::chrono::steady_clock;
+
+#if defined(__linux__) || defined(__APPLE__)
+void *map_shared(int fd, size_t size)
+{
+    const int flags{fd < 0 ? MAP_SHARED | MAP_ANONYMOUS : MAP_SHARED};
+    void *data{mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0)};
+    return data == MAP_FAILED ? nullptr : data;
+}
+#endif
+
+bool valid_name(const char *name)
+{
+    return name && name[0] == '/' && strlen(name) <= shared_region::max_name_length;
+}
+
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+} // namespace
+
+bool shared_region::create_anonymous(size_t size)
+{
+    close();
+#if defined(__linux__) || defined(__APPLE__)
+    _data = map_shared(-1, size);
+    _size = _data ? size : 0;
+    return _data != nullptr;
+#else
+    return false;
+#endif
+}
+
+bool shared_region::create(const char *name, size_t size)
+{
+    close();
+#if defined(__linux__) || defined(__APPLE__)
+    if (!valid_name(name))
+        return false;
+
+    // Never takes over a name, its owner may still be running
+    const int fd{shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600)};
+    if (fd < 0)
+        return false;
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        ::close(fd);
+        shm_unlink(name);
+        return false;
+    }
+
+    _data = map_shared(fd, size);
+    ::close(fd);
+    if (!_data)
+    {
+        shm_unlink(name);
+        return false;
+    }
+    _size = size;
+    strncpy(_name, name, sizeof(_name) - 1);
+    return true;
+#else
+    (void)name;
+    (void)size;
+    return false;
+#endif
+}
+
+bool shared_region::remove(const char *name)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    return valid_name(name) && shm_unlink(name) == 0;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+bool shared_region::open(const char *name)
+{
+    close();
+#if defined(__linux__) || defined(__APPLE__)
+    if (!valid_name(name))
+        return false;
+
+    const int fd{shm_open(name, O_RDWR, 0)};
+    if (fd < 0)
+        return false;
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    _data = map_shared(fd, (size_t)info.st_size);
+    ::close(fd);
+    _size = _data ? (size_t)info.st_size : 0;
+    return _data != nullptr;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+void shared_region::close()
+{
+#if defined(__linux__) || defined(__APPLE__)
+    if (_data)
+        munmap(_data, _size);
+    if (_name[0])
+        shm_unlink(_name);
+#endif
+    _data = nullptr;
+    _size = 0;
+    _name[0] = '\0';
+}
+
+u32 current_process()
+{
+#if defined(__linux__) || defined(__APPLE__)
+    return (u32)getpid();
+#else
+    return 0;
+#endif
+}
+
+bool process_exists(u32 pid)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    // Signal 0 only checks, EPERM means it exists but belongs to someone else
+    return kill((pid_t)pid, 0) == 0 || errno != ESRCH;
+#else
+    (void)pid;
+    return true;
+#endif
+}
+
+bool futex_wait(std::atomic<u32> &word, u32 expected, u32 timeout_us)
+{
+#if defined(__linux__)
+    // Not FUTEX_PRIVATE_FLAG, the word is shared with other processes
+    timespec timeout{(time_t)(timeout_us / 1'000'000), (long)(timeout_us % 1'000'000) * 1000};
+    const long result{syscall(SYS_futex, reinterpret_cast<u32 *>(&word), FUTEX_WAIT, expected,
+                              timeout_us ? &timeout : nullptr, nullptr, 0)};
+    if (result != 0 && errno == ETIMEDOUT)
+        return word.load(std::memory_order_acquire) != expected;
+    return true;
+#else
+    const auto deadline{clock::now() + std::chrono::microseconds{timeout_us}};
+    while (word.load(std::memory_order_acquire) == expected)
+    {
+        if (timeout_us && clock::now() >= deadline)
+            return false;
+        std::this_thread::yield();
+    }
+    return true;
+#endif
+}
+
+void futex_wake(std::atomic<u32> &word, u32 count)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<u32 *>(&word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+#else
+    (void)word;
+    (void)count;
+#endif
+}
+
+bool wait_for_change(std::atomic<u32> &word, u32 value, u32 timeout_us)
+{
+    for (u32 i{0}; i < spin_checks; ++i)
+    {
+        if (word.load(std::memory_order_acquire) != value)
+            return true;
+        cpu_relax();
+    }
+
+    const auto deadline{clock::now() + std::chrono::microseconds{timeout_us}};
+    while (word.load(std::memory_order_acquire) == value)
+    {
+        u32 remaining{0};
+        if (timeout_us)
+        {
+            const auto left{std::chrono::duration_cast<std::chrono::microseconds>(
+                deadline - clock::now())};
+            if (left.count() <= 0)
+                return false;
+            remaining = (u32)left.count();
+        }
+        futex_wait(word, value, remaining);
+    }
+    return true;
+}
+
+void process_barrier::init(u32 count)
+{
+    arrived.store(0, std::memory_order_relaxed);
+    generation.store(0, std::memory_order_relaxed);
+    participants = count;
+}
+
+u32 process_barrier::arrive()
+{
+    // The generation cannot end before this participant arrived, so reading it first is safe
+    const u32 current{generation.load(std::memory_order_acquire)};
+    if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == participants)
+    {
+        arrived.store(0, std::memory_order_relaxed);
+        generation.store(current + 1, std::memory_order_release);
+        futex_wake(generation);
+    }
+    return current;
+}
+
+bool process_barrier::wait(u32 current, u32 timeout_us)
+{
+    return wait_for_change(generation, current, timeout_us);
+}
+
+} // namespace lark::ipc
@@ -0,0 +1,141 @@
+/**
+ * @file SharedMemory.h
+ * @brief Memory shared between processes and futex waits on words inside it
+ *
+ * A shared_region is either anonymous, inherited by processes forked after
+ * it was created, or named, so unrelated processes can map it by name.
+ * Waiting uses futexes on 32-bit words of a region: a waiter sleeps in the
+ * kernel and one syscall wakes it, there are no pipes or sockets involved.
+ * Where futexes are not available, waits fall back to yielding.
+ *
+ * Only POSIX platforms are supported, creating a region fails elsewhere.
+ */
+
+#pragma once
+#include "../Common/CommonHeaders.h"
+#include <atomic>
+
+namespace lark::ipc
+{
+
+/**
+ * @class shared_region
+ * @brief Owns one mapping of shared memory, zero-filled when created
+ */
+class shared_region
+{
+  public:
+    static constexpr u32 max_name_length{63}; ///< Names start with a slash
+
+    shared_region() = default;
+    ~shared_region() { close(); }
+    shared_region(const shared_region &) = delete;
+    shared_region &operator=(const shared_region &) = delete;
+
+    /**
+     * @brief Maps memory that children forked afterwards share with this process
+     *
+     * Pages are only committed when touched, so generous sizes are cheap.
+     */
+    bool create_anonymous(size_t size);
+
+    /**
+     * @brief Creates a named region, fails if the name is taken
+     *
+     * The name is unlinked again when the creating object closes it.
+     */
+    bool create(const char *name, size_t size);
+
+    /**
+     * @brief Unlinks a name, e.g. one left behind by a process that crashed
+     *
+     * Processes that mapped the region keep their mapping.
+     */
+    static bool remove(const char *name);
+
+    /**
+     * @brief Maps a region created by another process, in full
+     */
+    bool open(const char *name);
+
+    void close();
+
+    void *data() const { return _data; }
+    size_t size() const { return _size; }
+    bool is_open() const { return _data != nullptr; }
+
+  private:
+    void *_data{nullptr};
+    size_t _size{0};
+    char _name[max_name_length + 1]{}; ///< Set while this object has to unlink the name
+};
+
+/**
+ * @brief Id of the calling process, for peers to check on it
+ */
+u32 current_process();
+
+/**
+ * @brief False once the process has exited, always true where this cannot be checked
+ */
+bool process_exists(u32 pid);
+
+/**
+ * @brief Sleeps while word holds expected
+ * @param timeout_us 0 waits without a time limit
+ * @return false if the timeout expired with word unchanged
+ *
+ * Returns early on spurious wakeups, callers recheck their condition.
+ */
+bool futex_wait(std::atomic<u32> &word, u32 expected, u32 timeout_us = 0);
+
+constexpr u32 wake_all{0x7fff'ffff};
+
+/**
+ * @brief Wakes up to count processes sleeping on word
+ */
+void futex_wake(std::atomic<u32> &word, u32 count = wake_all);
+
+/**
+ * @brief Spins briefly, then sleeps until word no longer holds value
+ * @return false if timeout_us expired first, 0 waits without a time limit
+ *
+ * The spin catches peers that are a few microseconds behind without a syscall.
+ */
+bool wait_for_change(std::atomic<u32> &word, u32 value, u32 timeout_us = 0);
+
+/**
+ * @struct process_barrier
+ * @brief Reusable barrier placed in shared memory
+ *
+ * Participants arrive, then wait for the generation they arrived in to end.
+ * Splitting the two lets a waiter check on its peers between timed waits.
+ * A participant that gives up after a timeout leaves the barrier unusable.
+ */
+struct process_barrier
+{
+    /**
+     * @brief Call once before any participant arrives, e.g. before forking
+     */
+    void init(u32 count);
+
+    /**
+     * @brief Counts the caller in, the last arrival releases everyone
+     * @return The generation to pass to wait()
+     */
+    u32 arrive();
+
+    /**
+     * @brief Spins briefly, then sleeps until the generation ended
+     * @return false if timeout_us expired first, 0 waits without a time limit
+     */
+    bool wait(u32 generation, u32 timeout_us = 0);
+
+    std::atomic<u32> arrived{0};
+    std::atomic<u32> generation{0};
+    u32 participants{0};
+};
+
+static_assert(std::atomic<u32>::is_always_lock_free, "futex words must be plain 32-bit words");
+
+} // namespace lark::ipc
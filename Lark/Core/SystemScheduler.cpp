@@ -0,0 +1,145 @@
+#include "SystemScheduler.h"
+#include <chrono>
+
+namespace lark
+{
+namespace
+{
+constexpr f32 timing_smoothing{0.1f};
+
+bool conflicts(const SystemInfo &a, const SystemInfo &b)
+{
+    return (a.writes & (b.reads | b.writes)) || (a.reads & b.writes);
+}
+} // namespace
+
+u32 SystemScheduler::add_system(SystemInfo info)
+{
+    assert(info.execute);
+    _systems.emplace_back(node{std::move(info), {}, 0});
+    _graph_dirty = true;
+    return (u32)_systems.size() - 1;
+}
+
+void SystemScheduler::clear()
+{
+    _systems.clear();
+    _timings.clear();
+    _remaining.reset();
+    _graph_dirty = true;
+}
+
+bool SystemScheduler::depends_on(u32 system, u32 other)
+{
+    assert(system < _systems.size() && other < _systems.size());
+    if (_graph_dirty)
+        build_graph();
+
+    const auto &dependents = _systems[other].dependents;
+    return std::find(dependents.begin(), dependents.end(), system) != dependents.end();
+}
+
+void SystemScheduler::build_graph()
+{
+    const u32 count{(u32)_systems.size()};
+
+    // Conflicting systems keep their registration order, which makes the graph acyclic
+    for (auto &system : _systems)
+    {
+        system.dependents.clear();
+        system.dependency_count = 0;
+    }
+
+    for (u32 j{1}; j < count; ++j)
+    {
+        for (u32 i{0}; i < j; ++i)
+        {
+            if (conflicts(_systems[i].info, _systems[j].info))
+            {
+                _systems[i].dependents.push_back(j);
+                ++_systems[j].dependency_count;
+            }
+        }
+    }
+
+    _timings.resize(count);
+    for (u32 i{0}; i < count; ++i)
+        _timings[i].name = _systems[i].info.name.c_str();
+
+    _remaining = std::make_unique<std::atomic<u32>[]>(count);
+    _graph_dirty = false;
+}
+
+void SystemScheduler::run(f32 dt)
+{
+    if (_systems.empty())
+        return;
+
+    if (_graph_dirty)
+        build_graph();
+
+    const u32 count{(u32)_systems.size()};
+    for (u32 i{0}; i < count; ++i)
+        _remaining[i].store(_systems[i].dependency_count, std::memory_order_relaxed);
+
+    jobs::counter done;
+    _dt = dt;
+    _done = &done;
+
+    for (u32 i{0}; i < count; ++i)
+    {
+        if (_systems[i].dependency_count == 0)
+            jobs::submit(jobs::job{&SystemScheduler::system_entry, this, i, i + 1, &done});
+    }
+
+    jobs::wait(done);
+    _done = nullptr;
+}
+
+void SystemScheduler::system_entry(void *data, u32 index, u32)
+{
+    auto *scheduler{static_cast<SystemScheduler *>(data)};
+    scheduler->execute_system(index, scheduler->_dt);
+
+    // Dependents are queued before this job reports completion, so the run
+    // cannot finish while work is still being released
+    for (u32 dependent : scheduler->_systems[index].dependents)
+    {
+        if (scheduler->_remaining[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            jobs::submit(jobs::job{&SystemScheduler::system_entry, scheduler, dependent,
+                                   dependent + 1, scheduler->_done});
+        }
+    }
+}
+
+void SystemScheduler::execute_system(u32 index, f32 dt)
+{
+    using clock = std::chrono::steady_clock;
+    const SystemInfo &info{_systems[index].info};
+    const auto start = clock::now();
+
+    const u32 items{info.item_count ? info.item_count() : 1};
+    if (!info.parallel || !info.item_count)
+    {
+        if (items)
+            info.execute(dt, 0, items);
+    }
+    else
+    {
+        jobs::parallel_for(items, info.chunk_size,
+                           [&info, dt](u32 begin, u32 end) { info.execute(dt, begin, end); });
+    }
+
+    const f32 elapsed_ms{std::chrono::duration<f32, std::milli>(clock::now() - start).count()};
+
+    // Each system runs at most once per tick, so its slot has a single writer
+    SystemTiming &timing{_timings[index]};
+    timing.last_ms = elapsed_ms;
+    timing.average_ms = timing.average_ms == 0.f
+                            ? elapsed_ms
+                            : timing.average_ms + (elapsed_ms - timing.average_ms) * timing_smoothing;
+    timing.items = items;
+}
+
+} // namespace lark
@@ -0,0 +1,143 @@
+/**
+ * @file SystemScheduler.h
+ * @brief Dependency-ordered execution of the per-tick simulation systems
+ *
+ * Systems declare which resources they read and write. Two systems conflict
+ * when one writes something the other touches; conflicting systems run in
+ * registration order, everything else may run concurrently on the job pool.
+ * A system that reports an item count is additionally split into chunks.
+ */
+
+#pragma once
+#include "../Common/CommonHeaders.h"
+#include "JobSystem.h"
+#include <functional>
+
+namespace lark
+{
+
+/**
+ * @enum SystemResource
+ * @brief Data a system can read or write during a tick
+ */
+enum class SystemResource : u32
+{
+    wind_field,     ///< Shared wind model (stateful)
+    drone_wind,     ///< Wind sample stored on each drone
+    drone_setpoint, ///< Trajectory setpoint of each drone
+    drone_control,  ///< Last control input of each drone
+    drone_state,    ///< Integrated drone state
+    transform,      ///< Transform components
+    physics_body,   ///< Bullet world and rigid bodies
+    script,         ///< Script components
+    sensor_data,    ///< Sensor clocks, noise states and sample rings
+    drone_estimate, ///< State estimate and covariance of each drone
+    neighbor_grid,  ///< Spatial hash of the drone positions
+    bridge,         ///< Shared-memory bridge to external controllers
+
+    count
+};
+
+using resource_set = u64;
+
+constexpr resource_set resource_bit(SystemResource r) { return resource_set{1} << (u32)r; }
+
+template <typename... Rs> constexpr resource_set resources(Rs... rs)
+{
+    return (resource_set{0} | ... | resource_bit(rs));
+}
+
+/**
+ * @struct SystemInfo
+ * @brief Description of a system registered with the scheduler
+ */
+struct SystemInfo
+{
+    std::string name;
+    resource_set reads{0};
+    resource_set writes{0};
+
+    /**
+     * Number of independent items to process this tick. When empty the system
+     * is executed once with the range [0, 1).
+     */
+    std::function<u32()> item_count;
+
+    /** Processes items [begin, end) */
+    std::function<void(f32 dt, u32 begin, u32 end)> execute;
+
+    u32 chunk_size{0};  ///< Items per job, 0 lets the job system decide
+    bool parallel{true}; ///< false keeps all items on a single thread
+};
+
+/**
+ * @struct SystemTiming
+ * @brief Wall-clock cost of one system
+ */
+struct SystemTiming
+{
+    const char *name{nullptr};
+    f32 last_ms{0.f};    ///< Duration of the most recent run
+    f32 average_ms{0.f}; ///< Exponential moving average of the duration
+    u32 items{0};        ///< Items processed in the most recent run
+};
+
+/**
+ * @class SystemScheduler
+ * @brief Builds a DAG from the declared access sets and runs it on the job pool
+ */
+class SystemScheduler
+{
+  public:
+    SystemScheduler() = default;
+    SystemScheduler(const SystemScheduler &) = delete;
+    SystemScheduler &operator=(const SystemScheduler &) = delete;
+
+    /**
+     * @brief Registers a system
+     * @return Index of the system, used by timings and dependency queries
+     */
+    u32 add_system(SystemInfo info);
+
+    /**
+     * @brief Removes all systems
+     */
+    void clear();
+
+    /**
+     * @brief Runs every system once, respecting their dependencies
+     * @param dt Time step forwarded to the systems
+     */
+    void run(f32 dt);
+
+    /**
+     * @brief Whether the system waits for the other one to finish
+     */
+    bool depends_on(u32 system, u32 other);
+
+    u32 system_count() const { return (u32)_systems.size(); }
+
+    const util::vector<SystemTiming> &timings() const { return _timings; }
+
+  private:
+    struct node
+    {
+        SystemInfo info;
+        util::vector<u32> dependents;
+        u32 dependency_count{0};
+    };
+
+    void build_graph();
+    void execute_system(u32 index, f32 dt);
+    static void system_entry(void *data, u32 index, u32 end);
+
+    util::vector<node> _systems;
+    util::vector<SystemTiming> _timings;
+    std::unique_ptr<std::atomic<u32>[]> _remaining;
+    bool _graph_dirty{true};
+
+    f32 _dt{0.f};                   ///< Time step of the run in flight
+    jobs::counter *_done{nullptr}; ///< Completion counter of the run in flight
+};
+
+} // namespace lark
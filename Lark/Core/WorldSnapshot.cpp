@@ -0,0 +1,144 @@
+#include "WorldSnapshot.h"
+#include "Components/Transform.h"
+#include "Utils/Random.h"
+
+namespace lark
+{
+namespace
+{
+template <typename T> void write_section(util::byte_writer &out, const util::vector<T> *items)
+{
+    out.write((u8)(items != nullptr));
+    if (!items)
+        return;
+    out.write((u64)items->size());
+    out.write_bytes(items->data(), items->size() * sizeof(T));
+}
+
+template <typename T>
+bool read_section(util::byte_reader &in, std::shared_ptr<util::vector<T>> &items)
+{
+    u8 present{0};
+    if (!in.read(present))
+        return false;
+    if (!present)
+    {
+        items.reset();
+        return true;
+    }
+
+    u64 count{0};
+    if (!in.read(count))
+        return false;
+    const u8 *bytes{in.skip((size_t)count * sizeof(T))};
+    if (!bytes)
+        return false;
+
+    items = std::make_shared<util::vector<T>>((size_t)count);
+    std::memcpy(items->data(), bytes, (size_t)count * sizeof(T));
+    return true;
+}
+} // namespace
+
+world_snapshot world_snapshot::capture(physics::World *world)
+{
+    world_snapshot snapshot{};
+    snapshot._stream_position = random::stream_position();
+
+    util::byte_writer transforms;
+    transform::save_state(transforms);
+    snapshot._transforms = std::make_shared<util::vector<u8>>(std::move(transforms.buffer()));
+
+    snapshot._drones = std::make_shared<util::vector<drone::saved_state>>();
+    drone::save_states(*snapshot._drones);
+
+    snapshot._sensors = std::make_shared<util::vector<sensors::saved_drone>>();
+    sensors::save_state(snapshot._sensor_clocks, *snapshot._sensors);
+
+    snapshot._filters = std::make_shared<util::vector<estimator::saved_filter>>();
+    estimator::save_state(snapshot._estimator_cursors, *snapshot._filters);
+
+    if (world)
+    {
+        snapshot._bodies = std::make_shared<util::vector<physics::World::body_state>>();
+        world->save_bodies(*snapshot._bodies);
+
+        if (const drone::Wind *wind{world->get_wind()})
+        {
+            util::byte_writer state;
+            wind->save_state(state);
+            snapshot._wind = std::make_shared<util::vector<u8>>(std::move(state.buffer()));
+        }
+    }
+    return snapshot;
+}
+
+bool world_snapshot::restore(physics::World *world) const
+{
+    if (empty())
+        return false;
+
+    // Everything that can fail is checked before the first write
+    drone::Wind *wind{world ? world->get_wind() : nullptr};
+    if (_bodies && !world)
+        return false;
+    if ((bool)_wind != (wind != nullptr))
+        return false;
+    if (_bodies && world->dynamics_world()->getNumCollisionObjects() != (int)_bodies->size())
+        return false;
+
+    util::byte_reader transforms{_transforms->data(), _transforms->size()};
+    u32 transform_count{0};
+    if (!util::byte_reader{transforms}.read(transform_count) ||
+        transform_count != transform::positions_view().count)
+        return false;
+    if (!drone::load_states(_drones->data(), (u32)_drones->size()))
+        return false;
+
+    transform::load_state(transforms);
+    sensors::load_state(_sensor_clocks, _sensors->data(), (u32)_sensors->size());
+    estimator::load_state(_estimator_cursors, _filters->data(), (u32)_filters->size());
+
+    if (_bodies)
+        world->load_bodies(_bodies->data(), (u32)_bodies->size());
+    if (wind)
+    {
+        util::byte_reader state{_wind->data(), _wind->size()};
+        wind->load_state(state);
+    }
+
+    random::set_stream_position(_stream_position);
+    return true;
+}
+
+void world_snapshot::set_drone_state(u32 index, const drone::DroneState &state)
+{
+    assert(index < drone_count());
+    if (_drones.use_count() > 1)
+        _drones = std::make_shared<util::vector<drone::saved_state>>(*_drones);
+    (*_drones)[index].state = state;
+}
+
+void world_snapshot::write(util::byte_writer &out) const
+{
+    out.write(_stream_position);
+    write_section(out, _transforms.get());
+    write_section(out, _drones.get());
+    out.write(_sensor_clocks);
+    write_section(out, _sensors.get());
+    out.write(_estimator_cursors);
+    write_section(out, _filters.get());
+    write_section(out, _bodies.get());
+    write_section(out, _wind.get());
+}
+
+bool world_snapshot::read(util::byte_reader &in)
+{
+    return in.read(_stream_position) && read_section(in, _transforms) &&
+           read_section(in, _drones) && in.read(_sensor_clocks) && read_section(in, _sensors) &&
+           in.read(_estimator_cursors) && read_section(in, _filters) &&
+           read_section(in, _bodies) && read_section(in, _wind) && _transforms && _drones &&
+           _sensors && _filters;
+}
+
+} // namespace lark
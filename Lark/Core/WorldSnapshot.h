@@ -0,0 +1,78 @@
+/**
+ * @file WorldSnapshot.h
+ * @brief In-memory copy of the simulated state for fast resets and branching
+ *
+ * Capturing and restoring are plain copies of the dense arrays: transforms,
+ * drone states with their setpoints, last controls and noise generators, the
+ * sensor clocks, biases and noise generators, the estimator filters with the
+ * sensor samples they consumed, the rigid bodies of the Bullet
+ * world, the wind model and the engine seed stream.
+ * Restoring writes into the existing storage in place, no entity or body is
+ * created or destroyed, so it only applies to the scene it was taken from.
+ *
+ * Copies of a snapshot share their sections. Editing a drone state of a copy
+ * first duplicates the drone section, so many what-if branches can start from
+ * one captured state without copying it up front.
+ */
+
+#pragma once
+#include "../Common/CommonHeaders.h"
+#include "../Components/Drone.h"
+#include "../Components/Estimator.h"
+#include "../Components/Sensors.h"
+#include "../PhysicExtension/World/World.h"
+#include "../Utils/BinaryStream.h"
+#include <memory>
+
+namespace lark
+{
+
+class world_snapshot
+{
+  public:
+    /**
+     * @brief Copies the current state
+     * @param world Bullet bodies and wind are included when not null
+     */
+    static world_snapshot capture(physics::World *world);
+
+    /**
+     * @brief Writes the state back
+     * @return false if the scene no longer matches, nothing is changed then
+     */
+    bool restore(physics::World *world) const;
+
+    bool empty() const { return !_transforms; }
+    u32 drone_count() const { return _drones ? (u32)_drones->size() : 0; }
+    const drone::saved_state &drone(u32 index) const { return (*_drones)[index]; }
+
+    /**
+     * @brief Replaces one drone state, copying the drone section if it is shared
+     */
+    void set_drone_state(u32 index, const drone::DroneState &state);
+
+    /**
+     * @brief Serializes every section, e.g. for replay checkpoints
+     */
+    void write(util::byte_writer &out) const;
+
+    /**
+     * @brief Reads sections written by write
+     */
+    bool read(util::byte_reader &in);
+
+  private:
+    template <typename T> using section = std::shared_ptr<util::vector<T>>;
+
+    u64 _stream_position{0};
+    section<u8> _transforms;
+    section<drone::saved_state> _drones;
+    sensors::saved_clocks _sensor_clocks{};
+    section<sensors::saved_drone> _sensors;
+    estimator::saved_cursors _estimator_cursors{};
+    section<estimator::saved_filter> _filters;
+    section<physics::World::body_state> _bodies; ///< Null when taken without a world
+    section<u8> _wind;                           ///< Null when the world had no wind
+};
+
+} // namespace lark
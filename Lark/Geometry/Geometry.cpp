@@ -1,5 +1,6 @@
 #include "Geometry.h"
-#include <execution>
+#include "../Core/FrameArena.h"
+#include "../Core/JobSystem.h"
 #include <map>
 
 namespace lark::tools
@@ -11,15 +12,10 @@ namespace
 void clear_processed_vertex_data(tools::mesh &m)
 {
     m.vertices.clear();
-    m.vertices.shrink_to_fit();
     m.indices.clear();
-    m.indices.shrink_to_fit();
     m.normals.clear();
-    m.normals.shrink_to_fit();
     m.tangents.clear();
-    m.tangents.shrink_to_fit();
     m.packed_vertices_static.clear();
-    m.packed_vertices_static.shrink_to_fit();
 }
 
 inline math::v3 calculate_triangle_normal(const math::v3 &v0, const math::v3 &v1,
@@ -35,22 +31,23 @@ void recalculate_normals(mesh &m)
     const u32 num_triangles = (u32)m.raw_indices.size() / 3;
     m.normals.resize(m.raw_indices.size());
 
-#pragma omp parallel for
-    for (s32 i = 0; i < (s32)num_triangles; ++i)
-    {
-        const u32 base_idx = i * 3;
-        const u32 i0 = m.raw_indices[base_idx];
-        const u32 i1 = m.raw_indices[base_idx + 1];
-        const u32 i2 = m.raw_indices[base_idx + 2];
-
-        const math::v3 n =
-            calculate_triangle_normal(m.positions[i0], m.positions[i1], m.positions[i2]);
-
-        // Store normal for all three vertices
-        m.normals[base_idx] = n;
-        m.normals[base_idx + 1] = n;
-        m.normals[base_idx + 2] = n;
-    }
+    jobs::parallel_for(num_triangles, 0, [&m](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; ++i)
+        {
+            const u32 base_idx = i * 3;
+            const u32 i0 = m.raw_indices[base_idx];
+            const u32 i1 = m.raw_indices[base_idx + 1];
+            const u32 i2 = m.raw_indices[base_idx + 2];
+
+            const math::v3 n =
+                calculate_triangle_normal(m.positions[i0], m.positions[i1], m.positions[i2]);
+
+            // Store normal for all three vertices
+            m.normals[base_idx] = n;
+            m.normals[base_idx + 1] = n;
+            m.normals[base_idx + 2] = n;
+        }
+    });
 }
 
 void process_normals(mesh &m, f32 smoothing_angle)
@@ -64,74 +61,98 @@ void process_normals(mesh &m, f32 smoothing_angle)
     assert(num_indices && num_vertices);
 
     m.indices.resize(num_indices);
-    m.vertices.reserve(num_vertices); // Pre-allocate to avoid reallocations
 
-    // Create index reference for vertices
-    std::vector<std::vector<u32>> idx_ref(num_vertices);
+    // Index references of every position as one flat array, built in index order so the
+    // output is deterministic. The temporaries live on this thread's scope arena, which the
+    // game loop does not reset if an import overlaps a tick.
+    memory::frame_scope scope;
+    memory::frame_vector<u32> ref_start(num_vertices + 1, 0);
+    memory::frame_vector<u32> ref_count(num_vertices, 0);
+    memory::frame_vector<u32> refs_flat(num_indices);
 
-    // Pre-calculate approximate size for index references
-    const u32 avg_refs_per_vertex = (num_indices + num_vertices - 1) / num_vertices;
-    for (auto &refs : idx_ref)
+    for (u32 i = 0; i < num_indices; ++i)
     {
-        refs.reserve(avg_refs_per_vertex);
+        ++ref_start[m.raw_indices[i] + 1];
     }
-
-// Build index references in parallel
-#pragma omp parallel for
-    for (s32 i = 0; i < (s32)num_indices; ++i)
+    for (u32 i = 0; i < num_vertices; ++i)
     {
-        const u32 vertex_idx = m.raw_indices[i];
-#pragma omp critical
-        {
-            idx_ref[vertex_idx].push_back(i);
-        }
+        ref_start[i + 1] += ref_start[i];
     }
-
-// Process vertices
-#pragma omp parallel for
-    for (s32 i = 0; i < (s32)num_vertices; ++i)
+    for (u32 i = 0; i < num_indices; ++i)
     {
-        auto &refs = idx_ref[i];
-        u32 num_refs = (u32)refs.size();
+        const u32 vertex_idx = m.raw_indices[i];
+        refs_flat[ref_start[vertex_idx] + ref_count[vertex_idx]++] = i;
+    }
 
-        for (u32 j = 0; j < num_refs; ++j)
+    // Split every position into output vertices. Indices first receive the vertex number
+    // local to their position, the remaining refs are the first index of each output vertex.
+    memory::frame_vector<u32> vertex_offsets(num_vertices + 1, 0);
+    jobs::parallel_for(num_vertices, 0, [&](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; ++i)
         {
-            vertex v;
-            v.position = m.positions[m.raw_indices[refs[j]]];
-            v.normal = m.normals[refs[j]];
+            u32 *const refs = refs_flat.data() + ref_start[i];
+            u32 num_refs = ref_count[i];
 
-            u32 vertex_index;
-#pragma omp critical
+            for (u32 j = 0; j < num_refs; ++j)
             {
-                vertex_index = (u32)m.vertices.size();
-                m.vertices.push_back(v);
-            }
-            m.indices[refs[j]] = vertex_index;
+                math::v3 normal = m.normals[refs[j]];
+                m.indices[refs[j]] = j;
 
-            if (!is_hard_edge)
-            {
-                for (u32 k = j + 1; k < num_refs; ++k)
+                if (!is_hard_edge)
                 {
-                    float cos_theta = 0.f;
-                    const math::v3 &n2 = m.normals[refs[k]];
-
-                    if (!is_soft_edge)
-                    {
-                        cos_theta = glm::dot(v.normal, n2) * glm::length(v.normal);
-                    }
-
-                    if (is_soft_edge || cos_theta >= cos_alpha)
+                    for (u32 k = j + 1; k < num_refs; ++k)
                     {
-                        v.normal += n2;
-                        m.indices[refs[k]] = vertex_index;
-                        refs.erase(refs.begin() + k);
-                        --num_refs;
-                        --k;
+                        float cos_theta = 0.f;
+                        const math::v3 &n2 = m.normals[refs[k]];
+
+                        if (!is_soft_edge)
+                        {
+                            cos_theta = glm::dot(normal, n2) * glm::length(normal);
+                        }
+
+                        if (is_soft_edge || cos_theta >= cos_alpha)
+                        {
+                            normal += n2;
+                            m.indices[refs[k]] = j;
+                            std::copy(refs + k + 1, refs + num_refs, refs + k);
+                            --num_refs;
+                            --k;
+                        }
                     }
                 }
             }
+
+            ref_count[i] = num_refs;
+            vertex_offsets[i + 1] = num_refs;
         }
+    });
+
+    for (u32 i = 0; i < num_vertices; ++i)
+    {
+        vertex_offsets[i + 1] += vertex_offsets[i];
     }
+
+    m.vertices.resize(vertex_offsets[num_vertices]);
+
+    jobs::parallel_for(num_vertices, 0, [&](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; ++i)
+        {
+            const u32 *const refs = refs_flat.data() + ref_start[i];
+            for (u32 j = 0; j < ref_count[i]; ++j)
+            {
+                vertex &v = m.vertices[vertex_offsets[i] + j];
+                v.position = m.positions[i];
+                v.normal = m.normals[refs[j]];
+            }
+        }
+    });
+
+    jobs::parallel_for(num_indices, 0, [&](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; ++i)
+        {
+            m.indices[i] += vertex_offsets[m.raw_indices[i]];
+        }
+    });
 }
 
 void process_uvs(mesh &m)
@@ -233,17 +254,18 @@ void pack_vertices_static(mesh &m)
 
     m.packed_vertices_static.resize(num_vertices);
 
-#pragma omp parallel for
-    for (s32 i = 0; i < (s32)num_vertices; ++i)
-    {
-        const vertex &v = m.vertices[i];
-        const u8 signs = (u8)((v.normal.z > 0.f) << 1);
-        const u16 normal_x = (u16)math::pack_float<16>(v.normal.x, -1.f, 1.f);
-        const u16 normal_y = (u16)math::pack_float<16>(v.normal.y, -1.f, 1.f);
+    jobs::parallel_for(num_vertices, 0, [&m](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; ++i)
+        {
+            const vertex &v = m.vertices[i];
+            const u8 signs = (u8)((v.normal.z > 0.f) << 1);
+            const u16 normal_x = (u16)math::pack_float<16>(v.normal.x, -1.f, 1.f);
+            const u16 normal_y = (u16)math::pack_float<16>(v.normal.y, -1.f, 1.f);
 
-        m.packed_vertices_static[i] = packed_vertex::vertex_static{
-            v.position, {0, 0, 0}, signs, normal_x, normal_y, {}, v.uv};
-    }
+            m.packed_vertices_static[i] = packed_vertex::vertex_static{
+                v.position, {0, 0, 0}, signs, normal_x, normal_y, {}, v.uv};
+        }
+    });
 }
 
 void process_vertices(mesh &m, const geometry_import_settings &settings)
@@ -396,12 +418,13 @@ void process_scene(scene &scene, const geometry_import_settings &settings)
         }
     }
 
-// Process all meshes in parallel
-#pragma omp parallel for schedule(dynamic)
-    for (s32 i = 0; i < (s32)all_meshes.size(); ++i)
-    {
-        process_vertices(*all_meshes[i], settings);
-    }
+    // One job per mesh, meshes vary wildly in size so idle threads steal the rest
+    jobs::parallel_for((u32)all_meshes.size(), 1, [&](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; ++i)
+        {
+            process_vertices(*all_meshes[i], settings);
+        }
+    });
 }
 
 void pack_data(const scene &scene, scene_data &data)
@@ -507,20 +530,8 @@ bool update_scene_mesh_positions(scene &scn, size_t lod_index, size_t mesh_index
 
     // Clear only *processed* data (vertices, indices, normals, tangents, packed vertices).
     // DO NOT clear raw_indices if we want to recalc geometry properly.
-    m.vertices.clear();
-    m.vertices.shrink_to_fit();
-
-    m.indices.clear();
-    m.indices.shrink_to_fit();
-
-    m.normals.clear();
-    m.normals.shrink_to_fit();
-
-    m.tangents.clear();
-    m.tangents.shrink_to_fit();
-
-    m.packed_vertices_static.clear();
-    m.packed_vertices_static.shrink_to_fit();
+    // Capacity is kept, a dynamic mesh is rebuilt with the same sizes every update.
+    clear_processed_vertex_data(m);
 
     // Usually we preserve UV sets (m.uv_sets) unless you specifically want to modify them.
 
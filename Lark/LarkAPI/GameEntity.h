@@ -8,6 +8,7 @@
 #include "ScriptComponent.h"
 #include "TransformComponent.h"
 #include "MaterialComponent.h"
+#include "../Components/ScriptRuntime.h"
 #include <pybind11/embed.h>
 #include <pybind11/operators.h>
 #include <pybind11/stl.h>
@@ -97,29 +98,62 @@ class entity_script : public game_entity::entity
 {
 
   public:
-    virtual ~entity_script() = default;
+    virtual ~entity_script()
+    {
+        // Scripts may be removed from any thread, the references need the GIL to be dropped
+        if (Py_IsInitialized() && m_instance)
+        {
+            pybind11::gil_scoped_acquire gil;
+            m_update = {};
+            m_begin_play = {};
+            m_instance = {};
+        }
+    }
 
-    void begin_play()
+    /**
+     * @brief Instantiates the Script class of a module for this entity
+     * @param module_name Python module that defines the Script class
+     *
+     * Called by the creator once the derived object exists. The module is
+     * imported through the runtime cache, so only the first instance of a
+     * script type pays for the import. Import and constructor errors are
+     * reported through sys.unraisablehook and leave the script without an
+     * instance.
+     */
+    void load(const std::string &module_name)
     {
+        runtime::wait_until_ready();
+        pybind11::gil_scoped_acquire gil;
         try
         {
-            if (m_instance && pybind11::hasattr(m_instance, "begin_play"))
+            const pybind11::object type{runtime::script_class(module_name)};
+            if (type)
             {
-                m_instance.attr("begin_play")();
+                // Registers the Entity type the instance is constructed with
+                pybind11::module_::import("lark");
+                m_instance = type(game_entity::entity{get_id()});
+
+                // Looked up once, the per-frame dispatch only calls them
+                if (pybind11::hasattr(m_instance, "begin_play"))
+                    m_begin_play = m_instance.attr("begin_play");
+                if (pybind11::hasattr(m_instance, "update"))
+                    m_update = m_instance.attr("update");
             }
         }
-        catch (const pybind11::error_already_set &e)
+        catch (pybind11::error_already_set &e)
         {
+            // Printed with its traceback, the entity keeps running without a script
+            e.discard_as_unraisable(module_name.c_str());
         }
     }
 
-    void update(float dt)
+    void begin_play()
     {
         try
         {
-            if (m_instance && pybind11::hasattr(m_instance, "update"))
+            if (m_begin_play)
             {
-                m_instance.attr("update")(dt);
+                m_begin_play();
             }
         }
         catch (const pybind11::error_already_set &e)
@@ -127,19 +161,13 @@ class entity_script : public game_entity::entity
         }
     }
 
-  protected:
-    explicit entity_script(game_entity::entity entity) : game_entity::entity{entity.get_id()}
+    void update(float dt)
     {
         try
         {
-            static pybind11::scoped_interpreter guard{};
-            // Assuming scripts are in a "scripts" folder relative to executable
-            const char *script_name = typeid(*this).name();
-            m_module = pybind11::module_::import(script_name);
-
-            if (pybind11::hasattr(m_module, "Script"))
+            if (m_update)
             {
-                m_instance = m_module.attr("Script")(entity);
+                m_update(dt);
             }
         }
         catch (const pybind11::error_already_set &e)
@@ -147,9 +175,19 @@ class entity_script : public game_entity::entity
         }
     }
 
+    /** Python Script instance, null when the module has no Script class */
+    const pybind11::object &instance() const { return m_instance; }
+
+    /** Bound update method resolved at creation, null when the script has none */
+    const pybind11::object &update_method() const { return m_update; }
+
+  protected:
+    explicit entity_script(game_entity::entity entity) : game_entity::entity{entity.get_id()} {}
+
   private:
-    pybind11::module m_module;
     pybind11::object m_instance;
+    pybind11::object m_begin_play;
+    pybind11::object m_update;
 };
 
 namespace detail
@@ -162,10 +200,13 @@ u8 register_script(size_t, script_creator);
 script_creator get_script_creator(size_t tag);
 void get_script_names(const char **names, size_t *count);
 
-template <class script_class> script_ptr create_script(game_entity::entity entity)
+template <class script_class>
+script_ptr create_script(game_entity::entity entity, const char *module_name)
 {
     assert(entity.is_valid());
-    return std::make_unique<script_class>(entity);
+    script_ptr script{std::make_unique<script_class>(entity)};
+    script->load(module_name);
+    return script;
 }
 
 u8 add_script_name(const char *name);
@@ -174,7 +215,9 @@ bool script_exists(size_t tag);
     namespace                                                                                      \
     {                                                                                              \
     const u8 _reg## TYPE{lark::script::detail::register_script(                                     \
-        lark::script::detail::string_hash()(#TYPE), &lark::script::detail::create_script<TYPE>)};  \
+        lark::script::detail::string_hash()(#TYPE), [](lark::game_entity::entity entity) {         \
+            return lark::script::detail::create_script<TYPE>(entity, #TYPE);                      \
+        })};                                                                                       \
     const u8 name## TYPE{lark::script::detail::add_script_name(#TYPE)};                             \
     }
 } // namespace detail
@@ -12,16 +12,16 @@ ControlInput Control::computeMotorCommands(const DroneState &state,
     Vector3f pos_err = state.position - desired.position;
     Vector3f dpos_err = state.velocity - desired.velocity;
 
-    Vector3f neg_kp_pos = -m_dynamics.GetQuadParams().control_gains.kp_pos;
+    Vector3f neg_kp_pos = -m_dynamics->GetQuadParams().control_gains.kp_pos;
     Vector3f term1 = neg_kp_pos.cwiseProduct(pos_err);
 
-    Vector3f neg_kd_pos = -m_dynamics.GetQuadParams().control_gains.kd_pos;
+    Vector3f neg_kd_pos = -m_dynamics->GetQuadParams().control_gains.kd_pos;
     Vector3f term2 = neg_kd_pos.cwiseProduct(dpos_err);
     Vector3f term3 = {0, 0, 9.81f};
     Vector3f subterm = desired.acceleration + term3;
     auto combinedTerm = term1 + term2 + subterm;
 
-    Vector3f F_des = m_dynamics.GetQuadParams().inertia_properties.mass * combinedTerm;
+    Vector3f F_des = m_dynamics->GetQuadParams().inertia_properties.mass * combinedTerm;
 
     // Get current body z-axis in world frame
     Matrix3f R = quaternionToRotationMatrix(state.attitude);
@@ -54,19 +54,19 @@ ControlInput Control::computeMotorCommands(const DroneState &state,
     Vector3f w_err = state.body_rates - w_des;
 
     // Desired torque
-    Vector3f u2 = m_dynamics.GetInertiaMatrix() *
-                      (-m_dynamics.GetQuadParams().control_gains.kp_att * att_err -
-                       m_dynamics.GetQuadParams().control_gains.kd_att * w_err) +
-                  state.body_rates.cross(m_dynamics.GetInertiaMatrix() * state.body_rates);
+    Vector3f u2 = m_dynamics->GetInertiaMatrix() *
+                      (-m_dynamics->GetQuadParams().control_gains.kp_att * att_err -
+                       m_dynamics->GetQuadParams().control_gains.kd_att * w_err) +
+                  state.body_rates.cross(m_dynamics->GetInertiaMatrix() * state.body_rates);
 
-    Vector3f cmd_w = -m_dynamics.GetQuadParams().control_gains.kp_att * att_err -
-                     m_dynamics.GetQuadParams().control_gains.kd_att * w_err;
+    Vector3f cmd_w = -m_dynamics->GetQuadParams().control_gains.kp_att * att_err -
+                     m_dynamics->GetQuadParams().control_gains.kd_att * w_err;
 
     Vector4f TM(u1, u2.x(), u2.y(), u2.z());
-    Matrix4f TM_to_f = m_dynamics.GetInverseControlAllocationMatrix();
+    Matrix4f TM_to_f = m_dynamics->GetInverseControlAllocationMatrix();
     Vector4f cmd_rotor_thrust = TM_to_f * TM;
     Vector4f cmd_motor_speeds =
-        cmd_rotor_thrust / m_dynamics.GetQuadParams().rotor_properties.k_eta;
+        cmd_rotor_thrust / m_dynamics->GetQuadParams().rotor_properties.k_eta;
     cmd_motor_speeds =
         cmd_motor_speeds.cwiseSign().cwiseProduct(cmd_motor_speeds.cwiseAbs().cwiseSqrt());
 
@@ -76,9 +76,9 @@ ControlInput Control::computeMotorCommands(const DroneState &state,
     input.cmd_moment = u2;
     input.cmd_w = cmd_w;
     input.cmd_q = rotationMatrixToQuaternion(R_des);
-    auto b = -m_dynamics.GetQuadParams().control_gains.kp_vel.cwiseProduct(pos_err);
+    auto b = -m_dynamics->GetQuadParams().control_gains.kp_vel.cwiseProduct(pos_err);
     input.cmd_v = b + desired.velocity;
-    input.cmd_acc = F_des / m_dynamics.GetQuadParams().inertia_properties.mass;
+    input.cmd_acc = F_des / m_dynamics->GetQuadParams().inertia_properties.mass;
     return input;
 };
 } // namespace lark::drones
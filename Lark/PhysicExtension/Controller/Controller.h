@@ -1,14 +1,15 @@
 #pragma once
 #include "PhysicExtension/Trajectory/Trajectory.h"
-#include "PhysicExtension/Utils/DroneDynamics.h"
+#include "PhysicExtension/Vehicles/VehicleTypes.h"
 
 namespace lark::drone
 {
 class Control
 {
   public:
-    explicit Control(const QuadParams &quad_params)
-        : m_dynamics(quad_params)
+    explicit Control(vehicle_type dynamics) : m_dynamics(std::move(dynamics)) {}
+
+    explicit Control(const QuadParams &quad_params) : Control(vehicle_types::acquire(quad_params))
     {
     }
 
@@ -16,6 +17,6 @@ class Control
                                                     const TrajectoryPoint &desired) const;
 
   private:
-    DroneDynamics m_dynamics;
+    vehicle_type m_dynamics; ///< Shared per vehicle type, see VehicleTypes.h
 };
 } // namespace lark::drones
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "VectorEnv.h"
+#include "Core/JobSystem.h"
+
+namespace lark::drone
+{
+namespace
+{
+constexpr f32 body_rate_penalty{0.05f};
+
+/**
+ * @brief Same sequence for the same seed and index, independent of thread count
+ */
+u32 env_seed(u64 seed, u32 env)
+{
+    const u64 mixed{(seed + env + 1) * 0x9E3779B97F4A7C15ull};
+    return (u32)(mixed ^ (mixed >> 32)) | 1u;
+}
+
+bool is_finite(const DroneState &state)
+{
+    return state.position.allFinite() && state.velocity.allFinite() &&
+           state.attitude.allFinite() && state.body_rates.allFinite();
+}
+} // namespace
+
+VectorEnv::VectorEnv(const QuadParams &params, const VectorEnvConfig &config) : _config{config}
+{
+    assert(_config.num_envs > 0 && _config.substeps > 0);
+    assert(_config.abstraction != ControlAbstraction::CMD_CTATT);
+
+    const vehicle_type dynamics{vehicle_types::acquire(params)};
+    _hover_speed = std::sqrt(params.inertia_properties.mass * 9.81f /
+                             ((f32)GeometricProperties::num_rotors * params.rotor_properties.k_eta));
+
+    const u32 count{_config.num_envs};
+    _vehicles.reserve(count);
+    _states.resize(count);
+    _episode_steps.resize(count);
+    _rngs.reserve(count);
+
+    for (u32 i{0}; i < count; ++i)
+    {
+        _vehicles.emplace_back(dynamics, DroneState{}, _config.abstraction);
+        _rngs.emplace_back(env_seed(_config.seed, i));
+        reset_env(i);
+    }
+}
+
+void VectorEnv::reset(const u32 *indices, u32 count, const VectorEnvBuffers &out)
+{
+    assert(out.observations);
+
+    if (!indices)
+    {
+        jobs::parallel_for(num_envs(), 0, [this, &out](u32 begin, u32 end) {
+            for (u32 i{begin}; i < end; ++i)
+            {
+                reset_env(i);
+                write_observation(i, out.observations);
+            }
+        });
+        return;
+    }
+
+    for (u32 i{0}; i < count; ++i)
+    {
+        assert(indices[i] < num_envs());
+        reset_env(indices[i]);
+        write_observation(indices[i], out.observations);
+    }
+}
+
+void VectorEnv::step(const f32 *actions, const VectorEnvBuffers &out)
+{
+    assert(actions && out.observations && out.rewards && out.terminated && out.truncated);
+
+    jobs::parallel_for(num_envs(), 0, [this, actions, &out](u32 begin, u32 end) {
+        for (u32 i{begin}; i < end; ++i)
+        {
+            const ControlInput input{make_input(actions + (size_t)i * action_size)};
+            DroneState &state{_states[i]};
+            for (u32 s{0}; s < _config.substeps; ++s)
+                state = _vehicles[i].step(state, input, _config.dt);
+
+            const bool finite{is_finite(state)};
+            const f32 distance{(state.position - _config.target).norm()};
+            const bool terminated{!finite || distance > _config.max_distance};
+            const bool truncated{!terminated && ++_episode_steps[i] >= _config.max_episode_steps};
+
+            out.rewards[i] = finite ? -distance - body_rate_penalty * state.body_rates.norm()
+                                    : -_config.max_distance;
+            out.terminated[i] = terminated;
+            out.truncated[i] = truncated;
+
+            if (terminated || truncated)
+                reset_env(i);
+
+            write_observation(i, out.observations);
+        }
+    });
+}
+
+void VectorEnv::reset_env(u32 env)
+{
+    std::uniform_real_distribution<f32> offset{-_config.spawn_extent, _config.spawn_extent};
+    auto &rng = _rngs[env];
+
+    DroneState &state{_states[env]};
+    state.position = _config.target + Vector3f{offset(rng), offset(rng), offset(rng)};
+    state.velocity.setZero();
+    state.attitude = Vector4f{0.f, 0.f, 0.f, 1.f};
+    state.body_rates.setZero();
+    state.wind.setZero();
+    state.rotor_speeds.setConstant(_hover_speed);
+
+    // Motor noise follows the env's seed as well, not the engine-wide stream
+    _vehicles[env].GetNoiseGenerator().seed(rng());
+
+    _episode_steps[env] = 0;
+}
+
+void VectorEnv::write_observation(u32 env, f32 *observations) const
+{
+    const DroneState &state{_states[env]};
+    f32 *row{observations + (size_t)env * observation_size};
+
+    Eigen::Map<Vector3f>{row + 0} = state.position;
+    Eigen::Map<Vector3f>{row + 3} = state.velocity;
+    Eigen::Map<Vector4f>{row + 6} = state.attitude;
+    Eigen::Map<Vector3f>{row + 10} = state.body_rates;
+}
+
+ControlInput VectorEnv::make_input(const f32 *action) const
+{
+    const Eigen::Map<const Vector4f> a{action};
+    ControlInput input{};
+
+    switch (_config.abstraction)
+    {
+    case ControlAbstraction::CMD_MOTOR_SPEEDS:
+        input.cmd_motor_speeds = a;
+        break;
+    case ControlAbstraction::CMD_MOTOR_THRUSTS:
+        input.cmd_motor_thrusts = a;
+        break;
+    case ControlAbstraction::CMD_CTBR:
+        input.cmd_thrust = a[0];
+        input.cmd_w = a.tail<3>();
+        break;
+    case ControlAbstraction::CMD_CTBM:
+        input.cmd_thrust = a[0];
+        input.cmd_moment = a.tail<3>();
+        break;
+    case ControlAbstraction::CMD_VEL:
+        input.cmd_v = a.head<3>();
+        break;
+    case ControlAbstraction::CMD_ACC:
+        input.cmd_acc = a.head<3>();
+        break;
+    case ControlAbstraction::CMD_CTATT:
+        break;
+    }
+
+    return input;
+}
+
+} // namespace lark::drone
@@ -0,0 +1,101 @@
+/**
+ * @file VectorEnv.h
+ * @brief Batch of independent single-drone environments for reinforcement learning
+ *
+ * Every environment owns one Multirotor and its state, outside of the entity
+ * system, so thousands of them can be stepped per call. All outputs are
+ * written into caller-owned buffers; the Python bindings hand NumPy-owned
+ * memory to it so stepping never creates Python objects.
+ */
+
+#pragma once
+#include "PhysicExtension/Vehicles/Multirotor.h"
+#include <random>
+
+namespace lark::drone
+{
+
+/**
+ * @struct VectorEnvConfig
+ * @brief Parameters shared by all environments of a batch
+ */
+struct VectorEnvConfig
+{
+    u32 num_envs{1};
+    f32 dt{0.01f};                ///< Integration step
+    u32 substeps{1};              ///< Integration steps per env step, the action is held
+    u32 max_episode_steps{500};   ///< Episodes are truncated after this many env steps
+    ControlAbstraction abstraction{ControlAbstraction::CMD_MOTOR_SPEEDS};
+    Vector3f target{0.f, 0.f, 1.f}; ///< Hover target in world space
+    f32 spawn_extent{1.f};        ///< Initial positions are uniform within target +- extent
+    f32 max_distance{5.f};        ///< Episodes terminate farther than this from the target
+    u64 seed{0};
+};
+
+/**
+ * @struct VectorEnvBuffers
+ * @brief Output arrays of a batch, each holding num_envs rows
+ */
+struct VectorEnvBuffers
+{
+    f32 *observations{nullptr}; ///< [num_envs, observation_size]
+    f32 *rewards{nullptr};      ///< [num_envs]
+    bool *terminated{nullptr};  ///< [num_envs]
+    bool *truncated{nullptr};   ///< [num_envs]
+};
+
+/**
+ * @class VectorEnv
+ * @brief Steps all environments in parallel on the job system
+ *
+ * Observation: position (3), velocity (3), attitude quaternion xyzw (4) and
+ * body rates (3). Reward: negative distance to the target minus a small body
+ * rate penalty. Environments that terminate or get truncated are reset right
+ * away, their observation row then holds the first observation of the new
+ * episode.
+ */
+class VectorEnv
+{
+  public:
+    static constexpr u32 observation_size{13};
+    static constexpr u32 action_size{4};
+
+    /**
+     * @brief Creates the batch. The abstraction must take four action values,
+     * CMD_CTATT is not supported.
+     */
+    VectorEnv(const QuadParams &params, const VectorEnvConfig &config);
+
+    /**
+     * @brief Starts new episodes
+     * @param indices Environments to reset, nullptr resets all of them
+     * @param count Number of indices
+     * @param out Only the observation rows of reset environments are written
+     */
+    void reset(const u32 *indices, u32 count, const VectorEnvBuffers &out);
+
+    /**
+     * @brief Applies one action per environment and advances all of them
+     * @param actions [num_envs, action_size], interpreted according to the abstraction
+     */
+    void step(const f32 *actions, const VectorEnvBuffers &out);
+
+    u32 num_envs() const { return _config.num_envs; }
+    const VectorEnvConfig &config() const { return _config; }
+    const DroneState &state(u32 env) const { return _states[env]; }
+
+  private:
+    void reset_env(u32 env);
+    void write_observation(u32 env, f32 *observations) const;
+    ControlInput make_input(const f32 *action) const;
+
+    VectorEnvConfig _config;
+    f32 _hover_speed{0.f}; ///< Rotor speed that cancels gravity, used for spawning
+
+    util::vector<Multirotor> _vehicles;
+    util::vector<DroneState> _states;
+    util::vector<u32> _episode_steps;
+    util::vector<std::minstd_rand> _rngs;
+};
+
+} // namespace lark::drone
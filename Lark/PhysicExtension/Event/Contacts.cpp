@@ -0,0 +1,136 @@
+#include "Contacts.h"
+#include <btBulletCollisionCommon.h>
+#include <algorithm>
+
+namespace lark::physics
+{
+namespace
+{
+id::id_type entity_of(const btCollisionObject *object)
+{
+    return (id::id_type)reinterpret_cast<uintptr_t>(object->getUserPointer());
+}
+
+u64 pair_key(id::id_type a, id::id_type b) { return ((u64)a << 32) | b; }
+
+/**
+ * @brief Deepest touching point of a manifold, false if none penetrates
+ */
+bool deepest_point(const btPersistentManifold &manifold, contact_event &contact)
+{
+    const btManifoldPoint *deepest{nullptr};
+    for (int i{0}; i < manifold.getNumContacts(); ++i)
+    {
+        const btManifoldPoint &point{manifold.getContactPoint(i)};
+        if (point.getDistance() <= 0.f && (!deepest || point.getDistance() < deepest->getDistance()))
+            deepest = &point;
+    }
+
+    if (!deepest)
+        return false;
+
+    const btVector3 position{(deepest->getPositionWorldOnA() + deepest->getPositionWorldOnB()) * 0.5f};
+    for (u32 i{0}; i < 3; ++i)
+    {
+        contact.position[i] = (f32)position[i];
+        contact.normal[i] = (f32)deepest->m_normalWorldOnB[i];
+    }
+    contact.depth = (f32)-deepest->getDistance();
+    return true;
+}
+
+/**
+ * @brief End event of a pair, keeps the last normal
+ */
+contact_event ended(const contact_event &last)
+{
+    contact_event event{last};
+    event.phase = contact_phase::end;
+    std::fill_n(event.position, 3, 0.f);
+    event.depth = 0.f;
+    return event;
+}
+} // namespace
+
+void ContactTracker::update(btCollisionDispatcher &dispatcher)
+{
+    std::swap(m_previous, m_active);
+    m_active.clear();
+    m_events.clear();
+
+    // Only pairs whose bounds overlap have a manifold
+    const int manifold_count{dispatcher.getNumManifolds()};
+    for (int i{0}; i < manifold_count; ++i)
+    {
+        const btPersistentManifold &manifold{*dispatcher.getManifoldByIndexInternal(i)};
+        contact_event contact{};
+        if (!deepest_point(manifold, contact))
+            continue;
+
+        id::id_type a{entity_of(manifold.getBody0())};
+        id::id_type b{entity_of(manifold.getBody1())};
+        if (a == b)
+            continue;
+
+        // The manifold normal points from body1 towards body0
+        if (a > b)
+        {
+            std::swap(a, b);
+            for (f32 &n : contact.normal)
+                n = -n;
+        }
+
+        contact.entity_a = a;
+        contact.entity_b = b;
+        m_active.push_back({pair_key(a, b), contact});
+    }
+
+    // Compound shapes give a pair several manifolds, keep the deepest
+    std::sort(m_active.begin(), m_active.end(),
+              [](const pair_contact &l, const pair_contact &r) {
+                  return l.key < r.key || (l.key == r.key && l.contact.depth > r.contact.depth);
+              });
+    m_active.erase(std::unique(m_active.begin(), m_active.end(),
+                               [](const pair_contact &l, const pair_contact &r) { return l.key == r.key; }),
+                   m_active.end());
+
+    // Both lists are sorted, one merge pass classifies every pair
+    u32 previous{0};
+    for (pair_contact &pair : m_active)
+    {
+        while (previous < m_previous.size() && m_previous[previous].key < pair.key)
+            m_events.push_back(ended(m_previous[previous++].contact));
+
+        const bool persists{previous < m_previous.size() && m_previous[previous].key == pair.key};
+        previous += persists;
+        pair.contact.phase = persists ? contact_phase::persist : contact_phase::begin;
+        m_events.push_back(pair.contact);
+    }
+
+    for (; previous < m_previous.size(); ++previous)
+        m_events.push_back(ended(m_previous[previous].contact));
+}
+
+void ContactTracker::clear()
+{
+    m_active.clear();
+    m_previous.clear();
+    m_events.clear();
+}
+
+u32 ContactTracker::events_of(id::id_type entity, contact_event *out, u32 capacity) const
+{
+    u32 count{0};
+    for (const contact_event &event : m_events)
+    {
+        if (event.entity_a != entity && event.entity_b != entity)
+            continue;
+
+        if (count < capacity)
+            out[count] = event;
+        ++count;
+    }
+    return count;
+}
+
+} // namespace lark::physics
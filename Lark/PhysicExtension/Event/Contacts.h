@@ -0,0 +1,88 @@
+/**
+ * @file Contacts.h
+ * @brief Contact events between entities, derived from Bullet's persistent manifolds
+ *
+ * After every collision pass the tracker reads the dispatcher's manifolds,
+ * merges all manifolds of an entity pair into one contact and compares the
+ * touching pairs with those of the previous pass. Each pair yields one event
+ * per pass: begin when it starts touching, persist while it keeps touching
+ * and end on the first pass it no longer does. Event storage is reused, the
+ * cost grows with the number of overlapping pairs, not with the body count.
+ */
+
+#pragma once
+#include "CommonHeaders.h"
+
+class btCollisionDispatcher;
+
+namespace lark::physics
+{
+
+enum class contact_phase : u32
+{
+    begin,
+    persist,
+    end,
+};
+
+/**
+ * @struct contact_event
+ * @brief One entity pair, entity_a is always the lower id
+ */
+struct contact_event
+{
+    id::id_type entity_a;
+    id::id_type entity_b;
+    contact_phase phase;
+    f32 position[3]; ///< Deepest point, midway between the surfaces. Zero for end events
+    f32 normal[3];   ///< World space, pointing from b towards a
+    f32 depth;       ///< Penetration depth, positive when overlapping
+};
+
+/**
+ * @class ContactTracker
+ * @brief Turns manifolds into begin/persist/end events per entity pair
+ *
+ * Bodies are mapped to entities through their user pointer, which
+ * physics::create sets to the entity id.
+ */
+class ContactTracker
+{
+  public:
+    /**
+     * @brief Replaces the events with those of the dispatcher's current manifolds
+     */
+    void update(btCollisionDispatcher &dispatcher);
+
+    /**
+     * @brief Forgets all pairs, the next update reports every contact as begin
+     */
+    void clear();
+
+    const contact_event *events() const { return m_events.data(); }
+    u32 event_count() const { return (u32)m_events.size(); }
+
+    /**
+     * @brief Pairs touching after the last update
+     */
+    u32 active_count() const { return (u32)m_active.size(); }
+
+    /**
+     * @brief Copies the events that involve entity
+     * @return Number of matching events, which may exceed capacity
+     */
+    u32 events_of(id::id_type entity, contact_event *out, u32 capacity) const;
+
+  private:
+    struct pair_contact
+    {
+        u64 key; ///< entity_a in the high bits, so sorting groups pairs
+        contact_event contact;
+    };
+
+    util::vector<pair_contact> m_active;   ///< Sorted by key
+    util::vector<pair_contact> m_previous; ///< m_active of the last update
+    util::vector<contact_event> m_events;
+};
+
+} // namespace lark::physics
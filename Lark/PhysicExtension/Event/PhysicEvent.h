@@ -1,62 +1,123 @@
 #pragma once
-#include <functional>
+#include "Core/Context.h"
+#include <algorithm>
+#include <tuple>
 #include <vector>
-#include <unordered_map>
-#include <typeindex>
-#include <memory>
-#include <string>
 
-// Base event class
-struct PhysicsEvent
+class btRigidBody;
+
+// Specific events, plain data so they can be queued by value
+struct PhysicObjectCreated
 {
-    virtual ~PhysicsEvent() = default;
+    btRigidBody* body;
 };
 
-// Specific events
-struct PhysicObjectCreated : PhysicsEvent
+struct PhysicObjectRemoved
 {
     btRigidBody* body;
 };
 
-struct PhysicObjectRemoved : PhysicsEvent
+using PhysicSubscription = u32;
+
+// Queue and subscribers of one event type
+template<typename TEvent>
+struct PhysicEventQueue
 {
-    btRigidBody* body;
+    using Handler = void (*)(void* owner, const TEvent* events, u32 count);
+
+    struct Subscriber
+    {
+        Handler handler;
+        void* owner;
+        PhysicSubscription id;
+    };
+
+    std::vector<TEvent> events;
+    std::vector<Subscriber> subscribers;
 };
 
+// Deferred event bus. Publish appends to the queue of the event type and
+// Dispatch hands every queue to its subscribers in one call per subscriber,
+// then clears it. Queues keep their capacity, so a steady tick allocates
+// nothing. The physics component dispatches once per tick (physics::dispatch_events).
+//
+// One bus per lark::context, events never cross into another simulation
 class PhysicEventBus
 {
 public:
     static PhysicEventBus& Get()
     {
-        static PhysicEventBus instance;
-        return instance;
+        static lark::context_local<PhysicEventBus> buses;
+        return *buses;
     }
 
-    template<typename TEvent>
-    void Subscribe(std::function<void(const TEvent&)> handler)
+    // Handler is a member function of TOwner taking (const TEvent*, u32 count),
+    // bound at compile time: Subscribe<PhysicObjectCreated, &Owner::OnCreated>(this)
+    template<typename TEvent, auto Handler, typename TOwner>
+    PhysicSubscription Subscribe(TOwner* owner)
     {
-        auto typeIndex = std::type_index(typeid(TEvent));
-        m_handlers[typeIndex].push_back(
-            [handler](const PhysicsEvent& e) {
-                handler(static_cast<const TEvent&>(e));
-            }
-        );
+        const PhysicSubscription id{++m_last_subscription};
+        Queue<TEvent>().subscribers.push_back(
+            {[](void* o, const TEvent* events, u32 count) {
+                 (static_cast<TOwner*>(o)->*Handler)(events, count);
+             },
+             owner, id});
+        return id;
+    }
+
+    void Unsubscribe(PhysicSubscription id)
+    {
+        std::apply([id](auto&... queues) { (EraseSubscriber(queues, id), ...); }, m_queues);
     }
 
     template<typename TEvent>
     void Publish(const TEvent& event)
     {
-        auto typeIndex = std::type_index(typeid(TEvent));
-        auto it = m_handlers.find(typeIndex);
-        if (it != m_handlers.end())
-        {
-            for (auto& handler : it->second)
-            {
-                handler(event);
-            }
-        }
+        Queue<TEvent>().events.push_back(event);
+    }
+
+    // Drains the queues in the order of m_queues. Handlers must not publish
+    // events of the type they are handling.
+    void Dispatch()
+    {
+        std::apply([](auto&... queues) { (DispatchQueue(queues), ...); }, m_queues);
+    }
+
+    template<typename TEvent>
+    u32 Pending() const
+    {
+        return (u32)std::get<PhysicEventQueue<TEvent>>(m_queues).events.size();
     }
 
 private:
-    std::unordered_map<std::type_index, std::vector<std::function<void(const PhysicsEvent&)>>> m_handlers;
-};
\ No newline at end of file
+    template<typename TEvent>
+    PhysicEventQueue<TEvent>& Queue()
+    {
+        return std::get<PhysicEventQueue<TEvent>>(m_queues);
+    }
+
+    template<typename TEvent>
+    static void DispatchQueue(PhysicEventQueue<TEvent>& queue)
+    {
+        if (queue.events.empty())
+            return;
+
+        const u32 count{(u32)queue.events.size()};
+        for (const auto& subscriber : queue.subscribers)
+            subscriber.handler(subscriber.owner, queue.events.data(), count);
+        queue.events.clear();
+    }
+
+    template<typename TEvent>
+    static void EraseSubscriber(PhysicEventQueue<TEvent>& queue, PhysicSubscription id)
+    {
+        auto& subscribers = queue.subscribers;
+        subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+                                         [id](const auto& s) { return s.id == id; }),
+                          subscribers.end());
+    }
+
+    // Every event type needs a queue here; creations drain before removals
+    std::tuple<PhysicEventQueue<PhysicObjectCreated>, PhysicEventQueue<PhysicObjectRemoved>> m_queues;
+    PhysicSubscription m_last_subscription{0};
+};
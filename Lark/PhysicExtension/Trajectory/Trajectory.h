@@ -1,5 +1,6 @@
 #pragma once
 #include "PhysicExtension/Utils/PhysicsMath.h"
+#include "Utils/Random.h"
 #include <random>
 #include <vector>
 
@@ -102,7 +103,7 @@ class Chaos : public Trajectory
 {
   public:
     Chaos(const Vector3f &center, float delta, int n_points, float segment_time = 1.0f)
-        : rng(std::random_device{}()), dist(-delta, delta), segment_time(segment_time)
+        : rng(random::next_seed()), dist(-delta, delta), segment_time(segment_time)
     {
 
         for (int i = 0; i < n_points; ++i)
@@ -135,22 +136,23 @@ class Chaos : public Trajectory
         Vector3f jerk = Vector3f::Zero();
         Vector3f snap = Vector3f::Zero();
 
-        // Fill trajectory point
-        point.position = pos;
-        point.velocity = vel;
-        point.acceleration = acc;
-        point.jerk = jerk;
-        point.snap = snap;
+        // Fill trajectory point, kept local so a shared trajectory can be sampled concurrently
+        TrajectoryPoint pt;
+        pt.position = pos;
+        pt.velocity = vel;
+        pt.acceleration = acc;
+        pt.jerk = jerk;
+        pt.snap = snap;
 
-        point.yaw = 0.0f;
-        point.yaw_dot = 0.0f;
-        point.yaw_ddot = 0.0f;
+        pt.yaw = 0.0f;
+        pt.yaw_dot = 0.0f;
+        pt.yaw_ddot = 0.0f;
 
-        return point;
+        return pt;
     };
 
   private:
-    std::mt19937 rng;
+    random::engine rng;
     std::uniform_real_distribution<float> dist;
 
     std::vector<Vector3f> points;
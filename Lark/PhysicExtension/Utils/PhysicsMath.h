@@ -2,6 +2,16 @@
 #include <Eigen/Core>
 #include <Eigen/Dense>
 #include <Eigen/Geometry>
+#include "Utils/Vector.h"
+
+namespace lark::util
+{
+// Eigen matrices hold their coefficients inline or behind a heap pointer, never a self-reference
+template <typename S, int R, int C, int O, int MR, int MC>
+struct is_trivially_relocatable<Eigen::Matrix<S, R, C, O, MR, MC>> : std::true_type
+{
+};
+} // namespace lark::util
 
 namespace lark::physics_math
 {
@@ -2,6 +2,8 @@
 #include <random>
 
 #include "PhysicsMath.h"
+#include "Utils/BinaryStream.h"
+#include "Utils/Random.h"
 
 namespace lark::drone
 {
@@ -13,6 +15,10 @@ class Wind
     virtual ~Wind() = default;
     virtual Eigen::Vector3f update(float t, Eigen::Vector3f position) = 0;
 
+    /** Writes the state that update() changes, stateless models write nothing */
+    virtual void save_state(util::byte_writer &out) const {}
+    virtual void load_state(util::byte_reader &in) {}
+
   protected:
     Eigen::Vector3f wind;
 };
@@ -69,7 +75,7 @@ class LadderWind : public Wind
                         Eigen::Vector3f max = Eigen::Vector3f(1, 1, 1),
                         Eigen::Vector3f d = Eigen::Vector3f(1, 1, 1),
                         Eigen::Vector3f Nstep = Eigen::Vector3f(5, 5, 5), bool r = false)
-        : duration(d), random(r), gen(std::random_device{}())
+        : duration(d), random(r), gen(lark::random::next_seed())
     {
         // Input validation
         if (Nstep.x() <= 0 || Nstep.y() <= 0 || Nstep.z() <= 0)
@@ -165,6 +171,28 @@ class LadderWind : public Wind
         return {wx, wy, wz};
     }
 
+    void save_state(util::byte_writer &out) const override
+    {
+        out.write(xid);
+        out.write(yid);
+        out.write(zid);
+        out.write_bytes(timer.data(), sizeof(f32) * 3);
+        out.write(lark::random::save_state(gen));
+    }
+
+    void load_state(util::byte_reader &in) override
+    {
+        u32 gen_state{0};
+        if (in.read(xid) && in.read(yid) && in.read(zid) &&
+            in.read_bytes(timer.data(), sizeof(f32) * 3) && in.read(gen_state))
+        {
+            lark::random::load_state(gen, gen_state);
+            wx = wx_arr[xid];
+            wy = wy_arr[yid];
+            wz = wz_arr[zid];
+        }
+    }
+
   private:
     int xid, yid, zid;
     int nx, ny, nz;
@@ -173,6 +201,6 @@ class LadderWind : public Wind
     Eigen::Vector3f duration;
     Eigen::Vector3f timer;
     bool random;
-    std::mt19937 gen;
+    lark::random::engine gen; // Qualified, the member above hides the namespace
 };
 } // namespace lark::drones
\ No newline at end of file
@@ -21,7 +21,7 @@ Vector4f Multirotor::GetCMDMotorSpeeds(DroneState state, ControlInput input)
     case ControlAbstraction::CMD_MOTOR_THRUSTS:
     {
         Vector4f motor_speeds =
-            input.cmd_motor_thrusts / m_dynamics.GetQuadParams().rotor_properties.k_eta;
+            input.cmd_motor_thrusts / m_dynamics->GetQuadParams().rotor_properties.k_eta;
         return motor_speeds.cwiseSign().cwiseProduct(motor_speeds.cwiseAbs().cwiseSqrt());
     }
 
@@ -35,19 +35,19 @@ Vector4f Multirotor::GetCMDMotorSpeeds(DroneState state, ControlInput input)
         cmd_thrust = input.cmd_thrust;
         Vector3f w_err = state.body_rates - input.cmd_w;
         Vector3f w_dot_cmd =
-            -m_dynamics.GetQuadParams().lower_level_controller_properties.k_w * w_err;
-        cmd_moment = m_dynamics.GetInertiaMatrix() * w_dot_cmd;
+            -m_dynamics->GetQuadParams().lower_level_controller_properties.k_w * w_err;
+        cmd_moment = m_dynamics->GetInertiaMatrix() * w_dot_cmd;
         break; // ADD BREAK
     }
 
     case ControlAbstraction::CMD_VEL:
     { // ADD BRACES
         Vector3f v_err = state.velocity - input.cmd_v;
-        Vector3f a_cmd = -m_dynamics.GetQuadParams().lower_level_controller_properties.k_v * v_err;
+        Vector3f a_cmd = -m_dynamics->GetQuadParams().lower_level_controller_properties.k_v * v_err;
 
         Vector3f subterm = a_cmd + Vector3f(0, 0, 9.81f);
 
-        F_des = m_dynamics.GetQuadParams().inertia_properties.mass * subterm;
+        F_des = m_dynamics->GetQuadParams().inertia_properties.mass * subterm;
 
         R = quaternionToRotationMatrix(state.attitude);
         b3 = R.col(2);
@@ -86,7 +86,7 @@ Vector4f Multirotor::GetCMDMotorSpeeds(DroneState state, ControlInput input)
 
     case ControlAbstraction::CMD_ACC:
     { // ADD BRACES
-        F_des = input.cmd_acc * m_dynamics.GetQuadParams().inertia_properties.mass;
+        F_des = input.cmd_acc * m_dynamics->GetQuadParams().inertia_properties.mass;
         R = quaternionToRotationMatrix(state.attitude);
         b3 = R.col(2);
         cmd_thrust = F_des.dot(b3);
@@ -115,9 +115,9 @@ Vector4f Multirotor::GetCMDMotorSpeeds(DroneState state, ControlInput input)
     }
 
     Vector4f TM(cmd_thrust, cmd_moment.x(), cmd_moment.y(), cmd_moment.z());
-    Vector4f cmd_motor_forces = m_dynamics.GetInverseControlAllocationMatrix() * TM;
+    Vector4f cmd_motor_forces = m_dynamics->GetInverseControlAllocationMatrix() * TM;
     Vector4f cmd_motor_speeds =
-        cmd_motor_forces / m_dynamics.GetQuadParams().rotor_properties.k_eta;
+        cmd_motor_forces / m_dynamics->GetQuadParams().rotor_properties.k_eta;
     cmd_motor_speeds =
         cmd_motor_speeds.cwiseSign().cwiseProduct(cmd_motor_speeds.cwiseAbs().cwiseSqrt());
 
@@ -132,54 +132,51 @@ std::pair<Vector3f, Vector3f> Multirotor::ComputeBodyWrench(const Vector3f &body
     // We need 3x4 for the multiplication, so transpose it
     // In NumPy: (n,1) * (m,) broadcasts → (n,m)
     // In Eigen: VectorN * VectorM.transpose() → (n,m)
-    auto geometry_transposed = m_dynamics.GetRotorGeometry().transpose();
+    // Everything is sized for the four rotors at compile time, so the step never allocates
+    const Matrix3x4f geometry_transposed = m_dynamics->GetRotorGeometry().transpose();
 
-    Eigen::Matrix<float, 3, Eigen::Dynamic> local_airspeeds(3, geometry_transposed.cols());
-
-    auto replicated_airspeed =
-        body_airspeed_vector.replicate(1, geometry_transposed.cols()).cast<float>();
-    auto rotational_velocity = hatMap(body_rate) * geometry_transposed;
-    local_airspeeds = replicated_airspeed + rotational_velocity;
+    const Matrix3x4f local_airspeeds =
+        body_airspeed_vector.replicate<1, 4>() + hatMap(body_rate) * geometry_transposed;
 
     // rotor speeds square
     Eigen::Vector4f rotor_square = rotor_speeds.array().square();
 
-    Eigen::Vector3f Tvec(0, 0, m_dynamics.GetQuadParams().rotor_properties.k_eta);
+    Eigen::Vector3f Tvec(0, 0, m_dynamics->GetQuadParams().rotor_properties.k_eta);
     Eigen::Matrix<float, 3, 4> T = Tvec * rotor_square.transpose();
 
     Vector3f D = Vector3f::Zero();
-    Eigen::Matrix3Xf H = Eigen::Matrix3Xf::Zero(3, rotor_speeds.size());
-    Eigen::Matrix3Xf M_flap = Eigen::Matrix3Xf::Zero(3, rotor_speeds.size());
+    Matrix3x4f H = Matrix3x4f::Zero();
+    Matrix3x4f M_flap = Matrix3x4f::Zero();
 
     if (m_aero)
     {
         float airspeed_magnitude = body_airspeed_vector.norm();
-        Matrix3f drag_matrix = m_dynamics.GetQuadParams().aero_dynamics_properties.GetDragMatrix();
+        Matrix3f drag_matrix = m_dynamics->GetQuadParams().aero_dynamics_properties.GetDragMatrix();
         Vector3f drag_direction = drag_matrix * body_airspeed_vector;
         D = -airspeed_magnitude * drag_direction;
 
         // H force calculation
-        Eigen::Matrix3Xf temp =
-            m_dynamics.GetQuadParams().rotor_properties.GetRotorDragMatrix() * local_airspeeds;
-        H = -temp.array() * rotor_speeds.transpose().replicate(3, 1).array();
+        const Matrix3x4f temp =
+            m_dynamics->GetQuadParams().rotor_properties.GetRotorDragMatrix() * local_airspeeds;
+        H = -temp.array() * rotor_speeds.transpose().replicate<3, 1>().array();
 
         // Pitching flapping moment acting at each propeller hub
         Vector3f z_unit(0, 0, 1);
-        for (int i = 0; i < m_dynamics.GetQuadParams().geometric_properties.num_rotors; ++i)
+        for (int i = 0; i < m_dynamics->GetQuadParams().geometric_properties.num_rotors; ++i)
         {
             Matrix3f hat_local = hatMap(local_airspeeds.col(i));
-            M_flap.col(i) = -m_dynamics.GetQuadParams().rotor_properties.k_flap * rotor_speeds(i) *
+            M_flap.col(i) = -m_dynamics->GetQuadParams().rotor_properties.k_flap * rotor_speeds(i) *
                             (hat_local * z_unit);
         }
 
         // Translational lift
-        Eigen::RowVectorXf xy_squared = local_airspeeds.topRows<2>().colwise().squaredNorm();
-        T.row(2).array() += m_dynamics.GetQuadParams().rotor_properties.k_h * xy_squared.array();
+        const Eigen::RowVector4f xy_squared = local_airspeeds.topRows<2>().colwise().squaredNorm();
+        T.row(2).array() += m_dynamics->GetQuadParams().rotor_properties.k_h * xy_squared.array();
     }
 
     // Compute the moments due to the rotor thrusts, rotor drag, and rotor drag torques
     Vector3f M_force = Vector3f::Zero();
-    for (int i = 0; i < m_dynamics.GetQuadParams().geometric_properties.num_rotors; ++i)
+    for (int i = 0; i < m_dynamics->GetQuadParams().geometric_properties.num_rotors; ++i)
     {
         Vector3f r = geometry_transposed.col(i);
         Vector3f f = T.col(i) + H.col(i);
@@ -189,8 +186,8 @@ std::pair<Vector3f, Vector3f> Multirotor::ComputeBodyWrench(const Vector3f &body
 
     M_force = -M_force;
 
-    Eigen::Vector3f subterm(0, 0, m_dynamics.GetQuadParams().rotor_properties.k_m);
-    Eigen::Vector4f rotor_dir = m_dynamics.GetQuadParams().geometric_properties.rotor_directions;
+    Eigen::Vector3f subterm(0, 0, m_dynamics->GetQuadParams().rotor_properties.k_m);
+    Eigen::Vector4f rotor_dir = m_dynamics->GetQuadParams().geometric_properties.rotor_directions;
 
     // scale each column j by rotor_square[j] * rotor_dir[j]
     Eigen::Vector4f col_scale = rotor_square.cwiseProduct(rotor_dir);
@@ -221,7 +218,7 @@ SDot Multirotor::s_dot_fn(DroneState state, Vector4f cmd_rotor_speeds)
     Matrix3f R = quaternionToRotationMatrix(state.attitude);
 
     // rotor speeds derivative
-    float tau_scalar = 1.0f / m_dynamics.GetQuadParams().motor_properties.tau_m;
+    float tau_scalar = 1.0f / m_dynamics->GetQuadParams().motor_properties.tau_m;
     Vector4f rotor_diff = cmd_rotor_speeds - rotor_speeds;
     Vector4f rotor_accel = tau_scalar * rotor_diff;
 
@@ -246,29 +243,31 @@ SDot Multirotor::s_dot_fn(DroneState state, Vector4f cmd_rotor_speeds)
 
     if (m_enable_ground and state.position.y() == 0.f)
     {
-        Ftot -= m_dynamics.GetWeight();
+        Ftot -= m_dynamics->GetWeight();
     }
 
     // velocity derivative
     Vector3f v_dot =
-        (m_dynamics.GetWeight() + Ftot) / m_dynamics.GetQuadParams().inertia_properties.mass;
+        (m_dynamics->GetWeight() + Ftot) / m_dynamics->GetQuadParams().inertia_properties.mass;
 
     Vector3f wind_dot = Vector3f::Zero();
 
     // Angular velocity derivative
     Vector3f w = state.body_rates;
     Matrix3f w_hat = hatMap(w);
-    Vector3f inertia_body_rates = m_dynamics.GetInertiaMatrix() * w;
+    Vector3f inertia_body_rates = m_dynamics->GetInertiaMatrix() * w;
     Vector3f test = w_hat * inertia_body_rates;
 
     Vector3f test2 = MtotB - test;
-    Vector3f w_dot = m_dynamics.GetInverseInertia() * test2;
+    Vector3f w_dot = m_dynamics->GetInverseInertia() * test2;
 
+#ifdef LARK_DEBUG_DYNAMICS
     std::cout << "Angular dynamics debug:\n";
     std::cout << "  MtotB: " << MtotB.transpose() << "\n";
     std::cout << "  w_hat @ (I@w): " << test.transpose() << "\n";
     std::cout << "  MtotB - w_hat@(I@w): " << test2.transpose() << "\n";
     std::cout << "  w_dot: " << w_dot.transpose() << "\n";
+#endif
 
     return {x_dot, v_dot, q_dot, w_dot, wind_dot, rotor_accel};
 }
@@ -279,8 +278,8 @@ DroneState Multirotor::step(DroneState state, ControlInput input, float dt)
 
     // Clamp rotor speeds
     cmd_rotor_speeds =
-        cmd_rotor_speeds.cwiseMax(m_dynamics.GetQuadParams().motor_properties.rotor_speed_min)
-            .cwiseMin(m_dynamics.GetQuadParams().motor_properties.rotor_speed_max);
+        cmd_rotor_speeds.cwiseMax(m_dynamics->GetQuadParams().motor_properties.rotor_speed_min)
+            .cwiseMin(m_dynamics->GetQuadParams().motor_properties.rotor_speed_max);
 
     // Compute state derivative
     SDot s_dot = s_dot_fn(state, cmd_rotor_speeds);
@@ -300,23 +299,21 @@ DroneState Multirotor::step(DroneState state, ControlInput input, float dt)
     state.attitude.normalize();
 
     // Add noise to motor speeds (if motor_noise > 0)
-    if (m_dynamics.GetQuadParams().motor_properties.motor_noise_std > 0)
+    if (m_dynamics->GetQuadParams().motor_properties.motor_noise_std > 0)
     {
-        std::random_device rd;
-        std::mt19937 gen(rd());
         std::normal_distribution<float> noise(
-            0.0f, std::abs(m_dynamics.GetQuadParams().motor_properties.motor_noise_std));
+            0.0f, std::abs(m_dynamics->GetQuadParams().motor_properties.motor_noise_std));
 
         for (int i = 0; i < state.rotor_speeds.size(); ++i)
         {
-            state.rotor_speeds(i) += noise(gen);
+            state.rotor_speeds(i) += noise(m_noise_rng);
         }
     }
 
     // Clamp rotor speeds after noise
     state.rotor_speeds =
-        state.rotor_speeds.cwiseMax(m_dynamics.GetQuadParams().motor_properties.rotor_speed_min)
-            .cwiseMin(m_dynamics.GetQuadParams().motor_properties.rotor_speed_max);
+        state.rotor_speeds.cwiseMax(m_dynamics->GetQuadParams().motor_properties.rotor_speed_min)
+            .cwiseMin(m_dynamics->GetQuadParams().motor_properties.rotor_speed_max);
 
     return state;
 }
@@ -325,13 +322,13 @@ StateDot Multirotor::stateDot(DroneState state, ControlInput input, float dt)
 {
     Vector4f cmd_motor_speeds = GetCMDMotorSpeeds(state, input);
     Vector4f cmd_rotor_speeds =
-        cmd_motor_speeds.cwiseMax(m_dynamics.GetQuadParams().motor_properties.rotor_speed_min)
-            .cwiseMin(m_dynamics.GetQuadParams().motor_properties.rotor_speed_max);
+        cmd_motor_speeds.cwiseMax(m_dynamics->GetQuadParams().motor_properties.rotor_speed_min)
+            .cwiseMin(m_dynamics->GetQuadParams().motor_properties.rotor_speed_max);
 
     SDot s_dot = s_dot_fn(state, cmd_rotor_speeds);
 
-    Eigen::VectorXf v_dot = s_dot.vdot; // Extract elements 3, 4, 5
-    Eigen::VectorXf w_dot = s_dot.wdot; // Extract elements 10, 11, 12
+    Vector3f v_dot = s_dot.vdot; // Extract elements 3, 4, 5
+    Vector3f w_dot = s_dot.wdot; // Extract elements 10, 11, 12
 
     return {v_dot, w_dot};
 }
@@ -1,6 +1,7 @@
 // Multirotor.h
 #pragma once
-#include "PhysicExtension/Utils/DroneDynamics.h"
+#include "PhysicExtension/Vehicles/VehicleTypes.h"
+#include "Utils/Random.h"
 
 namespace lark::drone
 {
@@ -23,14 +24,22 @@ struct SDot
 class Multirotor
 {
   public:
-    explicit Multirotor(const QuadParams &quad_params, const DroneState &initial_state,
+    explicit Multirotor(vehicle_type dynamics, const DroneState &initial_state,
                         ControlAbstraction control_abstraction, bool aero = true,
                         bool enable_ground = false)
-        : m_dynamics(quad_params), m_state(initial_state),
+        : m_dynamics(std::move(dynamics)), m_state(initial_state),
           m_control_abstraction(control_abstraction), m_aero(aero), m_enable_ground(enable_ground)
     {
     }
 
+    explicit Multirotor(const QuadParams &quad_params, const DroneState &initial_state,
+                        ControlAbstraction control_abstraction, bool aero = true,
+                        bool enable_ground = false)
+        : Multirotor(vehicle_types::acquire(quad_params), initial_state, control_abstraction,
+                     aero, enable_ground)
+    {
+    }
+
     DroneState step(DroneState state, ControlInput input, float dt);
     StateDot stateDot(DroneState state, ControlInput input, float dt);
     SDot s_dot_fn(DroneState state, Vector4f cmd_rotor_speeds);
@@ -39,15 +48,20 @@ class Multirotor
                                                     const Vector3f &body_airspeed_vector);
 
     const DroneState &GetState() const { return m_state; }
+    const DroneDynamics &GetDynamics() const { return *m_dynamics; }
 
     const std::pair<Vector3f, Vector3f> GetPairs() const { return {Mtot, Ftot}; }
 
+    /** Motor noise generator, seeded from the engine seed stream on construction */
+    random::engine &GetNoiseGenerator() { return m_noise_rng; }
+
   private:
-    DroneDynamics m_dynamics;
+    vehicle_type m_dynamics; ///< Shared per vehicle type, see VehicleTypes.h
     DroneState m_state;
     ControlAbstraction m_control_abstraction;
     bool m_aero;
     bool m_enable_ground;
+    random::engine m_noise_rng{random::next_seed()};
     Vector3f Ftot;
     Vector3f Mtot;
 
@@ -56,13 +70,13 @@ class Multirotor
     Vector3f GetCMDMoment(DroneState state, Vector3f att_err)
     {
         // Split the complex moment calculation into sub-terms
-        Vector3f attitude_term = -m_dynamics.GetQuadParams().control_gains.kp_att * att_err;
-        Vector3f rate_term = -m_dynamics.GetQuadParams().control_gains.kd_att * state.body_rates;
+        Vector3f attitude_term = -m_dynamics->GetQuadParams().control_gains.kp_att * att_err;
+        Vector3f rate_term = -m_dynamics->GetQuadParams().control_gains.kd_att * state.body_rates;
         Vector3f control_input = attitude_term + rate_term;
-        Vector3f inertia_control = m_dynamics.GetInertiaMatrix() * control_input;
+        Vector3f inertia_control = m_dynamics->GetInertiaMatrix() * control_input;
 
         // Compute the gyroscopic term separately
-        Vector3f inertia_omega = m_dynamics.GetInertiaMatrix() * state.body_rates;
+        Vector3f inertia_omega = m_dynamics->GetInertiaMatrix() * state.body_rates;
         Vector3f gyroscopic_term = state.body_rates.cross(inertia_omega);
 
         // Final moment
@@ -0,0 +1,152 @@
+#include "VehicleTypes.h"
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace lark::drone::vehicle_types
+{
+namespace
+{
+/**
+ * @struct registered_type
+ * @brief Live type of one parameter set, the registry does not keep it alive
+ */
+struct registered_type
+{
+    util::vector<f32> key;
+    std::weak_ptr<const DroneDynamics> dynamics;
+    const DroneDynamics *instance{nullptr}; ///< Tells the entry apart from a replacement
+};
+
+struct registry
+{
+    std::mutex mutex;
+    std::unordered_multimap<u64, registered_type> types; ///< By hash of the key
+};
+
+// Types free themselves through it, so it outlives the last holder even at exit
+const std::shared_ptr<registry> types_registry{std::make_shared<registry>()};
+
+void append(util::vector<f32> &key, f32 value)
+{
+    // -0 compares equal to 0 and has to hash alike
+    key.push_back(value == 0.f ? 0.f : value);
+}
+
+template <typename Derived> void append(util::vector<f32> &key, const Eigen::MatrixBase<Derived> &m)
+{
+    for (Eigen::Index i{0}; i < m.size(); ++i)
+        append(key, (f32)m(i));
+}
+
+/**
+ * @brief Flattens every field of the parameters, padding never takes part in the comparison
+ */
+util::vector<f32> make_key(const QuadParams &p)
+{
+    util::vector<f32> key;
+    key.reserve(64);
+
+    append(key, p.inertia_properties.mass);
+    append(key, p.inertia_properties.principal_inertia);
+    append(key, p.inertia_properties.product_inertia);
+
+    append(key, p.geometric_properties.rotor_radius);
+    for (const auto &position : p.geometric_properties.rotor_positions)
+        append(key, position);
+    append(key, p.geometric_properties.rotor_directions);
+    append(key, p.geometric_properties.imu_position);
+
+    append(key, p.aero_dynamics_properties.parasitic_drag);
+
+    const auto &rotor = p.rotor_properties;
+    for (f32 value : {rotor.k_eta, rotor.k_m, rotor.k_d, rotor.k_z, rotor.k_h, rotor.k_flap})
+        append(key, value);
+
+    const auto &motor = p.motor_properties;
+    for (f32 value :
+         {motor.tau_m, motor.rotor_speed_min, motor.rotor_speed_max, motor.motor_noise_std})
+        append(key, value);
+
+    append(key, p.control_gains.kp_pos);
+    append(key, p.control_gains.kd_pos);
+    append(key, p.control_gains.kp_att);
+    append(key, p.control_gains.kd_att);
+    append(key, p.control_gains.kp_vel);
+
+    const auto &llc = p.lower_level_controller_properties;
+    for (f32 value : {llc.k_w, llc.k_v, (f32)llc.kp_att, llc.kd_att})
+        append(key, value);
+
+    return key;
+}
+
+/**
+ * @brief FNV-1a over the bits of the key
+ */
+u64 hash_of(const util::vector<f32> &key)
+{
+    u64 hash{0xcbf29ce484222325ull};
+    for (const f32 value : key)
+    {
+        u32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (u32 b{0}; b < 4; ++b)
+            hash = (hash ^ ((bits >> (8 * b)) & 0xff)) * 0x100000001b3ull;
+    }
+    return hash;
+}
+} // namespace
+
+vehicle_type acquire(const QuadParams &params)
+{
+    util::vector<f32> key{make_key(params)};
+    const u64 hash{hash_of(key)};
+
+    registry &r{*types_registry};
+    std::lock_guard lock{r.mutex};
+    auto [first, last] = r.types.equal_range(hash);
+    auto entry = r.types.end();
+    for (auto it = first; it != last; ++it)
+    {
+        if (it->second.key == key)
+        {
+            if (vehicle_type type{it->second.dynamics.lock()})
+                return type;
+            // Its last holder is gone and the deleter waits for the lock, replace it
+            entry = it;
+            break;
+        }
+    }
+
+    const DroneDynamics *instance{new const DroneDynamics(params)};
+    vehicle_type type{instance, [owner = types_registry, hash](const DroneDynamics *dynamics) {
+                          {
+                              std::lock_guard lock{owner->mutex};
+                              auto [first, last] = owner->types.equal_range(hash);
+                              for (auto it = first; it != last; ++it)
+                              {
+                                  if (it->second.instance == dynamics)
+                                  {
+                                      owner->types.erase(it);
+                                      break;
+                                  }
+                              }
+                          }
+                          delete dynamics;
+                      }};
+
+    if (entry == r.types.end())
+        entry = r.types.emplace(hash, registered_type{std::move(key), {}, nullptr});
+    entry->second.dynamics = type;
+    entry->second.instance = instance;
+    return type;
+}
+
+u32 count()
+{
+    registry &r{*types_registry};
+    std::lock_guard lock{r.mutex};
+    return (u32)r.types.size();
+}
+} // namespace lark::drone::vehicle_types
@@ -0,0 +1,39 @@
+/**
+ * @file VehicleTypes.h
+ * @brief Registry of immutable airframe descriptions shared by all drones of a type
+ *
+ * DroneDynamics derives allocation, inertia and drag matrices from QuadParams.
+ * These only depend on the airframe, so they are computed once per distinct
+ * parameter set and every Multirotor and Control of that airframe shares the
+ * same instance instead of carrying its own copy.
+ *
+ * Users own their type: a type lives as long as any Multirotor, Control or
+ * other holder keeps a reference, and is freed with the last one. Holders
+ * read the dynamics through their reference without touching the registry.
+ */
+
+#pragma once
+#include "Common/CommonHeaders.h"
+#include "PhysicExtension/Utils/DroneDynamics.h"
+#include <memory>
+
+namespace lark::drone
+{
+using vehicle_type = std::shared_ptr<const DroneDynamics>;
+
+namespace vehicle_types
+{
+/**
+ * @brief Returns the type for the given parameters, creating it if no one holds it
+ *
+ * Parameter sets that compare equal field by field map to the same type.
+ * Thread-safe.
+ */
+vehicle_type acquire(const QuadParams &params);
+
+/**
+ * @brief Number of types that are alive
+ */
+u32 count();
+} // namespace vehicle_types
+} // namespace lark::drone
@@ -1,5 +1,13 @@
 #include "World.h"
 #include "WorldRegistry.h"
+#include "Components/Bridge.h"
+#include "Components/Downwash.h"
+#include "Components/Drone.h"
+#include "Components/Estimator.h"
+#include "Components/Neighbors.h"
+#include "Components/Sensors.h"
+#include "Core/FrameArena.h"
+#include "Core/JobSystem.h"
 #include "PhysicExtension/Event/PhysicEvent.h"
 #include "Utils/MathTypes.h"
 
@@ -7,23 +15,37 @@ namespace lark::physics
 {
 namespace
 {
-void handle_collisions() {}
-
-void sync_drone_to_transform(drone::component &drone_comp, transform::component &transform_comp)
+/**
+ * @brief Collects the broadphase leaves a ray passes and tests their shapes
+ */
+struct ray_leaf_callback : btDbvt::ICollide
 {
-    // Get drone state
-    drone::DroneState state = drone_comp.get_state();
+    ray_leaf_callback(const btTransform &from, const btTransform &to, id::id_type ignore,
+                      btCollisionWorld::ClosestRayResultCallback &result)
+        : from{from}, to{to}, ignore{ignore}, result{result}
+    {
+    }
 
-    // Update position from drone
-    math::v3 pos(state.position.x(), state.position.y(), state.position.z());
-    transform_comp.set_position(pos);
+    // Not virtual on every platform, btDbvt may take the policy as a template
+    void Process(const btDbvtNode *leaf)
+    {
+        const auto *proxy = static_cast<const btBroadphaseProxy *>(leaf->data);
+        auto *object = static_cast<btCollisionObject *>(proxy->m_clientObject);
+        if (!result.needsCollision(object->getBroadphaseHandle()))
+            return;
+        if (ignore != id::invalid_id &&
+            (id::id_type)reinterpret_cast<uintptr_t>(object->getUserPointer()) == ignore)
+            return;
 
-    // Update rotation from drone attitude quaternion
-    // DroneState stores as [x,y,z,w]
-    math::v4 rot(state.attitude.x(), state.attitude.y(), state.attitude.z(), state.attitude.w());
-    transform_comp.set_rotation(rot);
-}
+        btCollisionWorld::rayTestSingle(from, to, object, object->getCollisionShape(),
+                                        object->getWorldTransform(), result);
+    }
 
+    const btTransform &from;
+    const btTransform &to;
+    id::id_type ignore;
+    btCollisionWorld::ClosestRayResultCallback &result;
+};
 } // namespace
 
 World::World()
@@ -51,6 +73,9 @@ World::World()
     m_dynamics_world->setGravity(pending.gravity);
     // Set gravity (link this to WorldSettings if you like)
     WorldRegistry::instance().set_active_world(this);
+
+    // Bodies created while no world was active were dispatched to nobody
+    physics::publish_bodies();
 }
 
 World::~World()
@@ -96,71 +121,222 @@ void World::update(f32 dt)
         return;
     }
 
-    const auto &active_entities = game_entity::get_active_entities();
+    // Serial reference path, the game loop runs the same stages through its scheduler
+    const u32 drone_count{drone::count()};
+    sample_wind(dt, 0, drone_count);
+    downwash::update();
+    drone::update_trajectories(dt, 0, drone_count);
+    drone::update_controls(0, drone_count);
+    bridge::apply_commands();
+    drone::step_dynamics(dt, 0, drone_count);
+    drone::sync_transforms(0, drone_count);
+    neighbors::update();
+    sensors::update(dt);
+    estimator::update();
+    bridge::publish(dt);
+    step_bodies(dt);
+    report_drone_states();
 
-    // Frame counter for debug output
-    static int frame_count = 0;
-    frame_count++;
+    // Stages keep their per-tick temporaries on the tick arena, like under the game loop
+    memory::reset_frame_arenas();
+}
 
-    // Update Drones and Add to bullet
-    for (const auto &entity_id : active_entities)
-    {
-        game_entity::entity entity{entity_id};
-        auto drone = entity.drone();
-        auto transform = entity.transform();
-        if (drone.is_valid())
+void World::sample_wind(f32 dt, u32 begin, u32 end)
+{
+    if (m_wind)
+        drone::sample_wind(*m_wind, dt, begin, end);
+}
+
+void World::step_bodies(f32 dt)
+{
+    if (!m_dynamics_world)
+        return;
+
+    // Bodies join and leave the world only through their events, nothing is polled per entity
+    physics::dispatch_events();
+
+    // Skip Bullet simulation for now
+    // m_dynamics_world->stepSimulation(dt);
+
+    // Contacts only need the collision pass of a step, so they run without it
+    sync_drone_bodies();
+    m_dynamics_world->performDiscreteCollisionDetection();
+    m_contacts.update(*m_dispatcher);
+}
+
+void World::raycast(const ray_batch &rays, const ray_hits &hits) const
+{
+    assert(rays.origins && rays.directions && hits.distances);
+
+    // btDbvtBroadphase::rayTest shares one traversal stack, each range brings its own
+    jobs::parallel_for(rays.count, 64, [this, &rays, &hits](u32 begin, u32 end) {
+        btAlignedObjectArray<const btDbvtNode *> stack;
+        for (u32 i{begin}; i < end; ++i)
         {
-            // Get current drone state
-            drone::DroneState current_state = drone.get_state();
-
-            // Get wind at current position
-            auto wind = this->get_wind();
-            Eigen::Vector3f wind_vec = wind->update(dt, current_state.position);
-
-            // Update drone dynamics (this runs the full simulation step)
-            drone.update(dt, wind_vec);
-
-            // Sync updated drone state to transform
-            sync_drone_to_transform(drone, transform);
-
-            // Debug output every second (assuming 60 FPS)
-            if (frame_count % 60 == 0) {
-                drone::DroneState state = drone.get_state();
-                printf("Drone State - Pos: (%.2f, %.2f, %.2f) Vel: (%.2f, %.2f, %.2f) "
-                       "Orient: (%.2f, %.2f, %.2f, %.2f)\n",
-                       state.position.x(), state.position.y(), state.position.z(),
-                       state.velocity.x(), state.velocity.y(), state.velocity.z(),
-                       state.attitude.x(), state.attitude.y(), state.attitude.z(), state.attitude.w());
-
-                // Also show rotor speeds for debugging
-                printf("  Rotor Speeds: [%.1f, %.1f, %.1f, %.1f] rad/s\n",
-                       state.rotor_speeds[0], state.rotor_speeds[1],
-                       state.rotor_speeds[2], state.rotor_speeds[3]);
+            const f32 *o{rays.origins + (size_t)i * 3};
+            const f32 *d{rays.directions + (size_t)i * 3};
+            const btVector3 origin{o[0], o[1], o[2]};
+            const btVector3 direction{d[0], d[1], d[2]};
+            const btVector3 target{origin + direction * rays.max_distance};
+
+            btCollisionWorld::ClosestRayResultCallback result{origin, target};
+            const btTransform from{btQuaternion::getIdentity(), origin};
+            const btTransform to{btQuaternion::getIdentity(), target};
+            ray_leaf_callback leaves{from, to, rays.ignore ? rays.ignore[i] : id::invalid_id, result};
+
+            const btVector3 inverse{d[0] == 0.f ? btScalar(BT_LARGE_FLOAT) : 1.f / d[0],
+                                    d[1] == 0.f ? btScalar(BT_LARGE_FLOAT) : 1.f / d[1],
+                                    d[2] == 0.f ? btScalar(BT_LARGE_FLOAT) : 1.f / d[2]};
+            unsigned int signs[3]{inverse[0] < 0.f, inverse[1] < 0.f, inverse[2] < 0.f};
+            const btVector3 zero{0.f, 0.f, 0.f};
+
+            // Dynamic and static bodies live in separate trees
+            for (const btDbvt &tree : m_broadphase->m_sets)
+            {
+                if (tree.m_root)
+                    tree.rayTestInternal(tree.m_root, origin, target, inverse, signs,
+                                         rays.max_distance, zero, zero, stack, leaves);
+            }
+
+            const bool hit{result.hasHit()};
+            hits.distances[i] = hit ? result.m_closestHitFraction * rays.max_distance : rays.max_distance;
+            if (hits.normals)
+            {
+                f32 *n{hits.normals + (size_t)i * 3};
+                const btVector3 normal{hit ? result.m_hitNormalWorld : zero};
+                n[0] = normal.x();
+                n[1] = normal.y();
+                n[2] = normal.z();
+            }
+            if (hits.entities)
+            {
+                hits.entities[i] = hit ? (id::id_type)reinterpret_cast<uintptr_t>(
+                                             result.m_collisionObject->getUserPointer())
+                                       : id::invalid_id;
             }
         }
+    });
+}
+
+void World::sync_drone_bodies()
+{
+    // Drones are integrated by their own dynamics, their bodies follow the state
+    const storage_view entities{drone::entities_view()};
+    for (u32 i{0}; i < entities.count; ++i)
+    {
+        const game_entity::entity entity{game_entity::entity_id{*reinterpret_cast<const u32 *>(
+            static_cast<const u8 *>(entities.data) + (size_t)entities.stride * i)}};
+        const auto physics = entity.physics();
+        btRigidBody *body{physics.is_valid() ? physics.get_rigid_body() : nullptr};
+        if (!body || !body->isInWorld())
+            continue;
+
+        const drone::DroneState state{entity.drone().get_state()};
+        const btTransform transform{
+            btQuaternion{state.attitude.x(), state.attitude.y(), state.attitude.z(), state.attitude.w()},
+            btVector3{state.position.x(), state.position.y(), state.position.z()}};
+        body->setWorldTransform(transform);
+        body->setInterpolationWorldTransform(transform);
+    }
+}
 
-        // For non-drone entities with physics, we can still register them with Bullet
-        // but skip the simulation for now
-        auto physics = entity.physics();
-        if (physics.is_valid() && !drone.is_valid())
+void World::save_bodies(util::vector<body_state> &out) const
+{
+    const auto &objects = m_dynamics_world->getCollisionObjectArray();
+    out.resize((size_t)objects.size());
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        const btCollisionObject *obj = objects[i];
+        const btTransform &transform = obj->getWorldTransform();
+        const btQuaternion rotation = transform.getRotation();
+        body_state &state = out[(size_t)i];
+
+        for (int axis = 0; axis < 3; ++axis)
+            state.origin[axis] = transform.getOrigin()[axis];
+        for (int axis = 0; axis < 4; ++axis)
+            state.rotation[axis] = rotation[axis];
+
+        const btRigidBody *body = btRigidBody::upcast(obj);
+        const btVector3 linear = body ? body->getLinearVelocity() : btVector3{0, 0, 0};
+        const btVector3 angular = body ? body->getAngularVelocity() : btVector3{0, 0, 0};
+        for (int axis = 0; axis < 3; ++axis)
         {
-            ensure_body_in_world(physics);
+            state.linear_velocity[axis] = linear[axis];
+            state.angular_velocity[axis] = angular[axis];
         }
+        state.activation = obj->getActivationState();
     }
+}
 
-    // Skip Bullet simulation for now
-    // m_dynamics_world->stepSimulation(dt);
+bool World::load_bodies(const body_state *states, u32 count)
+{
+    auto &objects = m_dynamics_world->getCollisionObjectArray();
+    if ((u32)objects.size() != count)
+        return false;
+
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        btCollisionObject *obj = objects[i];
+        const body_state &state = states[i];
+        const btTransform transform{
+            btQuaternion{state.rotation[0], state.rotation[1], state.rotation[2], state.rotation[3]},
+            btVector3{state.origin[0], state.origin[1], state.origin[2]}};
+
+        obj->setWorldTransform(transform);
+        obj->setInterpolationWorldTransform(transform);
+        obj->forceActivationState(state.activation);
+        obj->setDeactivationTime(0);
+
+        btRigidBody *body = btRigidBody::upcast(obj);
+        if (!body)
+            continue;
 
-    // Handle any custom collisions if needed
-    handle_collisions();
+        const btVector3 linear{state.linear_velocity[0], state.linear_velocity[1],
+                               state.linear_velocity[2]};
+        const btVector3 angular{state.angular_velocity[0], state.angular_velocity[1],
+                                state.angular_velocity[2]};
+        body->setLinearVelocity(linear);
+        body->setAngularVelocity(angular);
+        body->setInterpolationLinearVelocity(linear);
+        body->setInterpolationAngularVelocity(angular);
+        body->clearForces();
+        if (body->getMotionState())
+            body->getMotionState()->setWorldTransform(transform);
+
+        // Cached contact points refer to the old poses
+        if (obj->getBroadphaseHandle())
+            m_broadphase->getOverlappingPairCache()->cleanProxyFromPairs(
+                obj->getBroadphaseHandle(), m_dispatcher);
+    }
+
+    // Warm starting would carry impulses over from the abandoned timeline
+    m_solver->reset();
+    return true;
 }
 
-void World::ensure_body_in_world(physics::component& physics_comp)
+void World::report_drone_states()
 {
-    btRigidBody* body = physics_comp.get_rigid_body(); // New method
-    if (body && !body->isInWorld())
+    // Debug output every second (assuming 60 FPS)
+    if (!m_reports_enabled || ++m_report_frame % 60 != 0)
+        return;
+
+    for (const auto &entity_id : game_entity::get_active_entities())
     {
-        m_dynamics_world->addRigidBody(body);
+        auto drone = game_entity::entity{entity_id}.drone();
+        if (!drone.is_valid())
+            continue;
+
+        drone::DroneState state = drone.get_state();
+        printf("Drone State - Pos: (%.2f, %.2f, %.2f) Vel: (%.2f, %.2f, %.2f) "
+               "Orient: (%.2f, %.2f, %.2f, %.2f)\n",
+               state.position.x(), state.position.y(), state.position.z(),
+               state.velocity.x(), state.velocity.y(), state.velocity.z(),
+               state.attitude.x(), state.attitude.y(), state.attitude.z(), state.attitude.w());
+
+        // Also show rotor speeds for debugging
+        printf("  Rotor Speeds: [%.1f, %.1f, %.1f, %.1f] rad/s\n",
+               state.rotor_speeds[0], state.rotor_speeds[1],
+               state.rotor_speeds[2], state.rotor_speeds[3]);
     }
 }
 } // namespace lark::physics
@@ -1,6 +1,7 @@
 #pragma once
 #include "Components/Entity.h"
 #include <btBulletDynamicsCommon.h>
+#include "PhysicExtension/Event/Contacts.h"
 #include "PhysicExtension/Utils/Wind.h"
 
 namespace lark::game_entity { class entity; }
@@ -15,26 +16,118 @@ class World
     World();
     ~World();
 
+    /**
+     * @brief Runs every simulation stage serially
+     */
     void update(f32 dt);
 
+    /**
+     * @brief Samples the wind model for drones in [begin, end)
+     */
+    void sample_wind(f32 dt, u32 begin, u32 end);
+
+    /**
+     * @brief Registers pending rigid bodies, advances the Bullet world and
+     * updates the contact events
+     */
+    void step_bodies(f32 dt);
+
+    /**
+     * @brief Contact events of the last step_bodies
+     */
+    const ContactTracker &contacts() const { return m_contacts; }
+
+    /**
+     * @struct ray_batch
+     * @brief Rays of one raycast call, all arrays hold count rows
+     */
+    struct ray_batch
+    {
+        const f32 *origins{nullptr};        ///< [count, 3]
+        const f32 *directions{nullptr};     ///< [count, 3], normalized
+        const id::id_type *ignore{nullptr}; ///< [count] entity whose bodies a ray passes, or nullptr
+        f32 max_distance{100.f};
+        u32 count{0};
+    };
+
+    /**
+     * @struct ray_hits
+     * @brief Caller-owned outputs of a raycast, normals and entities are optional
+     */
+    struct ray_hits
+    {
+        f32 *distances{nullptr};        ///< [count], max_distance where nothing was hit
+        f32 *normals{nullptr};          ///< [count, 3], zero where nothing was hit
+        id::id_type *entities{nullptr}; ///< [count], id::invalid_id where nothing was hit
+    };
+
+    /**
+     * @brief Finds the closest hit of every ray, split across the job pool
+     *
+     * Rays walk the broadphase trees against the body bounds of the last
+     * step_bodies, so lidars and rangefinders of a whole swarm fit in one call.
+     * Bodies must not be added, removed or moved while it runs.
+     */
+    void raycast(const ray_batch &rays, const ray_hits &hits) const;
+
+    /**
+     * @brief Prints the drone states once per second of frames
+     */
+    void report_drone_states();
+
+    /**
+     * @brief Turns the periodic drone state printout of update() on or off
+     */
+    void set_reports_enabled(bool enabled) { m_reports_enabled = enabled; }
+
+    /**
+     * @struct body_state
+     * @brief Motion state of one rigid body
+     */
+    struct body_state
+    {
+        btScalar origin[3];
+        btScalar rotation[4]; ///< Quaternion xyzw
+        btScalar linear_velocity[3];
+        btScalar angular_velocity[3];
+        int activation;
+    };
+
+    /**
+     * @brief Copies the state of every rigid body, in collision object order
+     */
+    void save_bodies(util::vector<body_state> &out) const;
+
+    /**
+     * @brief Restores states taken by save_bodies onto the same bodies, without
+     * removing or re-adding them
+     * @return false if the number of collision objects differs, nothing is changed then
+     */
+    bool load_bodies(const body_state *states, u32 count);
+
     btDiscreteDynamicsWorld *dynamics_world() { return m_dynamics_world; }
     void set_wind(std::shared_ptr<drone::Wind> wind) { m_wind = wind; }
     drone::Wind* get_wind() const { return m_wind.get(); }
 
   private:
 
-    void ensure_body_in_world(physics::component& physics_comp);
+    void sync_drone_bodies();
     void cleanup_all_bodies();
 
     // Bullet Physics
     btDefaultCollisionConfiguration *m_collision_config;
     btCollisionDispatcher *m_dispatcher;
-    btBroadphaseInterface *m_broadphase;
+    btDbvtBroadphase *m_broadphase; ///< Concrete type, raycast walks its trees
     btSequentialImpulseConstraintSolver *m_solver;
     btDiscreteDynamicsWorld *m_dynamics_world;
 
     // Wind
     std::shared_ptr<drone::Wind> m_wind;
+
+    ContactTracker m_contacts;
+
+    u32 m_report_frame{0}; ///< Frames since creation, for report_drone_states
+    bool m_reports_enabled{true};
 };
 
 } // namespace lark::physics
\ No newline at end of file
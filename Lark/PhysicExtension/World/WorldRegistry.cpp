@@ -9,7 +9,11 @@ namespace lark::physics
         SubscribeToEvents();
     }
 
-    WorldRegistry::~WorldRegistry() = default;
+    WorldRegistry::~WorldRegistry()
+    {
+        PhysicEventBus::Get().Unsubscribe(created_subscription_);
+        PhysicEventBus::Get().Unsubscribe(removed_subscription_);
+    }
 
     btDiscreteDynamicsWorld* WorldRegistry::get_dynamics_world()
     {
@@ -43,6 +47,36 @@ namespace lark::physics
         }
     }
 
+    void WorldRegistry::add_rigid_bodies(const PhysicObjectCreated* events, u32 count)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!active_world)
+            return;
+
+        auto* dynamics_world = active_world->dynamics_world();
+        for (u32 i{0}; i < count; ++i)
+        {
+            btRigidBody* body = events[i].body;
+            if (body && !body->isInWorld())
+                dynamics_world->addRigidBody(body);
+        }
+    }
+
+    void WorldRegistry::remove_rigid_bodies(const PhysicObjectRemoved* events, u32 count)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!active_world)
+            return;
+
+        auto* dynamics_world = active_world->dynamics_world();
+        for (u32 i{0}; i < count; ++i)
+        {
+            btRigidBody* body = events[i].body;
+            if (body && body->isInWorld())
+                dynamics_world->removeRigidBody(body);
+        }
+    }
+
     void WorldRegistry::set_pending_wind(std::shared_ptr<drone::Wind> wind){
         pending_.wind = wind;
     }
@@ -54,16 +88,9 @@ namespace lark::physics
 
 
     void WorldRegistry::SubscribeToEvents() {
-       PhysicEventBus::Get().Subscribe<PhysicObjectCreated>(
-           [this](const PhysicObjectCreated& e) {
-            add_rigid_body(e.body);
-           }
-       );
-
-       PhysicEventBus::Get().Subscribe<PhysicObjectRemoved>(
-           [this](const PhysicObjectRemoved& e) {
-            remove_rigid_body(e.body);
-           }
-       );
+       created_subscription_ =
+           PhysicEventBus::Get().Subscribe<PhysicObjectCreated, &WorldRegistry::add_rigid_bodies>(this);
+       removed_subscription_ =
+           PhysicEventBus::Get().Subscribe<PhysicObjectRemoved, &WorldRegistry::remove_rigid_bodies>(this);
     }
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include <btBulletDynamicsCommon.h>
 #include <mutex>
+#include "Core/Context.h"
+#include "PhysicExtension/Event/PhysicEvent.h"
 #include "PhysicExtension/Utils/Wind.h"
 
 namespace lark::physics
@@ -14,13 +16,14 @@ namespace lark::physics
         btVector3 gravity;
     };
 
+    // One registry per lark::context, so every context has its own active world
     class WorldRegistry
     {
     public:
         static WorldRegistry& instance()
         {
-            static WorldRegistry inst;
-            return inst;
+            static lark::context_local<WorldRegistry> registries;
+            return *registries;
         }
 
         void set_active_world(World* world)
@@ -42,12 +45,18 @@ namespace lark::physics
         void add_rigid_body(btRigidBody* body);
         void remove_rigid_body(btRigidBody* body);
 
+        // Batch handlers of the event bus, one lock and world lookup per batch
+        void add_rigid_bodies(const PhysicObjectCreated* events, u32 count);
+        void remove_rigid_bodies(const PhysicObjectRemoved* events, u32 count);
+
         void set_pending_gravity(btVector3 gravity);
         void set_pending_wind(std::shared_ptr<drone::Wind> wind);
         PendingSettings take_pending_settings() {return pending_; };
 
 
     private:
+        template <typename> friend class lark::context_local;
+
         void SubscribeToEvents();
 
         WorldRegistry();
@@ -58,6 +67,8 @@ namespace lark::physics
         World* active_world = nullptr;
         std::mutex mutex_;
         PendingSettings pending_;
+        PhysicSubscription created_subscription_{0};
+        PhysicSubscription removed_subscription_{0};
     };
 
 } // namespace lark::physics
\ No newline at end of file
@@ -0,0 +1,100 @@
+/**
+ * @file BinaryStream.h
+ * @brief Minimal byte buffer writer and reader for recordings and snapshots
+ *
+ * Values are stored in native layout and byte order; the buffers are meant to
+ * be read back by the same build on the same machine.
+ */
+
+#pragma once
+#include "../Common/PrimitiveTypes.h"
+#include "Vector.h"
+#include <cstring>
+
+namespace lark::util
+{
+
+class byte_writer
+{
+  public:
+    template <typename T> void write(const T &value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write_bytes(&value, sizeof(T));
+    }
+
+    void write_bytes(const void *data, size_t size)
+    {
+        const size_t offset{_buffer.size()};
+        _buffer.resize(offset + size);
+        if (size)
+            std::memcpy(_buffer.data() + offset, data, size);
+    }
+
+    size_t size() const { return _buffer.size(); }
+    const u8 *data() const { return _buffer.data(); }
+    void clear() { _buffer.clear(); }
+    vector<u8> &buffer() { return _buffer; }
+
+  private:
+    vector<u8> _buffer;
+};
+
+/**
+ * @class byte_reader
+ * @brief Reads values back in the order they were written
+ *
+ * Reading past the end leaves the output untouched and clears ok(), so a
+ * truncated buffer can be checked once after a sequence of reads.
+ */
+class byte_reader
+{
+  public:
+    byte_reader(const u8 *data, size_t size) : _data{data}, _size{size} {}
+
+    template <typename T> bool read(T &value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return read_bytes(&value, sizeof(T));
+    }
+
+    bool read_bytes(void *out, size_t size)
+    {
+        if (!_ok || size > _size - _offset)
+        {
+            _ok = false;
+            return false;
+        }
+        if (size)
+            std::memcpy(out, _data + _offset, size);
+        _offset += size;
+        return true;
+    }
+
+    /**
+     * @brief Skips bytes and returns where they start, nullptr if the buffer is too short
+     */
+    const u8 *skip(size_t size)
+    {
+        if (!_ok || size > _size - _offset)
+        {
+            _ok = false;
+            return nullptr;
+        }
+        const u8 *start{_data + _offset};
+        _offset += size;
+        return start;
+    }
+
+    bool ok() const { return _ok; }
+    bool at_end() const { return _offset == _size; }
+    size_t offset() const { return _offset; }
+
+  private:
+    const u8 *_data;
+    size_t _size;
+    size_t _offset{0};
+    bool _ok{true};
+};
+
+} // namespace lark::util
@@ -0,0 +1,198 @@
+/**
+ * @file Deque.h
+ * @brief Ring-buffer queue used for engine storage when USE_STL_DEQUE is 0
+ *
+ * std::deque allocates a fresh block every few elements as a queue rotates
+ * through it. The free-id lists and job queues only push and pop at the ends,
+ * so a single power-of-two ring that grows by doubling is enough and stops
+ * allocating once it reached its working size.
+ */
+
+#pragma once
+#include "Vector.h"
+
+namespace lark::util
+{
+
+/**
+ * @class deque
+ * @brief Double-ended queue stored in one contiguous ring buffer
+ *
+ * References stay valid until the next growth or removal of that element.
+ */
+template <typename T> class deque
+{
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T &;
+    using const_reference = const T &;
+
+    deque() = default;
+
+    deque(const deque &other) { *this = other; }
+
+    deque(deque &&other) noexcept { swap(other); }
+
+    ~deque()
+    {
+        clear();
+        std::allocator<T>{}.deallocate(_data, _capacity);
+    }
+
+    deque &operator=(const deque &other)
+    {
+        if (this != &other)
+        {
+            clear();
+            reserve(other._size);
+            for (size_t i{0}; i < other._size; ++i)
+                push_back(other[i]);
+        }
+        return *this;
+    }
+
+    deque &operator=(deque &&other) noexcept
+    {
+        if (this != &other)
+        {
+            deque{}.swap(*this);
+            swap(other);
+        }
+        return *this;
+    }
+
+    size_t size() const { return _size; }
+    size_t capacity() const { return _capacity; }
+    bool empty() const { return _size == 0; }
+
+    T &operator[](size_t index)
+    {
+        assert(index < _size);
+        return _data[slot(index)];
+    }
+
+    const T &operator[](size_t index) const
+    {
+        assert(index < _size);
+        return _data[slot(index)];
+    }
+
+    T &front() { return (*this)[0]; }
+    const T &front() const { return (*this)[0]; }
+    T &back() { return (*this)[_size - 1]; }
+    const T &back() const { return (*this)[_size - 1]; }
+
+    void push_back(const T &value) { emplace_back(value); }
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+    void push_front(const T &value) { emplace_front(value); }
+    void push_front(T &&value) { emplace_front(std::move(value)); }
+
+    template <typename... Args> T &emplace_back(Args &&...args)
+    {
+        if (_size == _capacity)
+        {
+            // args may refer to an element of this deque
+            T value(std::forward<Args>(args)...);
+            grow(_size + 1);
+            return *::new (static_cast<void *>(_data + slot(_size++))) T(std::move(value));
+        }
+        return *::new (static_cast<void *>(_data + slot(_size++))) T(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args> T &emplace_front(Args &&...args)
+    {
+        if (_size == _capacity)
+        {
+            T value(std::forward<Args>(args)...);
+            grow(_size + 1);
+            return construct_front(std::move(value));
+        }
+        return construct_front(std::forward<Args>(args)...);
+    }
+
+    void pop_front()
+    {
+        assert(_size);
+        _data[_head].~T();
+        _head = (_head + 1) & (_capacity - 1);
+        --_size;
+    }
+
+    void pop_back()
+    {
+        assert(_size);
+        --_size;
+        _data[slot(_size)].~T();
+    }
+
+    void clear()
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            for (size_t i{0}; i < _size; ++i)
+                _data[slot(i)].~T();
+        }
+        _head = 0;
+        _size = 0;
+    }
+
+    /**
+     * @brief Makes room for at least count elements, rounded up to a power of two
+     */
+    void reserve(size_t count)
+    {
+        if (count > _capacity)
+            grow(count);
+    }
+
+    void swap(deque &other) noexcept
+    {
+        std::swap(_data, other._data);
+        std::swap(_capacity, other._capacity);
+        std::swap(_head, other._head);
+        std::swap(_size, other._size);
+    }
+
+  private:
+    size_t slot(size_t index) const { return (_head + index) & (_capacity - 1); }
+
+    template <typename... Args> T &construct_front(Args &&...args)
+    {
+        const size_t head{(_head + _capacity - 1) & (_capacity - 1)};
+        T *item{::new (static_cast<void *>(_data + head)) T(std::forward<Args>(args)...)};
+        _head = head;
+        ++_size;
+        return *item;
+    }
+
+    /**
+     * @brief Moves the elements into a larger buffer, unwrapped so the head is at 0
+     */
+    void grow(size_t required)
+    {
+        size_t new_capacity{_capacity ? _capacity : size_t{8}};
+        while (new_capacity < required)
+            new_capacity *= 2;
+
+        T *buffer{std::allocator<T>{}.allocate(new_capacity)};
+        if (_size)
+        {
+            const size_t first{std::min(_size, _capacity - _head)};
+            detail::relocate(buffer, _data + _head, first);
+            detail::relocate(buffer + first, _data, _size - first);
+        }
+
+        std::allocator<T>{}.deallocate(_data, _capacity);
+        _data = buffer;
+        _capacity = new_capacity;
+        _head = 0;
+    }
+
+    T *_data{nullptr};
+    size_t _capacity{0}; ///< Always 0 or a power of two
+    size_t _head{0};
+    size_t _size{0};
+};
+
+} // namespace lark::util
@@ -1,12 +1,13 @@
 #pragma once
 
 #include "SourceLocation.h"
+#include <algorithm>
 #include <array>
 #include <chrono>
+#include <cstdio>
 #include <ctime>
 #include <iostream>
 #include <mutex>
-#include <sstream>
 #include <string>
 
 namespace utils
@@ -89,29 +90,19 @@ class Logger
             return;
         }
 
-        std::string formattedMessage;
-        try
-        {
-            // Format message outside the lock
-            formattedMessage = FormatLogMessage(level, message, location);
-        }
-        catch (...)
-        {
-            return;
-        }
+        // Header goes into a stack buffer, logging never touches the heap
+        std::array<char, 512> header{};
+        const size_t headerLength = FormatLogHeader(level, location, header.data(), header.size());
 
         try
         {
             std::lock_guard<std::mutex> lock(mutex_);
             // Use cerr for ERROR and FATAL, cout for others
-            if (level >= Level::ERROR)
-            {
-                std::cerr << formattedMessage << std::flush;
-            }
-            else
-            {
-                std::cout << formattedMessage << std::flush;
-            }
+            std::ostream &out = level >= Level::ERROR ? std::cerr : std::cout;
+            out.write(header.data(), static_cast<std::streamsize>(headerLength));
+            out.write(message.data(), static_cast<std::streamsize>(message.size()));
+            out.put('\n');
+            out.flush();
         }
         catch (...)
         {
@@ -181,49 +172,50 @@ class Logger
      * @brief Format timestamp for log entry
      *
      * @param time Time point to format
-     * @return Formatted timestamp string
+     * @param buffer Output buffer
+     * @param size Size of the output buffer
+     * @return Number of characters written
      * @throws None
      */
-    static std::string FormatTimestamp(const std::chrono::system_clock::time_point &time) noexcept
+    static size_t FormatTimestamp(const std::chrono::system_clock::time_point &time, char *buffer,
+                                  size_t size) noexcept
     {
-        try
-        {
-            const auto timer = std::chrono::system_clock::to_time_t(time);
-            char buffer[32];
+        const auto timer = std::chrono::system_clock::to_time_t(time);
 
 #ifdef _WIN32
-            struct tm timeinfo;
-            localtime_s(&timeinfo, &timer);
-            strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &timeinfo);
+        struct tm timeinfo;
+        localtime_s(&timeinfo, &timer);
+        return strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &timeinfo);
 #else
-            struct tm *timeinfo = localtime(&timer);
-            strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", timeinfo);
+        struct tm timeinfo;
+        localtime_r(&timer, &timeinfo);
+        return strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &timeinfo);
 #endif
-
-            return std::string(buffer);
-        }
-        catch (...)
-        {
-            return "TIME_ERROR";
-        }
     }
 
-    std::string FormatLogMessage(Level level, const std::string &message,
-                                 const SourceLocation &location) const noexcept
+    /**
+     * @brief Format everything preceding the message
+     *
+     * @return Number of characters written, truncated to the buffer size
+     * @throws None
+     */
+    static size_t FormatLogHeader(Level level, const SourceLocation &location, char *buffer,
+                                  size_t size) noexcept
     {
-        try
+        char timestamp[32];
+        if (FormatTimestamp(std::chrono::system_clock::now(), timestamp, sizeof(timestamp)) == 0)
         {
-            std::stringstream ss;
-            ss << FormatTimestamp(std::chrono::system_clock::now()) << " [" << LevelToString(level)
-               << "] "
-               << "[" << location.file << ":" << location.line << "] "
-               << "[" << location.function << "] " << message << std::endl;
-            return ss.str();
+            snprintf(timestamp, sizeof(timestamp), "TIME_ERROR");
         }
-        catch (...)
+
+        const int length = snprintf(buffer, size, "%s [%s] [%s:%u] [%s] ", timestamp,
+                                    LevelToString(level), location.file,
+                                    static_cast<unsigned>(location.line), location.function);
+        if (length < 0)
         {
-            return message + "\n";
+            return 0;
         }
+        return std::min(static_cast<size_t>(length), size - 1);
     }
 
     std::mutex mutex_;            ///< Thread synchronization mutex
@@ -0,0 +1,94 @@
+/**
+ * @file Random.h
+ * @brief Engine-wide seed source for reproducible simulation runs
+ *
+ * Every random engine in the simulation is seeded from a stream derived from
+ * one base seed and a counter, instead of std::random_device. Two runs that
+ * set the same seed and create their objects in the same order draw the same
+ * numbers. The engines are std::minstd_rand, whose whole state is a single
+ * word, so recordings and snapshots can store it cheaply.
+ *
+ * The seed and counter belong to the current context, so environments stepped
+ * side by side draw independent, reproducible streams.
+ */
+
+#pragma once
+#include "../Common/PrimitiveTypes.h"
+#include "../Core/Context.h"
+#include <atomic>
+#include <random>
+#include <sstream>
+
+namespace lark::random
+{
+namespace detail
+{
+struct seed_stream
+{
+    std::atomic<u64> base_seed{0x853c49e6748fea9bull};
+    std::atomic<u64> counter{0};
+};
+
+inline context_local<seed_stream> streams;
+
+constexpr u64 splitmix64(u64 x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+} // namespace detail
+
+using engine = std::minstd_rand;
+
+/**
+ * @brief Sets the base seed and restarts the stream counter
+ */
+inline void set_seed(u64 seed)
+{
+    detail::seed_stream &stream{*detail::streams};
+    stream.base_seed.store(seed, std::memory_order_relaxed);
+    stream.counter.store(0, std::memory_order_relaxed);
+}
+
+inline u64 get_seed() { return detail::streams->base_seed.load(std::memory_order_relaxed); }
+
+/**
+ * @brief Number of seeds handed out since the last set_seed
+ */
+inline u64 stream_position() { return detail::streams->counter.load(std::memory_order_relaxed); }
+
+inline void set_stream_position(u64 position)
+{
+    detail::streams->counter.store(position, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Seed for the next random engine that gets created
+ */
+inline u32 next_seed()
+{
+    detail::seed_stream &stream{*detail::streams};
+    const u64 position{stream.counter.fetch_add(1, std::memory_order_relaxed)};
+    return (u32)detail::splitmix64(stream.base_seed.load(std::memory_order_relaxed) ^
+                                   detail::splitmix64(position));
+}
+
+/**
+ * @brief Full state of an engine, restore it with load_state
+ */
+inline u32 save_state(const engine &e)
+{
+    std::ostringstream stream;
+    stream << e;
+    return (u32)std::stoul(stream.str());
+}
+
+inline void load_state(engine &e, u32 state)
+{
+    // The state is always in [1, modulus), which seed() keeps as is
+    e.seed(state);
+}
+
+} // namespace lark::random
@@ -1,12 +1,12 @@
 #pragma once
 
-#define USE_STL_VECTOR 1
-#define USE_STL_DEQUE 1
+#define USE_STL_VECTOR 0
+#define USE_STL_DEQUE 0
 #include <LinearMath/btVector3.h>
 #include <glm/vec3.hpp>
+#include <algorithm>
 
 #if USE_STL_VECTOR
-#include <algorithm>
 #include <vector>
 namespace lark::util
 {
@@ -24,10 +24,23 @@ template <typename T> void erase_unordered(std::vector<T> &v, size_t index)
         v.clear();
     }
 }
-
-inline btVector3 glm_to_bt_vector3(glm::vec3 vec) { return btVector3{vec.x, vec.y, vec.z}; }
-
-inline glm::vec3 bt_to_glm_vec3(const btVector3 &v) { return glm::vec3(v.x(), v.y(), v.z()); }
+} // namespace lark::util
+#else
+#include "Vector.h"
+namespace lark::util
+{
+template <typename T, size_t N, typename G> void erase_unordered(vector<T, N, G> &v, size_t index)
+{
+    if (v.size() > 1)
+    {
+        std::iter_swap(v.begin() + index, v.end() - 1);
+        v.pop_back();
+    }
+    else
+    {
+        v.clear();
+    }
+}
 } // namespace lark::util
 #endif
 
@@ -37,8 +50,13 @@ namespace lark::util
 {
 template <typename T> using deque = std::deque<T>;
 }
+#else
+#include "Deque.h"
 #endif
 
 namespace lark::util
 {
-}
+inline btVector3 glm_to_bt_vector3(glm::vec3 vec) { return btVector3{vec.x, vec.y, vec.z}; }
+
+inline glm::vec3 bt_to_glm_vec3(const btVector3 &v) { return glm::vec3(v.x(), v.y(), v.z()); }
+} // namespace lark::util
@@ -0,0 +1,449 @@
+/**
+ * @file Vector.h
+ * @brief Contiguous container used for engine storage when USE_STL_VECTOR is 0
+ *
+ * Differences to std::vector:
+ * - Element types that are trivially relocatable are moved with memcpy when the
+ *   buffer grows or the container is moved, instead of being move-constructed
+ *   and destroyed one by one.
+ * - The growth factor is a policy parameter.
+ * - An optional inline buffer keeps small vectors off the heap.
+ */
+
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace lark::util
+{
+
+/**
+ * @brief Whether an object can be moved to another address by copying its bytes
+ *
+ * True for trivially copyable types. Other types opt in by declaring
+ * `using trivially_relocatable = std::true_type;`, which is valid for anything
+ * that does not store pointers into itself (Eigen fixed-size types,
+ * std::shared_ptr, std::unique_ptr and aggregates of those).
+ */
+template <typename T, typename = void>
+struct is_trivially_relocatable : std::is_trivially_copyable<T>
+{
+};
+
+template <typename T>
+struct is_trivially_relocatable<T, std::void_t<typename T::trivially_relocatable>>
+    : std::bool_constant<T::trivially_relocatable::value || std::is_trivially_copyable_v<T>>
+{
+};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v{is_trivially_relocatable<T>::value};
+
+namespace growth
+{
+/** @brief Doubles the capacity, same as libstdc++ */
+struct doubling
+{
+    static constexpr size_t next(size_t capacity, size_t required)
+    {
+        return std::max(required, capacity ? capacity * 2 : size_t{4});
+    }
+};
+
+/** @brief Grows by 1.5, lets freed blocks be reused by later growth */
+struct one_and_half
+{
+    static constexpr size_t next(size_t capacity, size_t required)
+    {
+        return std::max(required, capacity ? capacity + capacity / 2 + 1 : size_t{4});
+    }
+};
+} // namespace growth
+
+namespace detail
+{
+template <typename T, size_t N> struct inline_storage
+{
+    T *inline_data() { return std::launder(reinterpret_cast<T *>(_bytes)); }
+    const T *inline_data() const { return std::launder(reinterpret_cast<const T *>(_bytes)); }
+
+    alignas(T) unsigned char _bytes[N * sizeof(T)];
+};
+
+template <typename T> struct inline_storage<T, 0>
+{
+    T *inline_data() { return nullptr; }
+    const T *inline_data() const { return nullptr; }
+};
+
+/**
+ * @brief Moves n objects from src to uninitialized dst and ends their lifetime in src
+ */
+template <typename T> void relocate(T *dst, T *src, size_t n)
+{
+    if constexpr (is_trivially_relocatable_v<T>)
+    {
+        if (n)
+            std::memcpy(static_cast<void *>(dst), static_cast<const void *>(src), n * sizeof(T));
+    }
+    else
+    {
+        for (size_t i{0}; i < n; ++i)
+        {
+            ::new (static_cast<void *>(dst + i)) T(std::move(src[i]));
+            src[i].~T();
+        }
+    }
+}
+
+template <typename T> void destroy(T *first, size_t n)
+{
+    if constexpr (!std::is_trivially_destructible_v<T>)
+    {
+        for (size_t i{0}; i < n; ++i)
+            first[i].~T();
+    }
+}
+} // namespace detail
+
+/**
+ * @class vector
+ * @brief Dynamic array with relocation-aware growth
+ * @tparam T Element type
+ * @tparam InlineCapacity Elements stored inside the object before the first heap allocation
+ * @tparam Growth Policy with a static next(capacity, required) returning the new capacity
+ *
+ * Iterators are plain pointers. As with std::vector, any growth invalidates them.
+ */
+template <typename T, size_t InlineCapacity = 0, typename Growth = growth::doubling>
+class vector : private detail::inline_storage<T, InlineCapacity>
+{
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T &;
+    using const_reference = const T &;
+    using pointer = T *;
+    using const_pointer = const T *;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    vector() : _data{this->inline_data()}, _capacity{InlineCapacity} {}
+
+    explicit vector(size_t count) : vector() { resize(count); }
+
+    vector(size_t count, const T &value) : vector() { resize(count, value); }
+
+    template <typename It, typename = std::enable_if_t<!std::is_integral_v<It>>>
+    vector(It first, It last) : vector()
+    {
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                        typename std::iterator_traits<It>::iterator_category>)
+            reserve((size_t)std::distance(first, last));
+
+        for (; first != last; ++first)
+            emplace_back(*first);
+    }
+
+    vector(std::initializer_list<T> values) : vector(values.begin(), values.end()) {}
+
+    vector(const std::vector<T> &other) : vector(other.begin(), other.end()) {}
+
+    vector(std::vector<T> &&other) : vector()
+    {
+        reserve(other.size());
+        for (auto &value : other)
+            emplace_back(std::move(value));
+        other.clear();
+    }
+
+    vector(const vector &other) : vector(other.begin(), other.end()) {}
+
+    vector(vector &&other) noexcept : vector() { take(other); }
+
+    ~vector()
+    {
+        clear();
+        release();
+    }
+
+    vector &operator=(const vector &other)
+    {
+        if (this != &other)
+        {
+            clear();
+            reserve(other.size());
+            std::uninitialized_copy(other.begin(), other.end(), _data);
+            _size = other.size();
+        }
+        return *this;
+    }
+
+    vector &operator=(vector &&other) noexcept
+    {
+        if (this != &other)
+        {
+            clear();
+            release();
+            take(other);
+        }
+        return *this;
+    }
+
+    vector &operator=(std::initializer_list<T> values) { return *this = vector(values); }
+
+    size_t size() const { return _size; }
+    size_t capacity() const { return _capacity; }
+    bool empty() const { return _size == 0; }
+
+    /**
+     * @brief Whether the elements live in the inline buffer
+     */
+    bool is_inline() const { return InlineCapacity != 0 && _data == this->inline_data(); }
+
+    T *data() { return _data; }
+    const T *data() const { return _data; }
+
+    iterator begin() { return _data; }
+    iterator end() { return _data + _size; }
+    const_iterator begin() const { return _data; }
+    const_iterator end() const { return _data + _size; }
+    const_iterator cbegin() const { return _data; }
+    const_iterator cend() const { return _data + _size; }
+
+    T &operator[](size_t index)
+    {
+        assert(index < _size);
+        return _data[index];
+    }
+
+    const T &operator[](size_t index) const
+    {
+        assert(index < _size);
+        return _data[index];
+    }
+
+    T &front()
+    {
+        assert(_size);
+        return _data[0];
+    }
+
+    const T &front() const
+    {
+        assert(_size);
+        return _data[0];
+    }
+
+    T &back()
+    {
+        assert(_size);
+        return _data[_size - 1];
+    }
+
+    const T &back() const
+    {
+        assert(_size);
+        return _data[_size - 1];
+    }
+
+    void push_back(const T &value) { emplace_back(value); }
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    template <typename... Args> T &emplace_back(Args &&...args)
+    {
+        if (_size < _capacity)
+        {
+            T *item{::new (static_cast<void *>(_data + _size)) T(std::forward<Args>(args)...)};
+            ++_size;
+            return *item;
+        }
+
+        // Construct before relocating, args may refer to an element of this vector
+        const size_t new_capacity{Growth::next(_capacity, _size + 1)};
+        T *buffer{allocate(new_capacity)};
+        T *item{nullptr};
+        try
+        {
+            item = ::new (static_cast<void *>(buffer + _size)) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            deallocate(buffer, new_capacity);
+            throw;
+        }
+
+        detail::relocate(buffer, _data, _size);
+        release();
+        _data = buffer;
+        _capacity = new_capacity;
+        ++_size;
+        return *item;
+    }
+
+    void pop_back()
+    {
+        assert(_size);
+        --_size;
+        _data[_size].~T();
+    }
+
+    iterator erase(const_iterator position) { return erase(position, position + 1); }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        assert(first >= begin() && first <= last && last <= end());
+        T *dst{_data + (first - _data)};
+        T *src{_data + (last - _data)};
+        T *new_end{std::move(src, end(), dst)};
+        detail::destroy(new_end, (size_t)(end() - new_end));
+        _size = (size_t)(new_end - _data);
+        return dst;
+    }
+
+    void resize(size_t count)
+    {
+        if (count > _size)
+        {
+            reserve_for(count);
+            std::uninitialized_value_construct(_data + _size, _data + count);
+        }
+        else
+        {
+            detail::destroy(_data + count, _size - count);
+        }
+        _size = count;
+    }
+
+    void resize(size_t count, const T &value)
+    {
+        if (count > _size)
+        {
+            if (count > _capacity)
+            {
+                // value may be an element of this vector
+                const T copy{value};
+                reserve_for(count);
+                std::uninitialized_fill(_data + _size, _data + count, copy);
+            }
+            else
+            {
+                std::uninitialized_fill(_data + _size, _data + count, value);
+            }
+        }
+        else
+        {
+            detail::destroy(_data + count, _size - count);
+        }
+        _size = count;
+    }
+
+    /**
+     * @brief Grows the capacity to exactly the requested size, if it is larger
+     */
+    void reserve(size_t count)
+    {
+        if (count > _capacity)
+            reallocate(count);
+    }
+
+    void clear()
+    {
+        detail::destroy(_data, _size);
+        _size = 0;
+    }
+
+    void shrink_to_fit()
+    {
+        if (_capacity == _size || is_inline())
+            return;
+
+        if (_size <= InlineCapacity)
+        {
+            T *old{_data};
+            const size_t old_capacity{_capacity};
+            detail::relocate(this->inline_data(), old, _size);
+            deallocate(old, old_capacity);
+            _data = this->inline_data();
+            _capacity = InlineCapacity;
+        }
+        else
+        {
+            reallocate(_size);
+        }
+    }
+
+    bool operator==(const vector &other) const
+    {
+        return _size == other._size && std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const vector &other) const { return !(*this == other); }
+
+  private:
+    static T *allocate(size_t count) { return std::allocator<T>{}.allocate(count); }
+    static void deallocate(T *data, size_t count) { std::allocator<T>{}.deallocate(data, count); }
+
+    void reserve_for(size_t count)
+    {
+        if (count > _capacity)
+            reallocate(Growth::next(_capacity, count));
+    }
+
+    void reallocate(size_t new_capacity)
+    {
+        assert(new_capacity >= _size);
+        T *buffer{allocate(new_capacity)};
+        detail::relocate(buffer, _data, _size);
+        release();
+        _data = buffer;
+        _capacity = new_capacity;
+    }
+
+    /**
+     * @brief Frees the heap buffer, elements must already be destroyed or relocated
+     */
+    void release()
+    {
+        if (_data != this->inline_data())
+            deallocate(_data, _capacity);
+        _data = this->inline_data();
+        _capacity = InlineCapacity;
+    }
+
+    /**
+     * @brief Takes the elements of other, this must be empty and inline
+     */
+    void take(vector &other)
+    {
+        if (other.is_inline())
+        {
+            detail::relocate(_data, other._data, other._size);
+        }
+        else
+        {
+            _data = other._data;
+            _capacity = other._capacity;
+            other._data = other.inline_data();
+            other._capacity = InlineCapacity;
+        }
+        _size = other._size;
+        other._size = 0;
+    }
+
+    T *_data;
+    size_t _size{0};
+    size_t _capacity;
+};
+
+} // namespace lark::util
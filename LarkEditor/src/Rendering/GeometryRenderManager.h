@@ -4,6 +4,9 @@
 #include "../Utils/Etc/Logger.h"
 #include <unordered_map>
 #include <memory>
+#include <algorithm>
+#include <functional>
+#include <vector>
 
 class GeometryRenderManager
 {
@@ -76,20 +79,36 @@ public:
             it->second->buffers.get(), view, projection, distanceToCamera);
     }
 
-    // Render all visible geometries
+    // Render all visible geometries. Transforms are fetched for the whole batch at once
+    // (e.g. GeometryService::GetEntityTransforms) instead of one engine call per entity.
+    using BatchTransformFn = std::function<bool(const uint32_t*, uint32_t, glm::mat4*)>;
     void RenderAll(const glm::mat4& view, const glm::mat4& projection,
-                   float distanceToCamera, const std::function<glm::mat4(uint32_t)>& getTransform)
+                   float distanceToCamera, const BatchTransformFn& getTransforms)
     {
+        m_visibleIds.clear();
+        m_visibleRenderables.clear();
         for (const auto& [entityId, renderable] : m_renderables)
         {
             if (!renderable || !renderable->visible)
                 continue;
 
-            glm::mat4 model = getTransform ? getTransform(entityId) : glm::mat4(1.0f);
-            glm::mat4 finalView = view * model;
+            m_visibleIds.push_back(entityId);
+            m_visibleRenderables.push_back(renderable.get());
+        }
+
+        const uint32_t count = static_cast<uint32_t>(m_visibleIds.size());
+        m_modelMatrices.resize(count);
+        if (!getTransforms || !getTransforms(m_visibleIds.data(), count, m_modelMatrices.data()))
+        {
+            std::fill(m_modelMatrices.begin(), m_modelMatrices.end(), glm::mat4(1.0f));
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            glm::mat4 finalView = view * m_modelMatrices[i];
 
             GeometryRenderer::RenderGeometryAtLOD(
-                renderable->buffers.get(), finalView, projection, distanceToCamera);
+                m_visibleRenderables[i]->buffers.get(), finalView, projection, distanceToCamera);
         }
     }
 
@@ -123,4 +142,9 @@ public:
 
 private:
     std::unordered_map<uint32_t, std::unique_ptr<RenderableGeometry>> m_renderables;
+
+    // Scratch buffers reused across frames by RenderAll
+    std::vector<uint32_t> m_visibleIds;
+    std::vector<RenderableGeometry*> m_visibleRenderables;
+    std::vector<glm::mat4> m_modelMatrices;
 };
\ No newline at end of file
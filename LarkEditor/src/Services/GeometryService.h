@@ -123,6 +123,12 @@ public:
         return GetEntityTransformMatrix(entityId);
     }
 
+    // Get transforms for a batch of entities in a single engine call
+    bool GetEntityTransforms(const uint32_t* entityIds, uint32_t count, glm::mat4* outMatrices)
+    {
+        return GetEntityTransformMatrices(entityIds, count, outMatrices);
+    }
+
     // Set entity transform in engine
     bool SetEntityTransform(uint32_t entityId, const transform_component& transform)
     {
@@ -0,0 +1,220 @@
+/**
+ * @file LarkPy.cpp
+ * @brief Python extension module exposing batched drone environments
+ *
+ * Usage:
+ *   env = larkpy.VectorEnv(num_envs=4096)
+ *   obs = env.reset()
+ *   obs, reward, terminated, truncated = env.step(actions)  # actions: float32 [N, 4]
+ *
+ * The returned arrays are the same objects on every call. They own the memory
+ * the C++ side writes into, copy them if a previous step must be kept.
+ */
+
+#include "Core/JobSystem.h"
+#include "PhysicExtension/Environment/VectorEnv.h"
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <stdexcept>
+
+namespace py = pybind11;
+using namespace lark;
+
+namespace
+{
+/**
+ * @brief Hummingbird airframe, the reference vehicle of the dynamics tests
+ */
+drone::QuadParams default_quad_params()
+{
+    drone::QuadParams params{};
+
+    params.inertia_properties.mass = 0.500f;
+    params.inertia_properties.principal_inertia = {3.65e-3f, 3.68e-3f, 7.03e-3f};
+    params.inertia_properties.product_inertia = {0.f, 0.f, 0.f};
+
+    const f32 d{0.17f * 0.70710678118f};
+    params.geometric_properties.rotor_radius = 0.10f;
+    params.geometric_properties.rotor_positions = {
+        drone::Vector3f{d, d, 0.f}, drone::Vector3f{d, -d, 0.f}, drone::Vector3f{-d, -d, 0.f},
+        drone::Vector3f{-d, d, 0.f}};
+    params.geometric_properties.rotor_directions = {1.f, -1.f, 1.f, -1.f};
+    params.geometric_properties.imu_position = {0.f, 0.f, 0.f};
+
+    params.aero_dynamics_properties.parasitic_drag = {0.5e-2f, 0.5e-2f, 1e-2f};
+
+    params.rotor_properties.k_eta = 5.57e-06f;
+    params.rotor_properties.k_m = 1.36e-07f;
+    params.rotor_properties.k_d = 1.19e-04f;
+    params.rotor_properties.k_z = 2.32e-04f;
+    params.rotor_properties.k_h = 3.39e-3f;
+    params.rotor_properties.k_flap = 0.f;
+
+    params.motor_properties.tau_m = 0.005f;
+    params.motor_properties.rotor_speed_min = 0.f;
+    params.motor_properties.rotor_speed_max = 1500.f;
+    params.motor_properties.motor_noise_std = 0.f;
+
+    params.lower_level_controller_properties.k_w = 1.f;
+    params.lower_level_controller_properties.k_v = 10.f;
+    params.lower_level_controller_properties.kp_att = 544;
+    params.lower_level_controller_properties.kd_att = 46.64f;
+
+    return params;
+}
+
+drone::ControlAbstraction parse_control(const std::string &name)
+{
+    using drone::ControlAbstraction;
+    if (name == "motor_speeds")
+        return ControlAbstraction::CMD_MOTOR_SPEEDS;
+    if (name == "motor_thrusts")
+        return ControlAbstraction::CMD_MOTOR_THRUSTS;
+    if (name == "ctbr")
+        return ControlAbstraction::CMD_CTBR;
+    if (name == "ctbm")
+        return ControlAbstraction::CMD_CTBM;
+    if (name == "vel")
+        return ControlAbstraction::CMD_VEL;
+    if (name == "acc")
+        return ControlAbstraction::CMD_ACC;
+
+    throw std::invalid_argument{"unsupported control abstraction '" + name +
+                                "', expected motor_speeds, motor_thrusts, ctbr, ctbm, vel or acc"};
+}
+
+drone::VectorEnvConfig make_config(u32 num_envs, f32 dt, u32 substeps, u32 max_episode_steps,
+                                   const std::string &control, std::array<f32, 3> target,
+                                   f32 spawn_extent, f32 max_distance, u64 seed)
+{
+    if (num_envs == 0 || substeps == 0)
+        throw std::invalid_argument{"num_envs and substeps must be positive"};
+
+    drone::VectorEnvConfig config{};
+    config.num_envs = num_envs;
+    config.dt = dt;
+    config.substeps = substeps;
+    config.max_episode_steps = max_episode_steps;
+    config.abstraction = parse_control(control);
+    config.target = {target[0], target[1], target[2]};
+    config.spawn_extent = spawn_extent;
+    config.max_distance = max_distance;
+    config.seed = seed;
+    return config;
+}
+
+/**
+ * @class py_vector_env
+ * @brief Owns the NumPy output arrays and forwards to drone::VectorEnv
+ */
+class py_vector_env
+{
+  public:
+    using action_array = py::array_t<f32, py::array::c_style | py::array::forcecast>;
+    using index_array = py::array_t<u32, py::array::c_style | py::array::forcecast>;
+
+    explicit py_vector_env(const drone::VectorEnvConfig &config)
+        : _env{default_quad_params(), config},
+          _observations(std::vector<py::ssize_t>{(py::ssize_t)config.num_envs,
+                                                 (py::ssize_t)drone::VectorEnv::observation_size}),
+          _rewards((py::ssize_t)config.num_envs), _terminated((py::ssize_t)config.num_envs),
+          _truncated((py::ssize_t)config.num_envs)
+    {
+        _buffers.observations = _observations.mutable_data();
+        _buffers.rewards = _rewards.mutable_data();
+        _buffers.terminated = _terminated.mutable_data();
+        _buffers.truncated = _truncated.mutable_data();
+
+        std::fill_n(_buffers.rewards, config.num_envs, 0.f);
+        std::fill_n(_buffers.terminated, config.num_envs, false);
+        std::fill_n(_buffers.truncated, config.num_envs, false);
+    }
+
+    py::array_t<f32> reset(std::optional<index_array> indices)
+    {
+        const u32 *data{nullptr};
+        u32 count{0};
+        if (indices)
+        {
+            if (indices->ndim() != 1)
+                throw std::invalid_argument{"indices must be one-dimensional"};
+
+            data = indices->data();
+            count = (u32)indices->size();
+            for (u32 i{0}; i < count; ++i)
+            {
+                if (data[i] >= _env.num_envs())
+                    throw py::index_error{"environment index out of range"};
+            }
+        }
+
+        {
+            py::gil_scoped_release release;
+            _env.reset(data, count, _buffers);
+        }
+        return _observations;
+    }
+
+    py::tuple step(const action_array &actions)
+    {
+        if (actions.ndim() != 2 || actions.shape(0) != (py::ssize_t)_env.num_envs() ||
+            actions.shape(1) != (py::ssize_t)drone::VectorEnv::action_size)
+            throw std::invalid_argument{"actions must have shape (num_envs, 4)"};
+
+        {
+            py::gil_scoped_release release;
+            _env.step(actions.data(), _buffers);
+        }
+
+        return py::make_tuple(_observations, _rewards, _terminated, _truncated);
+    }
+
+    u32 num_envs() const { return _env.num_envs(); }
+    const py::array_t<f32> &observations() const { return _observations; }
+
+  private:
+    drone::VectorEnv _env;
+    py::array_t<f32> _observations;
+    py::array_t<f32> _rewards;
+    py::array_t<bool> _terminated;
+    py::array_t<bool> _truncated;
+    drone::VectorEnvBuffers _buffers{};
+};
+} // namespace
+
+PYBIND11_MODULE(larkpy, m)
+{
+    m.doc() = "Batched Lark drone environments";
+
+    // The importing thread becomes worker 0 of the engine pool, joined again at interpreter exit
+    jobs::initialize();
+    py::module_::import("atexit").attr("register")(py::cpp_function{[] { jobs::shutdown(); }});
+
+    py::class_<py_vector_env>(m, "VectorEnv")
+        .def(py::init([](u32 num_envs, f32 dt, u32 substeps, u32 max_episode_steps,
+                         const std::string &control, std::array<f32, 3> target, f32 spawn_extent,
+                         f32 max_distance, u64 seed) {
+                 return std::make_unique<py_vector_env>(
+                     make_config(num_envs, dt, substeps, max_episode_steps, control, target,
+                                 spawn_extent, max_distance, seed));
+             }),
+             py::arg("num_envs"), py::arg("dt") = 0.01f, py::arg("substeps") = 1u,
+             py::arg("max_episode_steps") = 500u, py::arg("control") = "motor_speeds",
+             py::arg("target") = std::array<f32, 3>{0.f, 0.f, 1.f}, py::arg("spawn_extent") = 1.f,
+             py::arg("max_distance") = 5.f, py::arg("seed") = 0u)
+        .def("reset", &py_vector_env::reset, py::arg("indices") = py::none(),
+             "Starts new episodes for the given environments (all if None), returns the "
+             "observation array")
+        .def("step", &py_vector_env::step, py::arg("actions"),
+             "Advances every environment, returns (observations, rewards, terminated, truncated)")
+        .def_property_readonly("num_envs", &py_vector_env::num_envs)
+        .def_property_readonly("observations", &py_vector_env::observations)
+        .def_property_readonly_static(
+            "observation_size", [](py::object) { return drone::VectorEnv::observation_size; })
+        .def_property_readonly_static("action_size",
+                                      [](py::object) { return drone::VectorEnv::action_size; });
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include "Core/Context.h"
+#include "Core/FrameArena.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace lark::memory::test
+{
+
+class FrameArenaTest : public ::testing::Test
+{
+  protected:
+    frame_arena arena;
+};
+
+TEST_F(FrameArenaTest, AllocationsAreAlignedAndDistinct)
+{
+    u8 *a{static_cast<u8 *>(arena.allocate(3, 1))};
+    u8 *b{static_cast<u8 *>(arena.allocate(16, 16))};
+    u8 *c{static_cast<u8 *>(arena.allocate(8, 64))};
+
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 16, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(c) % 64, 0u);
+    EXPECT_GE(b, a + 3);
+    EXPECT_GE(c, b + 16);
+}
+
+TEST_F(FrameArenaTest, ResetCoalescesIntoOneBlock)
+{
+    // Overflow the first block a few times
+    for (u32 i{0}; i < 64; ++i)
+        arena.allocate(16 * 1024);
+
+    const size_t capacity{arena.capacity()};
+    EXPECT_GE(capacity, size_t{64 * 16 * 1024});
+
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.capacity(), capacity);
+
+    // The same workload now fits without growing
+    for (u32 i{0}; i < 64; ++i)
+        arena.allocate(16 * 1024);
+    EXPECT_EQ(arena.capacity(), capacity);
+}
+
+TEST_F(FrameArenaTest, ScopeRewindsAndVectorsUseArena)
+{
+    arena.allocate(100);
+    const size_t used_before{arena.used()};
+    {
+        frame_scope scope{arena};
+        frame_vector<u32> values{frame_allocator<u32>{arena}};
+        values.reserve(1000);
+        for (u32 i{0}; i < 1000; ++i)
+            values.push_back(i);
+
+        EXPECT_EQ(values[999], 999u);
+        EXPECT_GE(arena.used(), used_before + 1000 * sizeof(u32));
+    }
+    EXPECT_EQ(arena.used(), used_before);
+}
+
+TEST_F(FrameArenaTest, ScopedTemporariesSurviveTheTickReset)
+{
+    context ctx;
+    context_scope bind{ctx};
+    frame_arena &tick{thread_frame_arena()};
+    tick.allocate(100);
+    {
+        frame_scope scope;
+        EXPECT_EQ(&thread_frame_arena(), &thread_scope_arena());
+
+        frame_vector<u32> values(1000, 7u);
+        const size_t used{thread_scope_arena().used()};
+        EXPECT_GE(used, 1000 * sizeof(u32));
+
+        // A tick of the same context ends on another thread while the scope is open
+        std::thread loop{[&ctx] {
+            context_scope loop_bind{ctx};
+            reset_frame_arenas();
+        }};
+        loop.join();
+
+        EXPECT_EQ(tick.used(), 0u);
+        EXPECT_EQ(thread_scope_arena().used(), used);
+        EXPECT_EQ(values[999], 7u);
+    }
+    EXPECT_EQ(&thread_frame_arena(), &tick);
+    EXPECT_EQ(thread_scope_arena().used(), 0u);
+}
+
+TEST_F(FrameArenaTest, TracksHeapAllocationsWhenEnabled)
+{
+    const u64 before{allocation_count()};
+    auto *value{new u32{7}};
+    delete value;
+
+    if (allocation_tracking_enabled())
+        EXPECT_GE(allocation_count(), before + 1);
+    else
+        EXPECT_EQ(allocation_count(), 0u);
+}
+
+} // namespace lark::memory::test
@@ -0,0 +1,202 @@
+#pragma once
+#include "Core/GameLoop.h"
+#include "Core/Replay.h"
+#include "ECSTests/ComponentViewTest.h"
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+
+namespace lark::test
+{
+
+class ReplayTest : public ComponentViewTest
+{
+  protected:
+    using states = util::vector<drone::DroneState>;
+
+    void SetUp() override
+    {
+        GameLoop::Config config{};
+        config.background_script_startup = false;
+        loop = std::make_unique<GameLoop>(config);
+        ASSERT_TRUE(loop->initialize());
+
+        for (u32 i{0}; i < 3; ++i)
+            create_drone((f32)i + 1.f);
+    }
+
+    void TearDown() override
+    {
+        bridge::suspend(false);
+        bridge::close();
+        ComponentViewTest::TearDown();
+        loop.reset();
+        std::filesystem::remove(path);
+    }
+
+    states current_states() const
+    {
+        states result;
+        for (auto id : ids)
+            result.push_back(game_entity::entity{id}.drone().get_state());
+        return result;
+    }
+
+    // Records the ticks, returns the states before the first and after every tick
+    util::vector<states> record(u32 ticks, u32 checkpoint_interval,
+                                const std::function<void(u32)> &after_tick = {})
+    {
+        replay::recorder recorder;
+        EXPECT_TRUE(recorder.open(path.c_str(), checkpoint_interval));
+        loop->set_recorder(&recorder);
+
+        util::vector<states> history{current_states()};
+        for (u32 i{0}; i < ticks; ++i)
+        {
+            loop->step(0.01f);
+            if (after_tick)
+                after_tick(i);
+            history.push_back(current_states());
+        }
+
+        loop->set_recorder(nullptr);
+        EXPECT_TRUE(recorder.close());
+        return history;
+    }
+
+    void expect_states(const states &expected, u64 tick) const
+    {
+        const states actual{current_states()};
+        ASSERT_EQ(actual.size(), expected.size());
+        for (u32 i{0}; i < actual.size(); ++i)
+        {
+            EXPECT_EQ(actual[i].position, expected[i].position) << "tick " << tick;
+            EXPECT_EQ(actual[i].velocity, expected[i].velocity) << "tick " << tick;
+            EXPECT_EQ(actual[i].attitude, expected[i].attitude) << "tick " << tick;
+        }
+    }
+
+    std::unique_ptr<GameLoop> loop;
+    std::string path{(std::filesystem::temp_directory_path() / "lark_replay_test.lrk").string()};
+};
+
+TEST_F(ReplayTest, ReplayRepeatsTheRecordedRun)
+{
+    const util::vector<states> history{record(12, 5)};
+
+    replay::replayer replayer;
+    ASSERT_TRUE(replayer.open(path.c_str()));
+    EXPECT_EQ(replayer.tick_count(), 12u);
+    ASSERT_TRUE(replayer.start(*loop));
+    expect_states(history[0], 0);
+
+    for (u64 tick{0}; tick < 12; ++tick)
+    {
+        ASSERT_TRUE(replayer.step(*loop));
+        expect_states(history[tick + 1], tick + 1);
+    }
+    EXPECT_FALSE(replayer.step(*loop));
+}
+
+TEST_F(ReplayTest, SeekDropsPendingCommands)
+{
+    const util::vector<states> history{record(12, 5)};
+
+    replay::replayer replayer;
+    ASSERT_TRUE(replayer.open(path.c_str()));
+    ASSERT_TRUE(replayer.start(*loop));
+    replayer.run(*loop);
+
+    // Queued for the next tick of the run we leave, must not reach the restored state
+    script::command teleport{script::command_type::set_drone_position, (id::id_type)ids[0]};
+    teleport.values[0] = 100.f;
+    script::queue_command(teleport);
+
+    // Between checkpoints, so the seek restores tick 5 and replays two ticks
+    ASSERT_TRUE(replayer.seek(*loop, 7));
+    EXPECT_EQ(replayer.current_tick(), 7u);
+    expect_states(history[7], 7);
+
+    ASSERT_TRUE(replayer.seek(*loop, 2));
+    expect_states(history[2], 2);
+}
+
+TEST_F(ReplayTest, HostWritesBetweenTicksAreReplayed)
+{
+    // Not a checkpoint tick, only the write makes the recorder take one
+    const util::vector<states> history{record(10, 0, [this](u32 tick) {
+        if (tick != 3)
+            return;
+        drone::DroneState state{game_entity::entity{ids[0]}.drone().get_state()};
+        state.position.x() += 0.5f;
+        state.velocity.z() = 1.f;
+        game_entity::entity{ids[0]}.drone().set_state(state);
+    })};
+
+    replay::replayer replayer;
+    ASSERT_TRUE(replayer.open(path.c_str()));
+    ASSERT_TRUE(replayer.start(*loop));
+    for (u64 tick{0}; tick < 10; ++tick)
+    {
+        ASSERT_TRUE(replayer.step(*loop));
+        expect_states(history[tick + 1], tick + 1);
+    }
+
+    // Seeking past the write starts from its checkpoint
+    ASSERT_TRUE(replayer.seek(*loop, 6));
+    expect_states(history[6], 6);
+}
+
+TEST_F(ReplayTest, BridgeCommandsAreReplayedWithoutTheClient)
+{
+    bridge::config config{};
+    config.name = "/lark_replay_test";
+    config.mode = bridge::sync_mode::free_running;
+    ASSERT_TRUE(bridge::open(config));
+    bridge::client client;
+    ASSERT_TRUE(client.attach(config.name));
+
+    // The client answers every frame with a full-throttle command for each drone
+    u64 applied{0};
+    const util::vector<states> history{record(8, 0, [&](u32) {
+        applied += bridge::applied_commands().size();
+        bridge::frame_view frame{};
+        if (!client.next_frame(frame, 100'000))
+            return;
+        for (u32 i{0}; i < frame.drone_count; ++i)
+        {
+            bridge::control_command command{};
+            for (f32 &speed : command.motor_speeds)
+                speed = 1000.f + 50.f * (f32)i;
+            command.thrust = 20.f;
+            client.set_command(i, frame.drones[i].entity, command);
+        }
+        client.submit();
+    })};
+    ASSERT_GT(applied, 0u);
+
+    // The client stays attached but is neither waited on nor sent frames
+    const u64 frames{bridge::get_status().frames};
+    replay::replayer replayer;
+    ASSERT_TRUE(replayer.open(path.c_str()));
+    ASSERT_TRUE(replayer.start(*loop));
+    EXPECT_TRUE(bridge::is_suspended());
+    for (u64 tick{0}; tick < 8; ++tick)
+    {
+        ASSERT_TRUE(replayer.step(*loop));
+        expect_states(history[tick + 1], tick + 1);
+    }
+    EXPECT_EQ(bridge::get_status().frames, frames);
+}
+
+TEST_F(ReplayTest, UnknownChunkIsRejected)
+{
+    record(3, 0);
+    std::ofstream{path, std::ios::binary | std::ios::app}.put(char{0x7f});
+
+    replay::replayer replayer;
+    EXPECT_FALSE(replayer.open(path.c_str()));
+}
+
+} // namespace lark::test
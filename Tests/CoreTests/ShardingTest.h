@@ -0,0 +1,182 @@
+#pragma once
+#include "Components/Drone.h"
+#include "Core/JobSystem.h"
+#include "Core/SharedMemory.h"
+#include "Core/Sharding.h"
+#include "PhysicsTests/MultirotorTest.h"
+#include <algorithm>
+#include <cmath>
+#include <unistd.h>
+
+namespace lark::test
+{
+
+class ShardingTest : public drone::test::MultirotorTest
+{
+  protected:
+    shard::config make_config(u32 shards)
+    {
+        shard::config c{};
+        c.shards = shards;
+        c.min_x = -4.f;
+        c.max_x = 4.f;
+        c.halo = 2.f;
+        c.max_drones = 1024;
+        c.max_transfers = 256;
+        c.params = createHummingbirdParams();
+        return c;
+    }
+
+    // A row along y just below x = 0, pushed across it and held at x = 1
+    static util::vector<shard::drone_record> crossing_row(u32 count)
+    {
+        const f32 hover{std::sqrt(0.5f * 9.81f / (4.f * 5.57e-6f))};
+        util::vector<shard::drone_record> drones(count);
+        for (u32 i{0}; i < count; ++i)
+        {
+            shard::drone_record &r{drones[i]};
+            r.key = 100 + i;
+            r.position[0] = -0.05f;
+            r.position[1] = (f32)i;
+            r.position[2] = 1.f;
+            r.velocity[0] = 1.f;
+            std::fill_n(r.rotor_speeds, 4, hover);
+            r.setpoint[0] = 1.f;
+            r.setpoint[1] = (f32)i;
+            r.setpoint[2] = 1.f;
+            r.user[0] = (f32)i;
+        }
+        return drones;
+    }
+
+    // Strongest downward wind on a drone of every shard after the given ticks
+    util::vector<f32> induced_winds(shard::config c, const util::vector<shard::drone_record> &drones,
+                                    u32 ticks)
+    {
+        ipc::shared_region region;
+        EXPECT_TRUE(region.create_anonymous(c.shards * sizeof(f32)));
+        f32 *const winds{static_cast<f32 *>(region.data())};
+        c.after_exchange = [winds](u32 shard, const shard::ghost_record *, u32) {
+            winds[shard] = 0.f;
+            for (u32 i{0}; i < drone::count(); ++i)
+                winds[shard] = std::min(winds[shard], drone::state_at(i).wind.z());
+        };
+
+        shard::cluster run;
+        EXPECT_TRUE(run.start(c, drones.data(), (u32)drones.size()));
+        EXPECT_TRUE(run.step(ticks));
+        run.stop();
+        return util::vector<f32>(winds, winds + c.shards);
+    }
+
+    shard::cluster cluster;
+};
+
+TEST_F(ShardingTest, DronesMigrateWithTheirData)
+{
+    constexpr u32 count{16};
+    const util::vector<shard::drone_record> drones{crossing_row(count)};
+    ASSERT_TRUE(cluster.start(make_config(2), drones.data(), count));
+    ASSERT_TRUE(cluster.step(200));
+
+    EXPECT_EQ(cluster.stats(0).drones, 0u);
+    EXPECT_EQ(cluster.stats(1).drones, count);
+    EXPECT_EQ(cluster.stats(0).sent, cluster.stats(1).received);
+    EXPECT_GE(cluster.stats(1).received, count);
+    EXPECT_EQ(cluster.stats(0).ticks, 200u);
+
+    // Within the halo of the boundary, so the other shard mirrors all of them
+    EXPECT_EQ(cluster.stats(0).ghosts, count);
+
+    util::vector<shard::drone_record> gathered;
+    ASSERT_TRUE(cluster.gather(gathered));
+    ASSERT_EQ(gathered.size(), count);
+    for (u32 i{0}; i < count; ++i)
+    {
+        EXPECT_EQ(gathered[i].key, 100u + i);
+        EXPECT_EQ(gathered[i].user[0], (f32)i);
+        EXPECT_GT(gathered[i].position[0], 0.f);
+        EXPECT_LT(gathered[i].position[0], 2.f);
+    }
+    cluster.stop();
+    EXPECT_FALSE(cluster.is_running());
+}
+
+TEST_F(ShardingTest, FullHaloBoxesCountDroppedGhosts)
+{
+    constexpr u32 count{16};
+    util::vector<shard::drone_record> drones{crossing_row(count)};
+    for (shard::drone_record &r : drones)
+    {
+        r.position[0] = -0.5f;
+        r.velocity[0] = 0.f;
+        r.setpoint[0] = -0.5f;
+    }
+
+    shard::config c{make_config(2)};
+    c.max_transfers = 4;
+    ASSERT_TRUE(cluster.start(c, drones.data(), count));
+    ASSERT_TRUE(cluster.step(3));
+
+    EXPECT_EQ(cluster.stats(1).ghosts, 4u);
+    EXPECT_EQ(cluster.stats(0).dropped_ghosts, 3u * (count - 4));
+    EXPECT_EQ(cluster.stats(1).dropped_ghosts, 0u);
+    cluster.stop();
+}
+
+TEST_F(ShardingTest, DeadWorkerFailsTheStep)
+{
+    shard::config c{make_config(3)};
+    c.after_exchange = [](u32 shard, const shard::ghost_record *, u32) {
+        if (shard == 1)
+            _exit(1);
+    };
+    ASSERT_TRUE(cluster.start(c, nullptr, 0));
+
+    EXPECT_FALSE(cluster.step(2));
+    EXPECT_FALSE(cluster.step(1));
+    cluster.stop();
+    EXPECT_FALSE(cluster.is_running());
+}
+
+TEST_F(ShardingTest, WakesReachAcrossTheBoundary)
+{
+    // One drone hovers just below x = 0, the other 1.5 m under it on the other side
+    const f32 hover{std::sqrt(0.5f * 9.81f / (4.f * 5.57e-6f))};
+    util::vector<shard::drone_record> drones(2);
+    const f32 positions[2][3]{{-0.1f, 0.f, 3.f}, {0.1f, 0.f, 1.5f}};
+    for (u32 i{0}; i < 2; ++i)
+    {
+        drones[i].key = i;
+        std::copy_n(positions[i], 3, drones[i].position);
+        std::copy_n(positions[i], 3, drones[i].setpoint);
+        std::fill_n(drones[i].rotor_speeds, 4, hover);
+    }
+
+    shard::config c{make_config(2)};
+    c.downwash.enabled = true;
+    const util::vector<f32> split{induced_winds(c, drones, 20)};
+    ASSERT_EQ(split.size(), 2u);
+
+    // The ghost of the upper drone blows the lower one down, nothing reaches the upper one
+    EXPECT_NEAR(split[0], 0.f, 1e-4f);
+    EXPECT_LT(split[1], -1.f);
+
+    // Ghosts lag one tick, otherwise the wake is the one of an unsplit world
+    c.shards = 1;
+    const util::vector<f32> whole{induced_winds(c, drones, 20)};
+    EXPECT_NEAR(split[1], whole[0], 0.05f * std::abs(whole[0]));
+}
+
+TEST_F(ShardingTest, StartRejectsARunningPool)
+{
+    jobs::initialize(2);
+    EXPECT_FALSE(cluster.start(make_config(2), nullptr, 0));
+    jobs::shutdown();
+
+    shard::config c{make_config(2)};
+    c.max_x = c.min_x;
+    EXPECT_FALSE(cluster.start(c, nullptr, 0));
+}
+
+} // namespace lark::test
@@ -0,0 +1,131 @@
+#pragma once
+#include "Core/JobSystem.h"
+#include "Core/SystemScheduler.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace lark::test
+{
+
+class SystemSchedulerTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override { jobs::initialize(4); }
+
+    void TearDown() override { jobs::shutdown(); }
+};
+
+TEST_F(SystemSchedulerTest, ParallelForVisitsEveryItemOnce)
+{
+    constexpr u32 count{10007};
+    std::unique_ptr<std::atomic<u32>[]> visits{std::make_unique<std::atomic<u32>[]>(count)};
+
+    jobs::parallel_for(count, 64, [&](u32 begin, u32 end) {
+        // Nested loops must not deadlock the pool
+        jobs::parallel_for(end - begin, 8, [&](u32 b, u32 e) {
+            for (u32 i{begin + b}; i < begin + e; ++i)
+                visits[i].fetch_add(1, std::memory_order_relaxed);
+        });
+    });
+
+    for (u32 i{0}; i < count; ++i)
+        ASSERT_EQ(visits[i].load(), 1u) << "item " << i;
+}
+
+TEST_F(SystemSchedulerTest, TaskGroupContinuationRunsAfterTasks)
+{
+    std::atomic<u32> finished{0};
+    std::atomic<u32> seen_by_continuation{0};
+    std::atomic<bool> chained{false};
+
+    jobs::task_group group;
+    for (u32 i{0}; i < 64; ++i)
+    {
+        group.run([&] {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            finished.fetch_add(1);
+        });
+    }
+
+    group.then([&] {
+        seen_by_continuation = finished.load();
+
+        // Work spawned by a continuation still belongs to the group
+        group.run([&] { chained = true; });
+    });
+
+    group.wait();
+    EXPECT_EQ(seen_by_continuation.load(), 64u);
+    EXPECT_TRUE(chained.load());
+    EXPECT_TRUE(group.is_done());
+}
+
+TEST_F(SystemSchedulerTest, ConflictingSystemsKeepRegistrationOrder)
+{
+    using r = SystemResource;
+    SystemScheduler scheduler;
+
+    std::mutex mutex;
+    util::vector<std::string> order;
+    const auto record = [&](const char *name) {
+        return [&, name](f32, u32, u32) {
+            std::lock_guard lock{mutex};
+            order.emplace_back(name);
+        };
+    };
+
+    const u32 produce{scheduler.add_system(
+        {"produce", 0, resources(r::drone_state), {}, record("produce")})};
+    const u32 unrelated{scheduler.add_system(
+        {"unrelated", 0, resources(r::script), {}, record("unrelated")})};
+    const u32 consume{scheduler.add_system(
+        {"consume", resources(r::drone_state), resources(r::transform), {}, record("consume")})};
+
+    EXPECT_TRUE(scheduler.depends_on(consume, produce));
+    EXPECT_FALSE(scheduler.depends_on(unrelated, produce));
+    EXPECT_FALSE(scheduler.depends_on(consume, unrelated));
+
+    for (u32 i{0}; i < 50; ++i)
+    {
+        order.clear();
+        scheduler.run(1.f / 60.f);
+
+        ASSERT_EQ(order.size(), 3u);
+        const auto position = [&](const char *name) {
+            return std::find(order.begin(), order.end(), name) - order.begin();
+        };
+        EXPECT_LT(position("produce"), position("consume"));
+    }
+}
+
+TEST_F(SystemSchedulerTest, ChunkedSystemsReportTimings)
+{
+    SystemScheduler scheduler;
+    constexpr u32 count{4096};
+    util::vector<f32> values(count, 0.f);
+
+    scheduler.add_system({"integrate",
+                          0,
+                          resources(SystemResource::drone_state),
+                          [] { return count; },
+                          [&](f32 dt, u32 begin, u32 end) {
+                              for (u32 i{begin}; i < end; ++i)
+                                  values[i] += dt;
+                          },
+                          128});
+
+    scheduler.run(0.5f);
+    scheduler.run(0.5f);
+
+    for (f32 v : values)
+        ASSERT_FLOAT_EQ(v, 1.f);
+
+    ASSERT_EQ(scheduler.timings().size(), 1u);
+    EXPECT_STREQ(scheduler.timings()[0].name, "integrate");
+    EXPECT_EQ(scheduler.timings()[0].items, count);
+    EXPECT_GE(scheduler.timings()[0].last_ms, 0.f);
+}
+
+} // namespace lark::test
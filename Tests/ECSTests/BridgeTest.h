@@ -0,0 +1,217 @@
+#pragma once
+#include "ComponentViewTest.h"
+#include "Components/Bridge.h"
+#include "Core/Context.h"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace lark::test
+{
+
+class BridgeTest : public ComponentViewTest
+{
+  protected:
+    static bridge::config make_config(bridge::sync_mode mode)
+    {
+        bridge::config c{};
+        c.name = "/lark_bridge_test";
+        c.capacity = 64;
+        c.max_samples = 256;
+        c.mode = mode;
+        c.timeout_us = 2'000'000;
+        return c;
+    }
+
+    // Engine side of a tick as World::update runs it, without the dynamics
+    static void tick()
+    {
+        drone::update_controls(0, drone::count());
+        bridge::apply_commands();
+        bridge::publish(0.01f);
+    }
+
+    static drone::ControlInput control_of(u32 index)
+    {
+        util::vector<drone::saved_state> states;
+        drone::save_states(states);
+        return states[index].last_control;
+    }
+
+    void TearDown() override
+    {
+        bridge::close();
+        ComponentViewTest::TearDown();
+    }
+};
+
+TEST_F(BridgeTest, LockstepAppliesTheAnswerToEveryFrame)
+{
+    for (u32 i{0}; i < 4; ++i)
+        create_drone((f32)i);
+    ASSERT_TRUE(bridge::open(make_config(bridge::sync_mode::lockstep)));
+
+    // The controller commands each drone's x position plus the frame's tick as motor speed
+    std::atomic<bool> attached{false};
+    std::thread controller{[&attached] {
+        bridge::client client;
+        attached = client.attach("/lark_bridge_test");
+        bridge::frame_view frame{};
+        while (attached && client.next_frame(frame, 2'000'000))
+        {
+            for (u32 i{0}; i < frame.drone_count; ++i)
+            {
+                bridge::control_command command{};
+                command.motor_speeds[0] = frame.drones[i].position[0] + (f32)frame.tick;
+                client.set_command(i, frame.drones[i].entity, command);
+            }
+            client.submit();
+        }
+    }};
+    while (!bridge::get_status().attached)
+        std::this_thread::yield();
+
+    constexpr u32 ticks{50};
+    for (u32 t{0}; t < ticks; ++t)
+    {
+        tick();
+        if (t == 0)
+            continue;
+        for (u32 i{0}; i < drone::count(); ++i)
+        {
+            const f32 x{drone::state_at(i).position.x()};
+            EXPECT_FLOAT_EQ(control_of(i).cmd_motor_speeds[0], x + (f32)(t - 1));
+        }
+    }
+
+    const bridge::status status{bridge::get_status()};
+    bridge::close();
+    controller.join();
+
+    EXPECT_TRUE(attached);
+    EXPECT_EQ(status.frames, ticks);
+    EXPECT_EQ(status.commands, (ticks - 1) * (u64)drone::count());
+    EXPECT_EQ(status.timeouts, 0u);
+    std::printf("bridge round trip: %.1f us per tick for %u drones\n",
+                status.wait_time * 1e6 / (ticks - 1), drone::count());
+}
+
+TEST_F(BridgeTest, DetachingReleasesTheEngine)
+{
+    create_drone(1.f);
+    ASSERT_TRUE(bridge::open(make_config(bridge::sync_mode::lockstep)));
+
+    // The controller reads one frame and leaves without answering it
+    std::thread controller{[] {
+        bridge::client client;
+        bridge::frame_view frame{};
+        if (client.attach("/lark_bridge_test"))
+            client.next_frame(frame, 2'000'000);
+    }};
+    while (!bridge::get_status().attached)
+        std::this_thread::yield();
+
+    tick();
+    tick();
+    controller.join();
+
+    // The second tick waited for an answer until the client detached, not for the timeout
+    const bridge::status status{bridge::get_status()};
+    EXPECT_FALSE(status.attached);
+    EXPECT_EQ(status.frames, 2u);
+    EXPECT_EQ(status.commands, 0u);
+    EXPECT_EQ(status.timeouts, 0u);
+    EXPECT_LT(status.wait_time, 1.0);
+}
+
+TEST_F(BridgeTest, AttachingMidRunDoesNotStall)
+{
+    create_drone(1.f);
+    bridge::config c{make_config(bridge::sync_mode::lockstep)};
+    c.timeout_us = 200'000;
+    ASSERT_TRUE(bridge::open(c));
+    for (u32 t{0}; t < 3; ++t)
+        tick();
+
+    // Nobody will hand the client the frames published before it attached
+    bridge::client client;
+    ASSERT_TRUE(client.attach("/lark_bridge_test"));
+    tick();
+
+    bridge::frame_view frame{};
+    ASSERT_TRUE(client.next_frame(frame, 200'000));
+    EXPECT_EQ(frame.tick, 3u);
+    bridge::control_command command{};
+    command.motor_speeds[0] = 42.f;
+    client.set_command(0, frame.drones[0].entity, command);
+    client.submit();
+    tick();
+
+    const bridge::status status{bridge::get_status()};
+    EXPECT_EQ(status.frames, 5u);
+    EXPECT_EQ(status.commands, 1u);
+    EXPECT_EQ(status.timeouts, 0u);
+    EXPECT_LT(status.wait_time, 0.1);
+    EXPECT_FLOAT_EQ(control_of(0).cmd_motor_speeds[0], 42.f);
+}
+
+TEST_F(BridgeTest, DeadClientIsDetachedAfterOneTimeout)
+{
+    create_drone(1.f);
+    bridge::config c{make_config(bridge::sync_mode::lockstep)};
+    c.timeout_us = 100'000;
+    ASSERT_TRUE(bridge::open(c));
+    tick();
+
+    // The client exits without detaching, as if it crashed
+    const pid_t pid{fork()};
+    if (pid == 0)
+    {
+        bridge::client client;
+        _exit(client.attach("/lark_bridge_test") ? 0 : 1);
+    }
+    ASSERT_GT(pid, 0);
+    int result{0};
+    ASSERT_EQ(waitpid(pid, &result, 0), pid);
+    ASSERT_EQ(result, 0);
+    ASSERT_TRUE(bridge::get_status().attached);
+
+    tick();
+    tick();
+    tick();
+    const bridge::status status{bridge::get_status()};
+    EXPECT_FALSE(status.attached);
+    EXPECT_EQ(status.timeouts, 1u);
+    EXPECT_EQ(status.lost_clients, 1u);
+}
+
+TEST_F(BridgeTest, OnlyAbandonedRegionsAreReplaced)
+{
+    const bridge::config c{make_config(bridge::sync_mode::lockstep)};
+    ASSERT_TRUE(bridge::open(c));
+
+    // Another engine in a process of its own, which exits without closing like after a crash
+    const auto open_elsewhere = [&c] {
+        const pid_t pid{fork()};
+        if (pid == 0)
+        {
+            context ctx;
+            context_scope scope{ctx};
+            _exit(bridge::open(c) ? 0 : 1);
+        }
+        int result{-1};
+        waitpid(pid, &result, 0);
+        return pid > 0 && WIFEXITED(result) && WEXITSTATUS(result) == 0;
+    };
+    EXPECT_FALSE(open_elsewhere());
+    EXPECT_TRUE(bridge::is_open());
+
+    // The region it leaves behind has no engine any more
+    bridge::close();
+    ASSERT_TRUE(open_elsewhere());
+    EXPECT_TRUE(bridge::open(c));
+}
+
+} // namespace lark::test
@@ -0,0 +1,116 @@
+#pragma once
+#include "Components/ChangeTracking.h"
+#include "Components/Entity.h"
+#include "Components/Transform.h"
+#include "Core/Context.h"
+#include <gtest/gtest.h>
+
+namespace lark::test
+{
+
+class ChangeTrackingTest : public ::testing::Test
+{
+  protected:
+    static game_entity::entity create_entity()
+    {
+        transform::init_info transform_info{};
+        game_entity::entity_info info{};
+        info.transform = &transform_info;
+        return game_entity::create(info);
+    }
+
+    static util::vector<id::id_type> changed_since(changes::component_type type,
+                                                   changes::frame_type frame)
+    {
+        util::vector<id::id_type> ids(changes::get_changed_since(type, frame, nullptr, 0));
+        changes::get_changed_since(type, frame, ids.data(), (u32)ids.size());
+        return ids;
+    }
+
+    // Every test starts from empty stores and frame 1
+    context ctx;
+    context_scope scope{ctx};
+};
+
+TEST_F(ChangeTrackingTest, WritesAreStampedWithTheCurrentFrame)
+{
+    const game_entity::entity a{create_entity()};
+    const game_entity::entity b{create_entity()};
+    changes::advance_frame();
+    changes::advance_frame();
+    const changes::frame_type synced{changes::current_frame()};
+
+    b.transform().set_position({1.f, 2.f, 3.f});
+    EXPECT_EQ(changes::last_changed(changes::component_type::transform, b.get_id()), synced);
+    EXPECT_LT(changes::last_changed(changes::component_type::transform, a.get_id()), synced);
+    EXPECT_EQ(changes::last_changed(changes::component_type::drone, b.get_id()), 0u);
+
+    const util::vector<id::id_type> ids{changed_since(changes::component_type::transform, synced)};
+    ASSERT_EQ(ids.size(), 1u);
+    EXPECT_EQ(ids[0], (id::id_type)b.get_id());
+
+    // The count is returned even when the ids do not fit
+    EXPECT_EQ(changes::get_changed_since(changes::component_type::transform, 1, nullptr, 0), 2u);
+}
+
+TEST_F(ChangeTrackingTest, RemovedEntitiesAreNotReported)
+{
+    const game_entity::entity a{create_entity()};
+    const game_entity::entity b{create_entity()};
+    game_entity::remove(a.get_id());
+
+    const util::vector<id::id_type> ids{changed_since(changes::component_type::transform, 1)};
+    ASSERT_EQ(ids.size(), 1u);
+    EXPECT_EQ(ids[0], (id::id_type)b.get_id());
+    EXPECT_EQ(changes::last_changed(changes::component_type::transform, a.get_id()), 0u);
+}
+
+TEST_F(ChangeTrackingTest, RemovalsAreReportedSinceAFrame)
+{
+    const game_entity::entity a{create_entity()};
+    const game_entity::entity b{create_entity()};
+    const game_entity::entity c{create_entity()};
+    game_entity::remove(a.get_id());
+    changes::advance_frame();
+    const changes::frame_type synced{changes::current_frame()};
+    game_entity::remove(c.get_id());
+    game_entity::remove(b.get_id());
+
+    util::vector<id::id_type> ids(changes::get_removed_since(synced, nullptr, 0));
+    ASSERT_EQ(ids.size(), 2u);
+    changes::get_removed_since(synced, ids.data(), (u32)ids.size());
+    EXPECT_EQ(ids[0], (id::id_type)c.get_id());
+    EXPECT_EQ(ids[1], (id::id_type)b.get_id());
+    EXPECT_EQ(changes::get_removed_since(1, nullptr, 0), 3u);
+
+    // Consumers that synchronized past a frame let its removals go
+    changes::discard_removed_before(synced);
+    EXPECT_EQ(changes::get_removed_since(1, nullptr, 0), 2u);
+}
+
+TEST_F(ChangeTrackingTest, RecycledSlotStartsClean)
+{
+    // Slots are only reused once enough of them were freed
+    util::vector<game_entity::entity_id> removed;
+    for (u32 i{0}; i <= id::min_deleted_elements; ++i)
+        removed.push_back(create_entity().get_id());
+    changes::mark_changed(changes::component_type::drone, id::index(removed[0]));
+    for (const auto id : removed)
+        game_entity::remove(id);
+    changes::advance_frame();
+
+    const game_entity::entity reused{create_entity()};
+    ASSERT_EQ(id::index(reused.get_id()), id::index(removed[0]));
+    ASSERT_NE((id::id_type)reused.get_id(), (id::id_type)removed[0]);
+
+    // Only the transform of the new owner is stamped, nothing of the previous one
+    EXPECT_EQ(changes::last_changed(changes::component_type::drone, reused.get_id()), 0u);
+    EXPECT_EQ(changes::last_changed(changes::component_type::transform, reused.get_id()),
+              changes::current_frame());
+    EXPECT_EQ(changed_since(changes::component_type::drone, 1).size(), 0u);
+    const util::vector<id::id_type> ids{changed_since(changes::component_type::transform, 1)};
+    ASSERT_EQ(ids.size(), 1u);
+    EXPECT_EQ(ids[0], (id::id_type)reused.get_id());
+}
+
+} // namespace lark::test
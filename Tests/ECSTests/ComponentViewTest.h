@@ -0,0 +1,96 @@
+#pragma once
+#include "Components/Drone.h"
+#include "Components/Entity.h"
+#include "Components/Transform.h"
+#include "PhysicsTests/MultirotorTest.h"
+#include <gtest/gtest.h>
+
+namespace lark::test
+{
+
+class ComponentViewTest : public drone::test::MultirotorTest
+{
+  protected:
+    game_entity::entity_id create_drone(f32 x)
+    {
+        transform::init_info transform_info{};
+        transform_info.position[0] = x;
+
+        drone::init_info drone_info{};
+        drone_info.params = createHummingbirdParams();
+        drone_info.abstraction = drone::ControlAbstraction::CMD_MOTOR_SPEEDS;
+        drone_info.initial_state.position = {x, 2.f * x, 3.f * x};
+        drone_info.initial_state.attitude = {0.f, 0.f, 0.f, 1.f};
+
+        game_entity::entity_info info{};
+        info.transform = &transform_info;
+        info.drone = &drone_info;
+        const auto id = game_entity::create(info).get_id();
+        ids.push_back(id);
+        return id;
+    }
+
+    void TearDown() override
+    {
+        for (auto id : ids)
+            game_entity::remove(id);
+    }
+
+    util::vector<game_entity::entity_id> ids;
+};
+
+TEST_F(ComponentViewTest, TransformViewAliasesPositions)
+{
+    const auto id = create_drone(4.f);
+    const storage_view view{transform::positions_view()};
+
+    ASSERT_GT(view.count, id::index(id));
+    EXPECT_EQ(view.width, 3u);
+    EXPECT_EQ(view.generation, transform::layout_generation());
+
+    const auto *row = reinterpret_cast<const f32 *>(static_cast<const u8 *>(view.data) +
+                                                    (size_t)view.stride * id::index(id));
+    EXPECT_FLOAT_EQ(row[0], 4.f);
+}
+
+TEST_F(ComponentViewTest, DroneViewsAreStridedOverState)
+{
+    for (u32 i{0}; i < 5; ++i)
+        create_drone((f32)i);
+
+    const storage_view positions{drone::state_view(drone::state_field::position)};
+    const storage_view entities{drone::entities_view()};
+    ASSERT_EQ(positions.count, drone::count());
+    EXPECT_EQ(positions.width, 3u);
+    EXPECT_EQ(entities.type, storage_view::uint32);
+
+    for (u32 i{0}; i < positions.count; ++i)
+    {
+        const auto *row = reinterpret_cast<const f32 *>(static_cast<const u8 *>(positions.data) +
+                                                        (size_t)positions.stride * i);
+        const u32 entity{*reinterpret_cast<const u32 *>(static_cast<const u8 *>(entities.data) +
+                                                        (size_t)entities.stride * i)};
+        const drone::DroneState state{
+            game_entity::entity{game_entity::entity_id{entity}}.drone().get_state()};
+
+        EXPECT_FLOAT_EQ(row[0], state.position.x());
+        EXPECT_FLOAT_EQ(row[2], state.position.z());
+    }
+}
+
+TEST_F(ComponentViewTest, RemovalInvalidatesDroneViews)
+{
+    create_drone(1.f);
+    create_drone(2.f);
+    const u64 generation{drone::layout_generation()};
+
+    // Swap-remove moves the last drone into the freed row
+    game_entity::remove(ids.front());
+    ids.erase(ids.begin());
+    EXPECT_NE(drone::layout_generation(), generation);
+
+    const storage_view view{drone::state_view(drone::state_field::position)};
+    EXPECT_EQ(view.generation, drone::layout_generation());
+}
+
+} // namespace lark::test
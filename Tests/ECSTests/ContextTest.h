@@ -0,0 +1,123 @@
+#pragma once
+#include "ComponentViewTest.h"
+#include "Core/Context.h"
+#include "Core/JobSystem.h"
+#include "Utils/Random.h"
+#include <thread>
+
+namespace lark::test
+{
+
+class ContextTest : public ComponentViewTest
+{
+  protected:
+    /**
+     * @brief Flies one drone in its own context, returns where it ends up
+     */
+    drone::DroneState fly_isolated(u64 seed, u32 steps)
+    {
+        context ctx;
+        context_scope scope{ctx};
+        random::set_seed(seed);
+
+        const auto id = create_drone(1.f);
+        ids.pop_back(); // Belongs to ctx, freed with it
+        for (u32 i{0}; i < steps; ++i)
+            drone::step_dynamics(0.01f, 0, drone::count());
+
+        return game_entity::entity{id}.drone().get_state();
+    }
+};
+
+TEST_F(ContextTest, StoresAreIndependent)
+{
+    const auto outer = create_drone(1.f);
+    const u32 outer_count{drone::count()};
+
+    {
+        context ctx;
+        context_scope scope{ctx};
+        EXPECT_EQ(drone::count(), 0u);
+
+        const auto inner = create_drone(2.f);
+        ids.pop_back();
+        EXPECT_EQ(drone::count(), 1u);
+        EXPECT_EQ(id::index(inner), 0u);
+        EXPECT_FLOAT_EQ(game_entity::entity{inner}.drone().get_state().position.x(), 2.f);
+    }
+
+    EXPECT_EQ(drone::count(), outer_count);
+    EXPECT_FLOAT_EQ(game_entity::entity{outer}.drone().get_state().position.x(), 1.f);
+}
+
+TEST_F(ContextTest, ConcurrentContextsAreDeterministic)
+{
+    drone::DroneState a{}, b{};
+    std::thread first{[&] { a = fly_isolated(7, 100); }};
+    std::thread second{[&] { b = fly_isolated(7, 100); }};
+    first.join();
+    second.join();
+
+    EXPECT_EQ(a.position, b.position);
+    EXPECT_EQ(a.velocity, b.velocity);
+    EXPECT_EQ(a.attitude, b.attitude);
+}
+
+TEST_F(ContextTest, SeedStreamIsPerContext)
+{
+    random::set_seed(1);
+    const u32 expected{random::next_seed()};
+
+    random::set_seed(1);
+    {
+        context ctx;
+        context_scope scope{ctx};
+        random::set_seed(1);
+        EXPECT_EQ(random::next_seed(), expected);
+        random::next_seed();
+    }
+
+    // Draws in ctx did not advance this stream
+    EXPECT_EQ(random::next_seed(), expected);
+}
+
+TEST_F(ContextTest, JobsRunInSubmitterContext)
+{
+    jobs::initialize(4);
+    {
+        context ctx;
+        context_scope scope{ctx};
+
+        std::atomic<u32> mismatches{0};
+        jobs::parallel_for(1024, 16, [&](u32, u32) {
+            if (&context::current() != &ctx)
+                ++mismatches;
+        });
+        EXPECT_EQ(mismatches.load(), 0u);
+    }
+    jobs::shutdown();
+}
+
+TEST_F(ContextTest, SharedPoolStopsWithTheLastUser)
+{
+    jobs::acquire(2);
+    std::thread{[] { jobs::acquire(4); }}.join();
+    EXPECT_EQ(jobs::thread_count(), 2u);
+
+    jobs::release();
+    ASSERT_TRUE(jobs::is_running());
+    std::atomic<u32> items{0};
+    jobs::parallel_for(64, 1, [&](u32 begin, u32 end) { items += end - begin; });
+    EXPECT_EQ(items.load(), 64u);
+
+    std::thread{[] { jobs::release(); }}.join();
+    EXPECT_FALSE(jobs::is_running());
+
+    // A pool started by another thread does not treat this one as its worker 0
+    std::thread{[] { jobs::acquire(2); }}.join();
+    EXPECT_EQ(jobs::thread_index(), u32_invalid_id);
+    jobs::release();
+    EXPECT_FALSE(jobs::is_running());
+}
+
+} // namespace lark::test
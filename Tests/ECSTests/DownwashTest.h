@@ -0,0 +1,159 @@
+#pragma once
+#include "ComponentViewTest.h"
+#include "Components/Downwash.h"
+#include "Components/Neighbors.h"
+#include "Core/FrameArena.h"
+#include "Core/JobSystem.h"
+#include <chrono>
+#include <thread>
+
+namespace lark::test
+{
+
+class DownwashTest : public ComponentViewTest
+{
+  protected:
+    game_entity::entity_id place_drone(f32 x, f32 y, f32 z, f32 rotor_speed)
+    {
+        const auto id = create_drone(0.f);
+        drone::DroneState state{game_entity::entity{id}.drone().get_state()};
+        state.position = {x, y, z};
+        state.velocity.setZero();
+        state.body_rates.setZero();
+        state.wind.setZero();
+        state.rotor_speeds.setConstant(rotor_speed);
+        game_entity::entity{id}.drone().set_state(state);
+        return id;
+    }
+
+    static drone::Vector3f wind_of(game_entity::entity_id id)
+    {
+        return game_entity::entity{id}.drone().get_state().wind;
+    }
+
+    static void enable(bool enabled)
+    {
+        downwash::config c{};
+        c.enabled = enabled;
+        downwash::configure(c);
+    }
+
+    void TearDown() override
+    {
+        downwash::configure({});
+        neighbors::configure({});
+        ComponentViewTest::TearDown();
+    }
+};
+
+TEST_F(DownwashTest, WakeReachesDronesBelowOnly)
+{
+    const auto above = place_drone(0.f, 0.f, 2.f, 470.f);
+    const auto below = place_drone(0.f, 0.f, 1.f, 470.f);
+    const auto beside = place_drone(3.f, 0.f, 1.f, 470.f);
+    enable(true);
+    downwash::update();
+
+    // 4.9 N over four 0.1 m rotors: 4 m/s induced, 8 m/s contracted, widened to 0.35 m at 1 m
+    EXPECT_NEAR(wind_of(below).z(), -8.f * 0.2f / 0.35f, 0.05f);
+    EXPECT_NEAR(wind_of(below).head<2>().norm(), 0.f, 1e-4f);
+    EXPECT_NEAR(wind_of(above).norm(), 0.f, 1e-6f);
+    EXPECT_NEAR(wind_of(beside).norm(), 0.f, 1e-6f);
+
+    // The induced wind is replaced, not accumulated, and cleared once disabled
+    const f32 first{wind_of(below).z()};
+    downwash::update();
+    EXPECT_FLOAT_EQ(wind_of(below).z(), first);
+
+    enable(false);
+    downwash::update();
+    EXPECT_NEAR(wind_of(below).norm(), 0.f, 1e-6f);
+}
+
+TEST_F(DownwashTest, SourcesFollowDronesThatMovedSinceTheLastTick)
+{
+    const auto source = place_drone(20.f, 0.f, 2.f, 470.f);
+    const auto below = place_drone(0.f, 0.f, 1.f, 470.f);
+    place_drone(0.f, 0.f, -3.f, 470.f);
+
+    downwash::config c{};
+    c.enabled = true;
+    c.max_sources = 1;
+    downwash::configure(c);
+    downwash::update();
+    EXPECT_NEAR(wind_of(below).norm(), 0.f, 1e-6f);
+
+    // Moved without a layout change, a grid kept from the last update still has it far away
+    drone::DroneState state{game_entity::entity{source}.drone().get_state()};
+    state.position = {0.f, 0.f, 2.f};
+    game_entity::entity{source}.drone().set_state(state);
+    downwash::update();
+    EXPECT_LT(wind_of(below).z(), -1.f);
+}
+
+TEST_F(DownwashTest, WakesDoNotNeedNeighborQueries)
+{
+    place_drone(0.f, 0.f, 2.f, 470.f);
+    const auto below = place_drone(0.f, 0.f, 1.f, 470.f);
+    neighbors::config n{};
+    n.enabled = false;
+    neighbors::configure(n);
+    enable(true);
+
+    downwash::update();
+    EXPECT_LT(wind_of(below).z(), -1.f);
+
+    // Ghosts the grid does not know about clear the induced wind instead of keeping it
+    const downwash::ghost ghost{};
+    downwash::set_ghosts(&ghost, 1, drone::QuadParams{});
+    downwash::update();
+    EXPECT_NEAR(wind_of(below).norm(), 0.f, 1e-6f);
+    downwash::set_ghosts(nullptr, 0, drone::QuadParams{});
+}
+
+TEST_F(DownwashTest, ScratchLivesOnTheTickArena)
+{
+    place_drone(0.f, 0.f, 2.f, 470.f);
+    place_drone(0.f, 0.f, 1.f, 470.f);
+    enable(true);
+    memory::reset_frame_arenas();
+
+    downwash::update();
+    EXPECT_GT(memory::thread_frame_arena().used(), 0u);
+    memory::reset_frame_arenas();
+    EXPECT_EQ(memory::thread_frame_arena().used(), 0u);
+}
+
+TEST_F(DownwashTest, SwarmThroughput)
+{
+    // Two layers of 16 x 32 drones, 0.5 m apart and 1 m above each other
+    constexpr u32 columns{16}, rows{32};
+    for (u32 layer{0}; layer < 2; ++layer)
+        for (u32 x{0}; x < columns; ++x)
+            for (u32 y{0}; y < rows; ++y)
+                place_drone(x * 0.5f, y * 0.5f, 1.f + layer, 470.f);
+    enable(true);
+
+    jobs::initialize();
+    downwash::update();
+    constexpr u32 repeats{20};
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 r{0}; r < repeats; ++r)
+        downwash::update();
+    const std::chrono::duration<double, std::milli> elapsed{std::chrono::steady_clock::now() -
+                                                            start};
+    jobs::shutdown();
+
+    const double milliseconds{elapsed.count() / repeats};
+    RecordProperty("tick_microseconds", std::to_string((u64)(milliseconds * 1000.0)));
+    printf("Downwash: %.3f ms per tick for %u drones on %u threads\n", milliseconds, drone::count(),
+           std::thread::hardware_concurrency());
+
+    // Every lower drone sits in the wake of the one above it
+    u32 pushed{0};
+    for (auto id : ids)
+        pushed += wind_of(id).z() < -1.f ? 1 : 0;
+    EXPECT_EQ(pushed, columns * rows);
+}
+
+} // namespace lark::test
@@ -0,0 +1,181 @@
+#pragma once
+#include "ComponentViewTest.h"
+#include "Components/Sensors.h"
+#include <cmath>
+#include <memory>
+
+namespace lark::test
+{
+
+class DynamicsLodTest : public ComponentViewTest
+{
+  protected:
+    game_entity::entity_id hover_drone(f32 x)
+    {
+        const drone::Vector3f position{x, 0.f, 1.f};
+        const f32 hover_speed{std::sqrt(0.5f * 9.81f / (4.f * 5.57e-6f))};
+
+        transform::init_info transform_info{};
+        transform_info.position[0] = x;
+
+        drone::init_info drone_info{};
+        drone_info.params = createHummingbirdParams();
+        drone_info.abstraction = drone::ControlAbstraction::CMD_MOTOR_SPEEDS;
+        drone_info.trajectory = std::make_shared<drone::Circular>(position, 0.f, 0.f);
+        drone_info.initial_state.position = position;
+        drone_info.initial_state.attitude = {0.f, 0.f, 0.f, 1.f};
+        drone_info.initial_state.rotor_speeds.setConstant(hover_speed);
+        drone_info.last_control.cmd_motor_speeds.setConstant(hover_speed);
+
+        game_entity::entity_info info{};
+        info.transform = &transform_info;
+        info.drone = &drone_info;
+        const auto id = game_entity::create(info).get_id();
+        ids.push_back(id);
+        return id;
+    }
+
+    static drone::lod_config policy(u32 settle_ticks)
+    {
+        drone::lod_config c{};
+        c.enabled = true;
+        c.settle_ticks = settle_ticks;
+        return c;
+    }
+
+    static void tick(f32 dt)
+    {
+        drone::update_trajectories(dt, 0, drone::count());
+        drone::update_controls(0, drone::count());
+        drone::step_dynamics(dt, 0, drone::count());
+    }
+
+    void TearDown() override
+    {
+        drone::configure_lod({});
+        sensors::configure({});
+        ComponentViewTest::TearDown();
+    }
+};
+
+TEST_F(DynamicsLodTest, SettledDroneIsHeldUntilDisturbed)
+{
+    const auto id = hover_drone(0.f);
+    drone::configure_lod(policy(10));
+
+    for (u32 i{0}; i < 40; ++i)
+        tick(0.01f);
+
+    const drone::lod_stats settled{drone::get_lod_stats()};
+    EXPECT_EQ(settled.held, drone::count());
+    EXPECT_GT(settled.steps_skipped, 0u);
+
+    const drone::DroneState before{game_entity::entity{id}.drone().get_state()};
+    tick(0.01f);
+    const drone::DroneState after{game_entity::entity{id}.drone().get_state()};
+    EXPECT_EQ(before.position, after.position);
+    EXPECT_EQ(before.attitude, after.attitude);
+
+    // A gust larger than the wind tolerance wakes the drone up
+    util::vector<drone::Vector3f> gust(drone::count(), drone::Vector3f{1.f, 0.f, 0.f});
+    drone::set_induced_wind(gust.data(), 0, drone::count());
+    tick(0.01f);
+    EXPECT_EQ(drone::get_lod_stats().held, 0u);
+    EXPECT_EQ(drone::get_lod_stats().full, drone::count());
+}
+
+TEST_F(DynamicsLodTest, DistantDronesStepAtReducedRate)
+{
+    hover_drone(10.f);
+    drone::lod_config c{policy(1000)};
+    c.roi_radius = 1.f;
+    c.max_reduced_dt = 0.02f;
+    drone::configure_lod(c);
+
+    // 0.02 s over 0.005 s ticks, one step every four ticks
+    for (u32 i{0}; i < 8; ++i)
+        tick(0.005f);
+
+    const drone::lod_stats stats{drone::get_lod_stats()};
+    EXPECT_EQ(stats.reduced, drone::count());
+    EXPECT_EQ(stats.steps_taken, 2u * drone::count());
+    EXPECT_EQ(stats.steps_skipped, 6u * drone::count());
+    EXPECT_NEAR(stats.saved_fraction(), 0.75, 1e-9);
+}
+
+TEST_F(DynamicsLodTest, SavedStatesKeepTheLevelOfDetail)
+{
+    const auto id = hover_drone(10.f);
+    drone::lod_config c{policy(1000)};
+    c.roi_radius = 1.f;
+    c.max_reduced_dt = 0.02f;
+    drone::configure_lod(c);
+    tick(0.005f);
+    tick(0.005f);
+
+    // Halfway through a reduced step, a restore must not start the stride over
+    util::vector<drone::saved_state> saved;
+    drone::save_states(saved);
+    const auto run = [id] {
+        util::vector<f32> stepped;
+        for (u32 i{0}; i < 6; ++i)
+        {
+            tick(0.005f);
+            stepped.push_back(drone::stepped_dt_at(0));
+        }
+        return std::pair{stepped, game_entity::entity{id}.drone().get_state().position};
+    };
+    const auto first = run();
+    ASSERT_TRUE(drone::load_states(saved.data(), (u32)saved.size()));
+    EXPECT_EQ(drone::lod_at(0), drone::lod_level::reduced);
+    const auto second = run();
+    EXPECT_EQ(first.first, second.first);
+    EXPECT_EQ(first.second, second.second);
+}
+
+TEST_F(DynamicsLodTest, SensorsSampleReducedDronesOnlyWhenStepped)
+{
+    // Both fall freely, the far one outside the region is stepped every fourth tick
+    const auto near = create_drone(1.f);
+    const auto far = create_drone(100.f);
+    drone::lod_config c{policy(30)};
+    c.roi_radius = 10.f;
+    drone::configure_lod(c);
+
+    sensors::config s{};
+    s.imu = {200.f, 0.f, 0.f, 0.f, 0.f};
+    s.mocap.rate = 0.f;
+    sensors::configure(s);
+
+    // Starts tracking both at rest, neither is sampled before its first step
+    sensors::update(0.005f);
+    EXPECT_EQ(sensors::imu_written(), 0u);
+
+    u64 cursor{sensors::imu_written()};
+    u32 near_samples{0}, far_samples{0};
+    for (u32 tick{0}; tick < 40; ++tick)
+    {
+        drone::step_dynamics(0.005f, 0, drone::count());
+        sensors::update(0.005f);
+
+        sensors::imu_sample samples[4];
+        while (const u32 count{sensors::read_imu(cursor, samples, 4)})
+        {
+            for (u32 i{0}; i < count; ++i)
+            {
+                // In free fall the accelerometer reads about no specific force
+                EXPECT_LT(std::abs(samples[i].accel_true[2]), 0.5f) << "tick " << tick;
+                if (samples[i].entity == (id::id_type)near)
+                    ++near_samples;
+                if (samples[i].entity == (id::id_type)far)
+                    ++far_samples;
+            }
+        }
+    }
+
+    EXPECT_EQ(drone::get_lod_stats().reduced, 1u);
+    EXPECT_EQ(near_samples, 40u);
+    EXPECT_EQ(far_samples, 10u);
+}
+
+} // namespace lark::test
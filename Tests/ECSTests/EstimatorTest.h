@@ -0,0 +1,129 @@
+#pragma once
+#include "SensorTest.h"
+#include "Components/Estimator.h"
+
+namespace lark::test
+{
+
+class EstimatorTest : public SensorTest
+{
+  protected:
+    static u32 dense_index(game_entity::entity_id id)
+    {
+        for (u32 i{0}; i < drone::count(); ++i)
+        {
+            if (drone::entity_at(i) == id)
+                return i;
+        }
+        return u32_invalid_id;
+    }
+
+    void TearDown() override
+    {
+        estimator::configure({});
+        SensorTest::TearDown();
+    }
+};
+
+TEST_F(EstimatorTest, TracksADroneAtRest)
+{
+    const auto id = create_drone(1.f);
+    create_drone(2.f);
+
+    sensors::config c{noiseless(200.f, 100.f)};
+    c.imu.accel_noise_density = 0.004f;
+    c.imu.gyro_noise_density = 0.01f;
+    c.mocap.position_noise = 0.001f;
+    sensors::configure(c);
+
+    estimator::config e{};
+    e.enabled = true;
+    estimator::configure(e);
+
+    for (u32 i{0}; i < 400; ++i)
+    {
+        sensors::update(0.005f);
+        estimator::update();
+    }
+
+    const u32 index{dense_index(id)};
+    ASSERT_NE(index, u32_invalid_id);
+    const drone::DroneState truth{game_entity::entity{id}.drone().get_state()};
+    drone::DroneState estimate{truth};
+    estimate.position.setZero();
+    ASSERT_TRUE(estimator::estimate(index, estimate));
+
+    EXPECT_LT((estimate.position - truth.position).norm(), 0.01f);
+    EXPECT_LT(estimate.velocity.norm(), 0.01f);
+    EXPECT_NEAR(std::abs(estimate.attitude.dot(truth.attitude)), 1.f, 1e-4f);
+
+    f32 P[estimator::state_size * estimator::state_size];
+    ASSERT_TRUE(estimator::covariance(index, P));
+    for (u32 i{0}; i < estimator::state_size; ++i)
+    {
+        EXPECT_GT(P[i * estimator::state_size + i], 0.f);
+        EXPECT_LT(P[i * estimator::state_size + i], 0.01f);
+        for (u32 j{0}; j < i; ++j)
+            EXPECT_FLOAT_EQ(P[i * estimator::state_size + j], P[j * estimator::state_size + i]);
+    }
+}
+
+TEST_F(EstimatorTest, TracksMovingDronesWithAShortHistory)
+{
+    util::vector<game_entity::entity_id> moving;
+    for (u32 i{0}; i < 5; ++i)
+    {
+        const auto id = create_drone((f32)i);
+        game_entity::entity entity{id};
+        drone::DroneState state{entity.drone().get_state()};
+        state.velocity = {1.f + (f32)i, -0.5f * (f32)i, 2.f};
+        entity.drone().set_state(state);
+        moving.push_back(id);
+    }
+
+    // The ring holds just one update, samples still have to reach the right filters
+    sensors::configure(noiseless(200.f, 100.f, drone::count()));
+    estimator::config e{};
+    e.enabled = true;
+    estimator::configure(e);
+
+    for (u32 i{0}; i < 200; ++i)
+    {
+        drone::step_dynamics(0.005f, 0, drone::count());
+        sensors::update(0.005f);
+        estimator::update();
+    }
+
+    for (auto id : moving)
+    {
+        const u32 index{dense_index(id)};
+        ASSERT_NE(index, u32_invalid_id);
+        const drone::DroneState truth{game_entity::entity{id}.drone().get_state()};
+        drone::DroneState estimate{};
+        ASSERT_TRUE(estimator::estimate(index, estimate));
+
+        EXPECT_LT((estimate.position - truth.position).norm(), 0.01f);
+        EXPECT_LT((estimate.velocity - truth.velocity).norm(), 0.05f);
+    }
+}
+
+TEST_F(EstimatorTest, FeedsControlOnlyWhenAsked)
+{
+    create_drone(1.f);
+    EXPECT_FALSE(estimator::feeds_control());
+
+    estimator::config e{};
+    e.feed_control = true;
+    estimator::configure(e);
+    EXPECT_FALSE(estimator::feeds_control());
+
+    e.enabled = true;
+    estimator::configure(e);
+    EXPECT_TRUE(estimator::feeds_control());
+
+    // Nothing is tracked before the first update
+    drone::DroneState state{};
+    EXPECT_FALSE(estimator::estimate(0, state));
+}
+
+} // namespace lark::test
@@ -0,0 +1,185 @@
+#pragma once
+#include "ComponentViewTest.h"
+#include "Components/Neighbors.h"
+#include "Core/JobSystem.h"
+#include <chrono>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace lark::test
+{
+
+class NeighborTest : public ComponentViewTest
+{
+  protected:
+    static std::vector<f32> scattered(u32 count, f32 extent, u32 seed)
+    {
+        std::mt19937 rng{seed};
+        std::uniform_real_distribution<f32> coordinate{-extent, extent};
+        std::vector<f32> points(count * 3);
+        for (auto &p : points)
+            p = coordinate(rng);
+        return points;
+    }
+
+    static f32 distance_squared(const f32 *a, const f32 *b)
+    {
+        const f32 dx{a[0] - b[0]}, dy{a[1] - b[1]}, dz{a[2] - b[2]};
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    void TearDown() override
+    {
+        neighbors::configure({});
+        ComponentViewTest::TearDown();
+    }
+};
+
+TEST_F(NeighborTest, QueriesMatchBruteForce)
+{
+    constexpr u32 count{2000};
+    constexpr u32 queries{100};
+    constexpr u32 capacity{128};
+    constexpr u32 k{8};
+    constexpr f32 radius{1.5f};
+    const std::vector<f32> points{scattered(count, 8.f, 7)};
+
+    neighbors::spatial_hash hash;
+    hash.build(points.data(), 3 * sizeof(f32), count, 1.f);
+
+    std::vector<u32> exclude(queries), indices(queries * capacity), counts(queries);
+    for (u32 q{0}; q < queries; ++q)
+        exclude[q] = q * 13;
+    std::vector<f32> centers(queries * 3);
+    for (u32 q{0}; q < queries; ++q)
+        std::copy_n(points.data() + exclude[q] * 3, 3, centers.data() + q * 3);
+
+    const neighbors::query_batch batch{centers.data(), exclude.data(), queries};
+    const neighbors::query_results results{indices.data(), nullptr, counts.data(), capacity};
+
+    hash.radius(batch, radius, results);
+    for (u32 q{0}; q < queries; ++q)
+    {
+        std::vector<u32> expected;
+        for (u32 i{0}; i < count; ++i)
+        {
+            if (i != exclude[q] &&
+                distance_squared(points.data() + i * 3, centers.data() + q * 3) <= radius * radius)
+                expected.push_back(i);
+        }
+        ASSERT_LE(expected.size(), capacity);
+
+        std::vector<u32> found(indices.begin() + q * capacity,
+                               indices.begin() + q * capacity + counts[q]);
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, expected);
+    }
+
+    hash.nearest(batch, k, results);
+    for (u32 q{0}; q < queries; ++q)
+    {
+        std::vector<std::pair<f32, u32>> expected;
+        for (u32 i{0}; i < count; ++i)
+        {
+            if (i != exclude[q])
+            {
+                const f32 d{distance_squared(points.data() + i * 3, centers.data() + q * 3)};
+                expected.push_back({d, i});
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+
+        ASSERT_EQ(counts[q], k);
+        for (u32 i{0}; i < k; ++i)
+            EXPECT_EQ(indices[q * capacity + i], expected[i].second);
+    }
+}
+
+TEST_F(NeighborTest, FullRowsReportTheTrueCount)
+{
+    const std::vector<f32> points{scattered(50, 1.f, 3)};
+    neighbors::spatial_hash hash;
+    hash.build(points.data(), 3 * sizeof(f32), 50, 1.f);
+
+    const f32 center[3]{};
+    u32 indices[8]{}, count{0}, total{0};
+    const neighbors::query_results results{indices, nullptr, &count, 8, &total};
+    const u32 truncated{hash.radius({center, nullptr, 1}, 10.f, results)};
+    EXPECT_EQ(truncated, 1u);
+    EXPECT_EQ(count, 8u);
+    EXPECT_EQ(total, 50u);
+}
+
+TEST_F(NeighborTest, NonFinitePointsAreNeverFound)
+{
+    constexpr f32 nan{std::numeric_limits<f32>::quiet_NaN()};
+    const std::vector<f32> points{0.f, 0.f, 0.f, nan, 0.f, 0.f, 1e30f, -1e30f, 0.f, 0.5f, 0.f, 0.f};
+    neighbors::spatial_hash hash;
+    hash.build(points.data(), 3 * sizeof(f32), 4, 1.f);
+
+    const f32 centers[6]{0.f, 0.f, 0.f, nan, nan, nan};
+    u32 indices[8]{}, counts[2]{};
+    const neighbors::query_results results{indices, nullptr, counts, 4};
+    hash.radius({centers, nullptr, 2}, 2.f, results);
+    EXPECT_EQ(counts[0], 2u);
+    EXPECT_EQ(counts[1], 0u);
+
+    hash.nearest({centers, nullptr, 1}, 3, results);
+    ASSERT_EQ(counts[0], 3u);
+    EXPECT_EQ(indices[0], 0u);
+    EXPECT_EQ(indices[1], 3u);
+    EXPECT_EQ(indices[2], 2u);
+}
+
+TEST_F(NeighborTest, DroneGridFollowsPositions)
+{
+    const auto a = create_drone(1.f);
+    const auto b = create_drone(1.2f);
+    create_drone(30.f);
+    neighbors::update();
+
+    u32 index{u32_invalid_id};
+    for (u32 i{0}; i < drone::count(); ++i)
+    {
+        if (drone::entity_at(i) == a)
+            index = i;
+    }
+    ASSERT_NE(index, u32_invalid_id);
+
+    u32 found[4]{}, count{0};
+    f32 distances[4]{};
+    neighbors::drone_nearest(&index, 1, 1, {found, distances, &count, 4});
+    ASSERT_EQ(count, 1u);
+    EXPECT_EQ(drone::entity_at(found[0]), b);
+    // Drones sit at (x, 2x, 3x)
+    EXPECT_NEAR(distances[0], 0.2f * std::sqrt(14.f), 1e-4f);
+
+    neighbors::drone_radius(&index, 1, 5.f, {found, nullptr, &count, 4});
+    EXPECT_EQ(count, 1u);
+}
+
+TEST_F(NeighborTest, SwarmBuildThroughput)
+{
+    constexpr u32 count{100000};
+    const std::vector<f32> points{scattered(count, 100.f, 11)};
+    neighbors::spatial_hash hash;
+
+    jobs::initialize();
+    hash.build(points.data(), 3 * sizeof(f32), count, 2.f);
+    constexpr u32 repeats{20};
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 r{0}; r < repeats; ++r)
+        hash.build(points.data(), 3 * sizeof(f32), count, 2.f);
+    const std::chrono::duration<double, std::milli> elapsed{std::chrono::steady_clock::now() -
+                                                            start};
+    jobs::shutdown();
+
+    const double milliseconds{elapsed.count() / repeats};
+    RecordProperty("build_microseconds", std::to_string((u64)(milliseconds * 1000.0)));
+    printf("Spatial hash: %.3f ms per 100k point build on %u threads\n", milliseconds,
+           std::thread::hardware_concurrency());
+    EXPECT_EQ(hash.count(), count);
+}
+
+} // namespace lark::test
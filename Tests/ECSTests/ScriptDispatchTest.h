@@ -0,0 +1,200 @@
+#pragma once
+#include "Components/Entity.h"
+#include "Components/Script.h"
+#include "Components/ScriptRuntime.h"
+#include "Components/Transform.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+namespace lark::script::test
+{
+
+// Instances load the Python module named like the class
+class dispatch_each : public entity_script
+{
+  public:
+    explicit dispatch_each(game_entity::entity entity) : entity_script{entity} {}
+};
+
+class dispatch_batch : public entity_script
+{
+  public:
+    explicit dispatch_batch(game_entity::entity entity) : entity_script{entity} {}
+};
+
+class dispatch_slow : public entity_script
+{
+  public:
+    explicit dispatch_slow(game_entity::entity entity) : entity_script{entity} {}
+};
+
+REGISTER_SCRIPT(dispatch_each)
+REGISTER_SCRIPT(dispatch_batch)
+REGISTER_SCRIPT(dispatch_slow)
+
+class ScriptDispatchTest : public ::testing::Test
+{
+  protected:
+    using log_entry = std::pair<std::string, u32>;
+
+    static void SetUpTestSuite()
+    {
+        const std::filesystem::path folder{std::filesystem::temp_directory_path() /
+                                           "lark_script_dispatch"};
+        std::filesystem::create_directories(folder);
+        write(folder / "dispatch_log.py", "calls = []\n");
+        write(folder / "dispatch_each.py", "import dispatch_log\n"
+                                           "class Script:\n"
+                                           "    def __init__(self, entity):\n"
+                                           "        self.id = entity.id\n"
+                                           "    def update(self, dt):\n"
+                                           "        dispatch_log.calls.append(('each', self.id))\n");
+        write(folder / "dispatch_batch.py",
+              "import dispatch_log\n"
+              "class Script:\n"
+              "    def __init__(self, entity):\n"
+              "        pass\n"
+              "    @classmethod\n"
+              "    def update_batch(cls, dt, entity_ids, instances):\n"
+              "        dispatch_log.calls.append(('batch', len(instances)))\n"
+              "        for entity_id in entity_ids:\n"
+              "            dispatch_log.calls.append(('batch', entity_id))\n");
+        write(folder / "dispatch_slow.py", "import dispatch_log, time\n"
+                                           "class Script:\n"
+                                           "    def __init__(self, entity):\n"
+                                           "        self.id = entity.id\n"
+                                           "    def update(self, dt):\n"
+                                           "        time.sleep(0.005)\n"
+                                           "        dispatch_log.calls.append(('slow', self.id))\n");
+
+        runtime::wait_until_ready();
+        pybind11::gil_scoped_acquire gil;
+        pybind11::module_::import("sys").attr("path").attr("insert")(0, folder.string());
+
+        // A game loop started earlier preloads every registered script, before the folder existed
+        for (const char *name : {"dispatch_each", "dispatch_batch", "dispatch_slow"})
+            runtime::invalidate(name);
+    }
+
+    static void write(const std::filesystem::path &path, const char *source)
+    {
+        std::ofstream{path} << source;
+    }
+
+    void TearDown() override
+    {
+        for (auto id : ids)
+            game_entity::remove(id);
+        set_time_budget("dispatch_slow.Script", 0.f);
+    }
+
+    game_entity::entity_id create(const char *script_name)
+    {
+        transform::init_info transform_info{};
+        init_info script_info{detail::get_script_creator(detail::string_hash()(script_name))};
+        game_entity::entity_info info{};
+        info.transform = &transform_info;
+        info.script = &script_info;
+        const auto id = game_entity::create(info).get_id();
+        ids.push_back(id);
+        return id;
+    }
+
+    // Calls logged by the scripts since the last take
+    static util::vector<log_entry> take_log()
+    {
+        pybind11::gil_scoped_acquire gil;
+        pybind11::list calls{pybind11::module_::import("dispatch_log").attr("calls")};
+        util::vector<log_entry> entries;
+        for (const auto call : calls)
+        {
+            const auto entry = call.cast<pybind11::tuple>();
+            entries.emplace_back(entry[0].cast<std::string>(), entry[1].cast<u32>());
+        }
+        calls.attr("clear")();
+        return entries;
+    }
+
+    util::vector<game_entity::entity_id> ids;
+};
+
+TEST_F(ScriptDispatchTest, InstancesAreDispatchedPerClass)
+{
+    take_log();
+    const u32 a{(u32)create("dispatch_each")};
+    const u32 b{(u32)create("dispatch_batch")};
+    const u32 c{(u32)create("dispatch_each")};
+    const u32 d{(u32)create("dispatch_batch")};
+
+    tick(0.01f);
+
+    // Classes in order of their first instance, a class's updates back to back
+    const util::vector<log_entry> expected{{"each", a},  {"each", c}, {"batch", 2},
+                                           {"batch", b}, {"batch", d}};
+    EXPECT_EQ(take_log(), expected);
+
+    const util::vector<script_timing> &types{timings()};
+    ASSERT_EQ(types.size(), 2u);
+    EXPECT_EQ(types[0].name, "dispatch_each.Script");
+    EXPECT_FALSE(types[0].batched);
+    EXPECT_EQ(types[0].updated, 2u);
+    EXPECT_EQ(types[1].name, "dispatch_batch.Script");
+    EXPECT_TRUE(types[1].batched);
+    EXPECT_EQ(types[1].entities, 2u);
+}
+
+TEST_F(ScriptDispatchTest, ClassOverBudgetIsDeferred)
+{
+    take_log();
+    util::vector<u32> slow;
+    for (u32 i{0}; i < 3; ++i)
+        slow.push_back((u32)create("dispatch_slow"));
+    const u32 other{(u32)create("dispatch_each")};
+    set_time_budget("dispatch_slow.Script", 1.f);
+
+    // One slow instance spends the budget, the rest wait for the next ticks
+    for (u32 t{0}; t < 3; ++t)
+    {
+        tick(0.01f);
+        const util::vector<log_entry> expected{{"slow", slow[t]}, {"each", other}};
+        EXPECT_EQ(take_log(), expected);
+    }
+
+    const script_timing &timing{timings()[0]};
+    EXPECT_EQ(timing.name, "dispatch_slow.Script");
+    EXPECT_EQ(timing.entities, 3u);
+    EXPECT_EQ(timing.updated, 1u);
+    EXPECT_EQ(timing.overruns, 3u);
+    EXPECT_EQ(timings()[1].updated, 1u);
+
+    // Without a budget every instance runs in one tick again
+    set_time_budget("dispatch_slow.Script", 0.f);
+    tick(0.01f);
+    const util::vector<log_entry> expected{
+        {"slow", slow[0]}, {"slow", slow[1]}, {"slow", slow[2]}, {"each", other}};
+    EXPECT_EQ(take_log(), expected);
+}
+
+TEST_F(ScriptDispatchTest, TimingsSurviveSpawns)
+{
+    create("dispatch_slow");
+    create("dispatch_slow");
+    set_time_budget("dispatch_slow.Script", 1.f);
+    tick(0.01f);
+    tick(0.01f);
+    ASSERT_EQ(timings()[0].overruns, 2u);
+
+    // Regrouping for the new instance keeps the class's history
+    create("dispatch_slow");
+    tick(0.01f);
+    take_log();
+
+    ASSERT_EQ(timings().size(), 1u);
+    EXPECT_EQ(timings()[0].entities, 3u);
+    EXPECT_EQ(timings()[0].overruns, 3u);
+    EXPECT_GT(timings()[0].average_ms, 0.f);
+}
+
+} // namespace lark::script::test
@@ -0,0 +1,97 @@
+#pragma once
+#include "Components/Entity.h"
+#include "Components/ScriptExecution.h"
+#include "Components/Transform.h"
+#include <gtest/gtest.h>
+
+namespace lark::script::test
+{
+
+class ScriptExecutionTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        transform::init_info info{};
+        info.position[0] = 1.f;
+        info.position[1] = 2.f;
+        info.position[2] = 3.f;
+        info.rotation[3] = 1.f;
+
+        game_entity::entity_info entity_info{&info};
+        entity = game_entity::create(entity_info);
+    }
+
+    void TearDown() override
+    {
+        shutdown_execution();
+        game_entity::remove(entity.get_id());
+    }
+
+    const f32 *snapshot_row(view_column column) const
+    {
+        const storage_view view{column_view(column)};
+        EXPECT_LT(id::index(entity.get_id()), view.count);
+        return reinterpret_cast<const f32 *>(static_cast<const u8 *>(view.data) +
+                                             (size_t)view.stride * id::index(entity.get_id()));
+    }
+
+    game_entity::entity entity;
+};
+
+TEST_F(ScriptExecutionTest, CommandsApplyAtTheNextSyncPoint)
+{
+    command cmd{command_type::set_position, entity.get_id()};
+    cmd.values[0] = 7.f;
+    queue_command(cmd);
+
+    EXPECT_FLOAT_EQ(entity.transform().position().x, 1.f);
+    begin_frame(0.f);
+    end_frame();
+    EXPECT_FLOAT_EQ(entity.transform().position().x, 7.f);
+}
+
+TEST_F(ScriptExecutionTest, WorkerModeReadsTheSnapshot)
+{
+    set_execution_mode(execution_mode::worker_thread);
+    begin_frame(0.f);
+
+    // The systems keep writing the live store while the scripts run
+    entity.transform().set_position(math::v3{5.f, 0.f, 0.f});
+    EXPECT_FLOAT_EQ(snapshot_row(view_column::transform_positions)[0], 1.f);
+    EXPECT_FLOAT_EQ(snapshot_row(view_column::transform_positions)[2], 3.f);
+    end_frame();
+
+    const u64 generation{column_generation(view_column::transform_positions)};
+    begin_frame(0.f);
+    end_frame();
+    EXPECT_NE(column_generation(view_column::transform_positions), generation);
+    EXPECT_FLOAT_EQ(snapshot_row(view_column::transform_positions)[0], 5.f);
+}
+
+TEST_F(ScriptExecutionTest, SharedSnapshotIsNotReused)
+{
+    set_execution_mode(execution_mode::worker_thread);
+    EXPECT_FALSE(column_owner(view_column::transform_positions));
+    begin_frame(0.f);
+    end_frame();
+
+    // Nobody holds the buffer, the next tick captures into it again
+    const void *unshared{column_view(view_column::transform_positions).data};
+    begin_frame(0.f);
+    end_frame();
+    EXPECT_EQ(column_view(view_column::transform_positions).data, unshared);
+
+    // A script keeps an array of this tick while the entity moves
+    const std::shared_ptr<const void> owner{column_owner(view_column::transform_positions)};
+    const f32 *kept{snapshot_row(view_column::transform_positions)};
+    entity.transform().set_position(math::v3{5.f, 0.f, 0.f});
+    begin_frame(0.f);
+    end_frame();
+
+    EXPECT_NE(column_view(view_column::transform_positions).data, unshared);
+    EXPECT_FLOAT_EQ(kept[0], 1.f);
+    EXPECT_FLOAT_EQ(snapshot_row(view_column::transform_positions)[0], 5.f);
+}
+
+} // namespace lark::script::test
@@ -0,0 +1,107 @@
+#pragma once
+#include "Components/ScriptRuntime.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+
+namespace lark::script::test
+{
+
+class ScriptRuntimeTest : public ::testing::Test
+{
+  protected:
+    static void SetUpTestSuite()
+    {
+        std::filesystem::create_directories(folder());
+        runtime::wait_until_ready();
+        pybind11::gil_scoped_acquire gil;
+        auto sys = pybind11::module_::import("sys");
+        sys.attr("path").attr("insert")(0, folder().string());
+
+        // Rewritten modules are reloaded from source within the same second
+        sys.attr("dont_write_bytecode") = true;
+    }
+
+    static std::filesystem::path folder()
+    {
+        return std::filesystem::temp_directory_path() / "lark_script_runtime";
+    }
+
+    // Called with the GIL held
+    static void write(const char *module_name, const char *source)
+    {
+        std::ofstream{folder() / (std::string{module_name} + ".py")} << source;
+        pybind11::module_::import("importlib").attr("invalidate_caches")();
+    }
+
+    static pybind11::object version_of(const pybind11::object &type)
+    {
+        return type ? type.attr("version") : pybind11::none();
+    }
+
+    pybind11::gil_scoped_acquire gil;
+};
+
+TEST_F(ScriptRuntimeTest, ModulesAreCachedUntilInvalidated)
+{
+    write("runtime_cached", "class Script:\n    version = 1\n");
+    runtime::invalidate("runtime_cached");
+    const pybind11::object first{runtime::script_class("runtime_cached")};
+    ASSERT_TRUE(first);
+    EXPECT_EQ(first.attr("version").cast<int>(), 1);
+
+    // Changes on disk are not seen while the module is cached
+    write("runtime_cached", "class Script:\n    version = 22\n");
+    EXPECT_TRUE(runtime::script_class("runtime_cached").is(first));
+
+    runtime::invalidate("runtime_cached");
+    const pybind11::object reloaded{runtime::script_class("runtime_cached")};
+    ASSERT_TRUE(reloaded);
+    EXPECT_FALSE(reloaded.is(first));
+    EXPECT_EQ(reloaded.attr("version").cast<int>(), 22);
+}
+
+TEST_F(ScriptRuntimeTest, FailedImportIsRetriedAfterInvalidate)
+{
+    write("runtime_broken", "class Script:\n    version = (\n");
+    runtime::invalidate("runtime_broken");
+    EXPECT_FALSE(runtime::script_class("runtime_broken"));
+
+    write("runtime_broken", "class Script:\n    version = 3\n");
+    EXPECT_FALSE(runtime::script_class("runtime_broken"));
+
+    runtime::invalidate_all();
+    EXPECT_EQ(version_of(runtime::script_class("runtime_broken")).cast<int>(), 3);
+}
+
+TEST_F(ScriptRuntimeTest, ModuleWithoutScriptHasNoClass)
+{
+    write("runtime_plain", "value = 1\n");
+    runtime::invalidate("runtime_plain");
+    EXPECT_FALSE(runtime::script_class("runtime_plain"));
+}
+
+TEST_F(ScriptRuntimeTest, LaterUserConfigIsApplied)
+{
+    const std::filesystem::path late{folder() / "late"};
+    std::filesystem::create_directories(late);
+    std::ofstream{late / "runtime_late.py"} << "class Script:\n    version = 5\n";
+    pybind11::module_::import("importlib").attr("invalidate_caches")();
+
+    // A second user of the running interpreter gets its paths and preloads
+    runtime::runtime_config config{};
+    config.search_paths.emplace_back(late.string());
+    config.preload.emplace_back("runtime_late");
+    runtime::acquire(config);
+
+    auto sys = pybind11::module_::import("sys");
+    EXPECT_TRUE(sys.attr("path").attr("__contains__")(late.string()).cast<bool>());
+    EXPECT_TRUE(sys.attr("modules").attr("__contains__")("runtime_late").cast<bool>());
+
+    // The host still holds the runtime
+    runtime::release();
+    EXPECT_TRUE(runtime::is_ready());
+    EXPECT_EQ(version_of(runtime::script_class("runtime_late")).cast<int>(), 5);
+}
+
+} // namespace lark::script::test
@@ -0,0 +1,60 @@
+#pragma once
+#include "ComponentViewTest.h"
+#include "Components/ChangeTracking.h"
+#include "Components/ScriptRuntime.h"
+#include <pybind11/eval.h>
+
+namespace lark::test
+{
+
+class ScriptViewTest : public ComponentViewTest
+{
+  protected:
+    static void SetUpTestSuite() { script::runtime::wait_until_ready(); }
+
+    static f32 eval_f32(const char *expression, const pybind11::dict &scope)
+    {
+        return pybind11::eval(expression, scope).cast<f32>();
+    }
+};
+
+TEST_F(ScriptViewTest, ViewsAliasTheLiveStore)
+{
+    create_drone(1.f);
+    const auto second = create_drone(2.f);
+
+    pybind11::gil_scoped_acquire gil;
+    pybind11::dict scope;
+    scope["row"] = 1;
+    pybind11::exec("import lark\nview = lark.drone_positions()\n", scope);
+    EXPECT_FLOAT_EQ(eval_f32("view[row, 1]", scope), 4.f);
+
+    // No copy was taken, the view shows what the engine writes afterwards
+    drone::DroneState state{game_entity::entity{second}.drone().get_state()};
+    state.position.y() = 7.f;
+    game_entity::entity{second}.drone().set_state(state);
+    EXPECT_FLOAT_EQ(eval_f32("view[row, 1]", scope), 7.f);
+    EXPECT_FLOAT_EQ(eval_f32("float(__import__('numpy').asarray(view)[row, 1])", scope), 7.f);
+    EXPECT_THROW(pybind11::exec("view[row, 1] = 0.0\n", scope), pybind11::error_already_set);
+
+    // Writes go straight into the store and flag the drones as changed
+    changes::advance_frame();
+    pybind11::exec("with lark.drone_positions(writable=True) as w:\n"
+                   "    w[row, 2] = 9.0\n",
+                   scope);
+    EXPECT_FLOAT_EQ(game_entity::entity{second}.drone().get_state().position.z(), 9.f);
+    EXPECT_EQ(changes::last_changed(changes::component_type::drone, second),
+              changes::current_frame());
+
+    // A new drone may move the storage, the old view refuses until refreshed
+    create_drone(3.f);
+    EXPECT_FALSE(pybind11::eval("view.valid", scope).cast<bool>());
+    EXPECT_THROW(pybind11::eval("view[row, 1]", scope), pybind11::error_already_set);
+    EXPECT_THROW(pybind11::eval("__import__('numpy').asarray(view)", scope),
+                 pybind11::error_already_set);
+    pybind11::exec("view.refresh()\n", scope);
+    EXPECT_FLOAT_EQ(eval_f32("view[row, 1]", scope), 7.f);
+    EXPECT_EQ(pybind11::eval("len(view)", scope).cast<u32>(), 3u);
+}
+
+} // namespace lark::test
@@ -0,0 +1,134 @@
+#pragma once
+#include "ComponentViewTest.h"
+#include "Components/Sensors.h"
+
+namespace lark::test
+{
+
+class SensorTest : public ComponentViewTest
+{
+  protected:
+    static sensors::config noiseless(f32 imu_rate, f32 mocap_rate, u32 history = 1024)
+    {
+        sensors::config c{};
+        c.imu = {imu_rate, 0.f, 0.f, 0.f, 0.f};
+        c.mocap = {mocap_rate, 0.f, 0.f, 0.f, 0.f};
+        c.history = history;
+        return c;
+    }
+
+    void TearDown() override
+    {
+        sensors::configure({});
+        ComponentViewTest::TearDown();
+    }
+};
+
+TEST_F(SensorTest, RatesAreDecoupledFromTheTick)
+{
+    create_drone(1.f);
+    create_drone(2.f);
+    sensors::configure(noiseless(100.f, 50.f));
+
+    for (u32 i{0}; i < 10; ++i)
+        sensors::update(0.01f);
+
+    EXPECT_EQ(sensors::imu_written(), 10u * drone::count());
+    EXPECT_EQ(sensors::mocap_written(), 5u * drone::count());
+}
+
+TEST_F(SensorTest, NoiselessReadingsMatchTheState)
+{
+    const auto id = create_drone(1.f);
+    sensors::configure(noiseless(100.f, 100.f));
+    sensors::update(0.01f);
+
+    util::vector<sensors::imu_sample> imu(drone::count());
+    util::vector<sensors::mocap_sample> mocap(drone::count());
+    u64 imu_cursor{0}, mocap_cursor{0};
+    ASSERT_EQ(sensors::read_imu(imu_cursor, imu.data(), drone::count()), drone::count());
+    ASSERT_EQ(sensors::read_mocap(mocap_cursor, mocap.data(), drone::count()), drone::count());
+
+    const auto it = std::find_if(imu.begin(), imu.end(),
+                                 [id](const auto &s) { return s.entity == (id::id_type)id; });
+    ASSERT_NE(it, imu.end());
+
+    // Level and at rest, the accelerometer only feels the support force
+    EXPECT_NEAR(it->accel[2], 9.81f, 1e-4f);
+    EXPECT_NEAR(it->accel[0], 0.f, 1e-4f);
+    EXPECT_NEAR(it->gyro[2], 0.f, 1e-6f);
+    EXPECT_FLOAT_EQ(it->time, 0.01f);
+
+    const drone::DroneState state{game_entity::entity{id}.drone().get_state()};
+    for (const auto &sample : mocap)
+    {
+        if (sample.entity != (id::id_type)id)
+            continue;
+        EXPECT_FLOAT_EQ(sample.position[0], state.position.x());
+        EXPECT_FLOAT_EQ(sample.position[2], state.position.z());
+        EXPECT_NEAR(sample.attitude[3], 1.f, 1e-6f);
+    }
+}
+
+TEST_F(SensorTest, NoiseFollowsTheSampleInterval)
+{
+    const auto id = create_drone(1.f);
+
+    // Root mean square of the gyro readings of the drone at rest over 1000 ticks of 10 ms
+    const auto gyro_noise = [id](f32 rate, u32 &samples) {
+        sensors::config c{noiseless(rate, 0.f)};
+        c.imu.gyro_noise_density = 0.01f;
+        sensors::configure(c);
+
+        f64 sum_squares{0.0};
+        samples = 0;
+        util::vector<sensors::imu_sample> imu(drone::count());
+        u64 cursor{0};
+        for (u32 t{0}; t < 1000; ++t)
+        {
+            sensors::update(0.01f);
+            const u32 count{sensors::read_imu(cursor, imu.data(), drone::count())};
+            for (u32 i{0}; i < count; ++i)
+            {
+                if (imu[i].entity != (id::id_type)id)
+                    continue;
+                for (f32 reading : imu[i].gyro)
+                    sum_squares += (f64)reading * reading;
+                ++samples;
+            }
+        }
+        return std::sqrt(sum_squares / (3 * samples));
+    };
+
+    // 1 kHz asked, one sample per tick delivered: sigma is density / sqrt(10 ms)
+    u32 samples{0};
+    EXPECT_NEAR(gyro_noise(1000.f, samples), 0.1, 0.01);
+    EXPECT_EQ(samples, 1000u);
+
+    // Below the tick rate every fourth tick samples, over 40 ms
+    EXPECT_NEAR(gyro_noise(25.f, samples), 0.05, 0.008);
+    EXPECT_EQ(samples, 250u);
+}
+
+TEST_F(SensorTest, RingKeepsTheNewestSamples)
+{
+    create_drone(1.f);
+    sensors::configure(noiseless(100.f, 0.f, 8));
+    const u32 drones{drone::count()};
+
+    for (u32 i{0}; i < 20; ++i)
+        sensors::update(0.01f);
+
+    sensors::imu_sample samples[16]{};
+    u64 cursor{0};
+    const u32 count{sensors::read_imu(cursor, samples, 16)};
+    EXPECT_EQ(count, 8u);
+    EXPECT_EQ(cursor, 20u * drones);
+    EXPECT_EQ(sensors::read_imu(cursor, samples, 16), 0u);
+    EXPECT_EQ(sensors::mocap_written(), 0u);
+
+    for (u32 i{1}; i < count; ++i)
+        EXPECT_GE(samples[i].time, samples[i - 1].time);
+}
+
+} // namespace lark::test
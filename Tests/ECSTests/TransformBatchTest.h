@@ -0,0 +1,78 @@
+#pragma once
+#include "Components/Entity.h"
+#include "Components/Transform.h"
+#include <gtest/gtest.h>
+
+namespace lark::transform::test
+{
+
+class TransformBatchTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        // Not a multiple of four so both the SIMD and the scalar tail are exercised
+        for (u32 i = 0; i < 37; ++i)
+        {
+            init_info info{};
+            info.position[0] = (f32)i;
+            info.position[1] = 2.f * (f32)i;
+            info.position[2] = -0.5f * (f32)i;
+
+            const glm::quat q{glm::radians(math::v3(10.f * i, 5.f * i, -3.f * i))};
+            info.rotation[0] = q.x;
+            info.rotation[1] = q.y;
+            info.rotation[2] = q.z;
+            info.rotation[3] = q.w;
+
+            info.scale[0] = 1.f + 0.1f * (f32)i;
+            info.scale[1] = 1.f;
+            info.scale[2] = 0.5f + 0.05f * (f32)i;
+
+            game_entity::entity_info entity_info{&info};
+            ids.push_back(game_entity::create(entity_info).get_id());
+        }
+    }
+
+    void TearDown() override
+    {
+        for (auto id : ids)
+        {
+            game_entity::remove(game_entity::entity_id{id});
+        }
+    }
+
+    util::vector<id::id_type> ids;
+};
+
+TEST_F(TransformBatchTest, MatchesPerEntityMatrices)
+{
+    util::vector<math::m4x4> batch(ids.size());
+    get_transform_matrices(ids.data(), (u32)ids.size(), batch.data());
+
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        const math::m4x4 expected{
+            game_entity::entity{game_entity::entity_id{ids[i]}}.transform().get_transform_matrix()};
+
+        for (int c = 0; c < 4; ++c)
+        {
+            for (int r = 0; r < 4; ++r)
+            {
+                EXPECT_NEAR(batch[i][c][r], expected[c][r], 1e-5f)
+                    << "entity " << i << " element [" << c << "][" << r << "]";
+            }
+        }
+    }
+}
+
+TEST_F(TransformBatchTest, InvalidIdsYieldIdentity)
+{
+    const id::id_type batch_ids[5]{ids[0], id::invalid_id, ids[1], ids[2], ids[3]};
+    math::m4x4 batch[5];
+    get_transform_matrices(batch_ids, 5, batch);
+
+    EXPECT_EQ(batch[1], math::m4x4(1.0f));
+    EXPECT_NE(batch[0], math::m4x4(1.0f));
+}
+} // namespace lark::transform::test
@@ -0,0 +1,168 @@
+#pragma once
+#include "ComponentViewTest.h"
+#include "Core/WorldSnapshot.h"
+#include "Components/Estimator.h"
+#include "Components/Sensors.h"
+
+namespace lark::test
+{
+
+class WorldSnapshotTest : public ComponentViewTest
+{
+  protected:
+    void advance(u32 steps)
+    {
+        for (u32 i{0}; i < steps; ++i)
+            drone::step_dynamics(0.01f, 0, drone::count());
+    }
+
+    // Steps with sensors, returns the gyro readings written meanwhile
+    util::vector<f32> sense(u32 steps)
+    {
+        util::vector<f32> readings;
+        util::vector<sensors::imu_sample> imu(drone::count());
+        u64 cursor{sensors::imu_written()};
+        for (u32 i{0}; i < steps; ++i)
+        {
+            advance(1);
+            sensors::update(0.01f);
+            estimator::update();
+            const u32 count{sensors::read_imu(cursor, imu.data(), drone::count())};
+            for (u32 j{0}; j < count; ++j)
+                for (f32 reading : imu[j].gyro)
+                    readings.push_back(reading);
+        }
+        return readings;
+    }
+
+    // Estimated positions and covariance of every drone
+    static util::vector<f32> estimates()
+    {
+        util::vector<f32> values;
+        for (u32 i{0}; i < drone::count(); ++i)
+        {
+            drone::DroneState state{};
+            f32 P[estimator::state_size * estimator::state_size];
+            EXPECT_TRUE(estimator::estimate(i, state));
+            EXPECT_TRUE(estimator::covariance(i, P));
+            for (u32 j{0}; j < 3; ++j)
+                values.push_back(state.position[j]);
+            for (f32 value : P)
+                values.push_back(value);
+        }
+        return values;
+    }
+
+    void TearDown() override
+    {
+        estimator::configure({});
+        sensors::configure({});
+        ComponentViewTest::TearDown();
+    }
+};
+
+TEST_F(WorldSnapshotTest, RestoreRewindsDrones)
+{
+    const auto id = create_drone(1.f);
+    game_entity::entity entity{id};
+
+    const world_snapshot snapshot{world_snapshot::capture(nullptr)};
+    const drone::DroneState before{entity.drone().get_state()};
+
+    advance(20);
+    ASSERT_NE(entity.drone().get_state().position, before.position);
+
+    ASSERT_TRUE(snapshot.restore(nullptr));
+    EXPECT_EQ(entity.drone().get_state().position, before.position);
+    EXPECT_EQ(entity.drone().get_state().velocity, before.velocity);
+}
+
+TEST_F(WorldSnapshotTest, ForkCopiesOnWrite)
+{
+    create_drone(1.f);
+    const world_snapshot base{world_snapshot::capture(nullptr)};
+
+    world_snapshot branch{base};
+    drone::DroneState moved{branch.drone(0).state};
+    moved.position.z() += 5.f;
+    branch.set_drone_state(0, moved);
+
+    EXPECT_EQ(branch.drone(0).state.position, moved.position);
+    EXPECT_NE(base.drone(0).state.position, moved.position);
+}
+
+TEST_F(WorldSnapshotTest, SerializedSnapshotRestores)
+{
+    const auto id = create_drone(2.f);
+    util::byte_writer out;
+    world_snapshot::capture(nullptr).write(out);
+    const drone::DroneState before{game_entity::entity{id}.drone().get_state()};
+
+    advance(10);
+
+    world_snapshot snapshot{};
+    util::byte_reader in{out.data(), out.size()};
+    ASSERT_TRUE(snapshot.read(in));
+    ASSERT_TRUE(snapshot.restore(nullptr));
+    EXPECT_EQ(game_entity::entity{id}.drone().get_state().position, before.position);
+}
+
+TEST_F(WorldSnapshotTest, RestoreRefusesChangedScene)
+{
+    create_drone(1.f);
+    const world_snapshot snapshot{world_snapshot::capture(nullptr)};
+    const auto added = create_drone(3.f);
+    const drone::DroneState state{game_entity::entity{added}.drone().get_state()};
+
+    EXPECT_FALSE(snapshot.restore(nullptr));
+    EXPECT_EQ(game_entity::entity{added}.drone().get_state().position, state.position);
+}
+
+TEST_F(WorldSnapshotTest, SensorsRepeatAfterRestore)
+{
+    create_drone(1.f);
+    create_drone(2.f);
+    sensors::configure({});
+    sense(5);
+
+    // Biases, noise generators and clocks rewind with the drones
+    const world_snapshot snapshot{world_snapshot::capture(nullptr)};
+    const u64 written{sensors::imu_written()};
+    const util::vector<f32> first{sense(12)};
+
+    ASSERT_TRUE(snapshot.restore(nullptr));
+    EXPECT_EQ(sensors::imu_written(), written);
+    const util::vector<f32> second{sense(12)};
+    ASSERT_FALSE(first.empty());
+    EXPECT_EQ(first, second);
+}
+
+TEST_F(WorldSnapshotTest, EstimatorRepeatsAfterRestore)
+{
+    create_drone(1.f);
+    create_drone(2.f);
+    sensors::configure({});
+    estimator::config e{};
+    e.enabled = true;
+    estimator::configure(e);
+    sense(5);
+
+    // Filters and their sample cursors rewind with the sensors
+    const world_snapshot snapshot{world_snapshot::capture(nullptr)};
+    const util::vector<f32> captured{estimates()};
+    sense(12);
+    const util::vector<f32> first{estimates()};
+    ASSERT_NE(first, captured);
+
+    util::byte_writer out;
+    snapshot.write(out);
+    world_snapshot read{};
+    util::byte_reader in{out.data(), out.size()};
+    ASSERT_TRUE(read.read(in));
+    ASSERT_TRUE(read.restore(nullptr));
+    EXPECT_EQ(estimates(), captured);
+    sense(12);
+    EXPECT_EQ(estimates(), first);
+}
+
+} // namespace lark::test
@@ -1,6 +1,32 @@
+#include "CoreTests/FrameArenaTest.h"
+#include "CoreTests/ReplayTest.h"
+#include "CoreTests/ShardingTest.h"
+#include "CoreTests/SystemSchedulerTest.h"
+#include "ECSTests/BridgeTest.h"
+#include "ECSTests/ChangeTrackingTest.h"
+#include "ECSTests/ComponentViewTest.h"
+#include "ECSTests/ContextTest.h"
+#include "ECSTests/DownwashTest.h"
+#include "ECSTests/DynamicsLodTest.h"
+#include "ECSTests/EstimatorTest.h"
+#include "ECSTests/NeighborTest.h"
+#include "ECSTests/ScriptDispatchTest.h"
+#include "ECSTests/ScriptExecutionTest.h"
+#include "ECSTests/ScriptRuntimeTest.h"
+#include "ECSTests/ScriptViewTest.h"
+#include "ECSTests/SensorTest.h"
+#include "ECSTests/TransformBatchTest.h"
+#include "ECSTests/WorldSnapshotTest.h"
+#include "PhysicsTests/ContactTest.h"
 #include "PhysicsTests/ControllerTest.h"
+#include "PhysicsTests/DeterminismTest.h"
 #include "PhysicsTests/DroneDynamicsTest.h"
 #include "PhysicsTests/MultirotorTest.h"
+#include "PhysicsTests/PhysicEventBusTest.h"
+#include "PhysicsTests/RaycastTest.h"
+#include "PhysicsTests/VectorEnvTest.h"
+#include "PhysicsTests/VehicleTypesTest.h"
+#include "UtilTests/ContainerTest.h"
 #include <gtest/gtest.h>
 
 int main(int argc, char **argv)
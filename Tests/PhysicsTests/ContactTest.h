@@ -0,0 +1,98 @@
+#pragma once
+#include "PhysicExtension/Event/Contacts.h"
+#include <btBulletCollisionCommon.h>
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace lark::physics::test
+{
+
+class ContactTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        dispatcher = std::make_unique<btCollisionDispatcher>(&config);
+        world = std::make_unique<btCollisionWorld>(dispatcher.get(), &broadphase, &config);
+    }
+
+    void TearDown() override
+    {
+        for (auto &object : objects)
+            world->removeCollisionObject(object.get());
+    }
+
+    btCollisionObject *add_sphere(id::id_type entity, f32 x)
+    {
+        auto object = std::make_unique<btCollisionObject>();
+        object->setCollisionShape(&sphere);
+        object->setWorldTransform(btTransform{btQuaternion::getIdentity(), btVector3{x, 0.f, 0.f}});
+        object->setUserPointer(reinterpret_cast<void *>((uintptr_t)entity));
+        world->addCollisionObject(object.get());
+        objects.push_back(std::move(object));
+        return objects.back().get();
+    }
+
+    void detect()
+    {
+        world->performDiscreteCollisionDetection();
+        tracker.update(*dispatcher);
+    }
+
+    btDefaultCollisionConfiguration config;
+    btDbvtBroadphase broadphase;
+    btSphereShape sphere{0.5f};
+    std::unique_ptr<btCollisionDispatcher> dispatcher;
+    std::unique_ptr<btCollisionWorld> world;
+    std::vector<std::unique_ptr<btCollisionObject>> objects;
+    ContactTracker tracker;
+};
+
+TEST_F(ContactTest, PairGoesThroughBeginPersistEnd)
+{
+    add_sphere(7, 0.f);
+    btCollisionObject *mover{add_sphere(3, 0.8f)};
+
+    detect();
+    ASSERT_EQ(tracker.event_count(), 1u);
+    const contact_event begin{tracker.events()[0]};
+    EXPECT_EQ(begin.phase, contact_phase::begin);
+    EXPECT_EQ(begin.entity_a, 3u);
+    EXPECT_EQ(begin.entity_b, 7u);
+    EXPECT_NEAR(begin.depth, 0.2f, 1e-3f);
+    // From 7 at the origin towards 3 at +x
+    EXPECT_GT(begin.normal[0], 0.9f);
+
+    detect();
+    ASSERT_EQ(tracker.event_count(), 1u);
+    EXPECT_EQ(tracker.events()[0].phase, contact_phase::persist);
+    EXPECT_EQ(tracker.active_count(), 1u);
+
+    mover->setWorldTransform(btTransform{btQuaternion::getIdentity(), btVector3{5.f, 0.f, 0.f}});
+    detect();
+    ASSERT_EQ(tracker.event_count(), 1u);
+    EXPECT_EQ(tracker.events()[0].phase, contact_phase::end);
+    EXPECT_EQ(tracker.active_count(), 0u);
+
+    detect();
+    EXPECT_EQ(tracker.event_count(), 0u);
+}
+
+TEST_F(ContactTest, EventsOfFiltersByEntity)
+{
+    add_sphere(1, 0.f);
+    add_sphere(2, 0.9f);
+    add_sphere(3, 20.f);
+    add_sphere(4, 20.9f);
+
+    detect();
+    EXPECT_EQ(tracker.event_count(), 2u);
+
+    contact_event events[2]{};
+    ASSERT_EQ(tracker.events_of(4, events, 2), 1u);
+    EXPECT_EQ(events[0].entity_a, 3u);
+    EXPECT_EQ(events[0].entity_b, 4u);
+    EXPECT_EQ(tracker.events_of(5, events, 2), 0u);
+}
+
+} // namespace lark::physics::test
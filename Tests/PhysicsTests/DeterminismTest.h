@@ -0,0 +1,72 @@
+#pragma once
+#include "MultirotorTest.h"
+#include "PhysicExtension/Utils/Wind.h"
+#include "Utils/Random.h"
+
+namespace lark::drone::test
+{
+
+class DeterminismTest : public MultirotorTest
+{
+  protected:
+    QuadParams noisyParams()
+    {
+        QuadParams params{createHummingbirdParams()};
+        params.motor_properties.motor_noise_std = 5.f;
+        return params;
+    }
+
+    util::vector<Vector4f> runNoisy(u64 seed, u32 steps)
+    {
+        random::set_seed(seed);
+        Multirotor vehicle{noisyParams(), createState(), ControlAbstraction::CMD_MOTOR_SPEEDS};
+
+        ControlInput input{};
+        input.cmd_motor_speeds.setConstant(500.f);
+
+        DroneState state{createState()};
+        util::vector<Vector4f> rotor_speeds;
+        for (u32 i{0}; i < steps; ++i)
+        {
+            state = vehicle.step(state, input, 0.01f);
+            rotor_speeds.push_back(state.rotor_speeds);
+        }
+        return rotor_speeds;
+    }
+};
+
+TEST_F(DeterminismTest, MotorNoiseRepeatsForTheSameSeed)
+{
+    const auto first = runNoisy(7, 50);
+    const auto second = runNoisy(7, 50);
+    const auto other = runNoisy(8, 50);
+
+    for (u32 i{0}; i < first.size(); ++i)
+        EXPECT_EQ(first[i], second[i]) << "step " << i;
+    EXPECT_NE(first.back(), other.back());
+}
+
+TEST_F(DeterminismTest, LadderWindContinuesFromSavedState)
+{
+    random::set_seed(3);
+    LadderWind wind{Vector3f{-1.f, -1.f, -1.f}, Vector3f{1.f, 1.f, 1.f}, Vector3f{0.5f, 0.7f, 0.3f},
+                    Vector3f{9.f, 9.f, 9.f}, true};
+    for (u32 i{0}; i < 20; ++i)
+        wind.update(0.1f * (f32)i, Vector3f::Zero());
+
+    util::byte_writer saved;
+    wind.save_state(saved);
+
+    util::vector<Vector3f> expected;
+    for (u32 i{20}; i < 60; ++i)
+        expected.push_back(wind.update(0.1f * (f32)i, Vector3f::Zero()));
+
+    util::byte_reader in{saved.data(), saved.size()};
+    wind.load_state(in);
+    EXPECT_TRUE(in.ok() && in.at_end());
+
+    for (u32 i{20}; i < 60; ++i)
+        EXPECT_EQ(wind.update(0.1f * (f32)i, Vector3f::Zero()), expected[i - 20]) << "t " << i;
+}
+
+} // namespace lark::drone::test
@@ -0,0 +1,73 @@
+#pragma once
+#include "PhysicExtension/Event/PhysicEvent.h"
+#include <gtest/gtest.h>
+
+namespace lark::physics::test
+{
+
+struct event_counter
+{
+    void on_created(const PhysicObjectCreated *events, u32 count)
+    {
+        ++batches;
+        received += count;
+        last = events[count - 1].body;
+    }
+
+    u32 batches{0};
+    u32 received{0};
+    btRigidBody *last{nullptr};
+};
+
+class PhysicEventBusTest : public ::testing::Test
+{
+  protected:
+    static btRigidBody *fake_body(uintptr_t i) { return reinterpret_cast<btRigidBody *>(i * 16); }
+
+    PhysicEventBus bus;
+    event_counter counter;
+};
+
+TEST_F(PhysicEventBusTest, PublishIsDeferredUntilDispatch)
+{
+    bus.Subscribe<PhysicObjectCreated, &event_counter::on_created>(&counter);
+
+    for (uintptr_t i{1}; i <= 100; ++i)
+        bus.Publish(PhysicObjectCreated{fake_body(i)});
+
+    EXPECT_EQ(counter.received, 0u);
+    EXPECT_EQ(bus.Pending<PhysicObjectCreated>(), 100u);
+
+    bus.Dispatch();
+    EXPECT_EQ(counter.batches, 1u);
+    EXPECT_EQ(counter.received, 100u);
+    EXPECT_EQ(counter.last, fake_body(100));
+    EXPECT_EQ(bus.Pending<PhysicObjectCreated>(), 0u);
+
+    // Nothing queued, nothing delivered
+    bus.Dispatch();
+    EXPECT_EQ(counter.batches, 1u);
+}
+
+TEST_F(PhysicEventBusTest, UnsubscribeStopsDelivery)
+{
+    const PhysicSubscription id{
+        bus.Subscribe<PhysicObjectCreated, &event_counter::on_created>(&counter)};
+    bus.Publish(PhysicObjectCreated{fake_body(1)});
+    bus.Unsubscribe(id);
+    bus.Dispatch();
+
+    EXPECT_EQ(counter.received, 0u);
+    EXPECT_EQ(bus.Pending<PhysicObjectCreated>(), 0u);
+}
+
+TEST_F(PhysicEventBusTest, OtherEventTypesAreNotDelivered)
+{
+    bus.Subscribe<PhysicObjectCreated, &event_counter::on_created>(&counter);
+    bus.Publish(PhysicObjectRemoved{fake_body(1)});
+    bus.Dispatch();
+
+    EXPECT_EQ(counter.batches, 0u);
+}
+
+} // namespace lark::physics::test
@@ -0,0 +1,118 @@
+#pragma once
+#include "Core/JobSystem.h"
+#include "PhysicExtension/World/World.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace lark::physics::test
+{
+
+class RaycastTest : public ::testing::Test
+{
+  protected:
+    // The world frees its bodies on destruction, shapes are kept here
+    void add_box(id::id_type entity, const btVector3 &position, f32 half_extent = 0.5f)
+    {
+        shapes.push_back(std::make_unique<btBoxShape>(btVector3{half_extent, half_extent, half_extent}));
+        auto *body = new btRigidBody{0.f, nullptr, shapes.back().get()};
+        body->setWorldTransform(btTransform{btQuaternion::getIdentity(), position});
+        body->setUserPointer(reinterpret_cast<void *>((uintptr_t)entity));
+        world.dynamics_world()->addRigidBody(body);
+    }
+
+    std::vector<std::unique_ptr<btBoxShape>> shapes;
+    World world;
+};
+
+TEST_F(RaycastTest, ReportsClosestHit)
+{
+    add_box(1, {5.f, 0.f, 0.f});
+    add_box(2, {10.f, 0.f, 0.f});
+
+    const f32 origins[9]{0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f};
+    const f32 directions[9]{1.f, 0.f, 0.f, -1.f, 0.f, 0.f, 1.f, 0.f, 0.f};
+    const id::id_type ignore[3]{id::invalid_id, id::invalid_id, 1};
+    f32 distances[3]{};
+    f32 normals[9]{};
+    id::id_type entities[3]{};
+
+    World::ray_batch rays{};
+    rays.origins = origins;
+    rays.directions = directions;
+    rays.ignore = ignore;
+    rays.max_distance = 50.f;
+    rays.count = 3;
+    world.raycast(rays, {distances, normals, entities});
+
+    EXPECT_NEAR(distances[0], 4.5f, 1e-3f);
+    EXPECT_EQ(entities[0], 1u);
+    EXPECT_NEAR(normals[0], -1.f, 1e-3f);
+
+    EXPECT_FLOAT_EQ(distances[1], 50.f);
+    EXPECT_EQ(entities[1], id::invalid_id);
+    EXPECT_FLOAT_EQ(normals[3], 0.f);
+
+    // The first box is ignored, as a sensor skips its own drone
+    EXPECT_NEAR(distances[2], 9.5f, 1e-3f);
+    EXPECT_EQ(entities[2], 2u);
+}
+
+TEST_F(RaycastTest, SwarmLidarThroughput)
+{
+    // 20 x 20 pillars, 256 drones with a 64 beam ring each
+    for (u32 x{0}; x < 20; ++x)
+        for (u32 y{0}; y < 20; ++y)
+            add_box(x * 20 + y, {x * 4.f, y * 4.f, 0.f}, 1.f);
+
+    constexpr u32 drones{256};
+    constexpr u32 beams{64};
+    constexpr u32 count{drones * beams};
+    std::vector<f32> origins(count * 3), directions(count * 3), distances(count);
+    for (u32 d{0}; d < drones; ++d)
+    {
+        for (u32 b{0}; b < beams; ++b)
+        {
+            const u32 i{d * beams + b};
+            const f32 angle{b * 6.2831853f / beams};
+            origins[i * 3 + 0] = (d % 16) * 5.f + 2.f;
+            origins[i * 3 + 1] = (d / 16) * 5.f + 2.f;
+            origins[i * 3 + 2] = 0.f;
+            directions[i * 3 + 0] = std::cos(angle);
+            directions[i * 3 + 1] = std::sin(angle);
+            directions[i * 3 + 2] = 0.f;
+        }
+    }
+
+    World::ray_batch rays{};
+    rays.origins = origins.data();
+    rays.directions = directions.data();
+    rays.max_distance = 30.f;
+    rays.count = count;
+
+    jobs::initialize();
+    constexpr u32 repeats{10};
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 r{0}; r < repeats; ++r)
+        world.raycast(rays, {distances.data(), nullptr, nullptr});
+    const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+    jobs::shutdown();
+
+    const double rays_per_second{count * repeats / elapsed.count()};
+    RecordProperty("rays_per_second", std::to_string((u64)rays_per_second));
+    printf("Raycast: %.2f Mrays/s on %u threads\n", rays_per_second * 1e-6,
+           std::thread::hardware_concurrency());
+
+    u32 hits{0};
+    for (f32 distance : distances)
+    {
+        EXPECT_LE(distance, rays.max_distance);
+        hits += distance < rays.max_distance;
+    }
+    EXPECT_GT(hits, 0u);
+}
+
+} // namespace lark::physics::test
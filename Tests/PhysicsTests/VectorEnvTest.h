@@ -0,0 +1,158 @@
+#pragma once
+#include "Core/JobSystem.h"
+#include "MultirotorTest.h"
+#include "PhysicExtension/Environment/VectorEnv.h"
+
+namespace lark::drone::test
+{
+
+class VectorEnvTest : public MultirotorTest
+{
+  protected:
+    struct buffers
+    {
+        explicit buffers(u32 count)
+            : observations(count * VectorEnv::observation_size), rewards(count),
+              terminated(count), truncated(count)
+        {
+        }
+
+        VectorEnvBuffers view()
+        {
+            return {observations.data(), rewards.data(), terminated.data(), truncated.data()};
+        }
+
+        util::vector<f32> observations;
+        util::vector<f32> rewards;
+        util::vector<bool> terminated;
+        util::vector<bool> truncated;
+    };
+
+    VectorEnvConfig make_config(u32 num_envs)
+    {
+        VectorEnvConfig config{};
+        config.num_envs = num_envs;
+        config.max_episode_steps = 50;
+        config.seed = 42;
+        return config;
+    }
+
+    util::vector<f32> hover_actions(u32 num_envs)
+    {
+        const QuadParams params{createHummingbirdParams()};
+        const f32 hover{std::sqrt(params.inertia_properties.mass * 9.81f /
+                                  (4.f * params.rotor_properties.k_eta))};
+        return util::vector<f32>(num_envs * VectorEnv::action_size, hover);
+    }
+};
+
+TEST_F(VectorEnvTest, SameSeedGivesSameRollout)
+{
+    constexpr u32 count{64};
+    VectorEnv serial{createHummingbirdParams(), make_config(count)};
+    buffers serial_out{count};
+    serial.reset(nullptr, 0, serial_out.view());
+
+    const bool owns_pool{!jobs::is_running()};
+    if (owns_pool)
+        jobs::initialize(4);
+    VectorEnv parallel{createHummingbirdParams(), make_config(count)};
+    buffers parallel_out{count};
+    parallel.reset(nullptr, 0, parallel_out.view());
+
+    const util::vector<f32> actions{hover_actions(count)};
+    for (u32 i{0}; i < 20; ++i)
+    {
+        serial.step(actions.data(), serial_out.view());
+        parallel.step(actions.data(), parallel_out.view());
+    }
+    if (owns_pool)
+        jobs::shutdown();
+
+    EXPECT_EQ(serial_out.observations, parallel_out.observations);
+    EXPECT_EQ(serial_out.rewards, parallel_out.rewards);
+}
+
+TEST_F(VectorEnvTest, SameSeedGivesSameMotorNoise)
+{
+    constexpr u32 count{4};
+    QuadParams params{createHummingbirdParams()};
+    params.motor_properties.motor_noise_std = 20.f;
+    const util::vector<f32> actions{hover_actions(count)};
+
+    const auto rollout = [&](u64 seed) {
+        VectorEnvConfig config{make_config(count)};
+        config.seed = seed;
+        VectorEnv env{params, config};
+        buffers out{count};
+        env.reset(nullptr, 0, out.view());
+        for (u32 i{0}; i < 10; ++i)
+            env.step(actions.data(), out.view());
+        return out.observations;
+    };
+
+    // Engines created in between move the engine-wide seed stream on
+    const util::vector<f32> first{rollout(42)};
+    random::next_seed();
+    EXPECT_EQ(rollout(42), first);
+    EXPECT_NE(rollout(43), first);
+}
+
+TEST_F(VectorEnvTest, HoverStaysAtSpawnAndTruncates)
+{
+    constexpr u32 count{8};
+    VectorEnv env{createHummingbirdParams(), make_config(count)};
+    buffers out{count};
+    env.reset(nullptr, 0, out.view());
+    const util::vector<f32> spawn{out.observations};
+
+    const util::vector<f32> actions{hover_actions(count)};
+    for (u32 step{1}; step < 50; ++step)
+    {
+        env.step(actions.data(), out.view());
+        for (u32 i{0}; i < count; ++i)
+        {
+            EXPECT_FALSE(out.terminated[i]);
+            EXPECT_FALSE(out.truncated[i]);
+        }
+    }
+
+    for (u32 i{0}; i < count; ++i)
+    {
+        const f32 *row{out.observations.data() + i * VectorEnv::observation_size};
+        const f32 *start{spawn.data() + i * VectorEnv::observation_size};
+        EXPECT_NEAR(row[2], start[2], 0.05f) << "environment " << i << " drifted vertically";
+    }
+
+    // The 50th step ends the episode and starts a new one in place
+    env.step(actions.data(), out.view());
+    for (u32 i{0}; i < count; ++i)
+    {
+        EXPECT_FALSE(out.terminated[i]);
+        EXPECT_TRUE(out.truncated[i]);
+    }
+    EXPECT_NE(out.observations, spawn);
+}
+
+TEST_F(VectorEnvTest, ResetOnlyTouchesSelectedRows)
+{
+    constexpr u32 count{4};
+    VectorEnv env{createHummingbirdParams(), make_config(count)};
+    buffers out{count};
+    env.reset(nullptr, 0, out.view());
+    const util::vector<f32> before{out.observations};
+
+    const u32 index{2};
+    env.reset(&index, 1, out.view());
+
+    for (u32 i{0}; i < count; ++i)
+    {
+        const bool changed{!std::equal(out.observations.data() + i * VectorEnv::observation_size,
+                                       out.observations.data() +
+                                           (i + 1) * VectorEnv::observation_size,
+                                       before.data() + i * VectorEnv::observation_size)};
+        EXPECT_EQ(changed, i == index);
+    }
+}
+
+} // namespace lark::drone::test
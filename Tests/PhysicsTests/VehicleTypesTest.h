@@ -0,0 +1,61 @@
+#pragma once
+#include "MultirotorTest.h"
+#include "PhysicExtension/Vehicles/VehicleTypes.h"
+
+namespace lark::drone::test
+{
+
+class VehicleTypesTest : public MultirotorTest
+{
+};
+
+TEST_F(VehicleTypesTest, IdenticalParamsShareOneType)
+{
+    const QuadParams params{createHummingbirdParams()};
+    const vehicle_type a{vehicle_types::acquire(params)};
+    const vehicle_type b{vehicle_types::acquire(createHummingbirdParams())};
+
+    EXPECT_EQ(a.get(), b.get());
+
+    // Vehicles built from the parameters resolve to the same type
+    const u32 count{vehicle_types::count()};
+    Multirotor vehicle{params, DroneState{}, ControlAbstraction::CMD_MOTOR_SPEEDS};
+    Control control{params};
+    EXPECT_EQ(vehicle_types::count(), count);
+    EXPECT_EQ(&vehicle.GetDynamics(), a.get());
+}
+
+TEST_F(VehicleTypesTest, DifferentParamsGetTheirOwnType)
+{
+    QuadParams heavy{createHummingbirdParams()};
+    heavy.inertia_properties.mass *= 2.f;
+
+    const vehicle_type light{vehicle_types::acquire(createHummingbirdParams())};
+    const vehicle_type heavier{vehicle_types::acquire(heavy)};
+
+    EXPECT_NE(light.get(), heavier.get());
+    EXPECT_FLOAT_EQ(heavier->GetQuadParams().inertia_properties.mass,
+                    2.f * light->GetQuadParams().inertia_properties.mass);
+}
+
+TEST_F(VehicleTypesTest, TypeIsFreedWithItsLastUser)
+{
+    QuadParams params{createHummingbirdParams()};
+    params.inertia_properties.mass = 0.731f;
+    const u32 count{vehicle_types::count()};
+
+    {
+        Multirotor vehicle{params, DroneState{}, ControlAbstraction::CMD_MOTOR_SPEEDS};
+        const Multirotor copy{vehicle};
+        EXPECT_EQ(vehicle_types::count(), count + 1);
+        EXPECT_EQ(&copy.GetDynamics(), &vehicle.GetDynamics());
+    }
+    EXPECT_EQ(vehicle_types::count(), count);
+
+    // Registering it again builds a fresh type
+    const vehicle_type again{vehicle_types::acquire(params)};
+    EXPECT_EQ(vehicle_types::count(), count + 1);
+    EXPECT_FLOAT_EQ(again->GetQuadParams().inertia_properties.mass, 0.731f);
+}
+
+} // namespace lark::drone::test
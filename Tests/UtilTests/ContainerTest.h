@@ -0,0 +1,166 @@
+#pragma once
+#include "Common/CommonHeaders.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+namespace lark::util::test
+{
+namespace
+{
+/** Counts live instances so leaks and double destruction show up */
+struct tracked
+{
+    static inline int live{0};
+
+    tracked(int v = 0) : value{v} { ++live; }
+    tracked(const tracked &other) : value{other.value} { ++live; }
+    tracked(tracked &&other) noexcept : value{other.value} { ++live; }
+    ~tracked() { --live; }
+    tracked &operator=(const tracked &) = default;
+    tracked &operator=(tracked &&) = default;
+
+    int value;
+};
+
+struct relocatable
+{
+    using trivially_relocatable = std::true_type;
+
+    std::shared_ptr<int> shared;
+    int value{0};
+};
+} // namespace
+
+static_assert(is_trivially_relocatable_v<int>);
+static_assert(is_trivially_relocatable_v<relocatable>);
+static_assert(!is_trivially_relocatable_v<std::string>);
+
+TEST(VectorTest, GrowthKeepsElements)
+{
+    vector<int> v;
+    for (int i{0}; i < 1000; ++i)
+        v.push_back(i);
+
+    ASSERT_EQ(v.size(), 1000u);
+    for (int i{0}; i < 1000; ++i)
+        EXPECT_EQ(v[i], i);
+
+    v.resize(10);
+    v.shrink_to_fit();
+    EXPECT_EQ(v.capacity(), 10u);
+    EXPECT_EQ(v.back(), 9);
+}
+
+TEST(VectorTest, NonTrivialElementsAreDestroyed)
+{
+    tracked::live = 0;
+    {
+        vector<tracked> v;
+        for (int i{0}; i < 100; ++i)
+            v.emplace_back(i);
+
+        v.erase(v.begin() + 10, v.begin() + 20);
+        EXPECT_EQ(v.size(), 90u);
+        EXPECT_EQ(v[10].value, 20);
+        EXPECT_EQ(tracked::live, 90);
+
+        vector<tracked> copy{v};
+        vector<tracked> moved{std::move(v)};
+        EXPECT_TRUE(v.empty());
+        EXPECT_EQ(copy.size(), moved.size());
+        EXPECT_EQ(tracked::live, 180);
+    }
+    EXPECT_EQ(tracked::live, 0);
+}
+
+TEST(VectorTest, PushBackOfOwnElementSurvivesGrowth)
+{
+    vector<std::string> v{"first"};
+    v.shrink_to_fit();
+    for (u32 i{0}; i < 8; ++i)
+        v.push_back(v.front());
+
+    for (const auto &s : v)
+        EXPECT_EQ(s, "first");
+}
+
+TEST(VectorTest, RelocatableTypeKeepsOwnership)
+{
+    vector<relocatable> v;
+    auto shared = std::make_shared<int>(7);
+    for (int i{0}; i < 64; ++i)
+        v.push_back({shared, i});
+
+    EXPECT_EQ(shared.use_count(), 65);
+    v.clear();
+    EXPECT_EQ(shared.use_count(), 1);
+}
+
+TEST(VectorTest, InlineBufferSpillsToHeap)
+{
+    vector<int, 4> v{1, 2, 3};
+    EXPECT_TRUE(v.is_inline());
+
+    vector<int, 4> moved{std::move(v)};
+    EXPECT_TRUE(moved.is_inline());
+    EXPECT_EQ(moved, (vector<int, 4>{1, 2, 3}));
+
+    moved.push_back(4);
+    moved.push_back(5);
+    EXPECT_FALSE(moved.is_inline());
+    EXPECT_EQ(moved[4], 5);
+
+    moved.resize(2);
+    moved.shrink_to_fit();
+    EXPECT_TRUE(moved.is_inline());
+    EXPECT_EQ(moved[1], 2);
+}
+
+TEST(VectorTest, ConvertsFromStdVector)
+{
+    std::vector<int> source{1, 2, 3};
+    vector<int> v;
+    v = std::move(source);
+    EXPECT_EQ(v, (vector<int>{1, 2, 3}));
+}
+
+TEST(DequeTest, RotatesWithoutGrowing)
+{
+    deque<u32> q;
+    for (u32 i{0}; i < 8; ++i)
+        q.push_back(i);
+
+    const size_t capacity{q.capacity()};
+    for (u32 i{8}; i < 1000; ++i)
+    {
+        EXPECT_EQ(q.front(), i - 8);
+        q.pop_front();
+        q.push_back(i);
+    }
+    EXPECT_EQ(q.capacity(), capacity);
+    EXPECT_EQ(q.back(), 999u);
+}
+
+TEST(DequeTest, GrowsAcrossTheWrap)
+{
+    deque<std::string> q;
+    for (u32 i{0}; i < 6; ++i)
+        q.push_back(std::to_string(i));
+    for (u32 i{0}; i < 4; ++i)
+        q.pop_front();
+
+    // Head sits near the end of the ring now, growing has to unwrap it
+    for (u32 i{6}; i < 40; ++i)
+        q.push_back(std::to_string(i));
+    q.push_front("3");
+
+    ASSERT_EQ(q.size(), 37u);
+    for (u32 i{0}; i < q.size(); ++i)
+        EXPECT_EQ(q[i], std::to_string(i + 3));
+
+    q.pop_back();
+    EXPECT_EQ(q.back(), "38");
+}
+
+} // namespace lark::util::test